@@ -24,13 +24,19 @@ option_mappings = {
   '-D'              => OptKVPair[:build_debug, true],
   '--debug'         => OptKVPair[:build_debug, true],
   '-ND'             => OptKVPair[:build_debug, false],
-  '--release'       => OptKVPair[:build_debug, false]
+  '--release'       => OptKVPair[:build_debug, false],
+
+  '-S'              => OptKVPair[:build_simd, true],
+  '--use-simd'      => OptKVPair[:build_simd, true],
+  '-NS'             => OptKVPair[:build_simd, false],
+  '--no-simd'       => OptKVPair[:build_simd, false]
 }
 
 options = {
   :build_float => false,
   :build_fast_math => false,
-  :build_debug => false
+  :build_debug => false,
+  :build_simd => true
 }
 
 ARGV.each {
@@ -65,6 +71,16 @@ else
   $stdout.puts "Using double as base type"
 end
 
+unless options[:build_simd]
+  $CFLAGS += " -DS_NO_SIMD"
+  $stdout.puts "SIMD code paths disabled"
+end
+
 have_library('m', 'cos')
 
+# Batch kernels can split work across threads when pthreads are available
+if have_header('pthread.h')
+  have_library('pthread', 'pthread_create')
+end
+
 create_makefile('snow-math/bindings', 'snow-math/')
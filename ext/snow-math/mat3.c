@@ -9,6 +9,12 @@
 
 #include "maths_local.h"
 
+#if defined(S_SIMD_SSE)
+#include <xmmintrin.h>
+#elif defined(S_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -53,6 +59,107 @@ const mat3_t g_mat3_identity = {
 
 
 
+#if defined(S_SIMD_SSE) || defined(S_SIMD_AVX2)
+
+#define S_MAT3_SIMD 1
+
+/*
+  The SIMD kernels below work on a padded 3x4 layout: each three-component
+  column of a matrix is held in one four-lane register. The fourth lane holds
+  whatever followed the column in memory and is never written back.
+*/
+#if defined(S_SIMD_SSE)
+typedef __m128 s_col_t;
+#define S_COL_LOADU(P)          _mm_loadu_ps(P)
+#define S_COL_STOREU(P, V)      _mm_storeu_ps((P), (V))
+#define S_COL_SPLAT(X)          _mm_set1_ps(X)
+#define S_COL_ADD(L, R)         _mm_add_ps((L), (R))
+#define S_COL_SUB(L, R)         _mm_sub_ps((L), (R))
+#define S_COL_MUL(L, R)         _mm_mul_ps((L), (R))
+#define S_COL_SWIZZLE(V, IMM)   _mm_shuffle_ps((V), (V), (IMM))
+#else
+typedef __m256d s_col_t;
+#define S_COL_LOADU(P)          _mm256_loadu_pd(P)
+#define S_COL_STOREU(P, V)      _mm256_storeu_pd((P), (V))
+#define S_COL_SPLAT(X)          _mm256_set1_pd(X)
+#define S_COL_ADD(L, R)         _mm256_add_pd((L), (R))
+#define S_COL_SUB(L, R)         _mm256_sub_pd((L), (R))
+#define S_COL_MUL(L, R)         _mm256_mul_pd((L), (R))
+#define S_COL_SWIZZLE(V, IMM)   _mm256_permute4x64_pd((V), (IMM))
+#endif
+
+#define S_COL_YZX(V) S_COL_SWIZZLE((V), _MM_SHUFFLE(3, 0, 2, 1))
+#define S_COL_ZXY(V) S_COL_SWIZZLE((V), _MM_SHUFFLE(3, 1, 0, 2))
+
+
+
+/* Loads the columns of m without reading past its last element. */
+static void mat3_load_cols(const mat3_t m, s_col_t *c0, s_col_t *c1, s_col_t *c2)
+{
+  *c0 = S_COL_LOADU(m);
+  *c1 = S_COL_LOADU(m + 3);
+  *c2 = S_COL_SWIZZLE(S_COL_LOADU(m + 5), _MM_SHUFFLE(3, 3, 2, 1));
+}
+
+
+
+/*
+  Stores the columns to out, writing exactly nine elements. The first two
+  stores spill one element into the following column, which the next store
+  then overwrites.
+*/
+static void mat3_store_cols(s_col_t c0, s_col_t c1, s_col_t c2, mat3_t out)
+{
+  s_float_t tail[4];
+  S_COL_STOREU(out, c0);
+  S_COL_STOREU(out + 3, c1);
+  S_COL_STOREU(tail, c2);
+  out[6] = tail[0];
+  out[7] = tail[1];
+  out[8] = tail[2];
+}
+
+
+
+static s_col_t s_col_cross(s_col_t l, s_col_t r)
+{
+  return S_COL_SUB(S_COL_MUL(S_COL_YZX(l), S_COL_ZXY(r)),
+                   S_COL_MUL(S_COL_ZXY(l), S_COL_YZX(r)));
+}
+
+
+
+static s_float_t s_col_dot(s_col_t l, s_col_t r)
+{
+  s_float_t prod[4];
+  S_COL_STOREU(prod, S_COL_MUL(l, r));
+  return prod[0] + prod[1] + prod[2];
+}
+
+
+
+static s_col_t s_col_normalize(s_col_t v)
+{
+  s_float_t mag = s_sqrt(s_col_dot(v, v));
+  if (mag) mag = s_float_lit(1.0) / mag;
+  return S_COL_MUL(v, S_COL_SPLAT(mag));
+}
+
+
+
+/* Returns the sum of c0 * x, c1 * y, and c2 * z. */
+static s_col_t s_col_combine(s_col_t c0, s_col_t c1, s_col_t c2,
+                             s_float_t x, s_float_t y, s_float_t z)
+{
+  return S_COL_ADD(S_COL_ADD(S_COL_MUL(c0, S_COL_SPLAT(x)),
+                             S_COL_MUL(c1, S_COL_SPLAT(y))),
+                   S_COL_MUL(c2, S_COL_SPLAT(z)));
+}
+
+#endif /* S_SIMD_SSE || S_SIMD_AVX2 */
+
+
+
 void mat3_identity(mat3_t out)
 {
   out[0] =
@@ -149,7 +256,7 @@ void mat3_from_quat(const quat_t in, mat3_t out)
   xz = in[0] * in[2];
 
   yy = in[1] * in[1];
-  yz = in[2] * in[2];
+  yz = in[1] * in[2];
 
   zz = in[2] * in[2];
 
@@ -231,12 +338,93 @@ void mat3_scale(const mat3_t in, s_float_t x, s_float_t y, s_float_t z, mat3_t o
 
 
 
+#if defined(S_MAT3_SIMD)
+
 void mat3_orthogonal(const mat3_t in, mat3_t out)
 {
-  vec3_normalize(&in[S_MT], &out[S_MT]);
-  vec3_cross_product(&in[S_MS], &in[S_MT], &out[S_MR]);
-  vec3_normalize(&in[S_MR], &out[S_MR]);
-  vec3_cross_product(&in[S_MT], &in[S_MR], &out[S_MS]);
+  s_col_t r, s, t;
+  mat3_load_cols(in, &r, &s, &t);
+  t = s_col_normalize(t);
+  r = s_col_normalize(s_col_cross(s, t));
+  s = s_col_cross(t, r);
+  mat3_store_cols(r, s, t, out);
+}
+
+
+
+void mat3_multiply(const mat3_t lhs, const mat3_t rhs, mat3_t out)
+{
+  s_col_t c0, c1, c2, r0, r1, r2;
+  mat3_load_cols(lhs, &c0, &c1, &c2);
+  r0 = s_col_combine(c0, c1, c2, rhs[0], rhs[1], rhs[2]);
+  r1 = s_col_combine(c0, c1, c2, rhs[3], rhs[4], rhs[5]);
+  r2 = s_col_combine(c0, c1, c2, rhs[6], rhs[7], rhs[8]);
+  mat3_store_cols(r0, r1, r2, out);
+}
+
+
+
+void mat3_rotate_vec3(const mat3_t lhs, const vec3_t rhs, vec3_t out)
+{
+  s_col_t c0, c1, c2;
+  s_float_t result[4];
+  mat3_load_cols(lhs, &c0, &c1, &c2);
+  S_COL_STOREU(result, s_col_combine(c0, c1, c2, rhs[0], rhs[1], rhs[2]));
+  out[0] = result[0];
+  out[1] = result[1];
+  out[2] = result[2];
+}
+
+void mat3_orthonormalize(const mat3_t in, mat3_t out)
+{
+  s_col_t c0, c1, c2;
+  mat3_load_cols(in, &c0, &c1, &c2);
+  c0 = s_col_normalize(c0);
+  c1 = S_COL_SUB(c1, S_COL_MUL(c0, S_COL_SPLAT(s_col_dot(c0, c1))));
+  c1 = s_col_normalize(c1);
+  c2 = S_COL_SUB(c2, S_COL_MUL(c0, S_COL_SPLAT(s_col_dot(c0, c2))));
+  c2 = S_COL_SUB(c2, S_COL_MUL(c1, S_COL_SPLAT(s_col_dot(c1, c2))));
+  c2 = s_col_normalize(c2);
+  mat3_store_cols(c0, c1, c2, out);
+}
+
+
+
+#else
+
+void mat3_orthogonal(const mat3_t in, mat3_t out)
+{
+  mat3_t temp;
+  vec3_normalize(&in[S_MT], &temp[S_MT]);
+  vec3_cross_product(&in[S_MS], &temp[S_MT], &temp[S_MR]);
+  vec3_normalize(&temp[S_MR], &temp[S_MR]);
+  vec3_cross_product(&temp[S_MT], &temp[S_MR], &temp[S_MS]);
+  mat3_copy(temp, out);
+}
+
+
+
+void mat3_orthonormalize(const mat3_t in, mat3_t out)
+{
+  s_float_t dot;
+  if (in != out) {
+    mat3_copy(in, out);
+  }
+  vec3_normalize(&out[0], &out[0]);
+  dot = vec3_dot_product(&out[0], &out[3]);
+  out[3] -= out[0] * dot;
+  out[4] -= out[1] * dot;
+  out[5] -= out[2] * dot;
+  vec3_normalize(&out[3], &out[3]);
+  dot = vec3_dot_product(&out[0], &out[6]);
+  out[6] -= out[0] * dot;
+  out[7] -= out[1] * dot;
+  out[8] -= out[2] * dot;
+  dot = vec3_dot_product(&out[3], &out[6]);
+  out[6] -= out[3] * dot;
+  out[7] -= out[4] * dot;
+  out[8] -= out[5] * dot;
+  vec3_normalize(&out[6], &out[6]);
 }
 
 
@@ -295,6 +483,8 @@ void mat3_rotate_vec3(const mat3_t lhs, const vec3_t rhs, vec3_t out)
   out[2] = z;
 }
 
+#endif /* S_MAT3_SIMD */
+
 
 
 void mat3_inv_rotate_vec3(const mat3_t lhs, const vec3_t rhs, vec3_t out)
@@ -314,6 +504,87 @@ void mat3_inv_rotate_vec3(const mat3_t lhs, const vec3_t rhs, vec3_t out)
 
 
 
+/* Gathers the affine coefficients (a, b, c, d, tx, ty) read by float_array_affine2 */
+static void mat3_affine_coefficients(const mat3_t in, int translate, s_float_t affine[6])
+{
+  affine[0] = in[0];
+  affine[1] = in[1];
+  affine[2] = in[3];
+  affine[3] = in[4];
+  affine[4] = translate ? in[6] : s_float_lit(0.0);
+  affine[5] = translate ? in[7] : s_float_lit(0.0);
+}
+
+
+
+void mat3_transform_vec2(const mat3_t lhs, const vec2_t rhs, vec2_t out)
+{
+  const s_float_t x = rhs[0];
+  const s_float_t y = rhs[1];
+  out[0] = lhs[0] * x + lhs[3] * y + lhs[6];
+  out[1] = lhs[1] * x + lhs[4] * y + lhs[7];
+}
+
+
+
+void mat3_rotate_vec2(const mat3_t lhs, const vec2_t rhs, vec2_t out)
+{
+  const s_float_t x = rhs[0];
+  const s_float_t y = rhs[1];
+  out[0] = lhs[0] * x + lhs[3] * y;
+  out[1] = lhs[1] * x + lhs[4] * y;
+}
+
+
+
+void mat3_trs_2d(const vec2_t translation, s_float_t angle, const vec2_t scale, mat3_t out)
+{
+  const s_float_t angle_rad = angle * S_DEG2RAD;
+  const s_float_t c = s_cos(angle_rad);
+  const s_float_t s = s_sin(angle_rad);
+  const s_float_t tx = translation[0];
+  const s_float_t ty = translation[1];
+  const s_float_t sx = scale[0];
+  const s_float_t sy = scale[1];
+  out[0] = c * sx;
+  out[1] = s * sx;
+  out[2] = s_float_lit(0.0);
+  out[3] = -s * sy;
+  out[4] = c * sy;
+  out[5] = s_float_lit(0.0);
+  out[6] = tx;
+  out[7] = ty;
+  out[8] = s_float_lit(1.0);
+}
+
+
+
+int mat3_inverse_affine(const mat3_t in, mat3_t out)
+{
+  const s_float_t a = in[0], b = in[1], c = in[3], d = in[4];
+  const s_float_t tx = in[6], ty = in[7];
+  s_float_t determinant = a * d - b * c;
+
+  if (float_is_zero(determinant)) {
+    return 0;
+  }
+  determinant = s_float_lit(1.0) / determinant;
+
+  out[0] = d * determinant;
+  out[1] = -b * determinant;
+  out[2] = s_float_lit(0.0);
+  out[3] = -c * determinant;
+  out[4] = a * determinant;
+  out[5] = s_float_lit(0.0);
+  out[6] = -(out[0] * tx + out[3] * ty);
+  out[7] = -(out[1] * tx + out[4] * ty);
+  out[8] = s_float_lit(1.0);
+
+  return 1;
+}
+
+
+
 void mat3_cofactor(const mat3_t in, mat3_t out)
 {
   const mat3_t temp = {
@@ -351,6 +622,43 @@ void mat3_adjoint(const mat3_t in, mat3_t out)
 
 
 
+#if defined(S_MAT3_SIMD)
+
+int mat3_inverse(const mat3_t in, mat3_t out)
+{
+  s_col_t c0, c1, c2, r0, r1, r2;
+  s_float_t rows[12];
+  s_float_t determinant;
+
+  mat3_load_cols(in, &c0, &c1, &c2);
+  r0 = s_col_cross(c1, c2);
+  determinant = s_col_dot(c0, r0);
+  if (!float_is_zero(determinant)) {
+    determinant = s_float_lit(1.0) / determinant;
+  } else {
+    return 0;
+  }
+
+  r1 = s_col_cross(c2, c0);
+  r2 = s_col_cross(c0, c1);
+  S_COL_STOREU(rows, r0);
+  S_COL_STOREU(rows + 4, r1);
+  S_COL_STOREU(rows + 8, r2);
+  out[0] = rows[0] * determinant;
+  out[1] = rows[4] * determinant;
+  out[2] = rows[8] * determinant;
+  out[3] = rows[1] * determinant;
+  out[4] = rows[5] * determinant;
+  out[5] = rows[9] * determinant;
+  out[6] = rows[2] * determinant;
+  out[7] = rows[6] * determinant;
+  out[8] = rows[10] * determinant;
+
+  return 1;
+}
+
+#else
+
 int mat3_inverse(const mat3_t in, mat3_t out)
 {
   s_float_t determinant = mat3_determinant(in);
@@ -375,6 +683,8 @@ int mat3_inverse(const mat3_t in, mat3_t out)
   return 1;
 }
 
+#endif /* S_MAT3_SIMD */
+
 
 
 void mat3_get_row3(const mat3_t in, int row, vec3_t out)
@@ -487,6 +797,262 @@ void mat3_set_column3(int column, const vec3_t in, mat3_t out)
 
 
 
+void mat3_array_to_mat4(const mat3_t *S_RESTRICT in, mat4_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat3_to_mat4(in[index], out[index]);
+  }
+}
+
+
+
+void mat3_array_from_quat(const quat_t *S_RESTRICT in, mat3_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat3_from_quat(in[index], out[index]);
+  }
+}
+
+
+
+
+
+void mat3_array_multiply(const mat3_t *lhs, const mat3_t *rhs, mat3_t *out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat3_multiply(lhs[index], rhs[index], out[index]);
+  }
+}
+
+
+
+void mat3_array_rotate_vec3(const mat3_t *S_RESTRICT lhs, const vec3_t *rhs, vec3_t *out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat3_rotate_vec3(lhs[index], rhs[index], out[index]);
+  }
+}
+
+
+
+size_t mat3_array_inverse(const mat3_t *in, mat3_t *out, size_t count)
+{
+  size_t index;
+  size_t failed = 0;
+  for (index = 0; index < count; ++index) {
+    if (!mat3_inverse(in[index], out[index])) {
+      mat3_identity(out[index]);
+      ++failed;
+    }
+  }
+  return failed;
+}
+
+
+
+void mat3_array_orthogonal(const mat3_t *in, mat3_t *out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat3_orthogonal(in[index], out[index]);
+  }
+}
+
+
+
+void mat3_array_orthonormalize(mat3_t *inout, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat3_orthonormalize(inout[index], inout[index]);
+  }
+}
+
+
+
+void mat3_array_transform_vec2(const mat3_t *lhs, size_t step, const vec2_t *in, int translate, vec2_t *out, size_t count)
+{
+  s_float_t affine[6];
+  size_t index;
+
+  if (step == 0) {
+    mat3_affine_coefficients(lhs[0], translate, affine);
+    float_array_affine2((const s_float_t *)in, affine, (s_float_t *)out, count);
+    return;
+  }
+
+  for (index = 0; index < count; ++index) {
+    if (translate) {
+      mat3_transform_vec2(lhs[index * step], in[index], out[index]);
+    } else {
+      mat3_rotate_vec2(lhs[index * step], in[index], out[index]);
+    }
+  }
+}
+
+
+
+void mat3_array_trs_2d(const vec2_t *translations, const s_float_t *angles, const vec2_t *scales, mat3_t *out, size_t count)
+{
+  static const vec2_t unit_scale = { s_float_lit(1.0), s_float_lit(1.0) };
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat3_trs_2d(translations[index], angles[index], scales ? scales[index] : unit_scale, out[index]);
+  }
+}
+
+
+
+size_t mat3_array_inverse_affine(const mat3_t *in, mat3_t *out, size_t count)
+{
+  size_t index;
+  size_t failed = 0;
+  for (index = 0; index < count; ++index) {
+    if (!mat3_inverse_affine(in[index], out[index])) {
+      mat3_identity(out[index]);
+      ++failed;
+    }
+  }
+  return failed;
+}
+
+
+
+/*
+  Cyclic Jacobi eigen-decomposition of a symmetric matrix. Each rotation zeroes
+  one off-diagonal pair, and sweeps repeat until the off-diagonal part is
+  negligible next to the diagonal. Eigenvectors are written as the rows of
+  rotation, sorted by decreasing eigenvalue, with the last one flipped if
+  needed so rotation is a proper rotation (determinant 1).
+*/
+#define MAT3_JACOBI_MAX_SWEEPS 32
+
+int mat3_eigen_symmetric(const mat3_t in, mat3_t rotation, vec3_t eigenvalues)
+{
+  static const int pairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+  s_float_t a[3][3];
+  s_float_t v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+  int order[3] = { 0, 1, 2 };
+  int converged = 0;
+  int sweep;
+  int pair;
+  int row;
+  int k;
+
+  for (row = 0; row < 3; ++row) {
+    for (k = 0; k < 3; ++k) {
+      a[row][k] = in[row * 3 + k];
+    }
+  }
+
+  for (sweep = 0; sweep < MAT3_JACOBI_MAX_SWEEPS; ++sweep) {
+    const s_float_t off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+    const s_float_t diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+    if (off <= S_FLOAT_EPSILON * S_FLOAT_EPSILON * diagonal || off == s_float_lit(0.0)) {
+      converged = 1;
+      break;
+    }
+
+    for (pair = 0; pair < 3; ++pair) {
+      const int p = pairs[pair][0];
+      const int q = pairs[pair][1];
+      s_float_t theta, t, c, s;
+
+      if (a[p][q] == s_float_lit(0.0)) {
+        continue;
+      }
+
+      theta = (a[q][q] - a[p][p]) / (s_float_lit(2.0) * a[p][q]);
+      t = s_float_lit(1.0) / (s_fabs(theta) + s_sqrt(theta * theta + s_float_lit(1.0)));
+      if (theta < s_float_lit(0.0)) {
+        t = -t;
+      }
+      c = s_float_lit(1.0) / s_sqrt(t * t + s_float_lit(1.0));
+      s = t * c;
+
+      for (k = 0; k < 3; ++k) {
+        const s_float_t akp = a[k][p];
+        const s_float_t akq = a[k][q];
+        a[k][p] = c * akp - s * akq;
+        a[k][q] = s * akp + c * akq;
+      }
+      for (k = 0; k < 3; ++k) {
+        const s_float_t apk = a[p][k];
+        const s_float_t aqk = a[q][k];
+        a[p][k] = c * apk - s * aqk;
+        a[q][k] = s * apk + c * aqk;
+      }
+      for (k = 0; k < 3; ++k) {
+        const s_float_t vkp = v[k][p];
+        const s_float_t vkq = v[k][q];
+        v[k][p] = c * vkp - s * vkq;
+        v[k][q] = s * vkp + c * vkq;
+      }
+    }
+  }
+
+  /* Sort the three eigenvalues in decreasing order */
+  for (row = 0; row < 2; ++row) {
+    for (k = row + 1; k < 3; ++k) {
+      if (a[order[k]][order[k]] > a[order[row]][order[row]]) {
+        const int swap = order[row];
+        order[row] = order[k];
+        order[k] = swap;
+      }
+    }
+  }
+
+  for (row = 0; row < 3; ++row) {
+    eigenvalues[row] = a[order[row]][order[row]];
+    for (k = 0; k < 3; ++k) {
+      rotation[row * 3 + k] = v[k][order[row]];
+    }
+  }
+
+  if (mat3_determinant(rotation) < s_float_lit(0.0)) {
+    rotation[6] = -rotation[6];
+    rotation[7] = -rotation[7];
+    rotation[8] = -rotation[8];
+  }
+
+  return converged;
+}
+
+
+
+/*
+  A reflected frame has its bitangent flipped before its rotation is taken,
+  and flipped back on decoding.
+*/
+void mat3_array_encode_qtangent(const mat3_t *in, size_t count, uint8_t *out)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    const s_float_t sign = (mat3_determinant(in[index]) < s_float_lit(0.0)) ? s_float_lit(-1.0) : s_float_lit(1.0);
+    mat3_t frame;
+    quat_t rotation;
+    mat3_copy(in[index], frame);
+    vec3_scale(frame + 3, sign, frame + 3);
+    quat_from_mat3(frame, rotation);
+    quat_encode_qtangent(rotation, sign, out + index * 8);
+  }
+}
+
+void mat3_array_decode_qtangent(const uint8_t *in, size_t count, mat3_t *out)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    quat_t rotation;
+    const s_float_t sign = quat_decode_qtangent(in + index * 8, rotation);
+    mat3_from_quat(rotation, out[index]);
+    vec3_scale(out[index] + 3, sign, out[index] + 3);
+  }
+}
+
 #if defined(__cplusplus)
 }
 #endif
@@ -9,6 +9,12 @@
 
 #include "maths_local.h"
 
+#if defined(S_SIMD_SSE)
+#include <xmmintrin.h>
+#elif defined(S_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -322,7 +328,7 @@ void mat4_from_quat(const quat_t quat, mat4_t out)
   xz = quat[0] * quat[2];
 
   yy = quat[1] * quat[1];
-  yz = quat[2] * quat[2];
+  yz = quat[1] * quat[2];
 
   zz = quat[2] * quat[2];
 
@@ -622,7 +628,7 @@ void mat4_adjoint(const mat4_t in, mat4_t out)
   }
 }
 
-s_float_t mat4_determinant(const mat4_t m)
+s_float_t mat4_determinant_ref(const mat4_t m)
 {
   return (
     (m[0] * mat4_cofactor(m, 1, 2, 3, 1, 2, 3)) -
@@ -632,10 +638,10 @@ s_float_t mat4_determinant(const mat4_t m)
     );
 }
 
-int mat4_inverse_general(const mat4_t in, mat4_t out)
+int mat4_inverse_general_ref(const mat4_t in, mat4_t out)
 {
   int index;
-  s_float_t det = mat4_determinant(in);
+  s_float_t det = mat4_determinant_ref(in);
 
   if (s_fabs(det) < S_FLOAT_EPSILON) {
     return 0;
@@ -650,6 +656,278 @@ int mat4_inverse_general(const mat4_t in, mat4_t out)
   return 1;
 }
 
+/*
+  The general inverse and determinant below share the twelve 2x2 determinants
+  of the top two rows (s0-s5) and bottom two rows (c0-c5) rather than computing
+  each 3x3 cofactor separately. With rows r0-r3:
+
+    s0 = r0.x*r1.y - r1.x*r0.y    c0 = r2.x*r3.y - r3.x*r2.y
+    s1 = r0.x*r1.z - r1.x*r0.z    c1 = r2.x*r3.z - r3.x*r2.z
+    s2 = r0.x*r1.w - r1.x*r0.w    c2 = r2.x*r3.w - r3.x*r2.w
+    s3 = r0.y*r1.z - r1.y*r0.z    c3 = r2.y*r3.z - r3.y*r2.z
+    s4 = r0.y*r1.w - r1.y*r0.w    c4 = r2.y*r3.w - r3.y*r2.w
+    s5 = r0.z*r1.w - r1.z*r0.w    c5 = r2.z*r3.w - r3.z*r2.w
+
+    det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0
+
+  Because inverse(transpose(m)) = transpose(inverse(m)), it doesn't matter
+  whether the matrix is read as rows or columns so long as the output is
+  written the same way.
+*/
+#define S_MAT4_DET_FROM_SUBDETS(S, C) \
+  (((S)[0] * (C)[5]) - ((S)[1] * (C)[4]) + ((S)[2] * (C)[3]) + \
+   ((S)[3] * (C)[2]) - ((S)[4] * (C)[1]) + ((S)[5] * (C)[0]))
+
+#if defined(S_SIMD_SSE)
+
+/*
+  Computes s0-s3, s4-s5 (duplicated), c0-c3, and c4-c5 (duplicated) for the
+  rows r0-r3.
+*/
+static void mat4_subdets_sse(__m128 r0, __m128 r1, __m128 r2, __m128 r3,
+                             __m128 *s03, __m128 *s45, __m128 *c03, __m128 *c45)
+{
+  #define S_SHUF(V, X, Y, Z, W) _mm_shuffle_ps((V), (V), _MM_SHUFFLE(W, Z, Y, X))
+  *s03 = _mm_sub_ps(_mm_mul_ps(S_SHUF(r0, 0, 0, 0, 1), S_SHUF(r1, 1, 2, 3, 2)),
+                    _mm_mul_ps(S_SHUF(r1, 0, 0, 0, 1), S_SHUF(r0, 1, 2, 3, 2)));
+  *s45 = _mm_sub_ps(_mm_mul_ps(S_SHUF(r0, 1, 2, 1, 2), S_SHUF(r1, 3, 3, 3, 3)),
+                    _mm_mul_ps(S_SHUF(r1, 1, 2, 1, 2), S_SHUF(r0, 3, 3, 3, 3)));
+  *c03 = _mm_sub_ps(_mm_mul_ps(S_SHUF(r2, 0, 0, 0, 1), S_SHUF(r3, 1, 2, 3, 2)),
+                    _mm_mul_ps(S_SHUF(r3, 0, 0, 0, 1), S_SHUF(r2, 1, 2, 3, 2)));
+  *c45 = _mm_sub_ps(_mm_mul_ps(S_SHUF(r2, 1, 2, 1, 2), S_SHUF(r3, 3, 3, 3, 3)),
+                    _mm_mul_ps(S_SHUF(r3, 1, 2, 1, 2), S_SHUF(r2, 3, 3, 3, 3)));
+  #undef S_SHUF
+}
+
+static s_float_t mat4_det_from_subdets_sse(__m128 s03, __m128 s45, __m128 c03, __m128 c45)
+{
+  s_float_t s[8], c[8];
+  _mm_storeu_ps(s, s03);
+  _mm_storeu_ps(s + 4, s45);
+  _mm_storeu_ps(c, c03);
+  _mm_storeu_ps(c + 4, c45);
+  return S_MAT4_DET_FROM_SUBDETS(s, c);
+}
+
+s_float_t mat4_determinant(const mat4_t m)
+{
+  __m128 s03, s45, c03, c45;
+  mat4_subdets_sse(_mm_loadu_ps(m), _mm_loadu_ps(m + 4),
+                   _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12),
+                   &s03, &s45, &c03, &c45);
+  return mat4_det_from_subdets_sse(s03, s45, c03, c45);
+}
+
+int mat4_inverse_general(const mat4_t in, mat4_t out)
+{
+  const __m128 sign = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+  const __m128 r0 = _mm_loadu_ps(in);
+  const __m128 r1 = _mm_loadu_ps(in + 4);
+  const __m128 r2 = _mm_loadu_ps(in + 8);
+  const __m128 r3 = _mm_loadu_ps(in + 12);
+  __m128 s03, s45, c03, c45, lo10, hi10, lo32, hi32, q0, q1, q2, q3;
+  __m128 k0, k1, k2, k3, k4, k5, inv_det;
+  s_float_t det;
+
+  mat4_subdets_sse(r0, r1, r2, r3, &s03, &s45, &c03, &c45);
+  det = mat4_det_from_subdets_sse(s03, s45, c03, c45);
+  if (s_fabs(det) < S_FLOAT_EPSILON) {
+    return 0;
+  }
+
+  /* qN = <r1[N], -r0[N], r3[N], -r2[N]> */
+  lo10 = _mm_unpacklo_ps(r1, r0);
+  hi10 = _mm_unpackhi_ps(r1, r0);
+  lo32 = _mm_unpacklo_ps(r3, r2);
+  hi32 = _mm_unpackhi_ps(r3, r2);
+  q0 = _mm_xor_ps(_mm_movelh_ps(lo10, lo32), sign);
+  q1 = _mm_xor_ps(_mm_movehl_ps(lo32, lo10), sign);
+  q2 = _mm_xor_ps(_mm_movelh_ps(hi10, hi32), sign);
+  q3 = _mm_xor_ps(_mm_movehl_ps(hi32, hi10), sign);
+
+  /* kN = <cN, cN, sN, sN> */
+  k0 = _mm_shuffle_ps(c03, s03, _MM_SHUFFLE(0, 0, 0, 0));
+  k1 = _mm_shuffle_ps(c03, s03, _MM_SHUFFLE(1, 1, 1, 1));
+  k2 = _mm_shuffle_ps(c03, s03, _MM_SHUFFLE(2, 2, 2, 2));
+  k3 = _mm_shuffle_ps(c03, s03, _MM_SHUFFLE(3, 3, 3, 3));
+  k4 = _mm_shuffle_ps(c45, s45, _MM_SHUFFLE(0, 0, 0, 0));
+  k5 = _mm_shuffle_ps(c45, s45, _MM_SHUFFLE(1, 1, 1, 1));
+
+  inv_det = _mm_set1_ps(s_float_lit(1.0) / det);
+
+  _mm_storeu_ps(out, _mm_mul_ps(inv_det,
+    _mm_add_ps(_mm_sub_ps(_mm_mul_ps(q1, k5), _mm_mul_ps(q2, k4)), _mm_mul_ps(q3, k3))));
+  _mm_storeu_ps(out + 4, _mm_mul_ps(inv_det,
+    _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(q2, k2), _mm_mul_ps(q0, k5)), _mm_mul_ps(q3, k1))));
+  _mm_storeu_ps(out + 8, _mm_mul_ps(inv_det,
+    _mm_add_ps(_mm_sub_ps(_mm_mul_ps(q0, k4), _mm_mul_ps(q1, k2)), _mm_mul_ps(q3, k0))));
+  _mm_storeu_ps(out + 12, _mm_mul_ps(inv_det,
+    _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(q1, k1), _mm_mul_ps(q0, k3)), _mm_mul_ps(q2, k0))));
+
+  return 1;
+}
+
+#elif defined(S_SIMD_AVX2)
+
+/* See mat4_subdets_sse. */
+static void mat4_subdets_avx2(__m256d r0, __m256d r1, __m256d r2, __m256d r3,
+                              __m256d *s03, __m256d *s45, __m256d *c03, __m256d *c45)
+{
+  #define S_SHUF(V, X, Y, Z, W) _mm256_permute4x64_pd((V), _MM_SHUFFLE(W, Z, Y, X))
+  *s03 = _mm256_sub_pd(_mm256_mul_pd(S_SHUF(r0, 0, 0, 0, 1), S_SHUF(r1, 1, 2, 3, 2)),
+                       _mm256_mul_pd(S_SHUF(r1, 0, 0, 0, 1), S_SHUF(r0, 1, 2, 3, 2)));
+  *s45 = _mm256_sub_pd(_mm256_mul_pd(S_SHUF(r0, 1, 2, 1, 2), S_SHUF(r1, 3, 3, 3, 3)),
+                       _mm256_mul_pd(S_SHUF(r1, 1, 2, 1, 2), S_SHUF(r0, 3, 3, 3, 3)));
+  *c03 = _mm256_sub_pd(_mm256_mul_pd(S_SHUF(r2, 0, 0, 0, 1), S_SHUF(r3, 1, 2, 3, 2)),
+                       _mm256_mul_pd(S_SHUF(r3, 0, 0, 0, 1), S_SHUF(r2, 1, 2, 3, 2)));
+  *c45 = _mm256_sub_pd(_mm256_mul_pd(S_SHUF(r2, 1, 2, 1, 2), S_SHUF(r3, 3, 3, 3, 3)),
+                       _mm256_mul_pd(S_SHUF(r3, 1, 2, 1, 2), S_SHUF(r2, 3, 3, 3, 3)));
+  #undef S_SHUF
+}
+
+static s_float_t mat4_det_from_subdets_avx2(__m256d s03, __m256d s45, __m256d c03, __m256d c45)
+{
+  s_float_t s[8], c[8];
+  _mm256_storeu_pd(s, s03);
+  _mm256_storeu_pd(s + 4, s45);
+  _mm256_storeu_pd(c, c03);
+  _mm256_storeu_pd(c + 4, c45);
+  return S_MAT4_DET_FROM_SUBDETS(s, c);
+}
+
+s_float_t mat4_determinant(const mat4_t m)
+{
+  __m256d s03, s45, c03, c45;
+  mat4_subdets_avx2(_mm256_loadu_pd(m), _mm256_loadu_pd(m + 4),
+                    _mm256_loadu_pd(m + 8), _mm256_loadu_pd(m + 12),
+                    &s03, &s45, &c03, &c45);
+  return mat4_det_from_subdets_avx2(s03, s45, c03, c45);
+}
+
+int mat4_inverse_general(const mat4_t in, mat4_t out)
+{
+  const __m256d sign = _mm256_set_pd(-0.0, 0.0, -0.0, 0.0);
+  const __m256d r0 = _mm256_loadu_pd(in);
+  const __m256d r1 = _mm256_loadu_pd(in + 4);
+  const __m256d r2 = _mm256_loadu_pd(in + 8);
+  const __m256d r3 = _mm256_loadu_pd(in + 12);
+  __m256d s03, s45, c03, c45, t0, t1, t2, t3, q0, q1, q2, q3;
+  __m256d k0, k1, k2, k3, k4, k5, inv_det;
+  s_float_t det;
+
+  mat4_subdets_avx2(r0, r1, r2, r3, &s03, &s45, &c03, &c45);
+  det = mat4_det_from_subdets_avx2(s03, s45, c03, c45);
+  if (s_fabs(det) < S_FLOAT_EPSILON) {
+    return 0;
+  }
+
+  /* qN = <r1[N], -r0[N], r3[N], -r2[N]> */
+  t0 = _mm256_unpacklo_pd(r1, r0);
+  t1 = _mm256_unpackhi_pd(r1, r0);
+  t2 = _mm256_unpacklo_pd(r3, r2);
+  t3 = _mm256_unpackhi_pd(r3, r2);
+  q0 = _mm256_xor_pd(_mm256_permute2f128_pd(t0, t2, 0x20), sign);
+  q1 = _mm256_xor_pd(_mm256_permute2f128_pd(t1, t3, 0x20), sign);
+  q2 = _mm256_xor_pd(_mm256_permute2f128_pd(t0, t2, 0x31), sign);
+  q3 = _mm256_xor_pd(_mm256_permute2f128_pd(t1, t3, 0x31), sign);
+
+  /* kN = <cN, cN, sN, sN> */
+  #define S_SPLAT_CS(C, S, N) \
+    _mm256_blend_pd(_mm256_permute4x64_pd((C), _MM_SHUFFLE(N, N, N, N)), \
+                    _mm256_permute4x64_pd((S), _MM_SHUFFLE(N, N, N, N)), 0xC)
+  k0 = S_SPLAT_CS(c03, s03, 0);
+  k1 = S_SPLAT_CS(c03, s03, 1);
+  k2 = S_SPLAT_CS(c03, s03, 2);
+  k3 = S_SPLAT_CS(c03, s03, 3);
+  k4 = S_SPLAT_CS(c45, s45, 0);
+  k5 = S_SPLAT_CS(c45, s45, 1);
+  #undef S_SPLAT_CS
+
+  inv_det = _mm256_set1_pd(s_float_lit(1.0) / det);
+
+  _mm256_storeu_pd(out, _mm256_mul_pd(inv_det,
+    _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(q1, k5), _mm256_mul_pd(q2, k4)), _mm256_mul_pd(q3, k3))));
+  _mm256_storeu_pd(out + 4, _mm256_mul_pd(inv_det,
+    _mm256_sub_pd(_mm256_sub_pd(_mm256_mul_pd(q2, k2), _mm256_mul_pd(q0, k5)), _mm256_mul_pd(q3, k1))));
+  _mm256_storeu_pd(out + 8, _mm256_mul_pd(inv_det,
+    _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(q0, k4), _mm256_mul_pd(q1, k2)), _mm256_mul_pd(q3, k0))));
+  _mm256_storeu_pd(out + 12, _mm256_mul_pd(inv_det,
+    _mm256_sub_pd(_mm256_sub_pd(_mm256_mul_pd(q1, k1), _mm256_mul_pd(q0, k3)), _mm256_mul_pd(q2, k0))));
+
+  return 1;
+}
+
+#else
+
+static void mat4_subdets(const mat4_t m, s_float_t s[6], s_float_t c[6])
+{
+  s[0] = (m[0 ] * m[5 ]) - (m[4 ] * m[1 ]);
+  s[1] = (m[0 ] * m[6 ]) - (m[4 ] * m[2 ]);
+  s[2] = (m[0 ] * m[7 ]) - (m[4 ] * m[3 ]);
+  s[3] = (m[1 ] * m[6 ]) - (m[5 ] * m[2 ]);
+  s[4] = (m[1 ] * m[7 ]) - (m[5 ] * m[3 ]);
+  s[5] = (m[2 ] * m[7 ]) - (m[6 ] * m[3 ]);
+
+  c[0] = (m[8 ] * m[13]) - (m[12] * m[9 ]);
+  c[1] = (m[8 ] * m[14]) - (m[12] * m[10]);
+  c[2] = (m[8 ] * m[15]) - (m[12] * m[11]);
+  c[3] = (m[9 ] * m[14]) - (m[13] * m[10]);
+  c[4] = (m[9 ] * m[15]) - (m[13] * m[11]);
+  c[5] = (m[10] * m[15]) - (m[14] * m[11]);
+}
+
+s_float_t mat4_determinant(const mat4_t m)
+{
+  s_float_t s[6], c[6];
+  mat4_subdets(m, s, c);
+  return S_MAT4_DET_FROM_SUBDETS(s, c);
+}
+
+int mat4_inverse_general(const mat4_t in, mat4_t out)
+{
+  s_float_t s[6], c[6];
+  mat4_t temp;
+  s_float_t det;
+  int index;
+
+  mat4_subdets(in, s, c);
+  det = S_MAT4_DET_FROM_SUBDETS(s, c);
+  if (s_fabs(det) < S_FLOAT_EPSILON) {
+    return 0;
+  }
+
+  temp[0 ] =  (in[5 ] * c[5]) - (in[6 ] * c[4]) + (in[7 ] * c[3]);
+  temp[1 ] = -(in[1 ] * c[5]) + (in[2 ] * c[4]) - (in[3 ] * c[3]);
+  temp[2 ] =  (in[13] * s[5]) - (in[14] * s[4]) + (in[15] * s[3]);
+  temp[3 ] = -(in[9 ] * s[5]) + (in[10] * s[4]) - (in[11] * s[3]);
+
+  temp[4 ] = -(in[4 ] * c[5]) + (in[6 ] * c[2]) - (in[7 ] * c[1]);
+  temp[5 ] =  (in[0 ] * c[5]) - (in[2 ] * c[2]) + (in[3 ] * c[1]);
+  temp[6 ] = -(in[12] * s[5]) + (in[14] * s[2]) - (in[15] * s[1]);
+  temp[7 ] =  (in[8 ] * s[5]) - (in[10] * s[2]) + (in[11] * s[1]);
+
+  temp[8 ] =  (in[4 ] * c[4]) - (in[5 ] * c[2]) + (in[7 ] * c[0]);
+  temp[9 ] = -(in[0 ] * c[4]) + (in[1 ] * c[2]) - (in[3 ] * c[0]);
+  temp[10] =  (in[12] * s[4]) - (in[13] * s[2]) + (in[15] * s[0]);
+  temp[11] = -(in[8 ] * s[4]) + (in[9 ] * s[2]) - (in[11] * s[0]);
+
+  temp[12] = -(in[4 ] * c[3]) + (in[5 ] * c[1]) - (in[6 ] * c[0]);
+  temp[13] =  (in[0 ] * c[3]) - (in[1 ] * c[1]) + (in[2 ] * c[0]);
+  temp[14] = -(in[12] * s[3]) + (in[13] * s[1]) - (in[14] * s[0]);
+  temp[15] =  (in[8 ] * s[3]) - (in[9 ] * s[1]) + (in[10] * s[0]);
+
+  det = s_float_lit(1.0) / det;
+  for (index = 0; index < 16; ++index) {
+    out[index] = temp[index] * det;
+  }
+
+  return 1;
+}
+
+#endif
+
+#undef S_MAT4_DET_FROM_SUBDETS
+
 /*! Translates the given matrix by <X, Y, Z>. */
 void mat4_translate(s_float_t x, s_float_t y, s_float_t z, const mat4_t in, mat4_t out)
 {
@@ -785,6 +1063,87 @@ void mat4_scale(const mat4_t in, s_float_t x, s_float_t y, s_float_t z, mat4_t o
   out[15] = in[15];
 }
 
+void mat4_orthonormalize(const mat4_t in, mat4_t out)
+{
+  s_float_t dot;
+  if (in != out) {
+    mat4_copy(in, out);
+  }
+  vec3_normalize(&out[0], &out[0]);
+  dot = vec3_dot_product(&out[0], &out[4]);
+  out[4 ] -= out[0] * dot;
+  out[5 ] -= out[1] * dot;
+  out[6 ] -= out[2] * dot;
+  vec3_normalize(&out[4], &out[4]);
+  dot = vec3_dot_product(&out[0], &out[8]);
+  out[8 ] -= out[0] * dot;
+  out[9 ] -= out[1] * dot;
+  out[10] -= out[2] * dot;
+  dot = vec3_dot_product(&out[4], &out[8]);
+  out[8 ] -= out[4] * dot;
+  out[9 ] -= out[5] * dot;
+  out[10] -= out[6] * dot;
+  vec3_normalize(&out[8], &out[8]);
+}
+
+void mat4_array_to_mat3(const mat4_t *S_RESTRICT in, mat3_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat4_to_mat3(in[index], out[index]);
+  }
+}
+
+void mat4_array_from_quat(const quat_t *S_RESTRICT in, mat4_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat4_from_quat(in[index], out[index]);
+  }
+}
+
+void mat4_array_orthonormalize(mat4_t *inout, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    mat4_orthonormalize(inout[index], inout[index]);
+  }
+}
+
+/*
+  World boxes use the absolute-matrix method: the box's center is transformed
+  as a point and its half extents by the absolute values of the upper 3x3, which
+  gives the tightest axis-aligned box around the transformed box. Each box is
+  read before it is written, so outputs may be the inputs.
+*/
+void mat4_array_transform_aabb(const mat4_t *transforms, const vec3_t *mins, const vec3_t *maxs,
+  const size_t *indices, size_t count, vec3_t *out_mins, vec3_t *out_maxs)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    const size_t box = indices ? indices[index] : index;
+    const s_float_t *m = transforms[box];
+    vec3_t center, extent, world_center, world_extent;
+    int axis;
+
+    for (axis = 0; axis < 3; ++axis) {
+      center[axis] = (mins[box][axis] + maxs[box][axis]) * s_float_lit(0.5);
+      extent[axis] = (maxs[box][axis] - mins[box][axis]) * s_float_lit(0.5);
+    }
+
+    mat4_transform_vec3(m, center, world_center);
+    for (axis = 0; axis < 3; ++axis) {
+      world_extent[axis] =
+        s_fabs(m[axis]) * extent[0] +
+        s_fabs(m[axis + 4]) * extent[1] +
+        s_fabs(m[axis + 8]) * extent[2];
+    }
+
+    vec3_subtract(world_center, world_extent, out_mins[box]);
+    vec3_add(world_center, world_extent, out_maxs[box]);
+  }
+}
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
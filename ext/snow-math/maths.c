@@ -1,6 +1,22 @@
 #include "maths_local.h"
 #define __SNOW__MATHS_C__
 
+#include <string.h>
+
+#if defined(S_HAVE_THREADS)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#if defined(S_SIMD_SSE)
+#include <xmmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#elif defined(S_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
 s_float_t S_FLOAT_EPSILON = s_float_lit(
                             #ifdef USE_FLOAT
                             1.0e-6
@@ -8,3 +24,1326 @@ s_float_t S_FLOAT_EPSILON = s_float_lit(
                             1.0e-9
                             #endif
                             );
+
+s_float_t float_sign(const s_float_t x)
+{
+  return (x > s_float_lit(0.0)) ? s_float_lit(1.0) : ((x < s_float_lit(0.0)) ? s_float_lit(-1.0) : s_float_lit(0.0));
+}
+
+void s_store_packed(uint64_t bits, size_t bytes, uint8_t *out)
+{
+  size_t index;
+  for (index = 0; index < bytes; ++index) {
+    out[index] = (uint8_t)(bits >> (index * 8));
+  }
+}
+
+uint64_t s_load_packed(const uint8_t *in, size_t bytes)
+{
+  uint64_t bits = 0;
+  size_t index;
+  for (index = 0; index < bytes; ++index) {
+    bits |= (uint64_t)in[index] << (index * 8);
+  }
+  return bits;
+}
+
+uint64_t s_quantize_unit(s_float_t t, uint64_t max_value)
+{
+  if (!(t > s_float_lit(0.0))) {
+    return 0;
+  } else if (t >= s_float_lit(1.0)) {
+    return max_value;
+  }
+  return (uint64_t)(t * (s_float_t)max_value + s_float_lit(0.5));
+}
+
+void s_store_snorm16(s_float_t value, uint8_t *out)
+{
+  if (!(value > s_float_lit(-1.0))) {
+    value = s_float_lit(-1.0);
+  } else if (value > s_float_lit(1.0)) {
+    value = s_float_lit(1.0);
+  }
+  s_store_packed((uint16_t)(int16_t)s_floor(value * s_float_lit(32767.0) + s_float_lit(0.5)), 2, out);
+}
+
+s_float_t s_load_snorm16(const uint8_t *in)
+{
+  const s_float_t value = (s_float_t)(int16_t)(uint16_t)s_load_packed(in, 2) / s_float_lit(32767.0);
+  return (value < s_float_lit(-1.0)) ? s_float_lit(-1.0) : value;
+}
+
+
+
+/*
+  Lane abstraction for the flat componentwise kernels below. A lane holds four
+  s_float_t in either SIMD path. Floor and ceil need SSE4.1 in the float path
+  and fall back to the scalar loop without it. Swapping pairs exchanges
+  neighbouring components, so xy pairs become yx. Movemask packs the sign bits
+  of a compare result into the low four bits of an int, and splatting W
+  copies the fourth component to all four.
+*/
+#if defined(S_SIMD_SSE)
+typedef __m128 s_lane_t;
+#define S_LANE_WIDTH          4
+#define S_LANE_LOADU(P)       _mm_loadu_ps((P))
+#define S_LANE_STOREU(P, V)   _mm_storeu_ps((P), (V))
+#define S_LANE_SPLAT(X)       _mm_set1_ps((X))
+#define S_LANE_MIN(A, B)      _mm_min_ps((A), (B))
+#define S_LANE_MAX(A, B)      _mm_max_ps((A), (B))
+#define S_LANE_AND(A, B)      _mm_and_ps((A), (B))
+#define S_LANE_ANDNOT(A, B)   _mm_andnot_ps((A), (B))
+#define S_LANE_ADD(A, B)      _mm_add_ps((A), (B))
+#define S_LANE_SUB(A, B)      _mm_sub_ps((A), (B))
+#define S_LANE_MUL(A, B)      _mm_mul_ps((A), (B))
+#define S_LANE_DIV(A, B)      _mm_div_ps((A), (B))
+#define S_LANE_SETR(A, B, C, D) _mm_setr_ps((A), (B), (C), (D))
+#define S_LANE_CMPGT(A, B)    _mm_cmpgt_ps((A), (B))
+#define S_LANE_CMPLT(A, B)    _mm_cmplt_ps((A), (B))
+#define S_LANE_CMPLE(A, B)    _mm_cmple_ps((A), (B))
+#define S_LANE_CMPEQ(A, B)    _mm_cmpeq_ps((A), (B))
+#if defined(__SSE4_1__)
+#define S_LANE_FLOOR(A)       _mm_floor_ps((A))
+#define S_LANE_CEIL(A)        _mm_ceil_ps((A))
+#endif
+#define S_LANE_SWAP_PAIRS(A)  _mm_shuffle_ps((A), (A), _MM_SHUFFLE(2, 3, 0, 1))
+#define S_LANE_MOVEMASK(A)    _mm_movemask_ps((A))
+#define S_LANE_OR(A, B)       _mm_or_ps((A), (B))
+#define S_LANE_SQRT(A)        _mm_sqrt_ps((A))
+#define S_LANE_SPLAT_W(A)     _mm_shuffle_ps((A), (A), _MM_SHUFFLE(3, 3, 3, 3))
+#elif defined(S_SIMD_AVX2)
+typedef __m256d s_lane_t;
+#define S_LANE_WIDTH          4
+#define S_LANE_LOADU(P)       _mm256_loadu_pd((P))
+#define S_LANE_STOREU(P, V)   _mm256_storeu_pd((P), (V))
+#define S_LANE_SPLAT(X)       _mm256_set1_pd((X))
+#define S_LANE_MIN(A, B)      _mm256_min_pd((A), (B))
+#define S_LANE_MAX(A, B)      _mm256_max_pd((A), (B))
+#define S_LANE_AND(A, B)      _mm256_and_pd((A), (B))
+#define S_LANE_ANDNOT(A, B)   _mm256_andnot_pd((A), (B))
+#define S_LANE_ADD(A, B)      _mm256_add_pd((A), (B))
+#define S_LANE_SUB(A, B)      _mm256_sub_pd((A), (B))
+#define S_LANE_MUL(A, B)      _mm256_mul_pd((A), (B))
+#define S_LANE_DIV(A, B)      _mm256_div_pd((A), (B))
+#define S_LANE_SETR(A, B, C, D) _mm256_setr_pd((A), (B), (C), (D))
+#define S_LANE_CMPGT(A, B)    _mm256_cmp_pd((A), (B), _CMP_GT_OQ)
+#define S_LANE_CMPLT(A, B)    _mm256_cmp_pd((A), (B), _CMP_LT_OQ)
+#define S_LANE_CMPLE(A, B)    _mm256_cmp_pd((A), (B), _CMP_LE_OQ)
+#define S_LANE_CMPEQ(A, B)    _mm256_cmp_pd((A), (B), _CMP_EQ_OQ)
+#define S_LANE_FLOOR(A)       _mm256_floor_pd((A))
+#define S_LANE_CEIL(A)        _mm256_ceil_pd((A))
+#define S_LANE_SWAP_PAIRS(A)  _mm256_permute_pd((A), 0x5)
+#define S_LANE_MOVEMASK(A)    _mm256_movemask_pd((A))
+#define S_LANE_OR(A, B)       _mm256_or_pd((A), (B))
+#define S_LANE_SQRT(A)        _mm256_sqrt_pd((A))
+#define S_LANE_SPLAT_W(A)     _mm256_permute4x64_pd((A), 0xFF)
+#endif
+
+/*
+  Note: the scalar tails and fallbacks use the same comparisons as the SIMD min
+  and max instructions, so NaN handling matches across paths (the right-hand
+  value wins).
+*/
+
+void float_array_min(const s_float_t *left, const s_float_t *right, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+#if defined(S_LANE_WIDTH)
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    S_LANE_STOREU(out + index, S_LANE_MIN(S_LANE_LOADU(left + index), S_LANE_LOADU(right + index)));
+  }
+#endif
+  for (; index < count; ++index) {
+    out[index] = (left[index] < right[index]) ? left[index] : right[index];
+  }
+}
+
+void float_array_max(const s_float_t *left, const s_float_t *right, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+#if defined(S_LANE_WIDTH)
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    S_LANE_STOREU(out + index, S_LANE_MAX(S_LANE_LOADU(left + index), S_LANE_LOADU(right + index)));
+  }
+#endif
+  for (; index < count; ++index) {
+    out[index] = (left[index] > right[index]) ? left[index] : right[index];
+  }
+}
+
+void float_array_min_tile(const s_float_t *in, const s_float_t *tile, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+  size_t tile_index;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t t0 = S_LANE_LOADU(tile);
+  const s_lane_t t1 = S_LANE_LOADU(tile + S_LANE_WIDTH);
+  const s_lane_t t2 = S_LANE_LOADU(tile + 2 * S_LANE_WIDTH);
+  for (; index + S_FLOAT_TILE_LENGTH <= count; index += S_FLOAT_TILE_LENGTH) {
+    S_LANE_STOREU(out + index, S_LANE_MIN(S_LANE_LOADU(in + index), t0));
+    S_LANE_STOREU(out + index + S_LANE_WIDTH, S_LANE_MIN(S_LANE_LOADU(in + index + S_LANE_WIDTH), t1));
+    S_LANE_STOREU(out + index + 2 * S_LANE_WIDTH, S_LANE_MIN(S_LANE_LOADU(in + index + 2 * S_LANE_WIDTH), t2));
+  }
+#endif
+  for (tile_index = 0; index < count; ++index) {
+    out[index] = (in[index] < tile[tile_index]) ? in[index] : tile[tile_index];
+    tile_index = (tile_index + 1) % S_FLOAT_TILE_LENGTH;
+  }
+}
+
+void float_array_max_tile(const s_float_t *in, const s_float_t *tile, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+  size_t tile_index;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t t0 = S_LANE_LOADU(tile);
+  const s_lane_t t1 = S_LANE_LOADU(tile + S_LANE_WIDTH);
+  const s_lane_t t2 = S_LANE_LOADU(tile + 2 * S_LANE_WIDTH);
+  for (; index + S_FLOAT_TILE_LENGTH <= count; index += S_FLOAT_TILE_LENGTH) {
+    S_LANE_STOREU(out + index, S_LANE_MAX(S_LANE_LOADU(in + index), t0));
+    S_LANE_STOREU(out + index + S_LANE_WIDTH, S_LANE_MAX(S_LANE_LOADU(in + index + S_LANE_WIDTH), t1));
+    S_LANE_STOREU(out + index + 2 * S_LANE_WIDTH, S_LANE_MAX(S_LANE_LOADU(in + index + 2 * S_LANE_WIDTH), t2));
+  }
+#endif
+  for (tile_index = 0; index < count; ++index) {
+    out[index] = (in[index] > tile[tile_index]) ? in[index] : tile[tile_index];
+    tile_index = (tile_index + 1) % S_FLOAT_TILE_LENGTH;
+  }
+}
+
+void float_array_clamp_tile(const s_float_t *in, const s_float_t *lower, const s_float_t *upper, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+  size_t tile_index;
+  s_float_t clamped;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t l0 = S_LANE_LOADU(lower);
+  const s_lane_t l1 = S_LANE_LOADU(lower + S_LANE_WIDTH);
+  const s_lane_t l2 = S_LANE_LOADU(lower + 2 * S_LANE_WIDTH);
+  const s_lane_t u0 = S_LANE_LOADU(upper);
+  const s_lane_t u1 = S_LANE_LOADU(upper + S_LANE_WIDTH);
+  const s_lane_t u2 = S_LANE_LOADU(upper + 2 * S_LANE_WIDTH);
+  for (; index + S_FLOAT_TILE_LENGTH <= count; index += S_FLOAT_TILE_LENGTH) {
+    S_LANE_STOREU(out + index, S_LANE_MIN(S_LANE_MAX(S_LANE_LOADU(in + index), l0), u0));
+    S_LANE_STOREU(out + index + S_LANE_WIDTH, S_LANE_MIN(S_LANE_MAX(S_LANE_LOADU(in + index + S_LANE_WIDTH), l1), u1));
+    S_LANE_STOREU(out + index + 2 * S_LANE_WIDTH, S_LANE_MIN(S_LANE_MAX(S_LANE_LOADU(in + index + 2 * S_LANE_WIDTH), l2), u2));
+  }
+#endif
+  for (tile_index = 0; index < count; ++index) {
+    clamped = (in[index] > lower[tile_index]) ? in[index] : lower[tile_index];
+    out[index] = (clamped < upper[tile_index]) ? clamped : upper[tile_index];
+    tile_index = (tile_index + 1) % S_FLOAT_TILE_LENGTH;
+  }
+}
+
+void float_array_abs(const s_float_t *in, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t sign_mask = S_LANE_SPLAT(s_float_lit(-0.0));
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    S_LANE_STOREU(out + index, S_LANE_ANDNOT(sign_mask, S_LANE_LOADU(in + index)));
+  }
+#endif
+  for (; index < count; ++index) {
+    out[index] = s_fabs(in[index]);
+  }
+}
+
+void float_array_floor(const s_float_t *in, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+#if defined(S_LANE_FLOOR)
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    S_LANE_STOREU(out + index, S_LANE_FLOOR(S_LANE_LOADU(in + index)));
+  }
+#endif
+  for (; index < count; ++index) {
+    out[index] = s_floor(in[index]);
+  }
+}
+
+void float_array_ceil(const s_float_t *in, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+#if defined(S_LANE_CEIL)
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    S_LANE_STOREU(out + index, S_LANE_CEIL(S_LANE_LOADU(in + index)));
+  }
+#endif
+  for (; index < count; ++index) {
+    out[index] = s_ceil(in[index]);
+  }
+}
+
+void float_array_sign(const s_float_t *in, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t zero = S_LANE_SPLAT(s_float_lit(0.0));
+  const s_lane_t one = S_LANE_SPLAT(s_float_lit(1.0));
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    const s_lane_t v = S_LANE_LOADU(in + index);
+    S_LANE_STOREU(out + index, S_LANE_SUB(
+      S_LANE_AND(S_LANE_CMPGT(v, zero), one),
+      S_LANE_AND(S_LANE_CMPLT(v, zero), one)));
+  }
+#endif
+  for (; index < count; ++index) {
+    out[index] = float_sign(in[index]);
+  }
+}
+
+void float_array_lerp(const s_float_t *from, const s_float_t *to, s_float_t delta, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t t = S_LANE_SPLAT(delta);
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    const s_lane_t a = S_LANE_LOADU(from + index);
+    S_LANE_STOREU(out + index, S_LANE_ADD(a, S_LANE_MUL(S_LANE_SUB(S_LANE_LOADU(to + index), a), t)));
+  }
+#endif
+  for (; index < count; ++index) {
+    out[index] = from[index] + (to[index] - from[index]) * delta;
+  }
+}
+
+/*
+  Each SIMD step covers four elements, which is components lanes. Slot s of
+  lane j holds a component of element (4 * j + s) / components, so the deltas
+  for a lane are gathered from those elements.
+*/
+void float_array_lerp_varying(const s_float_t *from, const s_float_t *to, const s_float_t *delta, size_t components, s_float_t *out, size_t count)
+{
+  size_t element = 0;
+  size_t component;
+#if defined(S_LANE_WIDTH)
+  size_t lane;
+  for (; element + S_LANE_WIDTH <= count; element += S_LANE_WIDTH) {
+    const s_float_t *d = delta + element;
+    const size_t base = element * components;
+    for (lane = 0; lane < components; ++lane) {
+      const size_t slot = lane * S_LANE_WIDTH;
+      const size_t offset = base + slot;
+      const s_lane_t t = S_LANE_SETR(
+        d[slot / components],
+        d[(slot + 1) / components],
+        d[(slot + 2) / components],
+        d[(slot + 3) / components]);
+      const s_lane_t a = S_LANE_LOADU(from + offset);
+      S_LANE_STOREU(out + offset, S_LANE_ADD(a, S_LANE_MUL(S_LANE_SUB(S_LANE_LOADU(to + offset), a), t)));
+    }
+  }
+#endif
+  for (; element < count; ++element) {
+    for (component = 0; component < components; ++component) {
+      const size_t index = element * components + component;
+      out[index] = from[index] + (to[index] - from[index]) * delta[element];
+    }
+  }
+}
+
+void float_array_axpy(s_float_t alpha, const s_float_t *x, s_float_t *y, size_t count)
+{
+  size_t index = 0;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t a = S_LANE_SPLAT(alpha);
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    S_LANE_STOREU(y + index, S_LANE_ADD(S_LANE_LOADU(y + index), S_LANE_MUL(S_LANE_LOADU(x + index), a)));
+  }
+#endif
+  for (; index < count; ++index) {
+    y[index] += alpha * x[index];
+  }
+}
+
+/*
+  Semi-implicit Euler: v = (v + a * delta) * damping_scale; x = x + v * delta.
+  The acceleration is either count components or, if acceleration_tiled is
+  nonzero, an S_FLOAT_TILE_LENGTH-component tile repeated across the arrays.
+*/
+void float_array_integrate_euler(s_float_t *position, s_float_t *velocity, const s_float_t *acceleration, int acceleration_tiled, s_float_t delta, s_float_t damping, size_t count)
+{
+  const s_float_t scale = s_float_lit(1.0) / (s_float_lit(1.0) + damping * delta);
+  size_t index = 0;
+  s_float_t v;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t dt = S_LANE_SPLAT(delta);
+  const s_lane_t k = S_LANE_SPLAT(scale);
+  size_t lane;
+  for (; index + S_FLOAT_TILE_LENGTH <= count; index += S_FLOAT_TILE_LENGTH) {
+    const s_float_t *a = acceleration_tiled ? acceleration : acceleration + index;
+    for (lane = 0; lane < S_FLOAT_TILE_LENGTH; lane += S_LANE_WIDTH) {
+      s_lane_t vl = S_LANE_LOADU(velocity + index + lane);
+      vl = S_LANE_MUL(S_LANE_ADD(vl, S_LANE_MUL(S_LANE_LOADU(a + lane), dt)), k);
+      S_LANE_STOREU(velocity + index + lane, vl);
+      S_LANE_STOREU(position + index + lane, S_LANE_ADD(S_LANE_LOADU(position + index + lane), S_LANE_MUL(vl, dt)));
+    }
+  }
+#endif
+  for (; index < count; ++index) {
+    const s_float_t a = acceleration_tiled ? acceleration[index % S_FLOAT_TILE_LENGTH] : acceleration[index];
+    v = (velocity[index] + a * delta) * scale;
+    velocity[index] = v;
+    position[index] += v * delta;
+  }
+}
+
+/*
+  Velocity Verlet position step: x = x + v * delta + a * delta^2 / 2, followed
+  by v = (v + a * kick) * damping_scale. Kick is delta when the acceleration is
+  constant over the step and delta / 2 when the caller applies the second half
+  kick after evaluating new accelerations. Acceleration is as for
+  float_array_integrate_euler.
+*/
+void float_array_integrate_verlet(s_float_t *position, s_float_t *velocity, const s_float_t *acceleration, int acceleration_tiled, s_float_t delta, s_float_t kick, s_float_t damping, size_t count)
+{
+  const s_float_t scale = s_float_lit(1.0) / (s_float_lit(1.0) + damping * delta);
+  const s_float_t half_dt2 = s_float_lit(0.5) * delta * delta;
+  size_t index = 0;
+#if defined(S_LANE_WIDTH)
+  const s_lane_t dt = S_LANE_SPLAT(delta);
+  const s_lane_t h = S_LANE_SPLAT(half_dt2);
+  const s_lane_t kk = S_LANE_SPLAT(kick);
+  const s_lane_t k = S_LANE_SPLAT(scale);
+  size_t lane;
+  for (; index + S_FLOAT_TILE_LENGTH <= count; index += S_FLOAT_TILE_LENGTH) {
+    const s_float_t *a = acceleration_tiled ? acceleration : acceleration + index;
+    for (lane = 0; lane < S_FLOAT_TILE_LENGTH; lane += S_LANE_WIDTH) {
+      const s_lane_t al = S_LANE_LOADU(a + lane);
+      const s_lane_t vl = S_LANE_LOADU(velocity + index + lane);
+      s_lane_t xl = S_LANE_LOADU(position + index + lane);
+      xl = S_LANE_ADD(xl, S_LANE_ADD(S_LANE_MUL(vl, dt), S_LANE_MUL(al, h)));
+      S_LANE_STOREU(position + index + lane, xl);
+      S_LANE_STOREU(velocity + index + lane, S_LANE_MUL(S_LANE_ADD(vl, S_LANE_MUL(al, kk)), k));
+    }
+  }
+#endif
+  for (; index < count; ++index) {
+    const s_float_t a = acceleration_tiled ? acceleration[index % S_FLOAT_TILE_LENGTH] : acceleration[index];
+    position[index] += velocity[index] * delta + a * half_dt2;
+    velocity[index] = (velocity[index] + a * kick) * scale;
+  }
+}
+
+
+
+/*
+  Sums of d, d * d, and d * next(d) over count triplets of components, where d
+  is a triplet minus origin and next rotates it to (y, z, x). Used for
+  covariance, so sums receives (x, y, z, xx, yy, zz, xy, yz, zx). Four triplets
+  fill three lanes, and each lane position always holds the same component.
+*/
+void float_array_moments3(const s_float_t *in, size_t count, const s_float_t *origin, s_float_t *sums)
+{
+  const size_t components = count * 3;
+  s_float_t shift[S_FLOAT_TILE_LENGTH];
+  s_float_t first[S_FLOAT_TILE_LENGTH];
+  s_float_t square[S_FLOAT_TILE_LENGTH];
+  s_float_t cross[S_FLOAT_TILE_LENGTH];
+  size_t index = 0;
+  size_t tile;
+
+  for (tile = 0; tile < S_FLOAT_TILE_LENGTH; ++tile) {
+    shift[tile] = origin[tile % 3];
+    first[tile] = square[tile] = cross[tile] = s_float_lit(0.0);
+  }
+
+#if defined(S_LANE_WIDTH)
+  {
+    s_lane_t lane_first[3];
+    s_lane_t lane_square[3];
+    s_lane_t lane_cross[3];
+    s_float_t next[S_FLOAT_TILE_LENGTH];
+    size_t lane;
+
+    for (lane = 0; lane < 3; ++lane) {
+      lane_first[lane] = lane_square[lane] = lane_cross[lane] = S_LANE_SPLAT(s_float_lit(0.0));
+    }
+
+    for (; index + S_FLOAT_TILE_LENGTH <= components; index += S_FLOAT_TILE_LENGTH) {
+      for (tile = 0; tile < S_FLOAT_TILE_LENGTH; tile += 3) {
+        next[tile]     = in[index + tile + 1] - shift[1];
+        next[tile + 1] = in[index + tile + 2] - shift[2];
+        next[tile + 2] = in[index + tile]     - shift[0];
+      }
+      for (lane = 0; lane < 3; ++lane) {
+        const size_t offset = lane * S_LANE_WIDTH;
+        const s_lane_t d = S_LANE_SUB(S_LANE_LOADU(in + index + offset), S_LANE_LOADU(shift + offset));
+        lane_first[lane] = S_LANE_ADD(lane_first[lane], d);
+        lane_square[lane] = S_LANE_ADD(lane_square[lane], S_LANE_MUL(d, d));
+        lane_cross[lane] = S_LANE_ADD(lane_cross[lane], S_LANE_MUL(d, S_LANE_LOADU(next + offset)));
+      }
+    }
+
+    for (lane = 0; lane < 3; ++lane) {
+      S_LANE_STOREU(first + lane * S_LANE_WIDTH, lane_first[lane]);
+      S_LANE_STOREU(square + lane * S_LANE_WIDTH, lane_square[lane]);
+      S_LANE_STOREU(cross + lane * S_LANE_WIDTH, lane_cross[lane]);
+    }
+  }
+#endif
+
+  for (; index < components; index += 3) {
+    const s_float_t dx = in[index] - shift[0];
+    const s_float_t dy = in[index + 1] - shift[1];
+    const s_float_t dz = in[index + 2] - shift[2];
+    first[0] += dx;
+    first[1] += dy;
+    first[2] += dz;
+    square[0] += dx * dx;
+    square[1] += dy * dy;
+    square[2] += dz * dz;
+    cross[0] += dx * dy;
+    cross[1] += dy * dz;
+    cross[2] += dz * dx;
+  }
+
+  for (tile = 0; tile < 9; ++tile) {
+    sums[tile] = s_float_lit(0.0);
+  }
+  for (tile = 0; tile < S_FLOAT_TILE_LENGTH; ++tile) {
+    sums[tile % 3] += first[tile];
+    sums[3 + tile % 3] += square[tile];
+    sums[6 + tile % 3] += cross[tile];
+  }
+}
+
+
+
+/*
+  Squared distances from one point to count points stored as separate arrays
+  of X, Y, and Z components, so each lane holds a different point.
+*/
+void float_array_distance_sq3(const s_float_t *point, const s_float_t *xs, const s_float_t *ys, const s_float_t *zs, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+
+#if defined(S_LANE_WIDTH)
+  const s_lane_t px = S_LANE_SPLAT(point[0]);
+  const s_lane_t py = S_LANE_SPLAT(point[1]);
+  const s_lane_t pz = S_LANE_SPLAT(point[2]);
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    const s_lane_t dx = S_LANE_SUB(S_LANE_LOADU(xs + index), px);
+    const s_lane_t dy = S_LANE_SUB(S_LANE_LOADU(ys + index), py);
+    const s_lane_t dz = S_LANE_SUB(S_LANE_LOADU(zs + index), pz);
+    S_LANE_STOREU(out + index,
+      S_LANE_ADD(S_LANE_ADD(S_LANE_MUL(dx, dx), S_LANE_MUL(dy, dy)), S_LANE_MUL(dz, dz)));
+  }
+#endif
+
+  for (; index < count; ++index) {
+    const s_float_t dx = xs[index] - point[0];
+    const s_float_t dy = ys[index] - point[1];
+    const s_float_t dz = zs[index] - point[2];
+    out[index] = dx * dx + dy * dy + dz * dz;
+  }
+}
+
+
+
+/*
+  Closest points on segments and boxes for count queries, with every input and
+  the closest points stored as rows of stride components, so each lane holds a
+  different query. Endpoints and bounds are selected with compare masks rather
+  than min and max so the results match the scalar tail exactly, including for
+  NaN and for boxes whose minimum exceeds their maximum.
+*/
+#if defined(S_LANE_WIDTH)
+#define S_LANE_SELECT(MASK, A, B) S_LANE_OR(S_LANE_AND((MASK), (A)), S_LANE_ANDNOT((MASK), (B)))
+#endif
+
+void float_array_closest_on_segment3(const s_float_t *in, size_t stride, s_float_t *closest,
+  s_float_t *distances, s_float_t *features, size_t count)
+{
+  const s_float_t *p = in;
+  const s_float_t *a = in + 3 * stride;
+  const s_float_t *b = in + 6 * stride;
+  size_t index = 0;
+  int axis;
+
+#if defined(S_LANE_WIDTH)
+  const s_lane_t zero = S_LANE_SPLAT(s_float_lit(0.0));
+  const s_lane_t one = S_LANE_SPLAT(s_float_lit(1.0));
+  const s_lane_t two = S_LANE_SPLAT(s_float_lit(2.0));
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    s_lane_t ab[3], ap[3];
+    s_lane_t dot = zero;
+    s_lane_t length_sq = zero;
+    s_lane_t distance_sq = zero;
+    s_lane_t t, start, end;
+    for (axis = 0; axis < 3; ++axis) {
+      const s_lane_t origin = S_LANE_LOADU(a + axis * stride + index);
+      ab[axis] = S_LANE_SUB(S_LANE_LOADU(b + axis * stride + index), origin);
+      ap[axis] = S_LANE_SUB(S_LANE_LOADU(p + axis * stride + index), origin);
+      dot = S_LANE_ADD(dot, S_LANE_MUL(ap[axis], ab[axis]));
+      length_sq = S_LANE_ADD(length_sq, S_LANE_MUL(ab[axis], ab[axis]));
+    }
+    t = S_LANE_AND(S_LANE_CMPGT(length_sq, zero), S_LANE_DIV(dot, length_sq));
+    start = S_LANE_CMPLE(t, zero);
+    end = S_LANE_CMPLE(one, t);
+    for (axis = 0; axis < 3; ++axis) {
+      const s_lane_t origin = S_LANE_LOADU(a + axis * stride + index);
+      const s_lane_t point = S_LANE_SELECT(start, origin, S_LANE_SELECT(end, S_LANE_LOADU(b + axis * stride + index),
+        S_LANE_ADD(origin, S_LANE_MUL(ab[axis], t))));
+      const s_lane_t delta = S_LANE_SUB(S_LANE_LOADU(p + axis * stride + index), point);
+      S_LANE_STOREU(closest + axis * stride + index, point);
+      distance_sq = S_LANE_ADD(distance_sq, S_LANE_MUL(delta, delta));
+    }
+    S_LANE_STOREU(distances + index, S_LANE_SQRT(distance_sq));
+    S_LANE_STOREU(features + index, S_LANE_SUB(S_LANE_SUB(two, S_LANE_AND(start, two)), S_LANE_AND(end, one)));
+  }
+#endif
+
+  for (; index < count; ++index) {
+    s_float_t dot = s_float_lit(0.0);
+    s_float_t length_sq = s_float_lit(0.0);
+    s_float_t distance_sq = s_float_lit(0.0);
+    s_float_t t;
+    for (axis = 0; axis < 3; ++axis) {
+      const s_float_t ab = b[axis * stride + index] - a[axis * stride + index];
+      dot += (p[axis * stride + index] - a[axis * stride + index]) * ab;
+      length_sq += ab * ab;
+    }
+    t = (length_sq > s_float_lit(0.0)) ? dot / length_sq : s_float_lit(0.0);
+    features[index] = (t <= s_float_lit(0.0)) ? s_float_lit(0.0) : ((t >= s_float_lit(1.0)) ? s_float_lit(1.0) : s_float_lit(2.0));
+    for (axis = 0; axis < 3; ++axis) {
+      const s_float_t origin = a[axis * stride + index];
+      s_float_t point;
+      s_float_t delta;
+      if (t <= s_float_lit(0.0)) {
+        point = origin;
+      } else if (t >= s_float_lit(1.0)) {
+        point = b[axis * stride + index];
+      } else {
+        point = origin + (b[axis * stride + index] - origin) * t;
+      }
+      delta = p[axis * stride + index] - point;
+      closest[axis * stride + index] = point;
+      distance_sq += delta * delta;
+    }
+    distances[index] = s_sqrt(distance_sq);
+  }
+}
+
+void float_array_closest_on_aabb3(const s_float_t *in, size_t stride, s_float_t *closest,
+  s_float_t *distances, s_float_t *features, size_t count)
+{
+  const s_float_t *p = in;
+  const s_float_t *low = in + 3 * stride;
+  const s_float_t *high = in + 6 * stride;
+  size_t index = 0;
+  int axis;
+
+#if defined(S_LANE_WIDTH)
+  for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+    s_lane_t distance_sq = S_LANE_SPLAT(s_float_lit(0.0));
+    s_lane_t feature = distance_sq;
+    for (axis = 0; axis < 3; ++axis) {
+      const s_lane_t value = S_LANE_LOADU(p + axis * stride + index);
+      const s_lane_t lower = S_LANE_LOADU(low + axis * stride + index);
+      const s_lane_t upper = S_LANE_LOADU(high + axis * stride + index);
+      const s_lane_t below = S_LANE_CMPLT(value, lower);
+      const s_lane_t above = S_LANE_ANDNOT(below, S_LANE_CMPGT(value, upper));
+      const s_lane_t clamped = S_LANE_SELECT(below, lower, S_LANE_SELECT(above, upper, value));
+      const s_lane_t delta = S_LANE_SUB(value, clamped);
+      S_LANE_STOREU(closest + axis * stride + index, clamped);
+      distance_sq = S_LANE_ADD(distance_sq, S_LANE_MUL(delta, delta));
+      feature = S_LANE_ADD(feature, S_LANE_AND(S_LANE_OR(below, above), S_LANE_SPLAT((s_float_t)(1 << axis))));
+    }
+    S_LANE_STOREU(distances + index, S_LANE_SQRT(distance_sq));
+    S_LANE_STOREU(features + index, feature);
+  }
+#endif
+
+  for (; index < count; ++index) {
+    s_float_t distance_sq = s_float_lit(0.0);
+    int feature = 0;
+    for (axis = 0; axis < 3; ++axis) {
+      const s_float_t value = p[axis * stride + index];
+      s_float_t clamped = value;
+      if (value < low[axis * stride + index]) {
+        clamped = low[axis * stride + index];
+        feature |= 1 << axis;
+      } else if (value > high[axis * stride + index]) {
+        clamped = high[axis * stride + index];
+        feature |= 1 << axis;
+      }
+      closest[axis * stride + index] = clamped;
+      distance_sq += (value - clamped) * (value - clamped);
+    }
+    distances[index] = s_sqrt(distance_sq);
+    features[index] = (s_float_t)feature;
+  }
+}
+
+
+
+/*
+  Applies a 2D affine map to count xy pairs, where affine holds (a, b, c, d,
+  tx, ty) and each pair becomes (a x + c y + tx, b x + d y + ty). A lane holds
+  two pairs: they are multiplied by (a, d), their swapped pairs by (c, b), and
+  the products summed with the translation. In may be out.
+*/
+void float_array_affine2(const s_float_t *in, const s_float_t *affine, s_float_t *out, size_t count)
+{
+  const size_t components = count * 2;
+  size_t index = 0;
+
+#if defined(S_LANE_WIDTH)
+  const s_lane_t diagonal = S_LANE_SETR(affine[0], affine[3], affine[0], affine[3]);
+  const s_lane_t cross = S_LANE_SETR(affine[2], affine[1], affine[2], affine[1]);
+  const s_lane_t translation = S_LANE_SETR(affine[4], affine[5], affine[4], affine[5]);
+  for (; index + S_LANE_WIDTH <= components; index += S_LANE_WIDTH) {
+    const s_lane_t v = S_LANE_LOADU(in + index);
+    S_LANE_STOREU(out + index,
+      S_LANE_ADD(S_LANE_ADD(S_LANE_MUL(v, diagonal), S_LANE_MUL(S_LANE_SWAP_PAIRS(v), cross)), translation));
+  }
+#endif
+
+  for (; index < components; index += 2) {
+    const s_float_t x = in[index];
+    const s_float_t y = in[index + 1];
+    out[index] = affine[0] * x + affine[2] * y + affine[4];
+    out[index + 1] = affine[1] * x + affine[3] * y + affine[5];
+  }
+}
+
+
+
+/*
+  Color transfer functions over count RGBA colors, leaving alpha unchanged. A
+  lane holds one color, so the RGB results are blended with the input's alpha
+  through a mask of the first three components. The exact functions use the
+  piecewise sRGB curve and extend it past [0, 1]. The fast ones clamp to
+  [0, 1] and fit the curve with a polynomial in x, or in the square roots of x
+  above the linear toe, staying within about 0.002 of it. In may be out.
+*/
+static s_float_t s_srgb_to_linear(s_float_t x)
+{
+  return (x <= s_float_lit(0.04045)) ?
+    x / s_float_lit(12.92) :
+    s_pow((x + s_float_lit(0.055)) / s_float_lit(1.055), s_float_lit(2.4));
+}
+
+static s_float_t s_linear_to_srgb(s_float_t x)
+{
+  return (x <= s_float_lit(0.0031308)) ?
+    x * s_float_lit(12.92) :
+    s_float_lit(1.055) * s_pow(x, s_float_lit(1.0) / s_float_lit(2.4)) - s_float_lit(0.055);
+}
+
+static s_float_t s_clamp_unit(s_float_t x)
+{
+  return (x > s_float_lit(0.0)) ? ((x < s_float_lit(1.0)) ? x : s_float_lit(1.0)) : s_float_lit(0.0);
+}
+
+void float_array_srgb_to_linear(const s_float_t *in, int fast, s_float_t *out, size_t count)
+{
+  const size_t components = count * 4;
+  size_t index = 0;
+
+#if defined(S_LANE_WIDTH)
+  if (fast) {
+    const s_lane_t rgb = S_LANE_CMPGT(S_LANE_SETR(1, 1, 1, 0), S_LANE_SPLAT(s_float_lit(0.0)));
+    const s_lane_t zero = S_LANE_SPLAT(s_float_lit(0.0));
+    const s_lane_t one = S_LANE_SPLAT(s_float_lit(1.0));
+    const s_lane_t c0 = S_LANE_SPLAT(s_float_lit(0.012522878));
+    const s_lane_t c1 = S_LANE_SPLAT(s_float_lit(0.682171111));
+    const s_lane_t c2 = S_LANE_SPLAT(s_float_lit(0.305306011));
+    for (; index < components; index += S_LANE_WIDTH) {
+      const s_lane_t v = S_LANE_LOADU(in + index);
+      const s_lane_t x = S_LANE_MIN(S_LANE_MAX(v, zero), one);
+      const s_lane_t y = S_LANE_MUL(x, S_LANE_ADD(S_LANE_MUL(x, S_LANE_ADD(S_LANE_MUL(x, c2), c1)), c0));
+      S_LANE_STOREU(out + index, S_LANE_OR(S_LANE_AND(rgb, y), S_LANE_ANDNOT(rgb, v)));
+    }
+  }
+#endif
+
+  for (; index < components; index += 4) {
+    int component;
+    for (component = 0; component < 3; ++component) {
+      const s_float_t x = in[index + component];
+      if (fast) {
+        const s_float_t c = s_clamp_unit(x);
+        out[index + component] = c * (c * (c * s_float_lit(0.305306011) + s_float_lit(0.682171111)) + s_float_lit(0.012522878));
+      } else {
+        out[index + component] = s_srgb_to_linear(x);
+      }
+    }
+    out[index + 3] = in[index + 3];
+  }
+}
+
+void float_array_linear_to_srgb(const s_float_t *in, int fast, s_float_t *out, size_t count)
+{
+  const size_t components = count * 4;
+  size_t index = 0;
+
+#if defined(S_LANE_WIDTH)
+  if (fast) {
+    const s_lane_t rgb = S_LANE_CMPGT(S_LANE_SETR(1, 1, 1, 0), S_LANE_SPLAT(s_float_lit(0.0)));
+    const s_lane_t zero = S_LANE_SPLAT(s_float_lit(0.0));
+    const s_lane_t one = S_LANE_SPLAT(s_float_lit(1.0));
+    const s_lane_t c1 = S_LANE_SPLAT(s_float_lit(0.585122381));
+    const s_lane_t c2 = S_LANE_SPLAT(s_float_lit(0.783140355));
+    const s_lane_t c3 = S_LANE_SPLAT(s_float_lit(0.368262736));
+    const s_lane_t knee = S_LANE_SPLAT(s_float_lit(0.0031308));
+    const s_lane_t slope = S_LANE_SPLAT(s_float_lit(12.92));
+    for (; index < components; index += S_LANE_WIDTH) {
+      const s_lane_t v = S_LANE_LOADU(in + index);
+      const s_lane_t x = S_LANE_MIN(S_LANE_MAX(v, zero), one);
+      const s_lane_t s1 = S_LANE_SQRT(x);
+      const s_lane_t s2 = S_LANE_SQRT(s1);
+      const s_lane_t s3 = S_LANE_SQRT(s2);
+      const s_lane_t curve = S_LANE_MIN(
+        S_LANE_SUB(S_LANE_ADD(S_LANE_MUL(c1, s1), S_LANE_MUL(c2, s2)), S_LANE_MUL(c3, s3)), one);
+      const s_lane_t toe = S_LANE_CMPGT(knee, x);
+      const s_lane_t y = S_LANE_OR(S_LANE_AND(toe, S_LANE_MUL(x, slope)), S_LANE_ANDNOT(toe, curve));
+      S_LANE_STOREU(out + index, S_LANE_OR(S_LANE_AND(rgb, y), S_LANE_ANDNOT(rgb, v)));
+    }
+  }
+#endif
+
+  for (; index < components; index += 4) {
+    int component;
+    for (component = 0; component < 3; ++component) {
+      const s_float_t x = in[index + component];
+      if (fast) {
+        const s_float_t c = s_clamp_unit(x);
+        const s_float_t s1 = s_sqrt(c);
+        const s_float_t s2 = s_sqrt(s1);
+        const s_float_t s3 = s_sqrt(s2);
+        const s_float_t curve = s_float_lit(0.585122381) * s1 + s_float_lit(0.783140355) * s2 - s_float_lit(0.368262736) * s3;
+        out[index + component] = (c < s_float_lit(0.0031308)) ? c * s_float_lit(12.92) :
+          ((curve < s_float_lit(1.0)) ? curve : s_float_lit(1.0));
+      } else {
+        out[index + component] = s_linear_to_srgb(x);
+      }
+    }
+    out[index + 3] = in[index + 3];
+  }
+}
+
+/* Multiplies the RGB of count RGBA colors by their alpha. In may be out. */
+void float_array_premultiply(const s_float_t *in, s_float_t *out, size_t count)
+{
+  const size_t components = count * 4;
+  size_t index = 0;
+
+#if defined(S_LANE_WIDTH)
+  const s_lane_t rgb = S_LANE_CMPGT(S_LANE_SETR(1, 1, 1, 0), S_LANE_SPLAT(s_float_lit(0.0)));
+  const s_lane_t one = S_LANE_SPLAT(s_float_lit(1.0));
+  for (; index < components; index += S_LANE_WIDTH) {
+    const s_lane_t v = S_LANE_LOADU(in + index);
+    const s_lane_t alpha = S_LANE_OR(S_LANE_AND(rgb, S_LANE_SPLAT_W(v)), S_LANE_ANDNOT(rgb, one));
+    S_LANE_STOREU(out + index, S_LANE_MUL(v, alpha));
+  }
+#endif
+
+  for (; index < components; index += 4) {
+    const s_float_t alpha = in[index + 3];
+    out[index] = in[index] * alpha;
+    out[index + 1] = in[index + 1] * alpha;
+    out[index + 2] = in[index + 2] * alpha;
+    out[index + 3] = alpha;
+  }
+}
+
+
+
+/*
+  Delta masks over count elements of components s_float_t, up to
+  S_DELTA_MAX_COMPONENTS. Four elements are compared at a time, since four
+  elements of any size are a whole number of lanes, and the lane compare masks
+  are gathered into one bit per component. A component is unchanged only if
+  it is within its threshold of the baseline, equal to it, or NaN in both, so
+  a component becoming or ceasing to be NaN always counts as changed.
+*/
+#define S_DELTA_MAX_COMPONENTS 16
+
+size_t float_array_delta_mask(const s_float_t *current, const s_float_t *baseline, const s_float_t *thresholds,
+  size_t components, size_t count, uint8_t *mask)
+{
+  size_t changed = 0;
+  size_t index = 0;
+  size_t component;
+
+  memset(mask, 0, (count + 7) / 8);
+
+#if defined(S_LANE_WIDTH) && defined(S_LANE_MOVEMASK)
+  {
+    const uint64_t element_bits = (UINT64_C(1) << components) - 1;
+    const size_t block = components * S_LANE_WIDTH;
+    const s_lane_t sign_mask = S_LANE_SPLAT(s_float_lit(-0.0));
+    s_float_t pattern[S_DELTA_MAX_COMPONENTS * S_LANE_WIDTH];
+    size_t lane;
+
+    for (component = 0; component < block; ++component) {
+      pattern[component] = thresholds[component % components];
+    }
+
+    for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+      const s_float_t *left = current + index * components;
+      const s_float_t *right = baseline + index * components;
+      uint64_t bits = 0;
+      for (component = 0; component < block; component += S_LANE_WIDTH) {
+        const s_lane_t x = S_LANE_LOADU(left + component);
+        const s_lane_t y = S_LANE_LOADU(right + component);
+        const s_lane_t delta = S_LANE_ANDNOT(sign_mask, S_LANE_SUB(x, y));
+        const int near = S_LANE_MOVEMASK(S_LANE_OR(S_LANE_CMPLE(delta, S_LANE_LOADU(pattern + component)),
+                                                   S_LANE_CMPEQ(x, y)));
+        const int ordered = S_LANE_MOVEMASK(S_LANE_OR(S_LANE_CMPEQ(x, x), S_LANE_CMPEQ(y, y)));
+        bits |= (uint64_t)(~(near | ~ordered) & 0xF) << component;
+      }
+      for (lane = 0; lane < S_LANE_WIDTH; ++lane) {
+        if ((bits >> (lane * components)) & element_bits) {
+          mask[(index + lane) >> 3] |= (uint8_t)(1 << ((index + lane) & 7));
+          ++changed;
+        }
+      }
+    }
+  }
+#endif
+
+  for (; index < count; ++index) {
+    const s_float_t *left = current + index * components;
+    const s_float_t *right = baseline + index * components;
+    for (component = 0; component < components; ++component) {
+      const s_float_t x = left[component];
+      const s_float_t y = right[component];
+      if (!(s_fabs(x - y) <= thresholds[component] || x == y || (x != x && y != y))) {
+        mask[index >> 3] |= (uint8_t)(1 << (index & 7));
+        ++changed;
+        break;
+      }
+    }
+  }
+
+  return changed;
+}
+
+/*
+  Payloads hold the masked elements back to back. They are copied bytewise, as
+  a payload following a mask in a buffer need not be aligned, and runs of eight
+  unchanged elements are skipped a mask byte at a time.
+*/
+void float_array_delta_gather(const s_float_t *current, const uint8_t *mask, size_t components, size_t count, uint8_t *payload)
+{
+  const size_t element_size = components * sizeof(s_float_t);
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    if (mask[index >> 3] == 0) {
+      index |= 7;
+    } else if (mask[index >> 3] & (1 << (index & 7))) {
+      memcpy(payload, current + index * components, element_size);
+      payload += element_size;
+    }
+  }
+}
+
+void float_array_delta_patch(const uint8_t *mask, const uint8_t *payload, size_t components, size_t count, s_float_t *out)
+{
+  const size_t element_size = components * sizeof(s_float_t);
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    if (mask[index >> 3] == 0) {
+      index |= 7;
+    } else if (mask[index >> 3] & (1 << (index & 7))) {
+      memcpy(out + index * components, payload, element_size);
+      payload += element_size;
+    }
+  }
+}
+
+
+
+/*
+  Maps a float to an unsigned integer that orders like the float does, so the
+  distance between two in units in the last place is the difference of their
+  mappings. Both zeroes map to the same value.
+*/
+static uint64_t s_float_ordered(s_float_t value)
+{
+#ifdef USE_FLOAT
+  union { uint32_t bits; float value; } number;
+  number.value = value;
+  return (number.bits & UINT32_C(0x80000000))
+    ? UINT64_C(0x80000000) - (number.bits & UINT32_C(0x7FFFFFFF))
+    : UINT64_C(0x80000000) + number.bits;
+#else
+  union { uint64_t bits; double value; } number;
+  number.value = value;
+  return (number.bits & UINT64_C(0x8000000000000000))
+    ? UINT64_C(0x8000000000000000) - (number.bits & UINT64_C(0x7FFFFFFFFFFFFFFF))
+    : UINT64_C(0x8000000000000000) + number.bits;
+#endif
+}
+
+static int s_float_approx_equal(s_float_t left, s_float_t right, s_float_t epsilon, uint64_t ulps, int use_ulps)
+{
+  if (left == right) {
+    return 1;
+  } else if (left != left || right != right) {
+    return 0;
+  } else if (use_ulps) {
+    const uint64_t a = s_float_ordered(left);
+    const uint64_t b = s_float_ordered(right);
+    return ((a > b) ? a - b : b - a) <= ulps;
+  }
+  return s_fabs(left - right) <= epsilon;
+}
+
+/*
+  Compares against an epsilon four elements at a time like the delta mask. The
+  ULP comparison needs 64-bit integer compares that the float path lacks, so it
+  always takes the scalar loop.
+*/
+size_t float_array_approx_equal(const s_float_t *left, const s_float_t *right, size_t components, size_t count,
+  s_float_t epsilon, uint64_t ulps, int use_ulps, s_float_t *mask)
+{
+  size_t equal = 0;
+  size_t index = 0;
+  size_t component;
+
+#if defined(S_LANE_WIDTH) && defined(S_LANE_MOVEMASK)
+  if (!use_ulps) {
+    const uint64_t element_bits = (UINT64_C(1) << components) - 1;
+    const size_t block = components * S_LANE_WIDTH;
+    const s_lane_t sign_mask = S_LANE_SPLAT(s_float_lit(-0.0));
+    const s_lane_t limit = S_LANE_SPLAT(epsilon);
+    size_t lane;
+
+    for (; index + S_LANE_WIDTH <= count; index += S_LANE_WIDTH) {
+      const s_float_t *a = left + index * components;
+      const s_float_t *b = right + index * components;
+      uint64_t bits = 0;
+      for (component = 0; component < block; component += S_LANE_WIDTH) {
+        const s_lane_t x = S_LANE_LOADU(a + component);
+        const s_lane_t y = S_LANE_LOADU(b + component);
+        const s_lane_t near = S_LANE_CMPLE(S_LANE_ANDNOT(sign_mask, S_LANE_SUB(x, y)), limit);
+        bits |= (uint64_t)S_LANE_MOVEMASK(S_LANE_OR(S_LANE_CMPEQ(x, y), near)) << component;
+      }
+      for (lane = 0; lane < S_LANE_WIDTH; ++lane) {
+        const int element_equal = ((bits >> (lane * components)) & element_bits) == element_bits;
+        equal += element_equal;
+        if (mask) {
+          mask[index + lane] = element_equal ? s_float_lit(1.0) : s_float_lit(0.0);
+        }
+      }
+    }
+  }
+#endif
+
+  for (; index < count; ++index) {
+    const s_float_t *a = left + index * components;
+    const s_float_t *b = right + index * components;
+    int element_equal = 1;
+    for (component = 0; component < components && element_equal; ++component) {
+      element_equal = s_float_approx_equal(a[component], b[component], epsilon, ulps, use_ulps);
+    }
+    equal += element_equal;
+    if (mask) {
+      mask[index] = element_equal ? s_float_lit(1.0) : s_float_lit(0.0);
+    }
+  }
+
+  return equal;
+}
+
+
+
+/*
+  A 64-bit hash in the style of xxHash64. Stripes of 32 bytes are mixed into
+  four independent accumulators so their multiplies overlap, and the tail is
+  folded in 8, 4, and 1 bytes at a time. Words are read in native byte order.
+*/
+#define S_HASH_PRIME1 UINT64_C(0x9E3779B185EBCA87)
+#define S_HASH_PRIME2 UINT64_C(0xC2B2AE3D27D4EB4F)
+#define S_HASH_PRIME3 UINT64_C(0x165667B19E3779F9)
+#define S_HASH_PRIME4 UINT64_C(0x85EBCA77C2B2AE63)
+#define S_HASH_PRIME5 UINT64_C(0x27D4EB2F165667C5)
+#define S_HASH_ROTL(X, R) (((X) << (R)) | ((X) >> (64 - (R))))
+
+static uint64_t s_hash_round(uint64_t accumulator, uint64_t word)
+{
+  accumulator += word * S_HASH_PRIME2;
+  accumulator = S_HASH_ROTL(accumulator, 31);
+  return accumulator * S_HASH_PRIME1;
+}
+
+uint64_t s_hash_bytes(const void *data, size_t bytes, uint64_t seed)
+{
+  const uint8_t *in = (const uint8_t *)data;
+  const uint8_t *const end = in + bytes;
+  uint64_t hash;
+  uint64_t word;
+  uint32_t half;
+
+  if (bytes >= 32) {
+    uint64_t lanes[4];
+    size_t lane;
+    lanes[0] = seed + S_HASH_PRIME1 + S_HASH_PRIME2;
+    lanes[1] = seed + S_HASH_PRIME2;
+    lanes[2] = seed;
+    lanes[3] = seed - S_HASH_PRIME1;
+    for (; in + 32 <= end; in += 32) {
+      for (lane = 0; lane < 4; ++lane) {
+        memcpy(&word, in + lane * 8, 8);
+        lanes[lane] = s_hash_round(lanes[lane], word);
+      }
+    }
+    hash = S_HASH_ROTL(lanes[0], 1) + S_HASH_ROTL(lanes[1], 7) +
+           S_HASH_ROTL(lanes[2], 12) + S_HASH_ROTL(lanes[3], 18);
+    for (lane = 0; lane < 4; ++lane) {
+      hash ^= s_hash_round(0, lanes[lane]);
+      hash = hash * S_HASH_PRIME1 + S_HASH_PRIME4;
+    }
+  } else {
+    hash = seed + S_HASH_PRIME5;
+  }
+
+  hash += (uint64_t)bytes;
+
+  for (; in + 8 <= end; in += 8) {
+    memcpy(&word, in, 8);
+    hash ^= s_hash_round(0, word);
+    hash = S_HASH_ROTL(hash, 27) * S_HASH_PRIME1 + S_HASH_PRIME4;
+  }
+  if (in + 4 <= end) {
+    memcpy(&half, in, 4);
+    hash ^= (uint64_t)half * S_HASH_PRIME1;
+    hash = S_HASH_ROTL(hash, 23) * S_HASH_PRIME2 + S_HASH_PRIME3;
+    in += 4;
+  }
+  for (; in < end; ++in) {
+    hash ^= (uint64_t)*in * S_HASH_PRIME5;
+    hash = S_HASH_ROTL(hash, 11) * S_HASH_PRIME1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= S_HASH_PRIME2;
+  hash ^= hash >> 29;
+  hash *= S_HASH_PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+
+
+/*
+  Random numbers. Every lane of an s_random_t is an independent xoshiro256+
+  generator and the lanes are stepped together so the loop vectorizes. Numbers
+  in [0, 1) are made by putting the high bits of a result in the mantissa of a
+  number in [1, 2) and subtracting one, which avoids an integer conversion.
+*/
+static uint64_t s_splitmix64(uint64_t *state)
+{
+  uint64_t z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+  z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+  return z ^ (z >> 31);
+}
+
+void s_random_seed(s_random_t *random, uint64_t seed, uint64_t stream)
+{
+  uint64_t mix = stream;
+  size_t word;
+  size_t lane;
+  mix = seed ^ s_splitmix64(&mix);
+  for (word = 0; word < 4; ++word) {
+    for (lane = 0; lane < S_RANDOM_LANES; ++lane) {
+      random->state[word][lane] = s_splitmix64(&mix);
+    }
+  }
+}
+
+static void s_random_next(s_random_t *random, uint64_t out[S_RANDOM_LANES])
+{
+  uint64_t *const s0 = random->state[0];
+  uint64_t *const s1 = random->state[1];
+  uint64_t *const s2 = random->state[2];
+  uint64_t *const s3 = random->state[3];
+  size_t lane;
+  for (lane = 0; lane < S_RANDOM_LANES; ++lane) {
+    const uint64_t t = s1[lane] << 17;
+    out[lane] = s0[lane] + s3[lane];
+    s2[lane] ^= s0[lane];
+    s3[lane] ^= s1[lane];
+    s1[lane] ^= s2[lane];
+    s0[lane] ^= s3[lane];
+    s2[lane] ^= t;
+    s3[lane] = (s3[lane] << 45) | (s3[lane] >> 19);
+  }
+}
+
+void s_random_uniform(s_random_t *random, s_float_t *out, size_t count)
+{
+  uint64_t bits[S_RANDOM_LANES];
+  s_float_t values[S_RANDOM_LANES];
+  size_t index;
+  size_t lane;
+  for (index = 0; index < count; index += S_RANDOM_LANES) {
+    s_random_next(random, bits);
+    for (lane = 0; lane < S_RANDOM_LANES; ++lane) {
+#ifdef USE_FLOAT
+      union { uint32_t bits; float value; } one_to_two;
+      one_to_two.bits = (uint32_t)(bits[lane] >> 41) | UINT32_C(0x3F800000);
+#else
+      union { uint64_t bits; double value; } one_to_two;
+      one_to_two.bits = (bits[lane] >> 12) | UINT64_C(0x3FF0000000000000);
+#endif
+      values[lane] = one_to_two.value - s_float_lit(1.0);
+    }
+    for (lane = 0; lane < S_RANDOM_LANES && index + lane < count; ++lane) {
+      out[index + lane] = values[lane];
+    }
+  }
+}
+
+void float_array_random_uniform(s_random_t *random, const s_float_t *low, const s_float_t *high, s_float_t *out, size_t count)
+{
+  size_t index = 0;
+  s_random_uniform(random, out, count);
+#if defined(S_LANE_WIDTH)
+  size_t lane;
+  for (; index + S_FLOAT_TILE_LENGTH <= count; index += S_FLOAT_TILE_LENGTH) {
+    for (lane = 0; lane < S_FLOAT_TILE_LENGTH; lane += S_LANE_WIDTH) {
+      const s_lane_t lo = S_LANE_LOADU(low + lane);
+      const s_lane_t extent = S_LANE_SUB(S_LANE_LOADU(high + lane), lo);
+      S_LANE_STOREU(out + index + lane, S_LANE_ADD(lo, S_LANE_MUL(extent, S_LANE_LOADU(out + index + lane))));
+    }
+  }
+#endif
+  for (; index < count; ++index) {
+    const size_t tile = index % S_FLOAT_TILE_LENGTH;
+    out[index] = low[tile] + (high[tile] - low[tile]) * out[index];
+  }
+}
+
+/*
+  Box-Muller transform over blocks of S_RANDOM_BLOCK uniform numbers. The block
+  length is a multiple of S_FLOAT_TILE_LENGTH, so tiles line up with each block.
+*/
+#define S_RANDOM_BLOCK (S_FLOAT_TILE_LENGTH * 8)
+
+void float_array_random_gaussian(s_random_t *random, const s_float_t *mean, const s_float_t *deviation, s_float_t *out, size_t count)
+{
+  s_float_t normal[S_RANDOM_BLOCK];
+  size_t block;
+  size_t index;
+  for (block = 0; block < count; block += S_RANDOM_BLOCK) {
+    const size_t block_count = (count - block < S_RANDOM_BLOCK) ? count - block : S_RANDOM_BLOCK;
+    s_random_uniform(random, normal, (block_count + 1) & ~(size_t)1);
+    for (index = 0; index < block_count; index += 2) {
+      const s_float_t radius = s_sqrt(s_float_lit(-2.0) * s_log(s_float_lit(1.0) - normal[index]));
+      const s_float_t angle = S_FLOAT_TAU * normal[index + 1];
+      normal[index] = radius * s_cos(angle);
+      normal[index + 1] = radius * s_sin(angle);
+    }
+    for (index = 0; index < block_count; ++index) {
+      const size_t tile = index % S_FLOAT_TILE_LENGTH;
+      out[block + index] = mean[tile] + deviation[tile] * normal[index];
+    }
+  }
+}
+
+
+
+/*
+  Parallel dispatch. Worker threads only run the given range function, which
+  must not call into Ruby; the calling thread runs the first range itself and
+  joins the rest before returning. Without pthreads (or with S_NO_THREADS
+  defined) everything runs on the calling thread.
+*/
+#if defined(S_HAVE_THREADS)
+
+typedef struct s_parallel_range_s {
+  s_range_fn_t fn;
+  void *context;
+  size_t begin;
+  size_t end;
+} s_parallel_range_t;
+
+static void *s_parallel_thunk(void *arg)
+{
+  const s_parallel_range_t *range = (const s_parallel_range_t *)arg;
+  range->fn(range->context, range->begin, range->end);
+  return NULL;
+}
+
+#endif
+
+int s_thread_count(int requested)
+{
+#if defined(S_HAVE_THREADS)
+  if (requested <= 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    requested = online > 0 ? (int)online : 1;
+  }
+  return requested > S_MAX_THREADS ? S_MAX_THREADS : requested;
+#else
+  (void)requested;
+  return 1;
+#endif
+}
+
+void s_parallel_for(size_t count, size_t grain, int threads, s_range_fn_t fn, void *context)
+{
+#if defined(S_HAVE_THREADS)
+  s_parallel_range_t ranges[S_MAX_THREADS];
+  pthread_t workers[S_MAX_THREADS];
+  int started[S_MAX_THREADS];
+  size_t chunks;
+  size_t per_chunk;
+  size_t index;
+
+  if (grain == 0) {
+    grain = 1;
+  }
+  threads = s_thread_count(threads);
+  chunks = (count + grain - 1) / grain;
+  if (chunks > (size_t)threads) {
+    chunks = (size_t)threads;
+  }
+
+  if (chunks <= 1) {
+    fn(context, 0, count);
+    return;
+  }
+
+  per_chunk = (count + chunks - 1) / chunks;
+  per_chunk = ((per_chunk + grain - 1) / grain) * grain;
+
+  for (index = 0; index < chunks; ++index) {
+    ranges[index].fn = fn;
+    ranges[index].context = context;
+    ranges[index].begin = index * per_chunk < count ? index * per_chunk : count;
+    ranges[index].end = ranges[index].begin + per_chunk < count ? ranges[index].begin + per_chunk : count;
+    started[index] = 0;
+  }
+
+  for (index = 1; index < chunks; ++index) {
+    if (ranges[index].begin < ranges[index].end) {
+      started[index] = pthread_create(&workers[index], NULL, s_parallel_thunk, &ranges[index]) == 0;
+      if (!started[index]) {
+        fn(context, ranges[index].begin, ranges[index].end);
+      }
+    }
+  }
+
+  fn(context, ranges[0].begin, ranges[0].end);
+
+  for (index = 1; index < chunks; ++index) {
+    if (started[index]) {
+      pthread_join(workers[index], NULL);
+    }
+  }
+#else
+  (void)grain;
+  (void)threads;
+  fn(context, 0, count);
+#endif
+}
@@ -10,8 +10,12 @@
 
 #ifdef __cplusplus
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #else
 #include <math.h>
+#include <stddef.h>
+#include <stdint.h>
 #endif
 
 #define S_STATIC_INLINE
@@ -25,6 +29,12 @@
 #define S_INLINE static
 #endif
 
+#if defined(__cplusplus)
+#define S_RESTRICT __restrict
+#else
+#define S_RESTRICT restrict
+#endif
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* __cplusplus */
@@ -40,6 +50,11 @@ typedef float s_float_t;
 #define s_atan(X) (atanf((X)))
 #define s_fabs(X) (fabsf((X)))
 #define s_sqrt(X) (sqrtf((X)))
+#define s_floor(X) (floorf((X)))
+#define s_ceil(X) (ceilf((X)))
+#define s_log(X)  (logf((X)))
+#define s_cbrt(X) (cbrtf((X)))
+#define s_pow(X, Y) (powf((X), (Y)))
 #define s_float_lit(X) (X##f)
 #else
 typedef double s_float_t;
@@ -51,9 +66,28 @@ typedef double s_float_t;
 #define s_atan(X) (atan((X)))
 #define s_fabs(X) (fabs((X)))
 #define s_sqrt(X) (sqrt((X)))
+#define s_floor(X) (floor((X)))
+#define s_ceil(X) (ceil((X)))
+#define s_log(X)  (log((X)))
+#define s_cbrt(X) (cbrt((X)))
+#define s_pow(X, Y) (pow((X), (Y)))
 #define s_float_lit(X) (X)
 #endif
 
+/*
+  SIMD code paths. These are enabled based on the instruction sets the compiler
+  targets (extconf.rb builds with -march=native) and only where a full vector
+  register holds four s_float_t, so SSE for floats and AVX2 for doubles. Define
+  S_NO_SIMD to build only the scalar reference paths.
+*/
+#if !defined(S_NO_SIMD)
+#if defined(USE_FLOAT) && defined(__SSE__)
+#define S_SIMD_SSE 1
+#elif !defined(USE_FLOAT) && defined(__AVX2__)
+#define S_SIMD_AVX2 1
+#endif
+#endif
+
 typedef s_float_t mat4_t[16];
 typedef s_float_t mat3_t[9];
 typedef s_float_t vec4_t[4];
@@ -88,6 +122,198 @@ S_INLINE int  float_equals(const s_float_t x, const s_float_t y)
   return float_is_zero(x - y);
 }
 
+/*!
+ * Returns 1 if x is positive, -1 if x is negative, and 0 otherwise.
+ */
+s_float_t     float_sign(const s_float_t x);
+
+/*
+  Packed encodings store each element's bits little-endian in the fewest whole
+  bytes, so a packed buffer reads the same on any host.
+*/
+void          s_store_packed(uint64_t bits, size_t bytes, uint8_t *out);
+uint64_t      s_load_packed(const uint8_t *in, size_t bytes);
+/* Maps t in [0, 1] to the nearest of 0 to max_value, clamping t */
+uint64_t      s_quantize_unit(s_float_t t, uint64_t max_value);
+/* Signed normalized 16-bit values, clamped to [-1, 1], in two packed bytes */
+void          s_store_snorm16(s_float_t value, uint8_t *out);
+s_float_t     s_load_snorm16(const uint8_t *in);
+
+
+
+/*==============================================================================
+
+  Componentwise operations over contiguous runs of count s_float_t
+
+==============================================================================*/
+
+/*
+  The number of components in a broadcast tile. Twelve is the smallest run that
+  holds a whole number of vec2_t, vec3_t, and vec4_t values as well as a whole
+  number of four-wide SIMD registers, so a tile filled with a repeated vector
+  lines up with every vector in an array regardless of where a register starts.
+*/
+#define S_FLOAT_TILE_LENGTH 12
+
+void          float_array_min(const s_float_t *left, const s_float_t *right, s_float_t *out, size_t count);
+void          float_array_max(const s_float_t *left, const s_float_t *right, s_float_t *out, size_t count);
+/* The _tile variants repeat an S_FLOAT_TILE_LENGTH-component tile as the right-hand side */
+void          float_array_min_tile(const s_float_t *in, const s_float_t *tile, s_float_t *out, size_t count);
+void          float_array_max_tile(const s_float_t *in, const s_float_t *tile, s_float_t *out, size_t count);
+void          float_array_clamp_tile(const s_float_t *in, const s_float_t *lower, const s_float_t *upper, s_float_t *out, size_t count);
+void          float_array_abs(const s_float_t *in, s_float_t *out, size_t count);
+void          float_array_floor(const s_float_t *in, s_float_t *out, size_t count);
+void          float_array_ceil(const s_float_t *in, s_float_t *out, size_t count);
+void          float_array_sign(const s_float_t *in, s_float_t *out, size_t count);
+void          float_array_lerp(const s_float_t *from, const s_float_t *to, s_float_t delta, s_float_t *out, size_t count);
+/*!
+ * Interpolates count elements of the given number of components (1 through 4)
+ * using one delta per element. Unlike the other functions, count is a number
+ * of elements rather than components.
+ */
+void          float_array_lerp_varying(const s_float_t *from, const s_float_t *to, const s_float_t *delta, size_t components, s_float_t *out, size_t count);
+/* Computes y = alpha * x + y */
+void          float_array_axpy(s_float_t alpha, const s_float_t *x, s_float_t *y, size_t count);
+/*!
+ * Sums the offsets from origin of count xyz triplets, their squares, and their
+ * products with the next component, writing (x, y, z, xx, yy, zz, xy, yz, zx).
+ */
+void          float_array_moments3(const s_float_t *in, size_t count, const s_float_t *origin, s_float_t *sums);
+/* Squared distances from point to count points given as X, Y, and Z arrays */
+void          float_array_distance_sq3(const s_float_t *point, const s_float_t *xs, const s_float_t *ys, const s_float_t *zs, s_float_t *out, size_t count);
+/*!
+ * Closest points on count segments (a, b) or boxes (low, high) to count points.
+ * In holds nine rows of stride components, the X, Y, and Z of the points and
+ * then of a and b or low and high, and closest gets three. Features are as for
+ * vec3_array_closest_on_segment and vec3_array_closest_on_aabb.
+ */
+void          float_array_closest_on_segment3(const s_float_t *in, size_t stride, s_float_t *closest,
+                s_float_t *distances, s_float_t *features, size_t count);
+void          float_array_closest_on_aabb3(const s_float_t *in, size_t stride, s_float_t *closest,
+                s_float_t *distances, s_float_t *features, size_t count);
+/* Maps count xy pairs by (a x + c y + tx, b x + d y + ty), given affine = (a, b, c, d, tx, ty) */
+void          float_array_affine2(const s_float_t *in, const s_float_t *affine, s_float_t *out, size_t count);
+/*!
+ * Delta compression over count elements of 1 to 16 components. The mask, of
+ * (count + 7) / 8 bytes, gets bit i set if any component of element i differs
+ * from baseline by more than its threshold or is NaN in only one of them, and
+ * the number of set bits is returned. Gather packs the masked elements of current into payload and
+ * patch copies them back out over the masked elements of out.
+ */
+size_t        float_array_delta_mask(const s_float_t *current, const s_float_t *baseline, const s_float_t *thresholds,
+                size_t components, size_t count, uint8_t *mask);
+void          float_array_delta_gather(const s_float_t *current, const uint8_t *mask, size_t components, size_t count, uint8_t *payload);
+void          float_array_delta_patch(const uint8_t *mask, const uint8_t *payload, size_t components, size_t count, s_float_t *out);
+/*!
+ * Approximate equality over count elements of 1 to 16 components. An element
+ * is equal if each of its components is equal to the other's or, with
+ * use_ulps, within ulps units in the last place of it, and otherwise within
+ * epsilon of it. NaN is never equal. If mask is non-NULL, it gets 1 for each
+ * equal element and 0 for each other. Returns the number of equal elements.
+ */
+size_t        float_array_approx_equal(const s_float_t *left, const s_float_t *right, size_t components, size_t count,
+                s_float_t epsilon, uint64_t ulps, int use_ulps, s_float_t *mask);
+/* Non-cryptographic 64-bit hash of bytes bytes of data */
+uint64_t      s_hash_bytes(const void *data, size_t bytes, uint64_t seed);
+/*!
+ * Color operations over count RGBA colors, leaving alpha unchanged. The fast
+ * sRGB conversions clamp to [0, 1] and approximate the curve.
+ */
+void          float_array_srgb_to_linear(const s_float_t *in, int fast, s_float_t *out, size_t count);
+void          float_array_linear_to_srgb(const s_float_t *in, int fast, s_float_t *out, size_t count);
+void          float_array_premultiply(const s_float_t *in, s_float_t *out, size_t count);
+/*!
+ * Integrators over count components of positions and velocities, updated in
+ * place. See maths.c for the exact update rules.
+ */
+void          float_array_integrate_euler(s_float_t *position, s_float_t *velocity, const s_float_t *acceleration, int acceleration_tiled, s_float_t delta, s_float_t damping, size_t count);
+void          float_array_integrate_verlet(s_float_t *position, s_float_t *velocity, const s_float_t *acceleration, int acceleration_tiled, s_float_t delta, s_float_t kick, s_float_t damping, size_t count);
+
+
+
+/*==============================================================================
+
+  Parallel dispatch
+
+==============================================================================*/
+
+/*
+  Threads are used when pthreads are available (extconf.rb checks for them) and
+  S_NO_THREADS isn't defined.
+*/
+#if defined(HAVE_PTHREAD_H) && !defined(S_NO_THREADS)
+#define S_HAVE_THREADS 1
+#endif
+
+#define S_MAX_THREADS 64
+
+typedef void (*s_range_fn_t)(void *context, size_t begin, size_t end);
+
+/*!
+ * Returns the number of threads s_parallel_for will use for a request of
+ * requested threads. Zero or less requests one thread per online processor.
+ */
+int           s_thread_count(int requested);
+/*!
+ * Splits [0, count) into at most threads ranges whose boundaries are multiples
+ * of grain and calls fn for each range, one range per thread.
+ */
+void          s_parallel_for(size_t count, size_t grain, int threads, s_range_fn_t fn, void *context);
+
+
+
+/*==============================================================================
+
+  Random numbers
+
+==============================================================================*/
+
+/*
+  s_random_t is a set of S_RANDOM_LANES interleaved xoshiro256+ generators, so
+  each step produces one number per lane and can be vectorized. A generator is
+  seeded from a seed and a stream number, which lets each block of an array be
+  filled from its own stream without depending on how many threads fill it.
+*/
+#define S_RANDOM_LANES 4
+#define S_FLOAT_TAU s_float_lit(6.28318530717958647692)
+
+typedef struct s_random_s {
+  uint64_t state[4][S_RANDOM_LANES];
+} s_random_t;
+
+void          s_random_seed(s_random_t *random, uint64_t seed, uint64_t stream);
+/* Writes count uniformly distributed numbers in [0, 1) to out */
+void          s_random_uniform(s_random_t *random, s_float_t *out, size_t count);
+
+/*!
+ * Fills count components with uniform numbers between low and high or with
+ * normally distributed numbers. low, high, mean, and deviation are
+ * S_FLOAT_TILE_LENGTH-component tiles.
+ */
+void          float_array_random_uniform(s_random_t *random, const s_float_t *low, const s_float_t *high, s_float_t *out, size_t count);
+void          float_array_random_gaussian(s_random_t *random, const s_float_t *mean, const s_float_t *deviation, s_float_t *out, size_t count);
+
+
+
+/*==============================================================================
+
+  Noise
+
+==============================================================================*/
+
+/* Simplex noise in roughly [-1, 1] */
+s_float_t     noise_simplex2(s_float_t x, s_float_t y);
+s_float_t     noise_simplex3(s_float_t x, s_float_t y, s_float_t z);
+s_float_t     noise_simplex4(s_float_t x, s_float_t y, s_float_t z, s_float_t w);
+
+/*!
+ * Writes normalized fBm simplex noise at each of count points to out. One
+ * octave is plain simplex noise. See noise.c.
+ */
+void          vec2_array_fbm(const vec2_t *in, int octaves, s_float_t lacunarity, s_float_t gain, s_float_t *out, size_t count);
+void          vec3_array_fbm(const vec3_t *in, int octaves, s_float_t lacunarity, s_float_t gain, s_float_t *out, size_t count);
+void          vec4_array_fbm(const vec4_t *in, int octaves, s_float_t lacunarity, s_float_t gain, s_float_t *out, size_t count);
+
 
 /*==============================================================================
 
@@ -127,6 +353,36 @@ int           vec2_divide(const vec2_t v, s_float_t divisor, vec2_t out);
 
 int           vec2_equals(const vec2_t left, const vec2_t right);
 
+/* Componentwise operations */
+void          vec2_min(const vec2_t left, const vec2_t right, vec2_t out);
+void          vec2_max(const vec2_t left, const vec2_t right, vec2_t out);
+void          vec2_clamp(const vec2_t v, const vec2_t lower, const vec2_t upper, vec2_t out);
+void          vec2_lerp(const vec2_t from, const vec2_t to, s_float_t delta, vec2_t out);
+void          vec2_abs(const vec2_t v, vec2_t out);
+void          vec2_floor(const vec2_t v, vec2_t out);
+void          vec2_ceil(const vec2_t v, vec2_t out);
+void          vec2_sign(const vec2_t v, vec2_t out);
+
+/* Batch operations over contiguous arrays of count elements */
+void          vec2_array_to_vec3(const vec2_t *S_RESTRICT in, vec3_t *S_RESTRICT out, size_t count);
+void          vec2_array_to_vec4(const vec2_t *S_RESTRICT in, s_float_t w, vec4_t *S_RESTRICT out, size_t count);
+/* Uniform points inside or on a circle of the given radius */
+void          vec2_array_random_in_sphere(s_random_t *random, s_float_t radius, vec2_t *out, size_t count);
+void          vec2_array_random_on_sphere(s_random_t *random, s_float_t radius, vec2_t *out, size_t count);
+/*
+  Polygons are count vertices closed back to the first. Containment writes 1 or
+  0 per point using the even-odd rule; area is signed, positive when CCW.
+*/
+void          vec2_array_polygon_contains(const vec2_t *polygon, size_t count, const vec2_t *points, s_float_t *out, size_t point_count);
+s_float_t     vec2_polygon_area(const vec2_t *polygon, size_t count);
+void          vec2_polygon_centroid(const vec2_t *polygon, size_t count, vec2_t out);
+/* Writes the CCW hull without collinear points; scratch holds count and out count + 1 */
+size_t        vec2_array_convex_hull(const vec2_t *in, size_t count, vec2_t *scratch, vec2_t *out);
+/* Params are the hit's fraction along the first segment or -1 on a miss */
+void          vec2_array_intersect_segments(const vec2_t *a0, size_t a0_step, const vec2_t *a1, size_t a1_step,
+                const vec2_t *b0, size_t b0_step, const vec2_t *b1, size_t b1_step,
+                size_t count, vec2_t *out, s_float_t *params);
+
 
 
 /*==============================================================================
@@ -168,6 +424,93 @@ int           vec3_divide(const vec3_t v, s_float_t divisor, vec3_t out);
 
 int           vec3_equals(const vec3_t left, const vec3_t right);
 
+/* Componentwise operations */
+void          vec3_min(const vec3_t left, const vec3_t right, vec3_t out);
+void          vec3_max(const vec3_t left, const vec3_t right, vec3_t out);
+void          vec3_clamp(const vec3_t v, const vec3_t lower, const vec3_t upper, vec3_t out);
+void          vec3_lerp(const vec3_t from, const vec3_t to, s_float_t delta, vec3_t out);
+void          vec3_abs(const vec3_t v, vec3_t out);
+void          vec3_floor(const vec3_t v, vec3_t out);
+void          vec3_ceil(const vec3_t v, vec3_t out);
+void          vec3_sign(const vec3_t v, vec3_t out);
+
+/* Batch operations over contiguous arrays of count elements */
+void          vec3_array_to_vec2(const vec3_t *S_RESTRICT in, vec2_t *S_RESTRICT out, size_t count);
+void          vec3_array_to_vec4(const vec3_t *S_RESTRICT in, s_float_t w, vec4_t *S_RESTRICT out, size_t count);
+/* Uniform points inside or on a sphere of the given radius */
+void          vec3_array_random_in_sphere(s_random_t *random, s_float_t radius, vec3_t *out, size_t count);
+void          vec3_array_random_on_sphere(s_random_t *random, s_float_t radius, vec3_t *out, size_t count);
+/*!
+ * Computes the mean and the population covariance matrix of count points in a
+ * single pass. Both are zero if count is zero.
+ */
+void          vec3_array_covariance(const vec3_t *in, size_t count, vec3_t mean, mat3_t out);
+/*!
+ * Fits an oriented bounding box to count points along their principal axes.
+ * The rows of axes are the box's axes and half_extents its half sizes along
+ * them.
+ */
+void          vec3_array_fit_obb(const vec3_t *in, size_t count, vec3_t center, mat3_t axes, vec3_t half_extents);
+/*!
+ * Bounding spheres of count points, written as (x, y, z, radius). Points are
+ * read through indices if it is non-null. Ritter's method is fast but loose;
+ * vec3_array_min_sphere finds the smallest sphere using count entries of
+ * scratch.
+ */
+void          vec3_array_ritter_sphere(const vec3_t *points, const size_t *indices, size_t count, vec4_t out);
+void          vec3_array_min_sphere(const vec3_t *points, const size_t *indices, size_t count, size_t *scratch, vec4_t out);
+/*!
+ * Closest points to count query points on segments, triangles, and AABBs, with
+ * their distances and the ids of the features they lie on. Each primitive's
+ * corners advance by their step per query; a step of 0 shares one corner
+ * across all queries. Out may be points.
+ *
+ * Segment features: 0 at a, 1 at b, 2 between them.
+ * Triangle features: 0 to 2 at a, b, c; 3 to 5 on edges ab, bc, ca; 6 inside.
+ * AABB features: a mask of the axes clamped, bit 0 for X to bit 2 for Z, so 0
+ * means the point is inside the box.
+ */
+void          vec3_array_closest_on_segment(const vec3_t *points, const vec3_t *a, size_t a_step,
+                const vec3_t *b, size_t b_step, size_t count, vec3_t *out, s_float_t *distances, s_float_t *features);
+void          vec3_array_closest_on_triangle(const vec3_t *points, const vec3_t *a, size_t a_step,
+                const vec3_t *b, size_t b_step, const vec3_t *c, size_t c_step, size_t count,
+                vec3_t *out, s_float_t *distances, s_float_t *features);
+void          vec3_array_closest_on_aabb(const vec3_t *points, const vec3_t *mins, size_t mins_step,
+                const vec3_t *maxs, size_t maxs_step, size_t count, vec3_t *out, s_float_t *distances, s_float_t *features);
+/*!
+ * Brute-force queries from the points in [query_begin, query_end) of queries
+ * to target_count targets. Results for query q are written at q's position:
+ * row q of a query-by-target distance matrix, or the k slots at q * k holding
+ * its k >= 1 nearest targets' indices and distances, sorted and padded with
+ * -1. If self is nonzero, queries are the targets and points are not paired
+ * with themselves.
+ *
+ * vec3_array_pairs_within runs twice. With null firsts it writes the number of
+ * targets within radius of each query to counts. Given counts holding each
+ * query's offset into the outputs, it writes those pairs and their distances.
+ */
+void          vec3_array_pairwise_distance(const vec3_t *queries, size_t query_begin, size_t query_end,
+                const vec3_t *targets, size_t target_count, s_float_t *out);
+void          vec3_array_k_nearest(const vec3_t *queries, size_t query_begin, size_t query_end,
+                const vec3_t *targets, size_t target_count, size_t k, int self, s_float_t *indices, s_float_t *distances);
+void          vec3_array_pairs_within(const vec3_t *queries, size_t query_begin, size_t query_end,
+                const vec3_t *targets, size_t target_count, s_float_t radius, int self,
+                size_t *counts, s_float_t *firsts, s_float_t *seconds, s_float_t *distances);
+/*!
+ * Quantizes count points to bits bits per axis, from 1 to 21, within the box
+ * from lower to upper, written packed to vec3_quantized_bytes(bits) bytes per
+ * point. Points outside the box are clamped to it.
+ */
+size_t        vec3_quantized_bytes(int bits);
+void          vec3_array_quantize(const vec3_t *in, size_t count, const vec3_t lower, const vec3_t upper, int bits, uint8_t *out);
+void          vec3_array_dequantize(const uint8_t *in, size_t count, const vec3_t lower, const vec3_t upper, int bits, vec3_t *out);
+/*!
+ * Octahedral encoding of count directions in two packed snorm16 values, 4
+ * bytes each. Directions need not be normalized; decoding normalizes.
+ */
+void          vec3_array_encode_octahedral(const vec3_t *in, size_t count, uint8_t *out);
+void          vec3_array_decode_octahedral(const uint8_t *in, size_t count, vec3_t *out);
+
 
 
 /*==============================================================================
@@ -209,6 +552,29 @@ int           vec4_divide(const vec4_t v, s_float_t divisor, vec4_t out);
 
 int           vec4_equals(const vec4_t left, const vec4_t right);
 
+/* Componentwise operations */
+void          vec4_min(const vec4_t left, const vec4_t right, vec4_t out);
+void          vec4_max(const vec4_t left, const vec4_t right, vec4_t out);
+void          vec4_clamp(const vec4_t v, const vec4_t lower, const vec4_t upper, vec4_t out);
+void          vec4_lerp(const vec4_t from, const vec4_t to, s_float_t delta, vec4_t out);
+void          vec4_abs(const vec4_t v, vec4_t out);
+void          vec4_floor(const vec4_t v, vec4_t out);
+void          vec4_ceil(const vec4_t v, vec4_t out);
+void          vec4_sign(const vec4_t v, vec4_t out);
+
+/* Batch operations over contiguous arrays of count elements */
+void          vec4_array_to_vec2(const vec4_t *S_RESTRICT in, vec2_t *S_RESTRICT out, size_t count);
+void          vec4_array_to_vec3(const vec4_t *S_RESTRICT in, vec3_t *S_RESTRICT out, size_t count);
+/*!
+ * Packs count RGBA colors, clamped to [0, 1], to 4 bytes each: RGBA8 as one
+ * byte per component, and RGB10A2 as a little-endian 32-bit word with 10 bits
+ * each for red from bit 0, green, and blue, and 2 bits for alpha.
+ */
+void          vec4_array_pack_rgba8(const vec4_t *in, size_t count, uint8_t *out);
+void          vec4_array_unpack_rgba8(const uint8_t *in, size_t count, vec4_t *out);
+void          vec4_array_pack_rgb10a2(const vec4_t *in, size_t count, uint8_t *out);
+void          vec4_array_unpack_rgb10a2(const uint8_t *in, size_t count, vec4_t *out);
+
 
 
 /*==============================================================================
@@ -231,6 +597,12 @@ void          mat3_from_quat(const quat_t in, mat3_t out);
 void          mat3_transpose(const mat3_t in, mat3_t out);
 void          mat3_scale(const mat3_t in, s_float_t x, s_float_t y, s_float_t z, mat3_t out);
 void          mat3_orthogonal(const mat3_t in, mat3_t out);
+/*!
+ * Gram-Schmidt orthonormalization of the matrix's three columns in memory,
+ * in[0..2], in[3..5], and in[6..8], which are the vectors mat3_get_row3
+ * returns. Unlike mat3_orthogonal, the first keeps its direction.
+ */
+void          mat3_orthonormalize(const mat3_t in, mat3_t out);
 void          mat3_multiply(const mat3_t lhs, const mat3_t rhs, mat3_t out);
 void          mat3_rotate_vec3(const mat3_t lhs, const vec3_t rhs, vec3_t out);
 void          mat3_inv_rotate_vec3(const mat3_t lhs, const vec3_t rhs, vec3_t out);
@@ -243,6 +615,50 @@ void          mat3_set_column3(int column, const vec3_t in, mat3_t out);
 s_float_t     mat3_determinant(const mat3_t in);
 int           mat3_equals(const mat3_t lhs, const mat3_t rhs);
 int           mat3_inverse(const mat3_t in, mat3_t out);
+/*!
+ * 2D affine transforms. The upper 2x2 of the matrix is the linear part and its
+ * third column holds the translation, so points are transformed as (x, y, 1)
+ * and directions as (x, y, 0). mat3_trs_2d composes translation * rotation *
+ * scale, with the angle in degrees, and mat3_inverse_affine inverts such a
+ * matrix, returning 0 if its linear part is singular.
+ */
+void          mat3_transform_vec2(const mat3_t lhs, const vec2_t rhs, vec2_t out);
+void          mat3_rotate_vec2(const mat3_t lhs, const vec2_t rhs, vec2_t out);
+void          mat3_trs_2d(const vec2_t translation, s_float_t angle, const vec2_t scale, mat3_t out);
+int           mat3_inverse_affine(const mat3_t in, mat3_t out);
+/*!
+ * Eigen-decomposition of a symmetric matrix. Eigenvectors are written to the
+ * rows of rotation, which is a proper rotation, in order of decreasing
+ * eigenvalue. Returns nonzero if the Jacobi iteration converged.
+ */
+int           mat3_eigen_symmetric(const mat3_t in, mat3_t rotation, vec3_t eigenvalues);
+
+/* Batch operations over contiguous arrays of count elements */
+void          mat3_array_to_mat4(const mat3_t *S_RESTRICT in, mat4_t *S_RESTRICT out, size_t count);
+void          mat3_array_from_quat(const quat_t *S_RESTRICT in, mat3_t *S_RESTRICT out, size_t count);
+void          mat3_array_multiply(const mat3_t *lhs, const mat3_t *rhs, mat3_t *out, size_t count);
+void          mat3_array_rotate_vec3(const mat3_t *S_RESTRICT lhs, const vec3_t *rhs, vec3_t *out, size_t count);
+/*! Singular matrices are replaced by the identity. Returns how many there were. */
+size_t        mat3_array_inverse(const mat3_t *in, mat3_t *out, size_t count);
+void          mat3_array_orthogonal(const mat3_t *in, mat3_t *out, size_t count);
+void          mat3_array_orthonormalize(mat3_t *inout, size_t count);
+/*!
+ * Transforms count Vec2s as points, or as directions if translate is zero. The
+ * matrices advance by step per element, so a step of 0 applies one matrix to
+ * every element. Out may be in.
+ */
+void          mat3_array_transform_vec2(const mat3_t *lhs, size_t step, const vec2_t *in, int translate, vec2_t *out, size_t count);
+/*! Scales may be null for unit scale. */
+void          mat3_array_trs_2d(const vec2_t *translations, const s_float_t *angles, const vec2_t *scales, mat3_t *out, size_t count);
+/*!
+ * QTangents of count tangent frames whose rows are the tangent, bitangent,
+ * and normal (see quat_array_encode_qtangent). Frames with a negative
+ * determinant are stored as reflections.
+ */
+void          mat3_array_encode_qtangent(const mat3_t *in, size_t count, uint8_t *out);
+void          mat3_array_decode_qtangent(const uint8_t *in, size_t count, mat3_t *out);
+/*! Singular matrices are replaced by the identity. Returns how many there were. */
+size_t        mat3_array_inverse_affine(const mat3_t *in, mat3_t *out, size_t count);
 
 
 /*==============================================================================
@@ -290,6 +706,11 @@ int           mat4_equals(const mat4_t left, const mat4_t right);
 
 void          mat4_transpose(const mat4_t in, mat4_t out);
 void          mat4_inverse_orthogonal(const mat4_t in, mat4_t out);
+/*!
+ * Gram-Schmidt orthonormalization of the upper 3x3 of the matrix. The
+ * translation and projection elements are left as-is.
+ */
+void          mat4_orthonormalize(const mat4_t in, mat4_t out);
 /*!
  * Writes the inverse affine of the input matrix to the output matrix.
  * \returns Non-zero if an inverse affine matrix can be created, otherwise
@@ -299,6 +720,12 @@ int           mat4_inverse_affine(const mat4_t in, mat4_t out);
 void          mat4_adjoint(const mat4_t in, mat4_t out);
 s_float_t     mat4_determinant(const mat4_t m);
 int           mat4_inverse_general(const mat4_t in, mat4_t out);
+/*!
+ * Scalar reference implementations of mat4_determinant and
+ * mat4_inverse_general using per-element 3x3 cofactors.
+ */
+s_float_t     mat4_determinant_ref(const mat4_t m);
+int           mat4_inverse_general_ref(const mat4_t in, mat4_t out);
 
 /*! Translates the given matrix by <X, Y, Z>. */
 void          mat4_translate(s_float_t x, s_float_t y, s_float_t z, const mat4_t in, mat4_t out);
@@ -310,6 +737,18 @@ void          mat4_rotate_vec3(const mat4_t left, const vec3_t right, vec3_t out
 void          mat4_inv_rotate_vec3(const mat4_t left, const vec3_t right, vec3_t out);
 void          mat4_scale(const mat4_t in, s_float_t x, s_float_t y, s_float_t z, mat4_t out);
 
+/* Batch operations over contiguous arrays of count elements */
+void          mat4_array_to_mat3(const mat4_t *S_RESTRICT in, mat3_t *S_RESTRICT out, size_t count);
+void          mat4_array_from_quat(const quat_t *S_RESTRICT in, mat4_t *S_RESTRICT out, size_t count);
+void          mat4_array_orthonormalize(mat4_t *inout, size_t count);
+/*!
+ * Transforms count local-space AABBs, given by their corners, into world-space
+ * AABBs. Box i uses transforms[i], or box indices[i] if indices is non-null, in
+ * which case only the listed boxes are written.
+ */
+void          mat4_array_transform_aabb(const mat4_t *transforms, const vec3_t *mins, const vec3_t *maxs,
+                const size_t *indices, size_t count, vec3_t *out_mins, vec3_t *out_maxs);
+
 
 
 /*==============================================================================
@@ -331,6 +770,12 @@ void          quat_negate(const quat_t in, quat_t out);
 
 void          quat_multiply(const quat_t left, const quat_t right, quat_t out);
 void          quat_multiply_vec3(const quat_t left, const vec3_t right, vec3_t out);
+/*!
+ * Scalar reference implementations of quat_multiply and quat_multiply_vec3.
+ * These are what the SIMD paths are checked against.
+ */
+void          quat_multiply_ref(const quat_t left, const quat_t right, quat_t out);
+void          quat_multiply_vec3_ref(const quat_t left, const vec3_t right, vec3_t out);
 
 void          quat_from_angle_axis(s_float_t angle, s_float_t x, s_float_t y, s_float_t z, quat_t out);
 void          quat_from_mat4(const mat4_t mat, quat_t out);
@@ -338,6 +783,40 @@ void          quat_from_mat3(const mat3_t mat, quat_t out);
 
 void          quat_slerp(const quat_t from, const quat_t to, s_float_t delta, quat_t out);
 
+/* Batch operations over contiguous arrays of count elements */
+void          quat_array_from_mat3(const mat3_t *S_RESTRICT in, quat_t *S_RESTRICT out, size_t count);
+void          quat_array_from_mat4(const mat4_t *S_RESTRICT in, quat_t *S_RESTRICT out, size_t count);
+/* out[i] = left[i] * right[i]; out may alias either input */
+void          quat_array_multiply(const quat_t *left, const quat_t *right, quat_t *out, size_t count);
+/* out[i] = left[i] * right[i]; out may alias right */
+void          quat_array_multiply_vec3(const quat_t *left, const vec3_t *right, vec3_t *out, size_t count);
+/* out[i] = left * right[i]; out may alias right */
+void          quat_multiply_vec3_array(const quat_t left, const vec3_t *right, vec3_t *out, size_t count);
+/* Zero-length quaternions are left unchanged */
+void          quat_array_normalize(quat_t *inout, size_t count);
+/* Integrates world-space angular velocities, damping them in place */
+void          quat_array_integrate(quat_t *orientation, vec3_t *angular_velocity, s_float_t delta, s_float_t damping, size_t count);
+/* Uniformly distributed unit quaternions */
+void          quat_array_random(s_random_t *random, quat_t *out, size_t count);
+/*!
+ * Smallest-three encoding of count rotations in 3 * bits + 2 bits each, for
+ * bits from 2 to 20, written packed to quat_smallest3_bytes(bits) bytes per
+ * rotation. Encoding normalizes its input and decoding renormalizes.
+ */
+size_t        quat_smallest3_bytes(int bits);
+void          quat_array_encode_smallest3(const quat_t *in, size_t count, int bits, uint8_t *out);
+void          quat_array_decode_smallest3(const uint8_t *in, size_t count, int bits, quat_t *out);
+/*!
+ * QTangents: tangent frame rotations in four packed snorm16 values, 8 bytes,
+ * with the frame's reflection in the sign of w. A negative sign means the
+ * frame's bitangent is flipped. Signs may be null on encoding for unflipped
+ * frames, and on decoding if they are not needed.
+ */
+void          quat_encode_qtangent(const quat_t in, s_float_t sign, uint8_t *out);
+s_float_t     quat_decode_qtangent(const uint8_t *in, quat_t out);
+void          quat_array_encode_qtangent(const quat_t *in, const s_float_t *signs, size_t count, uint8_t *out);
+void          quat_array_decode_qtangent(const uint8_t *in, size_t count, quat_t *out, s_float_t *signs);
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
@@ -0,0 +1,248 @@
+/*
+  Simplex noise
+  Written by Noel Cower
+
+  See COPYING for license information
+*/
+
+#define __SNOW__NOISE_C__
+
+#include "maths_local.h"
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+  Simplex noise after Stefan Gustavson's "Simplex noise demystified", using Ken
+  Perlin's permutation table. Lattice coordinates are wrapped to 256 before
+  hashing, but the lattice is skewed, so the noise doesn't tile along the axes.
+*/
+static const unsigned char s_noise_perm[256] = {
+  151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225,
+  140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23, 190, 6, 148,
+  247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32,
+  57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175,
+  74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122,
+  60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54,
+  65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169,
+  200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64,
+  52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212,
+  207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42, 223, 183, 170, 213,
+  119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
+  129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104,
+  218, 246, 97, 228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241,
+  81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157,
+  184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93,
+  222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180
+};
+
+#define S_NOISE_PERM(X) ((int)s_noise_perm[(X) & 255])
+
+static const signed char s_noise_grad3[12][3] = {
+  {  1,  1,  0 }, { -1,  1,  0 }, {  1, -1,  0 }, { -1, -1,  0 },
+  {  1,  0,  1 }, { -1,  0,  1 }, {  1,  0, -1 }, { -1,  0, -1 },
+  {  0,  1,  1 }, {  0, -1,  1 }, {  0,  1, -1 }, {  0, -1, -1 }
+};
+
+static const signed char s_noise_grad4[32][4] = {
+  {  0,  1,  1,  1 }, {  0,  1,  1, -1 }, {  0,  1, -1,  1 }, {  0,  1, -1, -1 },
+  {  0, -1,  1,  1 }, {  0, -1,  1, -1 }, {  0, -1, -1,  1 }, {  0, -1, -1, -1 },
+  {  1,  0,  1,  1 }, {  1,  0,  1, -1 }, {  1,  0, -1,  1 }, {  1,  0, -1, -1 },
+  { -1,  0,  1,  1 }, { -1,  0,  1, -1 }, { -1,  0, -1,  1 }, { -1,  0, -1, -1 },
+  {  1,  1,  0,  1 }, {  1,  1,  0, -1 }, {  1, -1,  0,  1 }, {  1, -1,  0, -1 },
+  { -1,  1,  0,  1 }, { -1,  1,  0, -1 }, { -1, -1,  0,  1 }, { -1, -1,  0, -1 },
+  {  1,  1,  1,  0 }, {  1,  1, -1,  0 }, {  1, -1,  1,  0 }, {  1, -1, -1,  0 },
+  { -1,  1,  1,  0 }, { -1,  1, -1,  0 }, { -1, -1,  1,  0 }, { -1, -1, -1,  0 }
+};
+
+/* Contribution of one simplex corner given its squared-distance falloff t */
+#define S_NOISE_CORNER(T, DOT) ((T) < s_float_lit(0.0) ? s_float_lit(0.0) : (T) * (T) * (T) * (T) * (DOT))
+
+s_float_t noise_simplex2(s_float_t x, s_float_t y)
+{
+  static const s_float_t F2 = s_float_lit(0.36602540378443864676);
+  static const s_float_t G2 = s_float_lit(0.21132486540518711775);
+  const s_float_t s = (x + y) * F2;
+  const int i = (int)s_floor(x + s);
+  const int j = (int)s_floor(y + s);
+  const s_float_t t = (s_float_t)(i + j) * G2;
+  const s_float_t x0 = x - ((s_float_t)i - t);
+  const s_float_t y0 = y - ((s_float_t)j - t);
+  const int i1 = x0 > y0;
+  const int j1 = !i1;
+  const s_float_t x1 = x0 - (s_float_t)i1 + G2;
+  const s_float_t y1 = y0 - (s_float_t)j1 + G2;
+  const s_float_t x2 = x0 - s_float_lit(1.0) + s_float_lit(2.0) * G2;
+  const s_float_t y2 = y0 - s_float_lit(1.0) + s_float_lit(2.0) * G2;
+  const signed char *g0 = s_noise_grad3[S_NOISE_PERM(i + S_NOISE_PERM(j)) % 12];
+  const signed char *g1 = s_noise_grad3[S_NOISE_PERM(i + i1 + S_NOISE_PERM(j + j1)) % 12];
+  const signed char *g2 = s_noise_grad3[S_NOISE_PERM(i + 1 + S_NOISE_PERM(j + 1)) % 12];
+  const s_float_t t0 = s_float_lit(0.5) - x0 * x0 - y0 * y0;
+  const s_float_t t1 = s_float_lit(0.5) - x1 * x1 - y1 * y1;
+  const s_float_t t2 = s_float_lit(0.5) - x2 * x2 - y2 * y2;
+  return s_float_lit(70.0) * (
+    S_NOISE_CORNER(t0, g0[0] * x0 + g0[1] * y0) +
+    S_NOISE_CORNER(t1, g1[0] * x1 + g1[1] * y1) +
+    S_NOISE_CORNER(t2, g2[0] * x2 + g2[1] * y2));
+}
+
+s_float_t noise_simplex3(s_float_t x, s_float_t y, s_float_t z)
+{
+  static const s_float_t F3 = s_float_lit(1.0) / s_float_lit(3.0);
+  static const s_float_t G3 = s_float_lit(1.0) / s_float_lit(6.0);
+  const s_float_t s = (x + y + z) * F3;
+  const int i = (int)s_floor(x + s);
+  const int j = (int)s_floor(y + s);
+  const int k = (int)s_floor(z + s);
+  const s_float_t t = (s_float_t)(i + j + k) * G3;
+  const s_float_t x0 = x - ((s_float_t)i - t);
+  const s_float_t y0 = y - ((s_float_t)j - t);
+  const s_float_t z0 = z - ((s_float_t)k - t);
+  int i1, j1, k1;
+  int i2, j2, k2;
+  s_float_t x1, y1, z1, x2, y2, z2, x3, y3, z3;
+  s_float_t t0, t1, t2, t3;
+  const signed char *g0, *g1, *g2, *g3;
+
+  /* Pick the simplex containing the point by ordering its offsets */
+  if (x0 >= y0) {
+    if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+    else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+  } else {
+    if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+    else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+    else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+  }
+
+  x1 = x0 - (s_float_t)i1 + G3;
+  y1 = y0 - (s_float_t)j1 + G3;
+  z1 = z0 - (s_float_t)k1 + G3;
+  x2 = x0 - (s_float_t)i2 + s_float_lit(2.0) * G3;
+  y2 = y0 - (s_float_t)j2 + s_float_lit(2.0) * G3;
+  z2 = z0 - (s_float_t)k2 + s_float_lit(2.0) * G3;
+  x3 = x0 - s_float_lit(1.0) + s_float_lit(3.0) * G3;
+  y3 = y0 - s_float_lit(1.0) + s_float_lit(3.0) * G3;
+  z3 = z0 - s_float_lit(1.0) + s_float_lit(3.0) * G3;
+
+  g0 = s_noise_grad3[S_NOISE_PERM(i + S_NOISE_PERM(j + S_NOISE_PERM(k))) % 12];
+  g1 = s_noise_grad3[S_NOISE_PERM(i + i1 + S_NOISE_PERM(j + j1 + S_NOISE_PERM(k + k1))) % 12];
+  g2 = s_noise_grad3[S_NOISE_PERM(i + i2 + S_NOISE_PERM(j + j2 + S_NOISE_PERM(k + k2))) % 12];
+  g3 = s_noise_grad3[S_NOISE_PERM(i + 1 + S_NOISE_PERM(j + 1 + S_NOISE_PERM(k + 1))) % 12];
+
+  t0 = s_float_lit(0.6) - x0 * x0 - y0 * y0 - z0 * z0;
+  t1 = s_float_lit(0.6) - x1 * x1 - y1 * y1 - z1 * z1;
+  t2 = s_float_lit(0.6) - x2 * x2 - y2 * y2 - z2 * z2;
+  t3 = s_float_lit(0.6) - x3 * x3 - y3 * y3 - z3 * z3;
+
+  return s_float_lit(32.0) * (
+    S_NOISE_CORNER(t0, g0[0] * x0 + g0[1] * y0 + g0[2] * z0) +
+    S_NOISE_CORNER(t1, g1[0] * x1 + g1[1] * y1 + g1[2] * z1) +
+    S_NOISE_CORNER(t2, g2[0] * x2 + g2[1] * y2 + g2[2] * z2) +
+    S_NOISE_CORNER(t3, g3[0] * x3 + g3[1] * y3 + g3[2] * z3));
+}
+
+s_float_t noise_simplex4(s_float_t x, s_float_t y, s_float_t z, s_float_t w)
+{
+  static const s_float_t F4 = s_float_lit(0.30901699437494742410);
+  static const s_float_t G4 = s_float_lit(0.13819660112501051518);
+  const s_float_t s = (x + y + z + w) * F4;
+  const int i = (int)s_floor(x + s);
+  const int j = (int)s_floor(y + s);
+  const int k = (int)s_floor(z + s);
+  const int l = (int)s_floor(w + s);
+  const s_float_t t = (s_float_t)(i + j + k + l) * G4;
+  vec4_t d[5];
+  int rank[4] = { 0, 0, 0, 0 };
+  int offset[5][4];
+  s_float_t total = s_float_lit(0.0);
+  int corner;
+  int axis;
+  int other;
+
+  d[0][0] = x - ((s_float_t)i - t);
+  d[0][1] = y - ((s_float_t)j - t);
+  d[0][2] = z - ((s_float_t)k - t);
+  d[0][3] = w - ((s_float_t)l - t);
+
+  /*
+    Rank the offsets by magnitude; the simplex's corners step along axes from
+    the largest offset to the smallest.
+  */
+  for (axis = 0; axis < 4; ++axis) {
+    for (other = axis + 1; other < 4; ++other) {
+      if (d[0][axis] > d[0][other]) {
+        ++rank[axis];
+      } else {
+        ++rank[other];
+      }
+    }
+  }
+
+  for (corner = 0; corner < 5; ++corner) {
+    for (axis = 0; axis < 4; ++axis) {
+      offset[corner][axis] = (corner == 0) ? 0 : (rank[axis] >= 4 - corner);
+      d[corner][axis] = d[0][axis] - (s_float_t)offset[corner][axis] + (s_float_t)corner * G4;
+    }
+  }
+
+  for (corner = 0; corner < 5; ++corner) {
+    const s_float_t *p = d[corner];
+    const int *o = offset[corner];
+    const signed char *g = s_noise_grad4[
+      S_NOISE_PERM(i + o[0] + S_NOISE_PERM(j + o[1] + S_NOISE_PERM(k + o[2] + S_NOISE_PERM(l + o[3])))) % 32];
+    const s_float_t falloff = s_float_lit(0.6) - p[0] * p[0] - p[1] * p[1] - p[2] * p[2] - p[3] * p[3];
+    total += S_NOISE_CORNER(falloff, g[0] * p[0] + g[1] * p[1] + g[2] * p[2] + g[3] * p[3]);
+  }
+
+  return s_float_lit(27.0) * total;
+}
+
+/*
+  fBm sums octaves of noise, each at lacunarity times the frequency and gain
+  times the amplitude of the one before it, and divides by the summed
+  amplitudes so the result stays in roughly [-1, 1]. One octave is plain noise.
+*/
+#define S_NOISE_FBM(NOISE_CALL)                                                 \
+  s_float_t sum = s_float_lit(0.0);                                             \
+  s_float_t amplitude = s_float_lit(1.0);                                       \
+  s_float_t amplitude_sum = s_float_lit(0.0);                                   \
+  s_float_t frequency = s_float_lit(1.0);                                       \
+  int octave;                                                                   \
+  for (octave = 0; octave < octaves; ++octave) {                                \
+    sum += amplitude * (NOISE_CALL);                                            \
+    amplitude_sum += amplitude;                                                 \
+    amplitude *= gain;                                                          \
+    frequency *= lacunarity;                                                    \
+  }                                                                             \
+  out[index] = (amplitude_sum != s_float_lit(0.0)) ? sum / amplitude_sum : s_float_lit(0.0);
+
+void vec2_array_fbm(const vec2_t *in, int octaves, s_float_t lacunarity, s_float_t gain, s_float_t *out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    S_NOISE_FBM(noise_simplex2(in[index][0] * frequency, in[index][1] * frequency))
+  }
+}
+
+void vec3_array_fbm(const vec3_t *in, int octaves, s_float_t lacunarity, s_float_t gain, s_float_t *out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    S_NOISE_FBM(noise_simplex3(in[index][0] * frequency, in[index][1] * frequency, in[index][2] * frequency))
+  }
+}
+
+void vec4_array_fbm(const vec4_t *in, int octaves, s_float_t lacunarity, s_float_t gain, s_float_t *out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    S_NOISE_FBM(noise_simplex4(in[index][0] * frequency, in[index][1] * frequency, in[index][2] * frequency, in[index][3] * frequency))
+  }
+}
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
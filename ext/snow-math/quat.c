@@ -9,6 +9,12 @@
 
 #include "maths_local.h"
 
+#if defined(S_SIMD_SSE)
+#include <xmmintrin.h>
+#elif defined(S_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -56,35 +62,96 @@ void quat_negate(const quat_t in, quat_t out)
   out[3] = -in[3];
 }
 
+/*
+  Both quat_multiply and quat_multiply_vec3 treat left as the rotation applied
+  first, so the result of quat_multiply is the Hamilton product right * left.
+*/
+void quat_multiply_ref(const quat_t left, const quat_t right, quat_t out)
+{
+  const s_float_t lx = left[0], ly = left[1], lz = left[2], lw = left[3];
+  const s_float_t rx = right[0], ry = right[1], rz = right[2], rw = right[3];
+
+  out[0] = (rw * lx) + (rx * lw) + (ry * lz) - (rz * ly);
+  out[1] = (rw * ly) + (ry * lw) + (rz * lx) - (rx * lz);
+  out[2] = (rw * lz) + (rz * lw) + (rx * ly) - (ry * lx);
+  out[3] = (rw * lw) - (rx * lx) - (ry * ly) - (rz * lz);
+}
+
+#if defined(S_SIMD_SSE)
+
 void quat_multiply(const quat_t left, const quat_t right, quat_t out)
 {
-  s_float_t w;
-  s_float_t w1, w2;
-  vec3_t t1, t2;
-  w1 = left[3];
-  w2 = right[3];
-
-  w = (w1 * w2) - vec3_dot_product(left, right);
-  vec3_copy(right, t1);
-  vec3_scale(t1, w1, t1);
-  vec3_copy(left, t2);
-  vec3_scale(t2, w2, t2);
-  vec3_add(t1, t2, t1);
-  vec3_cross_product(right, left, t2);
-  vec3_add(t1, t2, t1);
-  vec3_copy(t1, out);
-  out[3] = w;
+  const __m128 sign_w = _mm_set_ps(-0.0f, 0.0f, 0.0f, 0.0f);
+  const __m128 l = _mm_loadu_ps(left);
+  const __m128 r = _mm_loadu_ps(right);
+  __m128 result, term;
+
+  result = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)), l);
+  term = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 2, 1, 0)),
+                    _mm_shuffle_ps(l, l, _MM_SHUFFLE(0, 3, 3, 3)));
+  result = _mm_add_ps(result, _mm_xor_ps(term, sign_w));
+  term = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 0, 2, 1)),
+                    _mm_shuffle_ps(l, l, _MM_SHUFFLE(1, 1, 0, 2)));
+  result = _mm_add_ps(result, _mm_xor_ps(term, sign_w));
+  term = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 1, 0, 2)),
+                    _mm_shuffle_ps(l, l, _MM_SHUFFLE(2, 0, 2, 1)));
+  result = _mm_sub_ps(result, term);
+
+  _mm_storeu_ps(out, result);
+}
+
+#elif defined(S_SIMD_AVX2)
+
+void quat_multiply(const quat_t left, const quat_t right, quat_t out)
+{
+  const __m256d sign_w = _mm256_set_pd(-0.0, 0.0, 0.0, 0.0);
+  const __m256d l = _mm256_loadu_pd(left);
+  const __m256d r = _mm256_loadu_pd(right);
+  __m256d result, term;
+
+  result = _mm256_mul_pd(_mm256_permute4x64_pd(r, _MM_SHUFFLE(3, 3, 3, 3)), l);
+  term = _mm256_mul_pd(_mm256_permute4x64_pd(r, _MM_SHUFFLE(0, 2, 1, 0)),
+                       _mm256_permute4x64_pd(l, _MM_SHUFFLE(0, 3, 3, 3)));
+  result = _mm256_add_pd(result, _mm256_xor_pd(term, sign_w));
+  term = _mm256_mul_pd(_mm256_permute4x64_pd(r, _MM_SHUFFLE(1, 0, 2, 1)),
+                       _mm256_permute4x64_pd(l, _MM_SHUFFLE(1, 1, 0, 2)));
+  result = _mm256_add_pd(result, _mm256_xor_pd(term, sign_w));
+  term = _mm256_mul_pd(_mm256_permute4x64_pd(r, _MM_SHUFFLE(2, 1, 0, 2)),
+                       _mm256_permute4x64_pd(l, _MM_SHUFFLE(2, 0, 2, 1)));
+  result = _mm256_sub_pd(result, term);
+
+  _mm256_storeu_pd(out, result);
+}
+
+#else
+
+void quat_multiply(const quat_t left, const quat_t right, quat_t out)
+{
+  quat_multiply_ref(left, right, out);
+}
+
+#endif
+
+/*
+  Rotates right by left using t = 2 * cross(q, v); v' = v + w * t + cross(q, t)
+  rather than building a rotation matrix or doing two full quaternion products.
+*/
+void quat_multiply_vec3_ref(const quat_t left, const vec3_t right, vec3_t out)
+{
+  const s_float_t qx = left[0], qy = left[1], qz = left[2], qw = left[3];
+  const s_float_t vx = right[0], vy = right[1], vz = right[2];
+  const s_float_t tx = s_float_lit(2.0) * ((qy * vz) - (qz * vy));
+  const s_float_t ty = s_float_lit(2.0) * ((qz * vx) - (qx * vz));
+  const s_float_t tz = s_float_lit(2.0) * ((qx * vy) - (qy * vx));
+
+  out[0] = vx + (qw * tx) + ((qy * tz) - (qz * ty));
+  out[1] = vy + (qw * ty) + ((qz * tx) - (qx * tz));
+  out[2] = vz + (qw * tz) + ((qx * ty) - (qy * tx));
 }
 
 void quat_multiply_vec3(const quat_t left, const vec3_t right, vec3_t out)
 {
-  vec3_t lxr_cross, lxlr_cross;
-  vec3_cross_product(left, right, lxr_cross);
-  vec3_cross_product(left, lxr_cross, lxlr_cross);
-  vec3_scale(lxr_cross, s_float_lit(2.0) * left[3], lxr_cross);
-  vec3_scale(lxlr_cross, s_float_lit(2.0), lxlr_cross);
-  vec3_add(lxr_cross, lxlr_cross, lxr_cross);
-  vec3_add(right, lxr_cross, out);
+  quat_multiply_vec3_ref(left, right, out);
 }
 
 void quat_from_angle_axis(s_float_t angle, s_float_t x, s_float_t y, s_float_t z, quat_t out)
@@ -168,16 +235,18 @@ void quat_from_mat3(const mat3_t mat, quat_t out)
     out[2] = (m01 - m10) * r;
   } else {
     int index = 0;
-    if (mat[8] > (index ? mat[4] : mat[0])) {
-      index = 2;
-    } else if (mat[4] > mat[0]) {
+    if (mat[4] > mat[0]) {
       index = 1;
     }
+    if (mat[8] > mat[index * 4]) {
+      index = 2;
+    }
 
     switch (index) {
     default:
     case 0:
-      r = out[0] = s_sqrt(mat[0] - (mat[4] + mat[8]) + s_float_lit(1.0)) * s_float_lit(0.5);
+      r = s_sqrt(mat[0] - (mat[4] + mat[8]) + s_float_lit(1.0));
+      out[0] = r * s_float_lit(0.5);
       if (!float_is_zero(r)) {
         r = s_float_lit(0.5) / r;
       }
@@ -187,7 +256,8 @@ void quat_from_mat3(const mat3_t mat, quat_t out)
       break;
 
     case 1:
-      r = out[1] = s_sqrt(mat[4] - (mat[8] + mat[0]) + s_float_lit(1.0)) * s_float_lit(0.5);
+      r = s_sqrt(mat[4] - (mat[8] + mat[0]) + s_float_lit(1.0));
+      out[1] = r * s_float_lit(0.5);
       if (!float_is_zero(r)) {
         r = s_float_lit(0.5) / r;
       }
@@ -197,7 +267,8 @@ void quat_from_mat3(const mat3_t mat, quat_t out)
       break;
 
     case 2:
-      r = out[2] = s_sqrt(mat[4] - (mat[0] + mat[4]) + s_float_lit(1.0)) * s_float_lit(0.5);
+      r = s_sqrt(mat[8] - (mat[0] + mat[4]) + s_float_lit(1.0));
+      out[2] = r * s_float_lit(0.5);
       if (!float_is_zero(r)) {
         r = s_float_lit(0.5) / r;
       }
@@ -243,6 +314,336 @@ void quat_slerp(const quat_t from, const quat_t to, s_float_t delta, quat_t out)
   out[3] = (from[3] * scale0) + (dw * scale1);
 }
 
+void quat_array_from_mat3(const mat3_t *S_RESTRICT in, quat_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    quat_from_mat3(in[index], out[index]);
+  }
+}
+
+void quat_array_from_mat4(const mat4_t *S_RESTRICT in, quat_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    quat_from_mat4(in[index], out[index]);
+  }
+}
+
+void quat_array_multiply(const quat_t *left, const quat_t *right, quat_t *out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    quat_multiply(left[index], right[index], out[index]);
+  }
+}
+
+void quat_array_multiply_vec3(const quat_t *left, const vec3_t *right, vec3_t *out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    quat_multiply_vec3_ref(left[index], right[index], out[index]);
+  }
+}
+
+/*
+  With a single rotation applied to many vectors, it's cheaper to expand the
+  quaternion into a 3x3 rotation once (9 multiplies per vector afterward) than
+  to use the cross product form for every vector.
+*/
+void quat_multiply_vec3_array(const quat_t left, const vec3_t *right, vec3_t *out, size_t count)
+{
+  const s_float_t qx = left[0], qy = left[1], qz = left[2], qw = left[3];
+  const s_float_t xx = qx * qx, yy = qy * qy, zz = qz * qz;
+  const s_float_t xy = qx * qy, xz = qx * qz, yz = qy * qz;
+  const s_float_t wx = qw * qx, wy = qw * qy, wz = qw * qz;
+  const s_float_t m00 = s_float_lit(1.0) - s_float_lit(2.0) * (yy + zz);
+  const s_float_t m01 = s_float_lit(2.0) * (xy - wz);
+  const s_float_t m02 = s_float_lit(2.0) * (xz + wy);
+  const s_float_t m10 = s_float_lit(2.0) * (xy + wz);
+  const s_float_t m11 = s_float_lit(1.0) - s_float_lit(2.0) * (xx + zz);
+  const s_float_t m12 = s_float_lit(2.0) * (yz - wx);
+  const s_float_t m20 = s_float_lit(2.0) * (xz - wy);
+  const s_float_t m21 = s_float_lit(2.0) * (yz + wx);
+  const s_float_t m22 = s_float_lit(1.0) - s_float_lit(2.0) * (xx + yy);
+  size_t index;
+
+  for (index = 0; index < count; ++index) {
+    const s_float_t vx = right[index][0], vy = right[index][1], vz = right[index][2];
+    out[index][0] = (m00 * vx) + (m01 * vy) + (m02 * vz);
+    out[index][1] = (m10 * vx) + (m11 * vy) + (m12 * vz);
+    out[index][2] = (m20 * vx) + (m21 * vy) + (m22 * vz);
+  }
+}
+
+/*
+  Normalizes each quaternion in place. Zero-length quaternions are left as
+  they are.
+*/
+#if defined(S_SIMD_SSE)
+
+void quat_array_normalize(quat_t *inout, size_t count)
+{
+  const __m128 zero = _mm_setzero_ps();
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    __m128 q = _mm_loadu_ps(inout[index]);
+    __m128 mag = _mm_mul_ps(q, q);
+    mag = _mm_add_ps(mag, _mm_shuffle_ps(mag, mag, _MM_SHUFFLE(2, 3, 0, 1)));
+    mag = _mm_add_ps(mag, _mm_shuffle_ps(mag, mag, _MM_SHUFFLE(1, 0, 3, 2)));
+    mag = _mm_sqrt_ps(mag);
+    q = _mm_and_ps(_mm_cmpneq_ps(mag, zero), _mm_div_ps(q, mag));
+    _mm_storeu_ps(inout[index], q);
+  }
+}
+
+#elif defined(S_SIMD_AVX2)
+
+void quat_array_normalize(quat_t *inout, size_t count)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    __m256d q = _mm256_loadu_pd(inout[index]);
+    __m256d mag = _mm256_mul_pd(q, q);
+    mag = _mm256_add_pd(mag, _mm256_permute4x64_pd(mag, _MM_SHUFFLE(2, 3, 0, 1)));
+    mag = _mm256_add_pd(mag, _mm256_permute4x64_pd(mag, _MM_SHUFFLE(1, 0, 3, 2)));
+    mag = _mm256_sqrt_pd(mag);
+    q = _mm256_and_pd(_mm256_cmp_pd(mag, zero, _CMP_NEQ_OQ), _mm256_div_pd(q, mag));
+    _mm256_storeu_pd(inout[index], q);
+  }
+}
+
+#else
+
+void quat_array_normalize(quat_t *inout, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    vec4_normalize(inout[index], inout[index]);
+  }
+}
+
+#endif
+
+/*
+  Integrates orientations by world-space angular velocities (radians per second)
+  using q = normalize(q + (delta / 2) * (w * q)), after damping each angular
+  velocity in place by 1 / (1 + damping * delta). Orientations are normalized
+  in blocks so they're still in cache from the integration step.
+*/
+void quat_array_integrate(quat_t *orientation, vec3_t *angular_velocity, s_float_t delta, s_float_t damping, size_t count)
+{
+  const s_float_t scale = s_float_lit(1.0) / (s_float_lit(1.0) + damping * delta);
+  const s_float_t half_dt = s_float_lit(0.5) * delta;
+  const size_t block_size = 64;
+  size_t block;
+  size_t index;
+
+  for (block = 0; block < count; block += block_size) {
+    const size_t block_end = (block + block_size < count) ? block + block_size : count;
+    for (index = block; index < block_end; ++index) {
+      quat_t spin;
+      vec3_scale(angular_velocity[index], scale, angular_velocity[index]);
+      spin[0] = angular_velocity[index][0] * half_dt;
+      spin[1] = angular_velocity[index][1] * half_dt;
+      spin[2] = angular_velocity[index][2] * half_dt;
+      spin[3] = s_float_lit(0.0);
+      /* quat_multiply(q, spin) is the Hamilton product spin * q */
+      quat_multiply(orientation[index], spin, spin);
+      vec4_add(orientation[index], spin, orientation[index]);
+    }
+    quat_array_normalize(orientation + block, block_end - block);
+  }
+}
+
+/*
+  Uniform random rotations using Shoemake's method, which maps three uniform
+  numbers to a point uniformly distributed on the unit 3-sphere.
+*/
+#define QUAT_RANDOM_BLOCK 32
+
+void quat_array_random(s_random_t *random, quat_t *out, size_t count)
+{
+  s_float_t uniform[QUAT_RANDOM_BLOCK * 3];
+  size_t block;
+  size_t index;
+  for (block = 0; block < count; block += QUAT_RANDOM_BLOCK) {
+    const size_t block_count = (count - block < QUAT_RANDOM_BLOCK) ? count - block : QUAT_RANDOM_BLOCK;
+    s_random_uniform(random, uniform, block_count * 3);
+    for (index = 0; index < block_count; ++index) {
+      const s_float_t lower = s_sqrt(s_float_lit(1.0) - uniform[index * 3]);
+      const s_float_t upper = s_sqrt(uniform[index * 3]);
+      const s_float_t theta = S_FLOAT_TAU * uniform[index * 3 + 1];
+      const s_float_t phi = S_FLOAT_TAU * uniform[index * 3 + 2];
+      out[block + index][0] = lower * s_sin(theta);
+      out[block + index][1] = lower * s_cos(theta);
+      out[block + index][2] = upper * s_sin(phi);
+      out[block + index][3] = upper * s_cos(phi);
+    }
+  }
+}
+
+/*
+  Smallest-three encoding. The component with the largest magnitude is dropped
+  and rebuilt from the unit length on decoding, and the rotation is negated if
+  needed so that it is positive. The other three then lie within +/-sqrt(1/2)
+  and are quantized to bits bits each, following the dropped component's index
+  in the top two bits. They use 2^bits - 1 levels centred on zero, so zero is
+  exact and the identity rotation round-trips unchanged; the top code is
+  unused.
+*/
+#define QUAT_SMALLEST3_RANGE s_float_lit(0.7071067811865475)
+
+size_t quat_smallest3_bytes(int bits)
+{
+  return ((size_t)bits * 3 + 2 + 7) / 8;
+}
+
+void quat_array_encode_smallest3(const quat_t *in, size_t count, int bits, uint8_t *out)
+{
+  const size_t stride = quat_smallest3_bytes(bits);
+  const uint64_t max_value = (UINT64_C(1) << bits) - 2;
+  const s_float_t scale = s_float_lit(0.5) / QUAT_SMALLEST3_RANGE;
+  size_t index;
+
+  for (index = 0; index < count; ++index) {
+    const s_float_t *q = in[index];
+    s_float_t length_sq = vec4_dot_product(q, q);
+    s_float_t inv_length;
+    uint64_t packed;
+    int largest = 3;
+    int component;
+
+    if (!(length_sq > s_float_lit(0.0))) {
+      /* Zero and NaN rotations are stored as the identity */
+      q = g_quat_identity;
+      length_sq = s_float_lit(1.0);
+    }
+
+    for (component = 0; component < 3; ++component) {
+      if (s_fabs(q[component]) > s_fabs(q[largest])) {
+        largest = component;
+      }
+    }
+
+    inv_length = s_float_lit(1.0) / s_sqrt(length_sq);
+    if (q[largest] < s_float_lit(0.0)) {
+      inv_length = -inv_length;
+    }
+
+    packed = (uint64_t)largest;
+    for (component = 0; component < 4; ++component) {
+      if (component != largest) {
+        const s_float_t t = (q[component] * inv_length + QUAT_SMALLEST3_RANGE) * scale;
+        packed = (packed << bits) | s_quantize_unit(t, max_value);
+      }
+    }
+    s_store_packed(packed, stride, out + index * stride);
+  }
+}
+
+void quat_array_decode_smallest3(const uint8_t *in, size_t count, int bits, quat_t *out)
+{
+  const size_t stride = quat_smallest3_bytes(bits);
+  const uint64_t mask = (UINT64_C(1) << bits) - 1;
+  const s_float_t center = (s_float_t)((UINT64_C(1) << (bits - 1)) - 1);
+  const s_float_t scale = QUAT_SMALLEST3_RANGE / center;
+  size_t index;
+
+  for (index = 0; index < count; ++index) {
+    const uint64_t packed = s_load_packed(in + index * stride, stride);
+    const int largest = (int)((packed >> (bits * 3)) & 3);
+    s_float_t *q = out[index];
+    s_float_t sum_sq = s_float_lit(0.0);
+    int shift = bits * 2;
+    int component;
+
+    for (component = 0; component < 4; ++component) {
+      if (component != largest) {
+        const uint64_t value = (packed >> shift) & mask;
+        q[component] = ((s_float_t)value - center) * scale;
+        sum_sq += q[component] * q[component];
+        shift -= bits;
+      }
+    }
+
+    q[largest] = (sum_sq < s_float_lit(1.0)) ? s_sqrt(s_float_lit(1.0) - sum_sq) : s_float_lit(0.0);
+    vec4_normalize(q, q);
+  }
+}
+
+/*
+  QTangents. The rotation is stored with w non-negative, and at least one
+  snorm16 step above zero so that negating it for a reflected frame is never
+  lost to rounding.
+*/
+#define QUAT_QTANGENT_BIAS (s_float_lit(1.0) / s_float_lit(32767.0))
+
+void quat_encode_qtangent(const quat_t in, s_float_t sign, uint8_t *out)
+{
+  quat_t q;
+  int component;
+
+  if (vec4_dot_product(in, in) > s_float_lit(0.0)) {
+    vec4_normalize(in, q);
+  } else {
+    quat_identity(q);
+  }
+
+  if (q[3] < s_float_lit(0.0)) {
+    vec4_negate(q, q);
+  }
+
+  if (q[3] < QUAT_QTANGENT_BIAS) {
+    const s_float_t scale = s_sqrt(s_float_lit(1.0) - QUAT_QTANGENT_BIAS * QUAT_QTANGENT_BIAS) / vec3_length(q);
+    vec3_scale(q, scale, q);
+    q[3] = QUAT_QTANGENT_BIAS;
+  }
+
+  if (sign < s_float_lit(0.0)) {
+    vec4_negate(q, q);
+  }
+
+  for (component = 0; component < 4; ++component) {
+    s_store_snorm16(q[component], out + component * 2);
+  }
+}
+
+s_float_t quat_decode_qtangent(const uint8_t *in, quat_t out)
+{
+  s_float_t sign;
+  int component;
+
+  for (component = 0; component < 4; ++component) {
+    out[component] = s_load_snorm16(in + component * 2);
+  }
+
+  sign = (out[3] < s_float_lit(0.0)) ? s_float_lit(-1.0) : s_float_lit(1.0);
+  vec4_scale(out, sign, out);
+  vec4_normalize(out, out);
+  return sign;
+}
+
+void quat_array_encode_qtangent(const quat_t *in, const s_float_t *signs, size_t count, uint8_t *out)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    quat_encode_qtangent(in[index], signs ? signs[index] : s_float_lit(1.0), out + index * 8);
+  }
+}
+
+void quat_array_decode_qtangent(const uint8_t *in, size_t count, quat_t *out, s_float_t *signs)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    const s_float_t sign = quat_decode_qtangent(in + index * 8, out[index]);
+    if (signs) {
+      signs[index] = sign;
+    }
+  }
+}
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
@@ -7,6 +7,7 @@ See COPYING for license information
 
 #include "maths_local.h"
 #include "ruby.h"
+#include "ruby/encoding.h"
 
 #define kSM_WANT_TWO_TO_FOUR_FORMAT_LIT ("Expected a Vec2, Vec3, Vec4, or Quat, got %s")
 #define kSM_WANT_THREE_OR_FOUR_FORMAT_LIT ("Expected a Vec3, Vec4, or Quat, got %s")
@@ -23,11 +24,27 @@ See COPYING for license information
 */
 #define SM_KLASS(TYPE)              s_sm_##TYPE##_klass
 
+/*
+  Checks whether the value's class is exactly RB_TYPE without walking its
+  ancestors. Used as a fast path in SM_RB_IS_A, since most values passed around
+  are direct instances of the snow-math classes.
+*/
+#define SM_RB_IS_INSTANCE_OF(RB_VALUE, RB_TYPE) \
+  (!SPECIAL_CONST_P(RB_VALUE) && RBASIC(RB_VALUE)->klass == (RB_TYPE))
+
 /*
   Returns whether a given ruby value is a kind of RB_TYPE (a Ruby value for a
   class).
 */
-#define SM_RB_IS_A(RB_VALUE, RB_TYPE) (RTEST(rb_obj_is_kind_of((RB_VALUE), (RB_TYPE))))
+#define SM_RB_IS_A(RB_VALUE, RB_TYPE) (SM_RB_IS_INSTANCE_OF((RB_VALUE), (RB_TYPE)) || \
+                                       RTEST(rb_obj_is_kind_of((RB_VALUE), (RB_TYPE))))
+
+/*
+  Returns whether a value is a Numeric, checking for Fixnums and Floats before
+  falling back to a kind_of? test.
+*/
+#define SM_IS_NUMERIC(SM_VALUE) \
+  (FIXNUM_P(SM_VALUE) || RB_TYPE_P((SM_VALUE), T_FLOAT) || SM_RB_IS_A((SM_VALUE), rb_cNumeric))
 
 /*
   Wrapper around SM_RB_IS_A that checks for SM_RB_IS_A(value, SM_KLASS(type)).
@@ -73,6 +90,7 @@ See COPYING for license information
 #if BUILD_ARRAY_TYPE
 
 static ID kRB_NAME_FREEZE;
+static ID kRB_NAME_NEW;
 static ID kRB_IVAR_MATHARRAY_LENGTH;
 static ID kRB_IVAR_MATHARRAY_CACHE;
 static ID kRB_IVAR_MATHARRAY_SOURCE;
@@ -118,6 +136,45 @@ static VALUE sm_mathtype_array_freeze(VALUE sm_self)
   return rb_call_super(0, 0);
 }
 
+/*
+  Arrays whose memory is shared by snapshots are freed with
+  sm_array_shared_free, and their memory is counted here by the number of
+  arrays referencing it.
+*/
+static st_table *s_sm_shared_arrays = NULL;
+
+static void sm_array_shared_free(void *data);
+static void sm_array_unshare(VALUE sm_array);
+
+/*
+  Raises an exception if sm_value is frozen. Otherwise, if sm_value is a typed
+  array or an element of one and the array's memory is shared with a snapshot,
+  the array is given its own copy of its memory. Must be called before taking a
+  pointer to memory that will be written to.
+*/
+static void sm_check_writable(VALUE sm_value)
+{
+  VALUE sm_source;
+
+  rb_check_frozen(sm_value);
+
+  if (s_sm_shared_arrays->num_entries == 0 || !RB_TYPE_P(sm_value, T_DATA)) {
+    return;
+  } else if (RDATA(sm_value)->dfree == sm_array_shared_free) {
+    sm_array_unshare(sm_value);
+  } else if (RDATA(sm_value)->dfree == 0) {
+    /* Array elements don't own their memory and reference their array. */
+    sm_source = rb_ivar_get(sm_value, kRB_IVAR_MATHARRAY_SOURCE);
+    if (RB_TYPE_P(sm_source, T_DATA) && RDATA(sm_source)->dfree == sm_array_shared_free) {
+      sm_array_unshare(sm_source);
+    }
+  }
+}
+
+#else
+
+#define sm_check_writable(SM_VALUE) rb_check_frozen(SM_VALUE)
+
 #endif
 
 
@@ -160,6 +217,9 @@ static VALUE    sm_wrap_mat3(const mat3_t value, VALUE klass);
 static mat3_t * sm_unwrap_mat3(VALUE sm_value, mat3_t store);
 static VALUE    sm_wrap_mat4(const mat4_t value, VALUE klass);
 static mat4_t * sm_unwrap_mat4(VALUE sm_value, mat4_t store);
+static vec2_t * sm_vec2_operand(VALUE sm_rhs, vec2_t broadcast);
+static vec3_t * sm_vec3_operand(VALUE sm_rhs, vec3_t broadcast);
+static vec4_t * sm_vec4_operand(VALUE sm_rhs, vec4_t broadcast);
 
 
 
@@ -207,8 +267,8 @@ static VALUE sm_vec2_array_new(VALUE sm_self, VALUE sm_length_or_copy)
     const vec2_t *source;
     Data_Get_Struct(sm_length_or_copy, vec2_t, source);
     MEMCPY(arr, source, vec2_t, length);
-    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
     sm_self = rb_obj_class(sm_length_or_copy);
+    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
   }
   sm_type_array = Data_Wrap_Struct(sm_self, 0, free, arr);
   rb_ivar_set(sm_type_array, kRB_IVAR_MATHARRAY_LENGTH, sm_length_or_copy);
@@ -241,7 +301,7 @@ static VALUE sm_vec2_array_resize(VALUE sm_self, VALUE sm_new_length)
   size_t new_length;
   size_t old_length;
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   old_length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   new_length = NUM2SIZET(sm_new_length);
@@ -330,7 +390,7 @@ static VALUE sm_vec2_array_store(VALUE sm_self, VALUE sm_index, VALUE sm_value)
   size_t length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   size_t index = NUM2SIZET(sm_index);
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   if (index >= length) {
     rb_raise(rb_eRangeError,
@@ -406,8 +466,8 @@ static VALUE sm_vec3_array_new(VALUE sm_self, VALUE sm_length_or_copy)
     const vec3_t *source;
     Data_Get_Struct(sm_length_or_copy, vec3_t, source);
     MEMCPY(arr, source, vec3_t, length);
-    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
     sm_self = rb_obj_class(sm_length_or_copy);
+    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
   }
   sm_type_array = Data_Wrap_Struct(sm_self, 0, free, arr);
   rb_ivar_set(sm_type_array, kRB_IVAR_MATHARRAY_LENGTH, sm_length_or_copy);
@@ -440,7 +500,7 @@ static VALUE sm_vec3_array_resize(VALUE sm_self, VALUE sm_new_length)
   size_t new_length;
   size_t old_length;
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   old_length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   new_length = NUM2SIZET(sm_new_length);
@@ -529,7 +589,7 @@ static VALUE sm_vec3_array_store(VALUE sm_self, VALUE sm_index, VALUE sm_value)
   size_t length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   size_t index = NUM2SIZET(sm_index);
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   if (index >= length) {
     rb_raise(rb_eRangeError,
@@ -604,8 +664,8 @@ static VALUE sm_vec4_array_new(VALUE sm_self, VALUE sm_length_or_copy)
     const vec4_t *source;
     Data_Get_Struct(sm_length_or_copy, vec4_t, source);
     MEMCPY(arr, source, vec4_t, length);
-    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
     sm_self = rb_obj_class(sm_length_or_copy);
+    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
   }
   sm_type_array = Data_Wrap_Struct(sm_self, 0, free, arr);
   rb_ivar_set(sm_type_array, kRB_IVAR_MATHARRAY_LENGTH, sm_length_or_copy);
@@ -638,7 +698,7 @@ static VALUE sm_vec4_array_resize(VALUE sm_self, VALUE sm_new_length)
   size_t new_length;
   size_t old_length;
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   old_length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   new_length = NUM2SIZET(sm_new_length);
@@ -727,13 +787,13 @@ static VALUE sm_vec4_array_store(VALUE sm_self, VALUE sm_index, VALUE sm_value)
   size_t length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   size_t index = NUM2SIZET(sm_index);
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   if (index >= length) {
     rb_raise(rb_eRangeError,
       "Index %zu out of bounds for array with length %zu",
       index, length);
-  } else if (!SM_IS_A(sm_value, vec4) || !(SM_IS_A(sm_value, quat))) {
+  } else if (!SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
     rb_raise(rb_eTypeError,
       "Invalid value to store: expected Quat or Vec4, got %s",
       rb_obj_classname(sm_value));
@@ -802,8 +862,8 @@ static VALUE sm_quat_array_new(VALUE sm_self, VALUE sm_length_or_copy)
     const quat_t *source;
     Data_Get_Struct(sm_length_or_copy, quat_t, source);
     MEMCPY(arr, source, quat_t, length);
-    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
     sm_self = rb_obj_class(sm_length_or_copy);
+    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
   }
   sm_type_array = Data_Wrap_Struct(sm_self, 0, free, arr);
   rb_ivar_set(sm_type_array, kRB_IVAR_MATHARRAY_LENGTH, sm_length_or_copy);
@@ -836,7 +896,7 @@ static VALUE sm_quat_array_resize(VALUE sm_self, VALUE sm_new_length)
   size_t new_length;
   size_t old_length;
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   old_length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   new_length = NUM2SIZET(sm_new_length);
@@ -925,13 +985,13 @@ static VALUE sm_quat_array_store(VALUE sm_self, VALUE sm_index, VALUE sm_value)
   size_t length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   size_t index = NUM2SIZET(sm_index);
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   if (index >= length) {
     rb_raise(rb_eRangeError,
       "Index %zu out of bounds for array with length %zu",
       index, length);
-  } else if (!SM_IS_A(sm_value, vec4) || !(SM_IS_A(sm_value, quat))) {
+  } else if (!SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
     rb_raise(rb_eTypeError,
       "Invalid value to store: expected Quat or Vec4, got %s",
       rb_obj_classname(sm_value));
@@ -1000,8 +1060,8 @@ static VALUE sm_mat3_array_new(VALUE sm_self, VALUE sm_length_or_copy)
     const mat3_t *source;
     Data_Get_Struct(sm_length_or_copy, mat3_t, source);
     MEMCPY(arr, source, mat3_t, length);
-    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
     sm_self = rb_obj_class(sm_length_or_copy);
+    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
   }
   sm_type_array = Data_Wrap_Struct(sm_self, 0, free, arr);
   rb_ivar_set(sm_type_array, kRB_IVAR_MATHARRAY_LENGTH, sm_length_or_copy);
@@ -1034,7 +1094,7 @@ static VALUE sm_mat3_array_resize(VALUE sm_self, VALUE sm_new_length)
   size_t new_length;
   size_t old_length;
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   old_length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   new_length = NUM2SIZET(sm_new_length);
@@ -1126,7 +1186,7 @@ static VALUE sm_mat3_array_store(VALUE sm_self, VALUE sm_index, VALUE sm_value)
   size_t index = NUM2SIZET(sm_index);
   int is_mat3 = 0;
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   if (index >= length) {
     rb_raise(rb_eRangeError,
@@ -1204,8 +1264,8 @@ static VALUE sm_mat4_array_new(VALUE sm_self, VALUE sm_length_or_copy)
     const mat4_t *source;
     Data_Get_Struct(sm_length_or_copy, mat4_t, source);
     MEMCPY(arr, source, mat4_t, length);
-    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
     sm_self = rb_obj_class(sm_length_or_copy);
+    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
   }
   sm_type_array = Data_Wrap_Struct(sm_self, 0, free, arr);
   rb_ivar_set(sm_type_array, kRB_IVAR_MATHARRAY_LENGTH, sm_length_or_copy);
@@ -1238,7 +1298,7 @@ static VALUE sm_mat4_array_resize(VALUE sm_self, VALUE sm_new_length)
   size_t new_length;
   size_t old_length;
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   old_length = NUM2SIZET(sm_mathtype_array_length(sm_self));
   new_length = NUM2SIZET(sm_new_length);
@@ -1330,7 +1390,7 @@ static VALUE sm_mat4_array_store(VALUE sm_self, VALUE sm_index, VALUE sm_value)
   size_t index = NUM2SIZET(sm_index);
   int is_mat4 = 0;
 
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
 
   if (index >= length) {
     rb_raise(rb_eRangeError,
@@ -1371,703 +1431,1035 @@ static VALUE sm_mat4_array_size(VALUE sm_self)
 }
 
 
-#endif /* BUILD_ARRAY_TYPE */
-
-
 
 /*==============================================================================
 
-  vec2_t functions
+  Snow::FloatArray methods (s_sm_float_array_klass)
 
 ==============================================================================*/
 
-static VALUE sm_wrap_vec2(const vec2_t value, VALUE klass)
+static VALUE s_sm_float_array_klass = Qnil;
+
+/*
+ * In the first form, a new typed array of floats is allocated and returned. In
+ * the second form, a copy of a FloatArray is made and returned. Copied arrays
+ * do not share data.
+ *
+ * FloatArrays hold scalars for batch operations, such as per-element
+ * interpolation factors or per-point results, and are stored with the same
+ * precision as the other Snow math types.
+ *
+ * call-seq:
+ *    new(size)        -> new float_array
+ *    new(float_array) -> copy of float_array
+ */
+static VALUE sm_float_array_new(VALUE sm_self, VALUE sm_length_or_copy)
 {
-  vec2_t *copy;
-  VALUE sm_wrapped = Qnil;
-  if (!RTEST(klass)) {
-    klass = s_sm_vec2_klass;
+  size_t length = 0;
+  s_float_t *arr;
+  VALUE sm_type_array;
+  int copy_array = 0;
+  if ((copy_array = SM_IS_A(sm_length_or_copy, float_array))) {
+    length = NUM2SIZET(sm_mathtype_array_length(sm_length_or_copy));
+  } else {
+    length = NUM2SIZET(sm_length_or_copy);
   }
-  sm_wrapped = Data_Make_Struct(klass, vec2_t, 0, free, copy);
-  if (value) {
-    vec2_copy(value, *copy);
+  if (length <= 0) {
+    return Qnil;
   }
-  return sm_wrapped;
+  arr = ALLOC_N(s_float_t, length);
+  if (copy_array) {
+    const s_float_t *source;
+    Data_Get_Struct(sm_length_or_copy, s_float_t, source);
+    MEMCPY(arr, source, s_float_t, length);
+    sm_self = rb_obj_class(sm_length_or_copy);
+    sm_length_or_copy = sm_mathtype_array_length(sm_length_or_copy);
+  }
+  sm_type_array = Data_Wrap_Struct(sm_self, 0, free, arr);
+  rb_ivar_set(sm_type_array, kRB_IVAR_MATHARRAY_LENGTH, sm_length_or_copy);
+  rb_ivar_set(sm_type_array, kRB_IVAR_MATHARRAY_CACHE, rb_ary_new());
+  rb_obj_call_init(sm_type_array, 0, 0);
+  return sm_type_array;
 }
 
 
 
-static vec2_t *sm_unwrap_vec2(VALUE sm_value, vec2_t store)
+/*
+ * Resizes the array to new_length and returns self.
+ *
+ * If resizing to a length smaller than the previous length, excess array
+ * elements are discarded and the array is truncated. Otherwise, when resizing
+ * the array to a greater length than previous, new elements in the array will
+ * contain garbage values.
+ *
+ * If new_length is equal to self.length, the call does nothing to the array.
+ *
+ * Attempting to resize an array to a new length of zero or less will raise a
+ * RangeError.
+ *
+ * call-seq:
+ *    resize!(new_length) -> self
+ */
+static VALUE sm_float_array_resize(VALUE sm_self, VALUE sm_new_length)
 {
-  vec2_t *value;
-  Data_Get_Struct(sm_value, vec2_t, value);
-  if(store) vec2_copy(*value, store);
-  return value;
+  size_t new_length;
+  size_t old_length;
+
+  sm_check_writable(sm_self);
+
+  old_length = NUM2SIZET(sm_mathtype_array_length(sm_self));
+  new_length = NUM2SIZET(sm_new_length);
+
+  if (old_length == new_length) {
+    /* No change, done */
+    return sm_self;
+  } else if (new_length < 1) {
+    rb_raise(rb_eRangeError,
+      "Cannot resize array to length less than or equal to 0.");
+    return sm_self;
+  }
+
+  REALLOC_N(RDATA(sm_self)->data, s_float_t, new_length);
+  rb_ivar_set(sm_self, kRB_IVAR_MATHARRAY_LENGTH, sm_new_length);
+
+  return sm_self;
 }
 
 
 
 /*
- * Gets the component of the Vec2 at the given index.
+ * Fetches the float at the index and returns it. Unlike other typed arrays,
+ * the returned value is a copy and does not reference the array's memory.
  *
  * call-seq: fetch(index) -> float
  */
-static VALUE sm_vec2_fetch (VALUE sm_self, VALUE sm_index)
+static VALUE sm_float_array_fetch(VALUE sm_self, VALUE sm_index)
 {
-  static const int max_index = sizeof(vec2_t) / sizeof(s_float_t);
-  const vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  if (index < 0 || index >= max_index) {
+  const s_float_t *arr;
+  size_t length = NUM2SIZET(sm_mathtype_array_length(sm_self));
+  size_t index = NUM2SIZET(sm_index);
+  if (index >= length) {
     rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+      "Index %zu out of bounds for array with length %zu",
+      index, length);
   }
-  return DBL2NUM(self[0][NUM2INT(sm_index)]);
+
+  Data_Get_Struct(sm_self, s_float_t, arr);
+  return DBL2NUM(arr[index]);
 }
 
 
 
 /*
- * Sets the Vec2's component at the index to the value.
+ * Stores a Numeric at the given index.
  *
  * call-seq: store(index, value) -> value
  */
-static VALUE sm_vec2_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_float_array_store(VALUE sm_self, VALUE sm_index, VALUE sm_value)
 {
-  static const int max_index = sizeof(vec2_t) / sizeof(s_float_t);
-  vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  rb_check_frozen(sm_self);
-  if (index < 0 || index >= max_index) {
+  s_float_t *arr;
+  size_t length = NUM2SIZET(sm_mathtype_array_length(sm_self));
+  size_t index = NUM2SIZET(sm_index);
+
+  sm_check_writable(sm_self);
+
+  if (index >= length) {
     rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+      "Index %zu out of bounds for array with length %zu",
+      index, length);
   }
-  self[0][index] = (s_float_t)NUM2DBL(sm_value);
+
+  Data_Get_Struct(sm_self, s_float_t, arr);
+  arr[index] = (s_float_t)NUM2DBL(sm_value);
   return sm_value;
 }
 
 
 
 /*
- * Returns the length in bytes of the Vec2. When compiled to use doubles as the
- * base type, this is always 16. Otherwise, when compiled to use floats, it's
- * always 8.
+ * Returns the size of the array's data in bytes.
  *
  * call-seq: size -> fixnum
  */
-static VALUE sm_vec2_size (VALUE self)
+static VALUE sm_float_array_size(VALUE sm_self)
 {
-  return SIZET2NUM(sizeof(vec2_t));
+  size_t length = NUM2SIZET(sm_mathtype_array_length(sm_self));
+  return SIZET2NUM(length * sizeof(s_float_t));
 }
 
 
 
+
+/*==============================================================================
+
+  Shared typed array helpers and conversions
+
+==============================================================================*/
+
 /*
- * Returns the length of the Vec2 in components. Result is always 2.
- *
- * call-seq: length -> fixnum
- */
-static VALUE sm_vec2_length (VALUE self)
+  Identifies the element type of a typed array class. Used by functions shared
+  between all array types that need to know what they're working with.
+*/
+typedef enum {
+  SM_ARRAY_NONE = 0,
+  SM_ARRAY_VEC2,
+  SM_ARRAY_VEC3,
+  SM_ARRAY_VEC4,
+  SM_ARRAY_QUAT,
+  SM_ARRAY_MAT3,
+  SM_ARRAY_MAT4,
+  SM_ARRAY_FLOAT
+} sm_array_kind_t;
+
+/*
+  Returns the length of a typed array as a size_t.
+*/
+#define SM_ARRAY_LENGTH(SM_VALUE) NUM2SIZET(sm_mathtype_array_length((SM_VALUE)))
+
+static sm_array_kind_t sm_array_kind_of_class(VALUE klass)
 {
-  return SIZET2NUM(sizeof(vec2_t) / sizeof(s_float_t));
+  if (!RB_TYPE_P(klass, T_CLASS)) {
+    return SM_ARRAY_NONE;
+  }
+  #define SM_KIND_CHECK(TYPE, KIND)                                                 \
+  if (klass == SM_KLASS(TYPE) || rb_class_inherited_p(klass, SM_KLASS(TYPE)) == Qtrue) { \
+    return (KIND);                                                                  \
+  }
+  SM_KIND_CHECK(vec2_array, SM_ARRAY_VEC2)
+  SM_KIND_CHECK(vec3_array, SM_ARRAY_VEC3)
+  SM_KIND_CHECK(vec4_array, SM_ARRAY_VEC4)
+  SM_KIND_CHECK(quat_array, SM_ARRAY_QUAT)
+  SM_KIND_CHECK(mat3_array, SM_ARRAY_MAT3)
+  SM_KIND_CHECK(mat4_array, SM_ARRAY_MAT4)
+  SM_KIND_CHECK(float_array, SM_ARRAY_FLOAT)
+  #undef SM_KIND_CHECK
+  return SM_ARRAY_NONE;
 }
 
+static sm_array_kind_t sm_array_kind_of(VALUE sm_value)
+{
+  return sm_array_kind_of_class(rb_obj_class(sm_value));
+}
 
+/*
+  Returns the size in bytes of a single element of the given array kind.
+*/
+static size_t sm_array_kind_elem_size(sm_array_kind_t kind)
+{
+  switch (kind) {
+  case SM_ARRAY_VEC2: return sizeof(vec2_t);
+  case SM_ARRAY_VEC3: return sizeof(vec3_t);
+  case SM_ARRAY_VEC4: return sizeof(vec4_t);
+  case SM_ARRAY_QUAT: return sizeof(quat_t);
+  case SM_ARRAY_MAT3: return sizeof(mat3_t);
+  case SM_ARRAY_MAT4: return sizeof(mat4_t);
+  case SM_ARRAY_FLOAT: return sizeof(s_float_t);
+  default:            return 0;
+  }
+}
 
 /*
- * Returns a copy of self.
- *
- * call-seq:
- *    copy(output = nil) -> output or new vec2
- */
-static VALUE sm_vec2_copy(int argc, VALUE *argv, VALUE sm_self)
+  Returns the Snow array class for the given array kind, or nil.
+*/
+static VALUE sm_array_kind_base_class(sm_array_kind_t kind)
 {
-  VALUE sm_out;
-  vec2_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-   vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_copy (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_copy (*self, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
+  switch (kind) {
+  case SM_ARRAY_VEC2: return s_sm_vec2_array_klass;
+  case SM_ARRAY_VEC3: return s_sm_vec3_array_klass;
+  case SM_ARRAY_VEC4: return s_sm_vec4_array_klass;
+  case SM_ARRAY_QUAT: return s_sm_quat_array_klass;
+  case SM_ARRAY_MAT3: return s_sm_mat3_array_klass;
+  case SM_ARRAY_MAT4: return s_sm_mat4_array_klass;
+  case SM_ARRAY_FLOAT: return s_sm_float_array_klass;
+  default:            return Qnil;
   }
-  return sm_out;
 }
 
+/*
+  Raises an exception if sm_value isn't a kind of klass with at least length
+  elements. Returns sm_value.
+*/
+static VALUE sm_array_input(VALUE sm_value, VALUE klass, size_t length, const char *func_name)
+{
+  size_t value_length;
+
+  if (!SM_RB_IS_A(sm_value, klass)) {
+    rb_raise(rb_eTypeError,
+      "Invalid argument to %s: expected %s, got %s",
+      func_name,
+      rb_class2name(klass),
+      rb_obj_classname(sm_value));
+  }
+
+  value_length = SM_ARRAY_LENGTH(sm_value);
+  if (value_length < length) {
+    rb_raise(rb_eRangeError,
+      "Array passed to %s is too short: expected at least %zu elements, got %zu",
+      func_name, length, value_length);
+  }
 
+  return sm_value;
+}
 
 /*
- * Returns a vector whose components are the multiplicative inverse of this
- * vector's.
- *
- * call-seq:
- *    normalize(output = nil) -> output or new vec2
- */
-static VALUE sm_vec2_normalize(int argc, VALUE *argv, VALUE sm_self)
+  Reads an optional Range of elements of an array of the given length into
+  begin and count. nil selects the whole array.
+*/
+static void sm_array_range(VALUE sm_range, size_t length, size_t *begin, size_t *count, const char *func_name)
 {
-  VALUE sm_out;
-  vec2_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_normalize (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_normalize (*self, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to normalize");
+  long range_begin;
+  long range_length;
+
+  if (!RTEST(sm_range)) {
+    *begin = 0;
+    *count = length;
+    return;
   }
-  return sm_out;
+
+  if (!rb_range_beg_len(sm_range, &range_begin, &range_length, (long)length, 1)) {
+    rb_raise(rb_eTypeError,
+      "Invalid range passed to %s: expected Range, got %s",
+      func_name,
+      rb_obj_classname(sm_range));
+  }
+
+  if ((size_t)range_begin + (size_t)range_length > length) {
+    rb_raise(rb_eRangeError,
+      "Range passed to %s is out of bounds for an array of %zu elements",
+      func_name, length);
+  }
+
+  *begin = (size_t)range_begin;
+  *count = (size_t)range_length;
 }
 
 
 
 /*
- * Returns a vector whose components are the multiplicative inverse of this
- * vector's.
+  A group of points in a typed array. Unless indexed, the group is the count
+  elements starting at begin. If indexed, it is the elements at count indices
+  starting at begin in a separate index buffer.
+*/
+typedef struct sm_point_group_s {
+  size_t begin;
+  size_t count;
+  int indexed;
+} sm_point_group_t;
+
+/*
+  Reads the first group_count groups of points from sm_groups, an Array whose
+  entries are each nil (the whole array), a Range of elements, or an Array of
+  element indices, into groups. Returns the number of element indices the
+  indexed groups need, which are then read by sm_point_group_indices. Entries
+  missing because sm_groups shrank meanwhile are read as nil.
+*/
+static size_t sm_point_groups(VALUE sm_groups, size_t group_count, size_t length, sm_point_group_t *groups, const char *func_name)
+{
+  size_t index_count = 0;
+  size_t group_index;
+
+  for (group_index = 0; group_index < group_count; ++group_index) {
+    const VALUE sm_group = rb_ary_entry(sm_groups, (long)group_index);
+    groups[group_index].indexed = RB_TYPE_P(sm_group, T_ARRAY);
+    if (groups[group_index].indexed) {
+      groups[group_index].begin = index_count;
+      groups[group_index].count = (size_t)RARRAY_LEN(sm_group);
+      index_count += groups[group_index].count;
+    } else {
+      sm_array_range(sm_group, length, &groups[group_index].begin, &groups[group_index].count, func_name);
+    }
+  }
+
+  return index_count;
+}
+
+/*
+  Copies the element indices of the indexed groups read by sm_point_groups
+  into indices, checking each against length. Converting an index may call
+  into Ruby, so each group is checked to still be an Array of the length it
+  was read with before its indices are read.
+*/
+static void sm_point_group_indices(VALUE sm_groups, size_t group_count, size_t length, const sm_point_group_t *groups, size_t *indices, const char *func_name)
+{
+  size_t group_index;
+  size_t index;
+
+  for (group_index = 0; group_index < group_count; ++group_index) {
+    const VALUE sm_group = rb_ary_entry(sm_groups, (long)group_index);
+    if (!groups[group_index].indexed) {
+      continue;
+    }
+    for (index = 0; index < groups[group_index].count; ++index) {
+      long element;
+      if (!RB_TYPE_P(sm_group, T_ARRAY) || (size_t)RARRAY_LEN(sm_group) != groups[group_index].count) {
+        rb_raise(rb_eRuntimeError, "Groups passed to %s were modified while being read", func_name);
+      }
+      element = NUM2LONG(rb_ary_entry(sm_group, (long)index));
+      if (element < 0 || (size_t)element >= length) {
+        rb_raise(rb_eRangeError,
+          "Index %ld passed to %s is out of bounds for an array of %zu elements",
+          element, func_name, length);
+      }
+      indices[groups[group_index].begin + index] = (size_t)element;
+    }
+  }
+}
+
+
+
+/*
+  Returns an output array for a batch operation. If sm_out is nil, a new array
+  of klass with the given length is allocated. Otherwise, sm_out must be a
+  non-frozen kind of klass with at least length elements, and is returned.
+*/
+static VALUE sm_array_output(VALUE sm_out, VALUE klass, size_t length, const char *func_name)
+{
+  if (!RTEST(sm_out)) {
+    return rb_funcall(klass, kRB_NAME_NEW, 1, SIZET2NUM(length));
+  }
+
+  sm_array_input(sm_out, klass, length, func_name);
+  sm_check_writable(sm_out);
+  return sm_out;
+}
+
+
+
+/*
+  Frees memory shared between an array and its snapshots once no array
+  references it.
+*/
+static void sm_array_shared_free(void *data)
+{
+  st_data_t key = (st_data_t)data;
+  st_data_t refs;
+
+  if (st_lookup(s_sm_shared_arrays, key, &refs) && refs > 1) {
+    st_insert(s_sm_shared_arrays, key, refs - 1);
+    return;
+  }
+
+  st_delete(s_sm_shared_arrays, &key, NULL);
+  free(data);
+}
+
+/*
+  Gives an array sharing its memory with snapshots its own copy of it. If no
+  other array still references the memory, the array takes ownership of it
+  instead. Elements already fetched from the array are moved to the copy along
+  with it.
+*/
+static void sm_array_unshare(VALUE sm_array)
+{
+  st_data_t key = (st_data_t)RDATA(sm_array)->data;
+  st_data_t refs = 0;
+  size_t elem_size;
+  size_t length;
+  char *copy;
+  VALUE sm_cache;
+  long index;
+
+  st_lookup(s_sm_shared_arrays, key, &refs);
+  if (refs <= 1) {
+    st_delete(s_sm_shared_arrays, &key, NULL);
+    RDATA(sm_array)->dfree = free;
+    return;
+  }
+
+  elem_size = sm_array_kind_elem_size(sm_array_kind_of(sm_array));
+  length = SM_ARRAY_LENGTH(sm_array);
+  copy = ALLOC_N(char, length * elem_size);
+  MEMCPY(copy, RDATA(sm_array)->data, char, length * elem_size);
+  st_insert(s_sm_shared_arrays, key, refs - 1);
+  RDATA(sm_array)->data = copy;
+  RDATA(sm_array)->dfree = free;
+
+  sm_cache = rb_ivar_get(sm_array, kRB_IVAR_MATHARRAY_CACHE);
+  for (index = 0; index < RARRAY_LEN(sm_cache); ++index) {
+    VALUE sm_cached_entry = rb_ary_entry(sm_cache, index);
+    if (RTEST(sm_cached_entry)) {
+      RDATA(sm_cached_entry)->data = copy + (size_t)index * elem_size;
+    }
+  }
+}
+
+
+
+/*
+ * Returns a new array of the same class and length that shares this array's
+ * memory. Taking a snapshot doesn't copy anything: the first write to either
+ * array, whether through its methods, its elements, or as an output, gives the
+ * written array its own copy of the memory first, so writes are never seen
+ * through the other.
  *
- * call-seq:
- *    inverse(output = nil) -> output or new vec2
+ * Writes through the memory returned by #address aren't tracked, so don't write
+ * to an array through its address while it has snapshots.
+ *
+ * call-seq: snapshot -> new array
  */
-static VALUE sm_vec2_inverse(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mathtype_array_snapshot(VALUE sm_self)
 {
-  VALUE sm_out;
-  vec2_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_inverse (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_inverse (*self, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
+  void *data;
+  st_data_t refs = 1;
+  VALUE sm_snapshot;
+
+  Data_Get_Struct(sm_self, void, data);
+  if (RDATA(sm_self)->dfree == sm_array_shared_free) {
+    st_lookup(s_sm_shared_arrays, (st_data_t)data, &refs);
+  }
+  st_insert(s_sm_shared_arrays, (st_data_t)data, refs + 1);
+  RDATA(sm_self)->dfree = sm_array_shared_free;
+
+  sm_snapshot = Data_Wrap_Struct(rb_obj_class(sm_self), 0, sm_array_shared_free, data);
+  rb_ivar_set(sm_snapshot, kRB_IVAR_MATHARRAY_LENGTH, sm_mathtype_array_length(sm_self));
+  rb_ivar_set(sm_snapshot, kRB_IVAR_MATHARRAY_CACHE, rb_ary_new());
+  rb_obj_call_init(sm_snapshot, 0, 0);
+  return sm_snapshot;
+}
+
+
+
+/*
+  Returns a binary String of bytesize bytes for a batch encoder to write to. If
+  sm_out is nil, a new String is allocated. Otherwise, sm_out must be a
+  non-frozen String, which is resized and returned.
+*/
+static VALUE sm_packed_output(VALUE sm_out, size_t bytesize, const char *func_name)
+{
+  if (!RTEST(sm_out)) {
+    return rb_str_new(NULL, (long)bytesize);
+  } else if (!RB_TYPE_P(sm_out, T_STRING)) {
+    rb_raise(rb_eTypeError,
+      "Invalid argument to %s: expected String, got %s",
+      func_name,
+      rb_obj_classname(sm_out));
   }
+
+  rb_str_resize(sm_out, (long)bytesize);
+  rb_enc_associate_index(sm_out, rb_ascii8bit_encindex());
   return sm_out;
 }
 
+/*
+  Raises an exception if sm_packed isn't a String holding a whole number of
+  stride-byte elements. Returns the number of elements.
+*/
+static size_t sm_packed_input(VALUE sm_packed, size_t stride, const char *func_name)
+{
+  size_t bytesize;
+
+  if (!RB_TYPE_P(sm_packed, T_STRING)) {
+    rb_raise(rb_eTypeError,
+      "Invalid argument to %s: expected String, got %s",
+      func_name,
+      rb_obj_classname(sm_packed));
+  }
+
+  bytesize = (size_t)RSTRING_LEN(sm_packed);
+  if (bytesize % stride != 0) {
+    rb_raise(rb_eArgError,
+      "String passed to %s has %zu bytes, which is not a multiple of %zu",
+      func_name, bytesize, stride);
+  }
 
+  return bytesize / stride;
+}
 
 /*
- * Negates this vector's components and returns the result.
+  Reads an optional bit width, raising an ArgumentError if it is outside
+  [min_bits, max_bits].
+*/
+static int sm_packed_bits(VALUE sm_bits, int default_bits, int min_bits, int max_bits, const char *func_name)
+{
+  const int bits = RTEST(sm_bits) ? NUM2INT(sm_bits) : default_bits;
+  if (bits < min_bits || bits > max_bits) {
+    rb_raise(rb_eArgError,
+      "Invalid bit width passed to %s: expected %d to %d, got %d",
+      func_name, min_bits, max_bits, bits);
+  }
+  return bits;
+}
+
+
+
+/*
+ * Converts the elements of this array to the element type of another typed
+ * array class and returns an array of that class holding the converted
+ * elements. If an output array is provided, it must be a kind of klass and
+ * hold at least as many elements as self.
+ *
+ * Supported conversions are:
+ *
+ * - Vec2Array to Vec3Array (Z is 0) and Vec4Array (Z is 0, W is w)
+ * - Vec3Array to Vec2Array and Vec4Array (W is w)
+ * - Vec4Array to Vec2Array, Vec3Array, and QuatArray
+ * - QuatArray to Vec4Array, Mat3Array, and Mat4Array
+ * - Mat3Array to Mat4Array and QuatArray
+ * - Mat4Array to Mat3Array and QuatArray
+ *
+ * Converting to the array's own class copies its elements. FloatArrays can only
+ * be converted to FloatArrays.
  *
  * call-seq:
- *    negate(output = nil) -> output or new vec2
+ *    convert_to(klass, output = nil, w = 1) -> output or new array of klass
  */
-static VALUE sm_vec2_negate(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mathtype_array_convert_to(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_klass;
   VALUE sm_out;
-  vec2_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
+  VALUE sm_w;
+  sm_array_kind_t from_kind;
+  sm_array_kind_t to_kind;
+  s_float_t w = s_float_lit(1.0);
+  size_t length;
+  void *from;
+  void *to;
+
+  rb_scan_args(argc, argv, "12", &sm_klass, &sm_out, &sm_w);
+
+  from_kind = sm_array_kind_of(sm_self);
+  to_kind = sm_array_kind_of_class(sm_klass);
+  if (to_kind == SM_ARRAY_NONE) {
+    rb_raise(rb_eTypeError,
+      "Expected a typed array class to convert to, got %s",
+      RB_TYPE_P(sm_klass, T_CLASS) ? rb_class2name(sm_klass) : rb_obj_classname(sm_klass));
+  }
+
+  if (RTEST(sm_w)) {
+    w = (s_float_t)NUM2DBL(sm_w);
+  }
+
+  length = SM_ARRAY_LENGTH(sm_self);
+  sm_out = sm_array_output(sm_out, sm_klass, length, "convert_to");
+
+  Data_Get_Struct(sm_self, void, from);
+  Data_Get_Struct(sm_out, void, to);
+
+  #define SM_CONVERSION(FROM, TO) (((FROM) << 4) | (TO))
+  switch (SM_CONVERSION(from_kind, to_kind)) {
+  case SM_CONVERSION(SM_ARRAY_VEC2, SM_ARRAY_VEC2):
+  case SM_CONVERSION(SM_ARRAY_VEC3, SM_ARRAY_VEC3):
+  case SM_CONVERSION(SM_ARRAY_VEC4, SM_ARRAY_VEC4):
+  case SM_CONVERSION(SM_ARRAY_VEC4, SM_ARRAY_QUAT):
+  case SM_CONVERSION(SM_ARRAY_QUAT, SM_ARRAY_QUAT):
+  case SM_CONVERSION(SM_ARRAY_QUAT, SM_ARRAY_VEC4):
+  case SM_CONVERSION(SM_ARRAY_MAT3, SM_ARRAY_MAT3):
+  case SM_CONVERSION(SM_ARRAY_MAT4, SM_ARRAY_MAT4):
+  case SM_CONVERSION(SM_ARRAY_FLOAT, SM_ARRAY_FLOAT):
+    if (from != to) {
+      MEMCPY(to, from, char, length * sm_array_kind_elem_size(from_kind));
     }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_negate (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_negate (*self, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to negate");
+    break;
+
+  case SM_CONVERSION(SM_ARRAY_VEC2, SM_ARRAY_VEC3):
+    vec2_array_to_vec3((const vec2_t *)from, (vec3_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_VEC2, SM_ARRAY_VEC4):
+    vec2_array_to_vec4((const vec2_t *)from, w, (vec4_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_VEC3, SM_ARRAY_VEC2):
+    vec3_array_to_vec2((const vec3_t *)from, (vec2_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_VEC3, SM_ARRAY_VEC4):
+    vec3_array_to_vec4((const vec3_t *)from, w, (vec4_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_VEC4, SM_ARRAY_VEC2):
+    vec4_array_to_vec2((const vec4_t *)from, (vec2_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_VEC4, SM_ARRAY_VEC3):
+    vec4_array_to_vec3((const vec4_t *)from, (vec3_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_QUAT, SM_ARRAY_MAT3):
+    mat3_array_from_quat((const quat_t *)from, (mat3_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_QUAT, SM_ARRAY_MAT4):
+    mat4_array_from_quat((const quat_t *)from, (mat4_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_MAT3, SM_ARRAY_MAT4):
+    mat3_array_to_mat4((const mat3_t *)from, (mat4_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_MAT3, SM_ARRAY_QUAT):
+    quat_array_from_mat3((const mat3_t *)from, (quat_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_MAT4, SM_ARRAY_MAT3):
+    mat4_array_to_mat3((const mat4_t *)from, (mat3_t *)to, length);
+    break;
+  case SM_CONVERSION(SM_ARRAY_MAT4, SM_ARRAY_QUAT):
+    quat_array_from_mat4((const mat4_t *)from, (quat_t *)to, length);
+    break;
+
+  default:
+    rb_raise(rb_eTypeError,
+      "Cannot convert %s to %s",
+      rb_obj_classname(sm_self),
+      rb_class2name(sm_klass));
+    break;
   }
+  #undef SM_CONVERSION
+
   return sm_out;
 }
 
 
 
+
+/*==============================================================================
+
+  Typed array batch operations
+
+==============================================================================*/
+
 /*
- * Projects this vector onto a normal vector and returns the result.
+ * Multiplies each quaternion in this array by the quaternion at the same index
+ * in quat_array and returns an array of the results. quat_array must hold at
+ * least as many elements as self. Output may be self or quat_array.
  *
  * call-seq:
- *    project(normal, output = nil) -> output or new vec2
+ *    multiply_quat(quat_array, output = nil) -> output or new quat_array
  */
-static VALUE sm_vec2_project(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_quat_array_multiply_quat(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_rhs;
   VALUE sm_out;
-  vec2_t *self;
-  vec2_t *rhs;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  const quat_t *self;
+  const quat_t *rhs;
+  quat_t *output;
+
   rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec2(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_project(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_project(*self, *rhs, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to project");
-  }
+  sm_array_input(sm_rhs, s_sm_quat_array_klass, length, "multiply_quat");
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, "multiply_quat");
+
+  Data_Get_Struct(sm_self, quat_t, self);
+  Data_Get_Struct(sm_rhs, quat_t, rhs);
+  Data_Get_Struct(sm_out, quat_t, output);
+  quat_array_multiply(self, rhs, output, length);
+
   return sm_out;
 }
 
 
 
 /*
- * Reflects this vector against a normal vector and returns the result.
+ * Rotates each Vec3 in vec3_array by the quaternion at the same index in this
+ * array and returns an array of the results. vec3_array must hold at least as
+ * many elements as self. Output may be vec3_array.
  *
  * call-seq:
- *    reflect(normal, output = nil) -> output or new vec2
+ *    multiply_vec3(vec3_array, output = nil) -> output or new vec3_array
  */
-static VALUE sm_vec2_reflect(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_quat_array_multiply_vec3(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_rhs;
   VALUE sm_out;
-  vec2_t *self;
-  vec2_t *rhs;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  const quat_t *self;
+  const vec3_t *rhs;
+  vec3_t *output;
+
   rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec2(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_reflect(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_reflect(*self, *rhs, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to reflect");
-  }
+  sm_array_input(sm_rhs, s_sm_vec3_array_klass, length, "multiply_vec3");
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_rhs), length, "multiply_vec3");
+
+  Data_Get_Struct(sm_self, quat_t, self);
+  Data_Get_Struct(sm_rhs, vec3_t, rhs);
+  Data_Get_Struct(sm_out, vec3_t, output);
+  quat_array_multiply_vec3(self, rhs, output, length);
+
   return sm_out;
 }
 
 
 
 /*
- * Multiplies this and another vector's components together and returns the
- * result.
+ * Rotates every Vec3 in vec3_array by this quaternion and returns an array of
+ * the results. Output may be vec3_array.
  *
  * call-seq:
- *    multiply_vec2(vec2, output = nil) -> output or new vec2
+ *    multiply_vec3_array(vec3_array, output = nil) -> output or new vec3_array
  */
-static VALUE sm_vec2_multiply(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_quat_multiply_vec3_array(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_rhs;
   VALUE sm_out;
-  vec2_t *self;
-  vec2_t *rhs;
+  size_t length;
+  const quat_t *self;
+  const vec3_t *rhs;
+  vec3_t *output;
+
   rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec2(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_multiply(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_multiply(*self, *rhs, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to multiply");
-  }
+  sm_array_input(sm_rhs, s_sm_vec3_array_klass, 0, "multiply_vec3_array");
+  length = SM_ARRAY_LENGTH(sm_rhs);
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_rhs), length, "multiply_vec3_array");
+
+  self = sm_unwrap_quat(sm_self, NULL);
+  Data_Get_Struct(sm_rhs, vec3_t, rhs);
+  Data_Get_Struct(sm_out, vec3_t, output);
+  quat_multiply_vec3_array(*self, rhs, output, length);
+
   return sm_out;
 }
 
 
 
 /*
- * Adds this and another vector's components together and returns the result.
+ * Multiplies each matrix in this array by the matrix at the same index in
+ * mat3_array and returns an array of the results. mat3_array must hold at
+ * least as many elements as self. Output may be self or mat3_array.
  *
  * call-seq:
- *    add(vec2, output = nil) -> output or new vec2
+ *    multiply_mat3(mat3_array, output = nil) -> output or new mat3_array
  */
-static VALUE sm_vec2_add(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_array_multiply_mat3(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_rhs;
   VALUE sm_out;
-  vec2_t *self;
-  vec2_t *rhs;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  const mat3_t *self;
+  const mat3_t *rhs;
+  mat3_t *output;
+
   rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec2(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_add(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_add(*self, *rhs, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to add");
-  }
+  sm_array_input(sm_rhs, s_sm_mat3_array_klass, length, "multiply_mat3");
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, "multiply_mat3");
+
+  Data_Get_Struct(sm_self, mat3_t, self);
+  Data_Get_Struct(sm_rhs, mat3_t, rhs);
+  Data_Get_Struct(sm_out, mat3_t, output);
+  mat3_array_multiply(self, rhs, output, length);
+
   return sm_out;
 }
 
 
 
 /*
- * Subtracts another vector's components from this vector's and returns the
- * result.
+ * Rotates each Vec3 in vec3_array by the matrix at the same index in this
+ * array and returns an array of the results. vec3_array must hold at least as
+ * many elements as self. Output may be vec3_array.
  *
  * call-seq:
- *    subtract(vec2, output = nil) -> output or new vec2
+ *    rotate_vec3(vec3_array, output = nil) -> output or new vec3_array
  */
-static VALUE sm_vec2_subtract(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_array_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_rhs;
   VALUE sm_out;
-  vec2_t *self;
-  vec2_t *rhs;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  const mat3_t *self;
+  const vec3_t *rhs;
+  vec3_t *output;
+
   rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec2(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec2(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec2_t *output;
-    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec2(sm_out, NULL);
-    vec2_subtract(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec2_t output;
-    vec2_subtract(*self, *rhs, output);
-    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to subtract");
-  }
+  sm_array_input(sm_rhs, s_sm_vec3_array_klass, length, "rotate_vec3");
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_rhs), length, "rotate_vec3");
+
+  Data_Get_Struct(sm_self, mat3_t, self);
+  Data_Get_Struct(sm_rhs, vec3_t, rhs);
+  Data_Get_Struct(sm_out, vec3_t, output);
+  mat3_array_rotate_vec3(self, rhs, output, length);
+
   return sm_out;
 }
 
 
 
 /*
- * Returns the dot product of this and another Vec2 or the XY components of a
- * Vec3, Vec4, or Quat.
+ * Inverts each matrix in this array and returns an array of the results.
+ * Matrices that cannot be inverted are replaced by the identity in the output.
+ * Output may be self.
  *
  * call-seq:
- *    dot_product(vec2) -> float
- *    dot_product(vec3) -> float
- *    dot_product(vec4) -> float
- *    dot_product(quat) -> float
+ *    inverse(output = nil) -> output or new mat3_array
  */
-static VALUE sm_vec2_dot_product(VALUE sm_self, VALUE sm_other)
+static VALUE sm_mat3_array_inverse(int argc, VALUE *argv, VALUE sm_self)
 {
-  if (!SM_IS_A(sm_other, vec2) &&
-      !SM_IS_A(sm_other, vec3) &&
-      !SM_IS_A(sm_other, vec4) &&
-      !SM_IS_A(sm_other, quat)) {
-    rb_raise(rb_eArgError,
-      "Expected a Vec2, Vec3, Vec4, or Quat, got %s",
-      rb_obj_classname(sm_other));
-    return Qnil;
-  }
-  return DBL2NUM(
-    vec2_dot_product(
-      *sm_unwrap_vec2(sm_self, NULL),
-      *sm_unwrap_vec2(sm_other, NULL)));
-}
+  VALUE sm_out;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  const mat3_t *self;
+  mat3_t *output;
 
+  rb_scan_args(argc, argv, "01", &sm_out);
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, "inverse");
 
+  Data_Get_Struct(sm_self, mat3_t, self);
+  Data_Get_Struct(sm_out, mat3_t, output);
+  mat3_array_inverse(self, output, length);
 
-/*
- * Allocates a Vec2.
- *
- * call-seq:
- *    new()          -> vec2 with components [0, 0]
- *    new(x, y)      -> vec2 with components [x, y]
- *    new([x, y])    -> vec2 with components [x, y]
- *    new(vec2)      -> copy of vec3
- *    new(vec3)      -> vec2 of vec3's x and y components
- *    new(vec4)      -> vec2 of vec4's x and y components
- *    new(quat)      -> vec2 of quat's x and y components
- */
-static VALUE sm_vec2_new(int argc, VALUE *argv, VALUE self)
-{
-  VALUE sm_vec = sm_wrap_vec2(g_vec2_zero, self);
-  rb_obj_call_init(sm_vec, argc, argv);
-  return sm_vec;
+  return sm_out;
 }
 
 
 
 /*
- * Sets the Vec2's components.
+ * Orthogonalizes each matrix in this array (see Mat3#orthogonal) and returns
+ * an array of the results. Output may be self.
  *
  * call-seq:
- *    set(x, y)      -> vec2 with components [x, y]
- *    set([x, y])    -> vec2 with components [x, y]
- *    set(vec2)      -> copy of vec2
- *    set(vec3)      -> vec2 with components [vec3.xy]
- *    set(vec4)      -> vec2 with components [vec4.xy]
- *    set(quat)      -> vec2 with components [quat.xy]
+ *    orthogonal(output = nil) -> output or new mat3_array
  */
-static VALUE sm_vec2_init(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_array_orthogonal(int argc, VALUE *argv, VALUE sm_self)
 {
-  vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
-  size_t arr_index = 0;
-
-  rb_check_frozen(sm_self);
-
-  switch(argc) {
-
-  /* Default value */
-  case 0: { break; }
-
-  /* Copy or by-array */
-  case 1: {
-    if (SM_IS_A(argv[0], vec2) ||
-        SM_IS_A(argv[0], vec3) ||
-        SM_IS_A(argv[0], vec4) ||
-        SM_IS_A(argv[0], quat)) {
-      sm_unwrap_vec2(argv[0], *self);
-      break;
-    }
-
-    /* Optional offset into array provided */
-    if (0) {
-      case 2:
-      if (!SM_RB_IS_A(argv[0], rb_cArray)) {
-        self[0][0] = (s_float_t)NUM2DBL(argv[0]);
-        self[0][1] = (s_float_t)NUM2DBL(argv[1]);
-        break;
-      }
-      arr_index = NUM2SIZET(argv[1]);
-    }
+  VALUE sm_out;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  const mat3_t *self;
+  mat3_t *output;
 
-    /* Array of values */
-    VALUE arrdata = argv[0];
-    const size_t arr_end = arr_index + 2;
-    s_float_t *vec_elem = *self;
-    for (; arr_index < arr_end; ++arr_index, ++vec_elem) {
-      *vec_elem = (s_float_t)NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
-    }
-    break;
-  }
+  rb_scan_args(argc, argv, "01", &sm_out);
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, "orthogonal");
 
-  default: {
-    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
-    break;
-  }
-  } /* switch (argc) */
+  Data_Get_Struct(sm_self, mat3_t, self);
+  Data_Get_Struct(sm_out, mat3_t, output);
+  mat3_array_orthogonal(self, output, length);
 
-  return sm_self;
+  return sm_out;
 }
 
 
 
 /*
- * Returns a string representation of self.
- *
- *    Vec2[].to_s     # => "{ 0.0, 0.0 }"
+ * Re-orthonormalizes each matrix in this array in place using Gram-Schmidt.
+ * Useful for correcting drift in rotations that are integrated over time.
  *
  * call-seq:
- *    to_s -> string
+ *    orthonormalize! -> self
  */
-static VALUE sm_vec2_to_s(VALUE self)
+static VALUE sm_mat3_array_orthonormalize(VALUE sm_self)
 {
-  const s_float_t *v;
-  v = (const s_float_t *)*sm_unwrap_vec2(self, NULL);
-  return rb_sprintf(
-    "{ "
-    "%f, %f"
-    " }",
-    v[0], v[1]);
+  mat3_t *self;
+  sm_check_writable(sm_self);
+  Data_Get_Struct(sm_self, mat3_t, self);
+  mat3_array_orthonormalize(self, SM_ARRAY_LENGTH(sm_self));
+  return sm_self;
 }
 
 
 
 /*
- * Returns the squared magnitude of self.
+ * Re-orthonormalizes the upper 3x3 of each matrix in this array in place using
+ * Gram-Schmidt. Translations are left as-is.
  *
  * call-seq:
- *    magnitude_squared -> float
+ *    orthonormalize! -> self
  */
-static VALUE sm_vec2_magnitude_squared(VALUE sm_self)
+static VALUE sm_mat4_array_orthonormalize(VALUE sm_self)
 {
-  return DBL2NUM(vec2_length_squared(*sm_unwrap_vec2(sm_self, NULL)));
+  mat4_t *self;
+  sm_check_writable(sm_self);
+  Data_Get_Struct(sm_self, mat4_t, self);
+  mat4_array_orthonormalize(self, SM_ARRAY_LENGTH(sm_self));
+  return sm_self;
 }
 
 
 
 /*
- * Returns the magnitude of self.
+ * Normalizes each quaternion in this array in place. Zero-length quaternions
+ * are left as-is.
  *
  * call-seq:
- *    magnitude -> float
+ *    renormalize! -> self
  */
-static VALUE sm_vec2_magnitude(VALUE sm_self)
+static VALUE sm_quat_array_renormalize(VALUE sm_self)
 {
-  return DBL2NUM(vec2_length(*sm_unwrap_vec2(sm_self, NULL)));
+  quat_t *self;
+  sm_check_writable(sm_self);
+  Data_Get_Struct(sm_self, quat_t, self);
+  quat_array_normalize(self, SM_ARRAY_LENGTH(sm_self));
+  return sm_self;
 }
 
 
 
 /*
- * Scales this vector's components by a scalar value and returns the result.
- *
- * call-seq:
- *    scale(scalar, output = nil) -> output or new vec2
- */
-static VALUE sm_vec2_scale(int argc, VALUE *argv, VALUE sm_self)
+  Repeats sm_value, a Numeric or a vector of the element type of sm_self,
+  across tile.
+*/
+static void sm_vec_array_tile(VALUE sm_value, VALUE sm_self, s_float_t tile[S_FLOAT_TILE_LENGTH])
 {
-  VALUE sm_out;
-  VALUE sm_scalar;
-  s_float_t scalar;
-  vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
-
-  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
-  scalar = NUM2DBL(sm_scalar);
+  const sm_array_kind_t kind = sm_array_kind_of(sm_self);
+  const size_t components = sm_array_kind_elem_size(kind) / sizeof(s_float_t);
+  const s_float_t *source;
+  vec4_t broadcast;
+  size_t index;
 
-  if (SM_IS_A(sm_out, vec2) || SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
-    rb_check_frozen(sm_out);
-    vec2_scale(*self, scalar, *sm_unwrap_vec2(sm_out, NULL));
-  } else {
-    vec2_t out;
-    vec2_scale(*self, scalar, out);
-    sm_out = sm_wrap_vec2(out, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
+  switch (kind) {
+  case SM_ARRAY_VEC2: source = *sm_vec2_operand(sm_value, broadcast); break;
+  case SM_ARRAY_VEC3: source = *sm_vec3_operand(sm_value, broadcast); break;
+  default:            source = *sm_vec4_operand(sm_value, broadcast); break;
+  }
+
+  for (index = 0; index < S_FLOAT_TILE_LENGTH; ++index) {
+    tile[index] = source[index % components];
+  }
+}
+
+/*
+  Reads an operand of a componentwise vector array operation. If sm_value is an
+  array of the same element type as sm_self with at least length elements, its
+  components are returned. Otherwise sm_value must be a Numeric or a vector,
+  which is repeated across tile, and NULL is returned.
+*/
+static const s_float_t *sm_vec_array_operand(
+  VALUE sm_value,
+  VALUE sm_self,
+  size_t length,
+  s_float_t tile[S_FLOAT_TILE_LENGTH],
+  const char *func_name)
+{
+  const VALUE array_klass = sm_array_kind_base_class(sm_array_kind_of(sm_self));
+  const s_float_t *source;
+
+  if (!SM_IS_NUMERIC(sm_value) && SM_RB_IS_A(sm_value, array_klass)) {
+    sm_array_input(sm_value, array_klass, length, func_name);
+    Data_Get_Struct(sm_value, s_float_t, source);
+    return source;
+  }
+
+  sm_vec_array_tile(sm_value, sm_self, tile);
+  return NULL;
+}
+
+/*
+  Returns the number of s_float_t components held by a vector array.
+*/
+static size_t sm_vec_array_components(VALUE sm_self, size_t length)
+{
+  return length * (sm_array_kind_elem_size(sm_array_kind_of(sm_self)) / sizeof(s_float_t));
+}
+
+
+
+/*
+ * Returns an array of the smaller of each pair of components from this array
+ * and another array of the same type. If given a vector or Numeric, every
+ * element is compared against it. Output may be self or other.
+ *
+ * call-seq:
+ *    component_min(vec_array, output = nil) -> output or new vec_array
+ *    component_min(vec, output = nil) -> output or new vec_array
+ *    component_min(scalar, output = nil) -> output or new vec_array
+ */
+static VALUE sm_vec_array_component_min(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  s_float_t tile[S_FLOAT_TILE_LENGTH];
+  const s_float_t *self;
+  const s_float_t *rhs;
+  s_float_t *output;
+
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  rhs = sm_vec_array_operand(sm_rhs, sm_self, length, tile, "component_min");
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, "component_min");
+
+  Data_Get_Struct(sm_self, s_float_t, self);
+  Data_Get_Struct(sm_out, s_float_t, output);
+  if (rhs) {
+    float_array_min(self, rhs, output, sm_vec_array_components(sm_self, length));
+  } else {
+    float_array_min_tile(self, tile, output, sm_vec_array_components(sm_self, length));
   }
 
   return sm_out;
@@ -2076,29 +2468,35 @@ static VALUE sm_vec2_scale(int argc, VALUE *argv, VALUE sm_self)
 
 
 /*
- * Divides this vector's components by a scalar value and returns the result.
+ * Returns an array of the larger of each pair of components from this array
+ * and another array of the same type. If given a vector or Numeric, every
+ * element is compared against it. Output may be self or other.
  *
  * call-seq:
- *    divide(scalar, output = nil) -> output or new vec2
+ *    component_max(vec_array, output = nil) -> output or new vec_array
+ *    component_max(vec, output = nil) -> output or new vec_array
+ *    component_max(scalar, output = nil) -> output or new vec_array
  */
-static VALUE sm_vec2_divide(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec_array_component_max(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_rhs;
   VALUE sm_out;
-  VALUE sm_scalar;
-  s_float_t scalar;
-  vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  s_float_t tile[S_FLOAT_TILE_LENGTH];
+  const s_float_t *self;
+  const s_float_t *rhs;
+  s_float_t *output;
 
-  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
-  scalar = NUM2DBL(sm_scalar);
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  rhs = sm_vec_array_operand(sm_rhs, sm_self, length, tile, "component_max");
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, "component_max");
 
-  if (SM_IS_A(sm_out, vec2) || SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
-    rb_check_frozen(sm_out);
-    vec2_divide(*self, scalar, *sm_unwrap_vec2(sm_out, NULL));
+  Data_Get_Struct(sm_self, s_float_t, self);
+  Data_Get_Struct(sm_out, s_float_t, output);
+  if (rhs) {
+    float_array_max(self, rhs, output, sm_vec_array_components(sm_self, length));
   } else {
-    vec2_t out;
-    vec2_divide(*self, scalar, out);
-    sm_out = sm_wrap_vec2(out, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
+    float_array_max_tile(self, tile, output, sm_vec_array_components(sm_self, length));
   }
 
   return sm_out;
@@ -2107,780 +2505,1400 @@ static VALUE sm_vec2_divide(int argc, VALUE *argv, VALUE sm_self)
 
 
 /*
- * Tests whether a Vec2 is equivalent to another Vec2, a Vec3, Vec4, or a Quat.
- * When testing for equivalency against 4-component objects, only the first two
- * components are compared.
+ * Clamps each component of this array to the range given by lower and upper
+ * and returns an array of the results. Each bound may be an array of the same
+ * type, a vector applied to every element, or a Numeric applied to every
+ * component. Output may be self.
  *
  * call-seq:
- *    vec2 == other_vec2 -> bool
- *    vec2 == vec3       -> bool
- *    vec2 == vec4       -> bool
- *    vec2 == quat       -> bool
+ *    clamp(lower, upper, output = nil) -> output or new vec_array
  */
-static VALUE sm_vec2_equals(VALUE sm_self, VALUE sm_other)
+static VALUE sm_vec_array_clamp(int argc, VALUE *argv, VALUE sm_self)
 {
-  if (!RTEST(sm_other) || (!SM_IS_A(sm_other, vec2) && !SM_IS_A(sm_other, vec3) && !SM_IS_A(sm_other, vec4) && !SM_IS_A(sm_other, quat))) {
-    return Qfalse;
+  VALUE sm_lower;
+  VALUE sm_upper;
+  VALUE sm_out;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  size_t components;
+  s_float_t lower_tile[S_FLOAT_TILE_LENGTH];
+  s_float_t upper_tile[S_FLOAT_TILE_LENGTH];
+  const s_float_t *self;
+  const s_float_t *lower;
+  const s_float_t *upper;
+  s_float_t *output;
+
+  rb_scan_args(argc, argv, "21", &sm_lower, &sm_upper, &sm_out);
+  lower = sm_vec_array_operand(sm_lower, sm_self, length, lower_tile, "clamp");
+  upper = sm_vec_array_operand(sm_upper, sm_self, length, upper_tile, "clamp");
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, "clamp");
+
+  Data_Get_Struct(sm_self, s_float_t, self);
+  Data_Get_Struct(sm_out, s_float_t, output);
+  components = sm_vec_array_components(sm_self, length);
+  if (!lower && !upper) {
+    float_array_clamp_tile(self, lower_tile, upper_tile, output, components);
+  } else {
+    if (lower) {
+      float_array_max(self, lower, output, components);
+    } else {
+      float_array_max_tile(self, lower_tile, output, components);
+    }
+    if (upper) {
+      float_array_min(output, upper, output, components);
+    } else {
+      float_array_min_tile(output, upper_tile, output, components);
+    }
   }
 
-  return vec2_equals(*sm_unwrap_vec2(sm_self, NULL), *sm_unwrap_vec2(sm_other, NULL)) ? Qtrue : Qfalse;
+  return sm_out;
 }
 
 
 
-/*==============================================================================
+/*
+  Defines a binding for a unary componentwise vector array operation that calls
+  FUNC over every component of the array.
+*/
+#define SM_VEC_ARRAY_UNARY(NAME, FUNC)                                          \
+static VALUE sm_vec_array_##NAME(int argc, VALUE *argv, VALUE sm_self)          \
+{                                                                               \
+  VALUE sm_out;                                                                 \
+  size_t length = SM_ARRAY_LENGTH(sm_self);                                     \
+  const s_float_t *self;                                                        \
+  s_float_t *output;                                                            \
+                                                                                \
+  rb_scan_args(argc, argv, "01", &sm_out);                                      \
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, #NAME);       \
+                                                                                \
+  Data_Get_Struct(sm_self, s_float_t, self);                                    \
+  Data_Get_Struct(sm_out, s_float_t, output);                                   \
+  FUNC(self, output, sm_vec_array_components(sm_self, length));                 \
+                                                                                \
+  return sm_out;                                                                \
+}
 
-  vec3_t functions
+/*
+ * Returns an array of the absolute values of this array's components. Output
+ * may be self.
+ *
+ * call-seq:
+ *    abs(output = nil) -> output or new vec_array
+ */
+SM_VEC_ARRAY_UNARY(abs, float_array_abs)
 
-==============================================================================*/
+/*
+ * Rounds each of this array's components down and returns an array of the
+ * results. Output may be self.
+ *
+ * call-seq:
+ *    floor(output = nil) -> output or new vec_array
+ */
+SM_VEC_ARRAY_UNARY(floor, float_array_floor)
 
-static VALUE sm_wrap_vec3(const vec3_t value, VALUE klass)
+/*
+ * Rounds each of this array's components up and returns an array of the
+ * results. Output may be self.
+ *
+ * call-seq:
+ *    ceil(output = nil) -> output or new vec_array
+ */
+SM_VEC_ARRAY_UNARY(ceil, float_array_ceil)
+
+/*
+ * Returns an array holding 1, -1, or 0 for each of this array's components
+ * depending on whether it is positive, negative, or zero. Output may be self.
+ *
+ * call-seq:
+ *    sign(output = nil) -> output or new vec_array
+ */
+SM_VEC_ARRAY_UNARY(sign, float_array_sign)
+
+#undef SM_VEC_ARRAY_UNARY
+
+
+
+/*
+ * Linearly interpolates between the elements of from and to and returns an
+ * array of the results, computing from + (to - from) * delta in a single pass.
+ * Delta is either a Numeric applied to every element or a FloatArray holding
+ * one delta per element. Deltas are not clamped.
+ *
+ * from, to, and output must be kinds of the receiving class, and to and delta
+ * must hold at least as many elements as from. Output may be from or to.
+ *
+ * call-seq:
+ *    lerp(from, to, delta, output = nil) -> output or new array
+ *    lerp(from, to, float_array, output = nil) -> output or new array
+ */
+static VALUE sm_vec_array_s_lerp(int argc, VALUE *argv, VALUE sm_klass)
 {
-  vec3_t *copy;
-  VALUE sm_wrapped = Qnil;
-  if (!RTEST(klass)) {
-    klass = s_sm_vec3_klass;
+  VALUE sm_from;
+  VALUE sm_to;
+  VALUE sm_delta;
+  VALUE sm_out;
+  size_t length;
+  size_t components;
+  const s_float_t *from;
+  const s_float_t *to;
+  s_float_t *output;
+
+  rb_scan_args(argc, argv, "31", &sm_from, &sm_to, &sm_delta, &sm_out);
+  sm_array_input(sm_from, sm_klass, 0, "lerp");
+  length = SM_ARRAY_LENGTH(sm_from);
+  sm_array_input(sm_to, sm_klass, length, "lerp");
+  if (!SM_IS_NUMERIC(sm_delta)) {
+    sm_array_input(sm_delta, s_sm_float_array_klass, length, "lerp");
+  }
+  sm_out = sm_array_output(sm_out, sm_klass, length, "lerp");
+
+  components = sm_array_kind_elem_size(sm_array_kind_of_class(sm_klass)) / sizeof(s_float_t);
+  Data_Get_Struct(sm_from, s_float_t, from);
+  Data_Get_Struct(sm_to, s_float_t, to);
+  Data_Get_Struct(sm_out, s_float_t, output);
+  if (SM_IS_NUMERIC(sm_delta)) {
+    float_array_lerp(from, to, (s_float_t)NUM2DBL(sm_delta), output, length * components);
+  } else {
+    const s_float_t *delta;
+    Data_Get_Struct(sm_delta, s_float_t, delta);
+    float_array_lerp_varying(from, to, delta, components, output, length);
   }
-  sm_wrapped = Data_Make_Struct(klass, vec3_t, 0, free, copy);
-  if (value) {
-    vec3_copy(value, *copy);
+
+  return sm_out;
+}
+
+
+
+/*
+ * Adds alpha times each element of x to the element at the same index in this
+ * array, in place, and returns self. x must be an array of the same type
+ * holding at least as many elements as self.
+ *
+ * call-seq:
+ *    axpy!(alpha, x) -> self
+ */
+static VALUE sm_vec_array_axpy(VALUE sm_self, VALUE sm_alpha, VALUE sm_x)
+{
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  s_float_t alpha = (s_float_t)NUM2DBL(sm_alpha);
+  const s_float_t *x;
+  s_float_t *self;
+
+  sm_check_writable(sm_self);
+  sm_array_input(sm_x, sm_array_kind_base_class(sm_array_kind_of(sm_self)), length, "axpy!");
+
+  Data_Get_Struct(sm_self, s_float_t, self);
+  Data_Get_Struct(sm_x, s_float_t, x);
+  float_array_axpy(alpha, x, self, sm_vec_array_components(sm_self, length));
+
+  return sm_self;
+}
+
+
+
+/*
+  Arguments for the integrator range functions, which s_parallel_for runs on
+  ranges of elements. Work is split on multiples of SM_PARALLEL_GRAIN elements,
+  which keeps every range aligned with broadcast tiles.
+*/
+#define SM_PARALLEL_GRAIN (S_FLOAT_TILE_LENGTH * 256)
+
+typedef struct sm_integrate_args_s {
+  s_float_t *position;
+  s_float_t *velocity;
+  const s_float_t *acceleration;
+  int acceleration_tiled;
+  size_t components;
+  s_float_t delta;
+  s_float_t kick;
+  s_float_t damping;
+} sm_integrate_args_t;
+
+static void sm_integrate_euler_range(void *context, size_t begin, size_t end)
+{
+  const sm_integrate_args_t *args = (const sm_integrate_args_t *)context;
+  const size_t offset = begin * args->components;
+  float_array_integrate_euler(
+    args->position + offset,
+    args->velocity + offset,
+    args->acceleration_tiled ? args->acceleration : args->acceleration + offset,
+    args->acceleration_tiled,
+    args->delta,
+    args->damping,
+    (end - begin) * args->components);
+}
+
+static void sm_integrate_verlet_range(void *context, size_t begin, size_t end)
+{
+  const sm_integrate_args_t *args = (const sm_integrate_args_t *)context;
+  const size_t offset = begin * args->components;
+  float_array_integrate_verlet(
+    args->position + offset,
+    args->velocity + offset,
+    args->acceleration_tiled ? args->acceleration : args->acceleration + offset,
+    args->acceleration_tiled,
+    args->delta,
+    args->kick,
+    args->damping,
+    (end - begin) * args->components);
+}
+
+static void sm_integrate_quat_range(void *context, size_t begin, size_t end)
+{
+  const sm_integrate_args_t *args = (const sm_integrate_args_t *)context;
+  quat_array_integrate(
+    (quat_t *)args->position + begin,
+    (vec3_t *)args->velocity + begin,
+    args->delta,
+    args->damping,
+    end - begin);
+}
+
+/*
+  Fills in the position, velocity, and acceleration fields of args for an
+  integrator called on sm_self. A nil acceleration is treated as zero.
+*/
+static void sm_integrate_args_init(
+  sm_integrate_args_t *args,
+  VALUE sm_self,
+  VALUE sm_velocities,
+  VALUE sm_acceleration,
+  s_float_t tile[S_FLOAT_TILE_LENGTH],
+  const char *func_name)
+{
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+
+  sm_check_writable(sm_self);
+  sm_array_input(sm_velocities, sm_array_kind_base_class(sm_array_kind_of(sm_self)), length, func_name);
+  sm_check_writable(sm_velocities);
+
+  if (RTEST(sm_acceleration)) {
+    args->acceleration = sm_vec_array_operand(sm_acceleration, sm_self, length, tile, func_name);
+  } else {
+    MEMZERO(tile, s_float_t, S_FLOAT_TILE_LENGTH);
+    args->acceleration = NULL;
   }
-  return sm_wrapped;
+  args->acceleration_tiled = (args->acceleration == NULL);
+  if (args->acceleration_tiled) {
+    args->acceleration = tile;
+  }
+
+  args->components = sm_vec_array_components(sm_self, 1);
+  Data_Get_Struct(sm_self, s_float_t, args->position);
+  Data_Get_Struct(sm_velocities, s_float_t, args->velocity);
 }
 
 
 
-static vec3_t *sm_unwrap_vec3(VALUE sm_value, vec3_t store)
+/*
+ * Steps this array of positions and the given velocities forward by delta
+ * seconds in place using semi-implicit Euler integration:
+ *
+ *    velocity = (velocity + acceleration * delta) / (1 + damping * delta)
+ *    position = position + velocity * delta
+ *
+ * Acceleration may be nil, a vector or Numeric applied to every element (such
+ * as gravity), or an array of the same type holding per-element accelerations.
+ *
+ * If threads is greater than 1, large arrays are split across that many
+ * threads. Zero uses one thread per processor.
+ *
+ * call-seq:
+ *    integrate_euler!(velocities, delta, acceleration = nil, damping = 0, threads = 1) -> self
+ */
+static VALUE sm_vec_array_integrate_euler(int argc, VALUE *argv, VALUE sm_self)
 {
-  vec3_t *value;
-  Data_Get_Struct(sm_value, vec3_t, value);
-  if(store) vec3_copy(*value, store);
-  return value;
+  VALUE sm_velocities;
+  VALUE sm_delta;
+  VALUE sm_acceleration;
+  VALUE sm_damping;
+  VALUE sm_threads;
+  s_float_t tile[S_FLOAT_TILE_LENGTH];
+  sm_integrate_args_t args;
+
+  rb_scan_args(argc, argv, "23", &sm_velocities, &sm_delta, &sm_acceleration, &sm_damping, &sm_threads);
+  sm_integrate_args_init(&args, sm_self, sm_velocities, sm_acceleration, tile, "integrate_euler!");
+  args.delta = (s_float_t)NUM2DBL(sm_delta);
+  args.kick = args.delta;
+  args.damping = RTEST(sm_damping) ? (s_float_t)NUM2DBL(sm_damping) : s_float_lit(0.0);
+
+  s_parallel_for(SM_ARRAY_LENGTH(sm_self), SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_integrate_euler_range, &args);
+
+  return sm_self;
 }
 
 
 
 /*
- * Gets the component of the Vec3 at the given index.
+ * Steps this array of positions and the given velocities forward by delta
+ * seconds in place using velocity Verlet integration:
  *
- * call-seq: fetch(index) -> float
+ *    position = position + velocity * delta + acceleration * delta^2 / 2
+ *    velocity = (velocity + acceleration * kick) / (1 + damping * delta)
+ *
+ * If acceleration is a vector or Numeric, it is constant over the step, so kick
+ * is delta and the step is complete. If acceleration is an array of the same
+ * type, kick is delta / 2. In that case, finish the step after evaluating the
+ * accelerations at the new positions with
+ * <code>velocities.axpy!(delta / 2, new_accelerations)</code>.
+ *
+ * Threads is as for #integrate_euler!.
+ *
+ * call-seq:
+ *    integrate_verlet!(velocities, delta, acceleration, damping = 0, threads = 1) -> self
  */
-static VALUE sm_vec3_fetch (VALUE sm_self, VALUE sm_index)
+static VALUE sm_vec_array_integrate_verlet(int argc, VALUE *argv, VALUE sm_self)
 {
-  static const int max_index = sizeof(vec3_t) / sizeof(s_float_t);
-  const vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  if (index < 0 || index >= max_index) {
-    rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
-  }
-  return DBL2NUM(self[0][NUM2INT(sm_index)]);
+  VALUE sm_velocities;
+  VALUE sm_delta;
+  VALUE sm_acceleration;
+  VALUE sm_damping;
+  VALUE sm_threads;
+  s_float_t tile[S_FLOAT_TILE_LENGTH];
+  sm_integrate_args_t args;
+
+  rb_scan_args(argc, argv, "32", &sm_velocities, &sm_delta, &sm_acceleration, &sm_damping, &sm_threads);
+  sm_integrate_args_init(&args, sm_self, sm_velocities, sm_acceleration, tile, "integrate_verlet!");
+  args.delta = (s_float_t)NUM2DBL(sm_delta);
+  args.kick = args.acceleration_tiled ? args.delta : args.delta * s_float_lit(0.5);
+  args.damping = RTEST(sm_damping) ? (s_float_t)NUM2DBL(sm_damping) : s_float_lit(0.0);
+
+  s_parallel_for(SM_ARRAY_LENGTH(sm_self), SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_integrate_verlet_range, &args);
+
+  return sm_self;
 }
 
 
 
 /*
- * Sets the Vec3's component at the index to the value.
+ * Steps this array of orientations forward by delta seconds in place using the
+ * world-space angular velocities (in radians per second) at the same indices
+ * in angular_velocities, then renormalizes them. Angular velocities are first
+ * damped in place by 1 / (1 + damping * delta).
  *
- * call-seq: store(index, value) -> value
+ * Threads is as for Vec3Array#integrate_euler!.
+ *
+ * call-seq:
+ *    integrate!(angular_velocities, delta, damping = 0, threads = 1) -> self
  */
-static VALUE sm_vec3_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_quat_array_integrate(int argc, VALUE *argv, VALUE sm_self)
 {
-  static const int max_index = sizeof(vec3_t) / sizeof(s_float_t);
-  vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  rb_check_frozen(sm_self);
-  if (index < 0 || index >= max_index) {
-    rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  VALUE sm_angular_velocities;
+  VALUE sm_delta;
+  VALUE sm_damping;
+  VALUE sm_threads;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  sm_integrate_args_t args;
+
+  rb_scan_args(argc, argv, "22", &sm_angular_velocities, &sm_delta, &sm_damping, &sm_threads);
+  sm_check_writable(sm_self);
+  sm_array_input(sm_angular_velocities, s_sm_vec3_array_klass, length, "integrate!");
+  sm_check_writable(sm_angular_velocities);
+
+  MEMZERO(&args, sm_integrate_args_t, 1);
+  Data_Get_Struct(sm_self, s_float_t, args.position);
+  Data_Get_Struct(sm_angular_velocities, s_float_t, args.velocity);
+  args.delta = (s_float_t)NUM2DBL(sm_delta);
+  args.damping = RTEST(sm_damping) ? (s_float_t)NUM2DBL(sm_damping) : s_float_lit(0.0);
+
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_integrate_quat_range, &args);
+
+  return sm_self;
+}
+
+
+
+/*
+  Arguments for sm_random_range, which fills a range of elements of out. Each
+  block of SM_PARALLEL_GRAIN elements is filled from its own stream, numbered by
+  the block's position in the array, so the results depend only on the seed and
+  never on the number of threads used.
+*/
+typedef enum sm_random_kind_e {
+  SM_RANDOM_UNIFORM,
+  SM_RANDOM_GAUSSIAN,
+  SM_RANDOM_IN_SPHERE,
+  SM_RANDOM_ON_SPHERE,
+  SM_RANDOM_QUAT
+} sm_random_kind_t;
+
+typedef struct sm_random_args_s {
+  sm_random_kind_t kind;
+  uint64_t seed;
+  s_float_t *out;
+  size_t components;
+  s_float_t radius;
+  s_float_t low[S_FLOAT_TILE_LENGTH];
+  s_float_t high[S_FLOAT_TILE_LENGTH];
+} sm_random_args_t;
+
+static void sm_random_range(void *context, size_t begin, size_t end)
+{
+  const sm_random_args_t *args = (const sm_random_args_t *)context;
+  s_random_t random;
+  size_t block;
+
+  for (block = begin; block < end; block += SM_PARALLEL_GRAIN) {
+    const size_t count = (end - block < SM_PARALLEL_GRAIN) ? end - block : SM_PARALLEL_GRAIN;
+    s_float_t *out = args->out + block * args->components;
+    s_random_seed(&random, args->seed, block / SM_PARALLEL_GRAIN);
+
+    switch (args->kind) {
+    case SM_RANDOM_UNIFORM:
+      float_array_random_uniform(&random, args->low, args->high, out, count * args->components);
+      break;
+    case SM_RANDOM_GAUSSIAN:
+      float_array_random_gaussian(&random, args->low, args->high, out, count * args->components);
+      break;
+    case SM_RANDOM_IN_SPHERE:
+      if (args->components == 2) {
+        vec2_array_random_in_sphere(&random, args->radius, (vec2_t *)out, count);
+      } else {
+        vec3_array_random_in_sphere(&random, args->radius, (vec3_t *)out, count);
+      }
+      break;
+    case SM_RANDOM_ON_SPHERE:
+      if (args->components == 2) {
+        vec2_array_random_on_sphere(&random, args->radius, (vec2_t *)out, count);
+      } else {
+        vec3_array_random_on_sphere(&random, args->radius, (vec3_t *)out, count);
+      }
+      break;
+    case SM_RANDOM_QUAT:
+      quat_array_random(&random, (quat_t *)out, count);
+      break;
+    }
   }
-  self[0][index] = (s_float_t)NUM2DBL(sm_value);
-  return sm_value;
+}
+
+static VALUE sm_random_fill(VALUE sm_self, sm_random_args_t *args, VALUE sm_seed, VALUE sm_threads)
+{
+  sm_check_writable(sm_self);
+  args->seed = (uint64_t)NUM2ULL(sm_seed);
+  args->components = sm_vec_array_components(sm_self, 1);
+  Data_Get_Struct(sm_self, s_float_t, args->out);
+
+  s_parallel_for(SM_ARRAY_LENGTH(sm_self), SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_random_range, args);
+
+  return sm_self;
 }
 
 
 
 /*
- * Returns the length in bytes of the Vec3. When compiled to use doubles as the
- * base type, this is always 24. Otherwise, when compiled to use floats, it's
- * always 12.
+ * Fills this array with components uniformly distributed between low and high,
+ * which may be vectors or Numerics. For example, a Vec3Array can be filled with
+ * points in a box by passing the box's corners.
  *
- * call-seq: size -> fixnum
+ * The same seed always produces the same values, regardless of threads. If
+ * threads is greater than 1, large arrays are filled using that many threads.
+ * Zero uses one thread per processor.
+ *
+ * call-seq:
+ *    fill_uniform!(seed, low = 0, high = 1, threads = 1) -> self
  */
-static VALUE sm_vec3_size (VALUE self)
+static VALUE sm_vec_array_fill_uniform(int argc, VALUE *argv, VALUE sm_self)
 {
-  return SIZET2NUM(sizeof(vec3_t));
+  VALUE sm_seed;
+  VALUE sm_low;
+  VALUE sm_high;
+  VALUE sm_threads;
+  sm_random_args_t args;
+
+  rb_scan_args(argc, argv, "13", &sm_seed, &sm_low, &sm_high, &sm_threads);
+  args.kind = SM_RANDOM_UNIFORM;
+  sm_vec_array_tile(RTEST(sm_low) ? sm_low : INT2FIX(0), sm_self, args.low);
+  sm_vec_array_tile(RTEST(sm_high) ? sm_high : INT2FIX(1), sm_self, args.high);
+  return sm_random_fill(sm_self, &args, sm_seed, sm_threads);
 }
 
 
 
 /*
- * Returns the length of the Vec3 in components. Result is always 3.
+ * Fills this array with normally distributed components with the given mean
+ * and standard deviation, which may be vectors or Numerics. Seed and threads
+ * are as for #fill_uniform!.
  *
- * call-seq: length -> fixnum
+ * call-seq:
+ *    fill_gaussian!(seed, mean = 0, deviation = 1, threads = 1) -> self
  */
-static VALUE sm_vec3_length (VALUE self)
+static VALUE sm_vec_array_fill_gaussian(int argc, VALUE *argv, VALUE sm_self)
 {
-  return SIZET2NUM(sizeof(vec3_t) / sizeof(s_float_t));
+  VALUE sm_seed;
+  VALUE sm_mean;
+  VALUE sm_deviation;
+  VALUE sm_threads;
+  sm_random_args_t args;
+
+  rb_scan_args(argc, argv, "13", &sm_seed, &sm_mean, &sm_deviation, &sm_threads);
+  args.kind = SM_RANDOM_GAUSSIAN;
+  sm_vec_array_tile(RTEST(sm_mean) ? sm_mean : INT2FIX(0), sm_self, args.low);
+  sm_vec_array_tile(RTEST(sm_deviation) ? sm_deviation : INT2FIX(1), sm_self, args.high);
+  return sm_random_fill(sm_self, &args, sm_seed, sm_threads);
 }
 
 
 
 /*
- * Returns a copy of self.
+ * Fills this array with points uniformly distributed inside a sphere (a disc
+ * for Vec2Array) of the given radius centered on the origin. Seed and threads
+ * are as for #fill_uniform!.
  *
  * call-seq:
- *    copy(output = nil) -> output or new vec3
+ *    fill_in_sphere!(seed, radius = 1, threads = 1) -> self
  */
-static VALUE sm_vec3_copy(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec_array_fill_in_sphere(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out;
-  vec3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_copy (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_copy (*self, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
-  }
-  return sm_out;
+  VALUE sm_seed;
+  VALUE sm_radius;
+  VALUE sm_threads;
+  sm_random_args_t args;
+
+  rb_scan_args(argc, argv, "12", &sm_seed, &sm_radius, &sm_threads);
+  args.kind = SM_RANDOM_IN_SPHERE;
+  args.radius = RTEST(sm_radius) ? (s_float_t)NUM2DBL(sm_radius) : s_float_lit(1.0);
+  return sm_random_fill(sm_self, &args, sm_seed, sm_threads);
 }
 
 
 
 /*
- * Returns a vector whose components are the multiplicative inverse of this
- * vector's.
+ * Fills this array with points uniformly distributed on the surface of a sphere
+ * (a circle for Vec2Array) of the given radius centered on the origin. With the
+ * default radius, these are random unit directions. Seed and threads are as for
+ * #fill_uniform!.
  *
  * call-seq:
- *    normalize(output = nil) -> output or new vec3
+ *    fill_on_sphere!(seed, radius = 1, threads = 1) -> self
  */
-static VALUE sm_vec3_normalize(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec_array_fill_on_sphere(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out;
-  vec3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_normalize (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_normalize (*self, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to normalize");
-  }
-  return sm_out;
+  VALUE sm_seed;
+  VALUE sm_radius;
+  VALUE sm_threads;
+  sm_random_args_t args;
+
+  rb_scan_args(argc, argv, "12", &sm_seed, &sm_radius, &sm_threads);
+  args.kind = SM_RANDOM_ON_SPHERE;
+  args.radius = RTEST(sm_radius) ? (s_float_t)NUM2DBL(sm_radius) : s_float_lit(1.0);
+  return sm_random_fill(sm_self, &args, sm_seed, sm_threads);
 }
 
 
 
 /*
- * Returns a vector whose components are the multiplicative inverse of this
- * vector's.
+ * Fills this array with uniformly distributed random rotations. The same seed
+ * always produces the same rotations, regardless of threads. If threads is
+ * greater than 1, large arrays are filled using that many threads. Zero uses
+ * one thread per processor.
  *
  * call-seq:
- *    inverse(output = nil) -> output or new vec3
+ *    fill_random!(seed, threads = 1) -> self
  */
-static VALUE sm_vec3_inverse(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_quat_array_fill_random(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out;
-  vec3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_inverse (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_inverse (*self, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
+  VALUE sm_seed;
+  VALUE sm_threads;
+  sm_random_args_t args;
+
+  rb_scan_args(argc, argv, "11", &sm_seed, &sm_threads);
+  args.kind = SM_RANDOM_QUAT;
+  return sm_random_fill(sm_self, &args, sm_seed, sm_threads);
+}
+
+
+
+/*
+  Arguments for sm_noise_range. Noise is much more expensive per element than
+  the other batch operations, so it is split into smaller ranges.
+*/
+#define SM_NOISE_GRAIN 256
+
+typedef struct sm_noise_args_s {
+  const s_float_t *in;
+  size_t components;
+  int octaves;
+  s_float_t lacunarity;
+  s_float_t gain;
+  s_float_t *out;
+} sm_noise_args_t;
+
+static void sm_noise_range(void *context, size_t begin, size_t end)
+{
+  const sm_noise_args_t *args = (const sm_noise_args_t *)context;
+  switch (args->components) {
+  case 2:
+    vec2_array_fbm((const vec2_t *)args->in + begin, args->octaves, args->lacunarity, args->gain, args->out + begin, end - begin);
+    break;
+  case 3:
+    vec3_array_fbm((const vec3_t *)args->in + begin, args->octaves, args->lacunarity, args->gain, args->out + begin, end - begin);
+    break;
+  default:
+    vec4_array_fbm((const vec4_t *)args->in + begin, args->octaves, args->lacunarity, args->gain, args->out + begin, end - begin);
+    break;
   }
+}
+
+static VALUE sm_noise_fill(VALUE sm_self, sm_noise_args_t *args, VALUE sm_out, VALUE sm_threads, const char *func_name)
+{
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  s_float_t *self;
+
+  sm_out = sm_array_output(sm_out, s_sm_float_array_klass, length, func_name);
+  Data_Get_Struct(sm_self, s_float_t, self);
+  Data_Get_Struct(sm_out, s_float_t, args->out);
+  args->in = self;
+  args->components = sm_vec_array_components(sm_self, 1);
+
+  s_parallel_for(length, SM_NOISE_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_noise_range, args);
+
   return sm_out;
 }
 
 
 
 /*
- * Negates this vector's components and returns the result.
+ * Returns a FloatArray of simplex noise evaluated at each point in this array,
+ * using 2D noise for a Vec2Array, 3D for a Vec3Array, and 4D for a Vec4Array.
+ * Values are roughly in the range [-1, 1]. If an output array is provided, it
+ * must be a FloatArray holding at least as many elements as self.
+ *
+ * If threads is greater than 1, large arrays are split across that many
+ * threads. Zero uses one thread per processor.
  *
  * call-seq:
- *    negate(output = nil) -> output or new vec3
+ *    noise(output = nil, threads = 1) -> output or new float_array
  */
-static VALUE sm_vec3_negate(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec_array_noise(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_out;
-  vec3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_negate (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_negate (*self, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to negate");
-  }
-  return sm_out;
+  VALUE sm_threads;
+  sm_noise_args_t args;
+
+  rb_scan_args(argc, argv, "02", &sm_out, &sm_threads);
+  args.octaves = 1;
+  args.lacunarity = s_float_lit(2.0);
+  args.gain = s_float_lit(0.5);
+  return sm_noise_fill(sm_self, &args, sm_out, sm_threads, "noise");
 }
 
 
 
 /*
- * Projects this vector onto a normal vector and returns the result.
+ * Returns a FloatArray of fractal Brownian motion evaluated at each point in
+ * this array. Each octave of simplex noise is sampled at lacunarity times the
+ * frequency and gain times the amplitude of the octave before it, and the sum
+ * is divided by the total amplitude, so values stay roughly in [-1, 1].
+ *
+ * Output and threads are as for #noise.
  *
  * call-seq:
- *    project(normal, output = nil) -> output or new vec3
+ *    fbm(octaves, lacunarity = 2, gain = 0.5, output = nil, threads = 1) -> output or new float_array
  */
-static VALUE sm_vec3_project(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec_array_fbm(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
+  VALUE sm_octaves;
+  VALUE sm_lacunarity;
+  VALUE sm_gain;
   VALUE sm_out;
-  vec3_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_project(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_project(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to project");
+  VALUE sm_threads;
+  sm_noise_args_t args;
+
+  rb_scan_args(argc, argv, "14", &sm_octaves, &sm_lacunarity, &sm_gain, &sm_out, &sm_threads);
+  args.octaves = NUM2INT(sm_octaves);
+  if (args.octaves < 1) {
+    rb_raise(rb_eArgError, "fbm requires at least one octave, got %d", args.octaves);
   }
-  return sm_out;
+  args.lacunarity = RTEST(sm_lacunarity) ? (s_float_t)NUM2DBL(sm_lacunarity) : s_float_lit(2.0);
+  args.gain = RTEST(sm_gain) ? (s_float_t)NUM2DBL(sm_gain) : s_float_lit(0.5);
+  return sm_noise_fill(sm_self, &args, sm_out, sm_threads, "fbm");
 }
 
 
 
 /*
- * Reflects this vector against a normal vector and returns the result.
+ * Returns the covariance matrix of the points in this array, or of the points
+ * in range if one is given. This is the population covariance, so it is
+ * divided by the number of points, and is computed in a single pass.
+ *
+ * Its eigen-decomposition (see Mat3#eigen_symmetric) gives the principal axes
+ * of the points.
  *
  * call-seq:
- *    reflect(normal, output = nil) -> output or new vec3
+ *    covariance(range = nil, output = nil) -> output or new mat3
  */
-static VALUE sm_vec3_reflect(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_array_covariance(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
+  VALUE sm_range;
   VALUE sm_out;
-  vec3_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_reflect(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_reflect(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+  const vec3_t *self;
+  size_t begin;
+  size_t count;
+  vec3_t mean;
+  mat3_t covariance;
+
+  rb_scan_args(argc, argv, "02", &sm_range, &sm_out);
+  sm_array_range(sm_range, SM_ARRAY_LENGTH(sm_self), &begin, &count, "covariance");
+  Data_Get_Struct(sm_self, vec3_t, self);
+  vec3_array_covariance(self + begin, count, mean, covariance);
+
+  if (!RTEST(sm_out)) {
+    sm_out = sm_wrap_mat3(covariance, s_sm_mat3_klass);
     rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to reflect");
+  } else if (SM_IS_A(sm_out, mat3)) {
+    sm_check_writable(sm_out);
+    mat3_copy(covariance, *sm_unwrap_mat3(sm_out, NULL));
+  } else {
+    rb_raise(rb_eTypeError,
+      "Invalid argument to output of covariance: expected %s, got %s",
+      rb_class2name(s_sm_mat3_klass),
+      rb_obj_classname(sm_out));
   }
+
   return sm_out;
 }
 
 
 
 /*
- * Returns the cross product of this vector and another Vec3.
+  Arguments for sm_fit_obb_range. Ranges holds a (begin, count) pair of point
+  indices for each box.
+*/
+#define SM_OBB_GRAIN 16
+
+typedef struct sm_obb_args_s {
+  const vec3_t *points;
+  const size_t *ranges;
+  vec3_t *centers;
+  mat3_t *axes;
+  vec3_t *half_extents;
+} sm_obb_args_t;
+
+static void sm_fit_obb_range(void *context, size_t begin, size_t end)
+{
+  const sm_obb_args_t *args = (const sm_obb_args_t *)context;
+  size_t index;
+  for (index = begin; index < end; ++index) {
+    vec3_array_fit_obb(
+      args->points + args->ranges[index * 2],
+      args->ranges[index * 2 + 1],
+      args->centers[index],
+      args->axes[index],
+      args->half_extents[index]);
+  }
+}
+
+/*
+ * Fits an oriented bounding box to the points in each Range of ranges, using
+ * the principal axes of the points as the box's axes. Returns
+ * [centers, axes, half_extents], where centers and half_extents are Vec3Arrays
+ * and axes is a Mat3Array of rotations whose rows are the box axes, ordered
+ * from the direction of greatest spread to the least. Use
+ * axes.convert_to(QuatArray) for quaternions. An empty range yields an empty
+ * box at the origin.
+ *
+ * Any of the outputs may be provided, in which case they must hold at least
+ * as many elements as there are ranges and must not be self.
+ *
+ * If threads is greater than 1, the boxes are split across that many threads.
+ * Zero uses one thread per processor.
  *
  * call-seq:
- *    cross_product(vec3, output = nil) -> output or new vec3
+ *    fit_obbs(ranges, centers = nil, axes = nil, half_extents = nil, threads = 1) -> [centers, axes, half_extents]
  */
-static VALUE sm_vec3_cross_product(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_array_fit_obbs(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
-  vec3_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
+  VALUE sm_ranges;
+  VALUE sm_centers;
+  VALUE sm_axes;
+  VALUE sm_half_extents;
+  VALUE sm_threads;
+  VALUE sm_buffer;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  size_t range_count;
+  size_t index;
+  size_t *ranges;
+  sm_obb_args_t args;
+
+  rb_scan_args(argc, argv, "14", &sm_ranges, &sm_centers, &sm_axes, &sm_half_extents, &sm_threads);
+  Check_Type(sm_ranges, T_ARRAY);
+  if (sm_centers == sm_self || sm_half_extents == sm_self) {
+    rb_raise(rb_eArgError, "Outputs of fit_obbs must not be the array of points");
   }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_cross_product(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_cross_product(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to cross_product");
+
+  range_count = (size_t)RARRAY_LEN(sm_ranges);
+  ranges = ALLOCV_N(size_t, sm_buffer, range_count * 2);
+  for (index = 0; index < range_count; ++index) {
+    sm_array_range(rb_ary_entry(sm_ranges, (long)index), length,
+      &ranges[index * 2], &ranges[index * 2 + 1], "fit_obbs");
   }
-  return sm_out;
+
+  sm_centers = sm_array_output(sm_centers, s_sm_vec3_array_klass, range_count, "fit_obbs");
+  sm_axes = sm_array_output(sm_axes, s_sm_mat3_array_klass, range_count, "fit_obbs");
+  sm_half_extents = sm_array_output(sm_half_extents, s_sm_vec3_array_klass, range_count, "fit_obbs");
+
+  Data_Get_Struct(sm_self, vec3_t, args.points);
+  Data_Get_Struct(sm_centers, vec3_t, args.centers);
+  Data_Get_Struct(sm_axes, mat3_t, args.axes);
+  Data_Get_Struct(sm_half_extents, vec3_t, args.half_extents);
+  args.ranges = ranges;
+
+  s_parallel_for(range_count, SM_OBB_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_fit_obb_range, &args);
+
+  ALLOCV_END(sm_buffer);
+  return rb_ary_new3(3, sm_centers, sm_axes, sm_half_extents);
 }
 
 
 
 /*
- * Multiplies this and another vector's components together and returns the
- * result.
- *
- * call-seq:
- *    multiply_vec3(vec3, output = nil) -> output or new vec3
- */
-static VALUE sm_vec3_multiply(int argc, VALUE *argv, VALUE sm_self)
-{
-  VALUE sm_rhs;
-  VALUE sm_out;
-  vec3_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
+  Arguments for sm_sphere_range. Minimal spheres need scratch space for each
+  group, so scratch holds a run of entries for every group, starting at the
+  group's entry in scratch_offsets. Both are allocated by the calling thread.
+*/
+typedef struct sm_sphere_args_s {
+  const vec3_t *points;
+  const sm_point_group_t *groups;
+  const size_t *indices;
+  size_t *scratch;
+  const size_t *scratch_offsets;
+  vec4_t *out;
+  int minimal;
+} sm_sphere_args_t;
+
+static void sm_sphere_range(void *context, size_t begin, size_t end)
+{
+  const sm_sphere_args_t *args = (const sm_sphere_args_t *)context;
+  size_t index;
+
+  for (index = begin; index < end; ++index) {
+    const sm_point_group_t *group = args->groups + index;
+    const vec3_t *points = group->indexed ? args->points : args->points + group->begin;
+    const size_t *indices = group->indexed ? args->indices + group->begin : NULL;
+    if (args->minimal) {
+      vec3_array_min_sphere(points, indices, group->count, args->scratch + args->scratch_offsets[index], args->out[index]);
+    } else {
+      vec3_array_ritter_sphere(points, indices, group->count, args->out[index]);
     }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_multiply(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_multiply(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+  }
+}
+
+static void sm_vec3_array_spheres(VALUE sm_self, VALUE sm_groups, int minimal, vec4_t *out, VALUE sm_threads, const char *func_name)
+{
+  VALUE sm_group_buffer;
+  VALUE sm_index_buffer;
+  VALUE sm_offset_buffer = 0;
+  VALUE sm_scratch_buffer = 0;
+  sm_sphere_args_t args;
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  const size_t group_count = (size_t)RARRAY_LEN(sm_groups);
+  sm_point_group_t *groups = ALLOCV_N(sm_point_group_t, sm_group_buffer, group_count);
+  size_t *indices = ALLOCV_N(size_t, sm_index_buffer, sm_point_groups(sm_groups, group_count, length, groups, func_name));
+  size_t *offsets = NULL;
+  size_t scratch_length = 0;
+  size_t index;
+
+  sm_point_group_indices(sm_groups, group_count, length, groups, indices, func_name);
+  if (minimal) {
+    offsets = ALLOCV_N(size_t, sm_offset_buffer, group_count);
+    for (index = 0; index < group_count; ++index) {
+      offsets[index] = scratch_length;
+      scratch_length += groups[index].count;
+      if (scratch_length < groups[index].count) {
+        rb_raise(rb_eArgError, "Groups passed to %s hold too many points", func_name);
+      }
+    }
+    args.scratch = ALLOCV_N(size_t, sm_scratch_buffer, scratch_length);
+  } else {
+    args.scratch = NULL;
+  }
+  args.scratch_offsets = offsets;
+  args.indices = indices;
+  args.groups = groups;
+  args.out = out;
+  args.minimal = minimal;
+  Data_Get_Struct(sm_self, vec3_t, args.points);
+
+  s_parallel_for(group_count, 1,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_sphere_range, &args);
+
+  if (minimal) {
+    ALLOCV_END(sm_scratch_buffer);
+    ALLOCV_END(sm_offset_buffer);
+  }
+  ALLOCV_END(sm_index_buffer);
+  ALLOCV_END(sm_group_buffer);
+}
+
+static VALUE sm_vec3_array_sphere(int argc, VALUE *argv, VALUE sm_self, int minimal, const char *func_name)
+{
+  VALUE sm_group;
+  VALUE sm_out;
+  vec4_t sphere;
+
+  rb_scan_args(argc, argv, "02", &sm_group, &sm_out);
+  sm_vec3_array_spheres(sm_self, rb_ary_new3(1, sm_group), minimal, &sphere, Qnil, func_name);
+
+  if (!RTEST(sm_out)) {
+    sm_out = sm_wrap_vec4(sphere, s_sm_vec4_klass);
     rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_vec3");
+  } else if (SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
+    sm_check_writable(sm_out);
+    vec4_copy(sphere, *sm_unwrap_vec4(sm_out, NULL));
+  } else {
+    rb_raise(rb_eTypeError, kSM_WANT_FOUR_FORMAT_LIT, rb_obj_classname(sm_out));
   }
+
+  return sm_out;
+}
+
+static VALUE sm_vec3_array_sphere_batch(int argc, VALUE *argv, VALUE sm_self, int minimal, const char *func_name)
+{
+  VALUE sm_groups;
+  VALUE sm_out;
+  VALUE sm_threads;
+  vec4_t *out;
+
+  rb_scan_args(argc, argv, "12", &sm_groups, &sm_out, &sm_threads);
+  Check_Type(sm_groups, T_ARRAY);
+  sm_out = sm_array_output(sm_out, s_sm_vec4_array_klass, (size_t)RARRAY_LEN(sm_groups), func_name);
+  Data_Get_Struct(sm_out, vec4_t, out);
+  sm_vec3_array_spheres(sm_self, sm_groups, minimal, out, sm_threads, func_name);
   return sm_out;
 }
 
 
 
 /*
- * Adds this and another vector's components together and returns the result.
+ * Returns a bounding sphere of the points in this array as a Vec4 of its
+ * center and radius (x, y, z, radius), using Ritter's method. This takes two
+ * passes over the points and is fast, but the sphere is usually somewhat
+ * larger than necessary. See #bounding_sphere for the smallest sphere.
+ *
+ * Group selects the points to bound: nil for all of them, a Range of
+ * elements, or an Array of element indices. An empty group gives a zero
+ * sphere.
  *
  * call-seq:
- *    add(vec3, output = nil) -> output or new vec3
+ *    ritter_sphere(group = nil, output = nil) -> output or new vec4
  */
-static VALUE sm_vec3_add(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_array_ritter_sphere(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
-  vec3_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_add(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_add(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to add");
-  }
-  return sm_out;
+  return sm_vec3_array_sphere(argc, argv, sm_self, 0, "ritter_sphere");
 }
 
 
 
 /*
- * Subtracts another vector's components from this vector's and returns the
- * result.
+ * Returns the smallest sphere enclosing the points in this array as a Vec4 of
+ * its center and radius (x, y, z, radius), using Welzl's algorithm. Group is
+ * as for #ritter_sphere.
  *
  * call-seq:
- *    subtract(vec3, output = nil) -> output or new vec3
+ *    bounding_sphere(group = nil, output = nil) -> output or new vec4
  */
-static VALUE sm_vec3_subtract(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_array_bounding_sphere(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
-  vec3_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec3(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    vec3_subtract(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    vec3_subtract(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to subtract");
-  }
-  return sm_out;
+  return sm_vec3_array_sphere(argc, argv, sm_self, 1, "bounding_sphere");
 }
 
 
 
 /*
- * Returns the dot product of this and another Vec3 or the XYZ components of a
- * Vec4 or Quat.
+ * Returns a Vec4Array of Ritter bounding spheres, one for each group in
+ * groups, where each group is as for #ritter_sphere. If an output array is
+ * provided, it must hold at least as many elements as there are groups.
+ *
+ * If threads is greater than 1, the groups are split across that many
+ * threads. Zero uses one thread per processor.
  *
  * call-seq:
- *    dot_product(vec3) -> float
- *    dot_product(vec4) -> float
- *    dot_product(quat) -> float
+ *    ritter_spheres(groups, output = nil, threads = 1) -> output or new vec4_array
  */
-static VALUE sm_vec3_dot_product(VALUE sm_self, VALUE sm_other)
+static VALUE sm_vec3_array_ritter_spheres(int argc, VALUE *argv, VALUE sm_self)
 {
-  if (!SM_IS_A(sm_other, vec3) &&
-      !SM_IS_A(sm_other, vec4) &&
-      !SM_IS_A(sm_other, quat)) {
-    rb_raise(rb_eArgError,
-      "Expected a Quat, Vec3, or Vec4, got %s",
-      rb_obj_classname(sm_other));
-    return Qnil;
-  }
-  return DBL2NUM(
-    vec3_dot_product(
-      *sm_unwrap_vec3(sm_self, NULL),
-      *sm_unwrap_vec3(sm_other, NULL)));
+  return sm_vec3_array_sphere_batch(argc, argv, sm_self, 0, "ritter_spheres");
 }
 
 
 
 /*
- * Allocates a Vec3.
+ * Returns a Vec4Array of the smallest enclosing spheres of each group in
+ * groups. Groups, output, and threads are as for #ritter_spheres.
  *
  * call-seq:
- *    new()          -> vec3 with components [0, 0, 0]
- *    new(x, y, z)   -> vec3 with components [x, y, z]
- *    new([x, y, z]) -> vec3 with components [x, y, z]
- *    new(vec3)      -> copy of vec3
- *    new(vec4)      -> vec3 of vec4's x, y, and z components
- *    new(quat)      -> vec3 of quat's x, y, and z components
+ *    bounding_spheres(groups, output = nil, threads = 1) -> output or new vec4_array
  */
-static VALUE sm_vec3_new(int argc, VALUE *argv, VALUE self)
+static VALUE sm_vec3_array_bounding_spheres(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_vec = sm_wrap_vec3(g_vec3_zero, self);
-  rb_obj_call_init(sm_vec, argc, argv);
-  return sm_vec;
+  return sm_vec3_array_sphere_batch(argc, argv, sm_self, 1, "bounding_spheres");
 }
 
 
 
 /*
- * Sets the Vec3's components.
+  Arguments for sm_transform_aabb_range. If indices is non-null, the range is
+  over the dirty indices; otherwise it is over boxes starting at begin.
+*/
+typedef struct sm_aabb_args_s {
+  const mat4_t *transforms;
+  const vec3_t *mins;
+  const vec3_t *maxs;
+  const size_t *indices;
+  size_t begin;
+  vec3_t *out_mins;
+  vec3_t *out_maxs;
+} sm_aabb_args_t;
+
+static void sm_transform_aabb_range(void *context, size_t begin, size_t end)
+{
+  const sm_aabb_args_t *args = (const sm_aabb_args_t *)context;
+  if (args->indices) {
+    mat4_array_transform_aabb(args->transforms, args->mins, args->maxs,
+      args->indices + begin, end - begin, args->out_mins, args->out_maxs);
+  } else {
+    const size_t first = args->begin + begin;
+    mat4_array_transform_aabb(args->transforms + first, args->mins + first, args->maxs + first,
+      NULL, end - begin, args->out_mins + first, args->out_maxs + first);
+  }
+}
+
+
+
+/*
+ * Transforms local-space axis-aligned boxes by the matrices in this array and
+ * returns [world_mins, world_maxs], two Vec3Arrays holding the corners of the
+ * world-space boxes. Box i is given by mins[i] and maxs[i] and is transformed
+ * by self[i]. Each world box is the tightest axis-aligned box around the
+ * transformed box, found from its center and the absolute values of the
+ * matrix's upper 3x3.
+ *
+ * Dirty limits the boxes updated: nil for all of them, a Range of boxes, or an
+ * Array of box indices. Boxes outside the dirty set are left as-is in the
+ * outputs, so pass the previous outputs back in to keep them current. Outputs
+ * may be mins and maxs, provided no dirty index is repeated.
+ *
+ * If threads is greater than 1, the boxes are split across that many threads.
+ * Zero uses one thread per processor.
  *
  * call-seq:
- *    set(x, y, z)   -> vec3 with components [x, y, z]
- *    set([x, y, z]) -> vec3 with components [x, y, z]
- *    set(vec2)      -> vec3 with components [vec2.xy, 0]
- *    set(vec3)      -> copy of vec3
- *    set(vec4)      -> vec3 with components [vec4.xyz]
- *    set(quat)      -> vec3 with components [quat.xyz]
+ *    transform_aabbs(mins, maxs, dirty = nil, world_mins = nil, world_maxs = nil, threads = 1) -> [world_mins, world_maxs]
  */
-static VALUE sm_vec3_init(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat4_array_transform_aabbs(int argc, VALUE *argv, VALUE sm_self)
 {
-  vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
-  size_t arr_index = 0;
+  VALUE sm_mins;
+  VALUE sm_maxs;
+  VALUE sm_dirty;
+  VALUE sm_out_mins;
+  VALUE sm_out_maxs;
+  VALUE sm_threads;
+  VALUE sm_buffer;
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  const VALUE sm_groups = rb_ary_new3(1, Qnil);
+  sm_point_group_t dirty;
+  sm_aabb_args_t args;
+  size_t *indices;
 
-  rb_check_frozen(sm_self);
+  rb_scan_args(argc, argv, "24", &sm_mins, &sm_maxs, &sm_dirty, &sm_out_mins, &sm_out_maxs, &sm_threads);
+  sm_array_input(sm_mins, s_sm_vec3_array_klass, length, "transform_aabbs");
+  sm_array_input(sm_maxs, s_sm_vec3_array_klass, length, "transform_aabbs");
+  sm_out_mins = sm_array_output(sm_out_mins, s_sm_vec3_array_klass, length, "transform_aabbs");
+  sm_out_maxs = sm_array_output(sm_out_maxs, s_sm_vec3_array_klass, length, "transform_aabbs");
+  if (sm_out_mins == sm_out_maxs) {
+    rb_raise(rb_eArgError, "Invalid argument to transform_aabbs: world_mins and world_maxs must differ");
+  }
 
-  switch(argc) {
+  rb_ary_store(sm_groups, 0, sm_dirty);
+  indices = ALLOCV_N(size_t, sm_buffer, sm_point_groups(sm_groups, 1, length, &dirty, "transform_aabbs"));
+  sm_point_group_indices(sm_groups, 1, length, &dirty, indices, "transform_aabbs");
 
-  /* Default value */
-  case 0: { break; }
+  Data_Get_Struct(sm_self, mat4_t, args.transforms);
+  Data_Get_Struct(sm_mins, vec3_t, args.mins);
+  Data_Get_Struct(sm_maxs, vec3_t, args.maxs);
+  Data_Get_Struct(sm_out_mins, vec3_t, args.out_mins);
+  Data_Get_Struct(sm_out_maxs, vec3_t, args.out_maxs);
+  args.indices = dirty.indexed ? indices : NULL;
+  args.begin = dirty.indexed ? 0 : dirty.begin;
 
-  /* Copy or by-array */
-  case 1: {
-    if (SM_IS_A(argv[0], vec3) ||
-        SM_IS_A(argv[0], vec4) ||
-        SM_IS_A(argv[0], quat)) {
-      sm_unwrap_vec3(argv[0], *self);
-      break;
-    }
+  s_parallel_for(dirty.count, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_transform_aabb_range, &args);
 
-    if (SM_IS_A(argv[0], vec2)) {
-      sm_unwrap_vec2(argv[0], *self);
-      self[0][2] = s_float_lit(0.0);
-      break;
-    }
+  ALLOCV_END(sm_buffer);
+  return rb_ary_new3(2, sm_out_mins, sm_out_maxs);
+}
 
-    /* Optional offset into array provided */
-    if (0) {
-      case 2:
-      arr_index = NUM2SIZET(argv[1]);
-    }
 
-    /* Array of values */
-    if (SM_RB_IS_A(argv[0], rb_cArray)) {
-      VALUE arrdata = argv[0];
-      const size_t arr_end = arr_index + 3;
-      s_float_t *vec_elem = *self;
-      for (; arr_index < arr_end; ++arr_index, ++vec_elem) {
-        *vec_elem = (s_float_t)NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
-      }
-      break;
-    }
 
-    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Vec3");
+typedef enum sm_closest_kind_e {
+  SM_CLOSEST_SEGMENT,
+  SM_CLOSEST_TRIANGLE,
+  SM_CLOSEST_AABB
+} sm_closest_kind_t;
+
+/*
+  Arguments for sm_closest_range. Each primitive corner is either an array
+  with a step of 1 or a single vector, held in broadcast, with a step of 0.
+*/
+typedef struct sm_closest_args_s {
+  sm_closest_kind_t kind;
+  const vec3_t *points;
+  const vec3_t *corners[3];
+  size_t steps[3];
+  vec3_t broadcast[3];
+  vec3_t *out;
+  s_float_t *distances;
+  s_float_t *features;
+} sm_closest_args_t;
+
+static void sm_closest_range(void *context, size_t begin, size_t end)
+{
+  const sm_closest_args_t *args = (const sm_closest_args_t *)context;
+  const vec3_t *a = args->corners[0] + begin * args->steps[0];
+  const vec3_t *b = args->corners[1] + begin * args->steps[1];
+  const vec3_t *c = args->corners[2] + begin * args->steps[2];
+
+  switch (args->kind) {
+  case SM_CLOSEST_SEGMENT:
+    vec3_array_closest_on_segment(args->points + begin, a, args->steps[0], b, args->steps[1],
+      end - begin, args->out + begin, args->distances + begin, args->features + begin);
+    break;
+  case SM_CLOSEST_TRIANGLE:
+    vec3_array_closest_on_triangle(args->points + begin, a, args->steps[0], b, args->steps[1],
+      c, args->steps[2], end - begin, args->out + begin, args->distances + begin, args->features + begin);
+    break;
+  default:
+    vec3_array_closest_on_aabb(args->points + begin, a, args->steps[0], b, args->steps[1],
+      end - begin, args->out + begin, args->distances + begin, args->features + begin);
     break;
   }
+}
 
-  /* X, Y, Z */
-  case 3: {
-    self[0][0] = (s_float_t)NUM2DBL(argv[0]);
-    self[0][1] = (s_float_t)NUM2DBL(argv[1]);
-    self[0][2] = (s_float_t)NUM2DBL(argv[2]);
-    break;
+static VALUE sm_vec3_array_closest(int argc, VALUE *argv, VALUE sm_self, sm_closest_kind_t kind, const char *func_name)
+{
+  const int corner_count = (kind == SM_CLOSEST_TRIANGLE) ? 3 : 2;
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  VALUE sm_corners[3] = { Qnil, Qnil, Qnil };
+  VALUE sm_out;
+  VALUE sm_distances;
+  VALUE sm_features;
+  VALUE sm_threads;
+  sm_closest_args_t args;
+  int corner;
+
+  if (corner_count == 3) {
+    rb_scan_args(argc, argv, "34", &sm_corners[0], &sm_corners[1], &sm_corners[2],
+      &sm_out, &sm_distances, &sm_features, &sm_threads);
+  } else {
+    rb_scan_args(argc, argv, "24", &sm_corners[0], &sm_corners[1],
+      &sm_out, &sm_distances, &sm_features, &sm_threads);
+  }
+
+  args.kind = kind;
+  for (corner = 0; corner < 3; ++corner) {
+    if (corner >= corner_count) {
+      args.corners[corner] = args.corners[0];
+      args.steps[corner] = 0;
+    } else if (SM_RB_IS_A(sm_corners[corner], s_sm_vec3_array_klass)) {
+      sm_array_input(sm_corners[corner], s_sm_vec3_array_klass, length, func_name);
+      Data_Get_Struct(sm_corners[corner], vec3_t, args.corners[corner]);
+      args.steps[corner] = 1;
+    } else {
+      vec3_copy(*sm_vec3_operand(sm_corners[corner], args.broadcast[corner]), args.broadcast[corner]);
+      args.corners[corner] = &args.broadcast[corner];
+      args.steps[corner] = 0;
+    }
   }
 
-  default: {
-    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
-    break;
+  sm_out = sm_array_output(sm_out, s_sm_vec3_array_klass, length, func_name);
+  sm_distances = sm_array_output(sm_distances, s_sm_float_array_klass, length, func_name);
+  sm_features = sm_array_output(sm_features, s_sm_float_array_klass, length, func_name);
+  if (sm_distances == sm_features) {
+    rb_raise(rb_eArgError, "Invalid argument to %s: distances and features must differ", func_name);
   }
-  } /* switch (argc) */
 
-  return sm_self;
+  Data_Get_Struct(sm_self, vec3_t, args.points);
+  Data_Get_Struct(sm_out, vec3_t, args.out);
+  Data_Get_Struct(sm_distances, s_float_t, args.distances);
+  Data_Get_Struct(sm_features, s_float_t, args.features);
+
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_closest_range, &args);
+
+  return rb_ary_new3(3, sm_out, sm_distances, sm_features);
 }
 
 
 
 /*
- * Returns a string representation of self.
+ * Finds the closest point to each point in this array on a segment from a to
+ * b. Returns [points, distances, features]: a Vec3Array of the closest points,
+ * a FloatArray of the distances to them, and a FloatArray of the features they
+ * lie on, where 0 is a, 1 is b, and 2 is between them.
  *
- *    Vec3[].to_s     # => "{ 0.0, 0.0, 0.0 }"
+ * A and b may each be a Vec3Array, giving a segment per point, or a single
+ * vector shared by every point. Points may be self.
+ *
+ * If threads is greater than 1, the points are split across that many threads.
+ * Zero uses one thread per processor.
  *
  * call-seq:
- *    to_s -> string
+ *    closest_on_segments(a, b, points = nil, distances = nil, features = nil, threads = 1) -> [points, distances, features]
  */
-static VALUE sm_vec3_to_s(VALUE self)
+static VALUE sm_vec3_array_closest_on_segments(int argc, VALUE *argv, VALUE sm_self)
 {
-  const s_float_t *v;
-  v = (const s_float_t *)*sm_unwrap_vec3(self, NULL);
-  return rb_sprintf(
-    "{ "
-    "%f, %f, %f"
-    " }",
-    v[0], v[1], v[2]);
+  return sm_vec3_array_closest(argc, argv, sm_self, SM_CLOSEST_SEGMENT, "closest_on_segments");
 }
 
 
 
 /*
- * Returns the squared magnitude of self.
+ * Finds the closest point to each point in this array on a triangle with
+ * corners a, b, and c. Returns [points, distances, features] as for
+ * #closest_on_segments, where features 0 to 2 are the corners a, b, and c, 3 to
+ * 5 are the edges ab, bc, and ca, and 6 is the triangle's face. Degenerate
+ * triangles are treated as their nearest edge.
+ *
+ * Corners, outputs, and threads are as for #closest_on_segments.
  *
  * call-seq:
- *    magnitude_squared -> float
+ *    closest_on_triangles(a, b, c, points = nil, distances = nil, features = nil, threads = 1) -> [points, distances, features]
  */
-static VALUE sm_vec3_magnitude_squared(VALUE sm_self)
+static VALUE sm_vec3_array_closest_on_triangles(int argc, VALUE *argv, VALUE sm_self)
 {
-  return DBL2NUM(vec3_length_squared(*sm_unwrap_vec3(sm_self, NULL)));
+  return sm_vec3_array_closest(argc, argv, sm_self, SM_CLOSEST_TRIANGLE, "closest_on_triangles");
 }
 
 
 
 /*
- * Returns the magnitude of self.
+ * Finds the closest point to each point in this array on or in an axis-aligned
+ * box with corners mins and maxs. Returns [points, distances, features] as for
+ * #closest_on_segments, where each feature is a mask of the axes the point was
+ * clamped along (1 for X, 2 for Y, 4 for Z). A feature of 0 means the point is
+ * inside the box, 1, 2, or 4 that it is closest to a face, and other values
+ * that it is closest to an edge or corner.
+ *
+ * Corners, outputs, and threads are as for #closest_on_segments.
  *
  * call-seq:
- *    magnitude -> float
+ *    closest_on_aabbs(mins, maxs, points = nil, distances = nil, features = nil, threads = 1) -> [points, distances, features]
  */
-static VALUE sm_vec3_magnitude(VALUE sm_self)
+static VALUE sm_vec3_array_closest_on_aabbs(int argc, VALUE *argv, VALUE sm_self)
 {
-  return DBL2NUM(vec3_length(*sm_unwrap_vec3(sm_self, NULL)));
+  return sm_vec3_array_closest(argc, argv, sm_self, SM_CLOSEST_AABB, "closest_on_aabbs");
 }
 
 
 
+#define SM_PAIRS_GRAIN 64
+
+typedef enum sm_pairs_kind_e {
+  SM_PAIRS_DISTANCE,
+  SM_PAIRS_NEAREST,
+  SM_PAIRS_WITHIN
+} sm_pairs_kind_t;
+
 /*
- * Scales this vector's components by a scalar value and returns the result.
+  Arguments for sm_pairs_range. Radius queries run the range twice: first with
+  null firsts to count pairs, then again to write them.
+*/
+typedef struct sm_pairs_args_s {
+  sm_pairs_kind_t kind;
+  const vec3_t *queries;
+  const vec3_t *targets;
+  size_t target_count;
+  size_t k;
+  s_float_t radius;
+  int self;
+  size_t *counts;
+  s_float_t *firsts;
+  s_float_t *seconds;
+  s_float_t *indices;
+  s_float_t *distances;
+} sm_pairs_args_t;
+
+static void sm_pairs_range(void *context, size_t begin, size_t end)
+{
+  const sm_pairs_args_t *args = (const sm_pairs_args_t *)context;
+  switch (args->kind) {
+  case SM_PAIRS_DISTANCE:
+    vec3_array_pairwise_distance(args->queries, begin, end, args->targets, args->target_count, args->distances);
+    break;
+  case SM_PAIRS_NEAREST:
+    vec3_array_k_nearest(args->queries, begin, end, args->targets, args->target_count,
+      args->k, args->self, args->indices, args->distances);
+    break;
+  default:
+    vec3_array_pairs_within(args->queries, begin, end, args->targets, args->target_count,
+      args->radius, args->self, args->counts, args->firsts, args->seconds, args->distances);
+    break;
+  }
+}
+
+/*
+  Fills in the queries and targets of args from sm_self and sm_other, which is
+  self if nil.
+*/
+static void sm_pairs_args_init(sm_pairs_args_t *args, sm_pairs_kind_t kind, VALUE sm_self, VALUE sm_other, const char *func_name)
+{
+  memset(args, 0, sizeof(*args));
+  args->kind = kind;
+  args->self = !RTEST(sm_other);
+  if (args->self) {
+    sm_other = sm_self;
+  }
+  sm_array_input(sm_other, s_sm_vec3_array_klass, 0, func_name);
+  Data_Get_Struct(sm_self, vec3_t, args->queries);
+  Data_Get_Struct(sm_other, vec3_t, args->targets);
+  args->target_count = SM_ARRAY_LENGTH(sm_other);
+}
+
+
+
+/*
+ * Returns a FloatArray of the distances from each point in this array to each
+ * point in other, with one row per point in this array, so the distance from
+ * self[i] to other[j] is at i * other.length + j. If other is nil, the
+ * distances are between the points of this array.
+ *
+ * Targets are processed in cache-sized blocks with the distances computed in
+ * SIMD lanes, which suits sets of up to a few thousand points. If threads is
+ * greater than 1, the points of this array are split across that many
+ * threads. Zero uses one thread per processor.
  *
  * call-seq:
- *    scale(scalar, output = nil) -> output or new vec3
+ *    pairwise_distances(other = nil, output = nil, threads = 1) -> output or new float_array
  */
-static VALUE sm_vec3_scale(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_array_pairwise_distances(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_other;
   VALUE sm_out;
-  VALUE sm_scalar;
-  s_float_t scalar;
-  vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
+  VALUE sm_threads;
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  sm_pairs_args_t args;
 
-  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
-  scalar = NUM2DBL(sm_scalar);
+  rb_scan_args(argc, argv, "03", &sm_other, &sm_out, &sm_threads);
+  sm_pairs_args_init(&args, SM_PAIRS_DISTANCE, sm_self, sm_other, "pairwise_distances");
+  sm_out = sm_array_output(sm_out, s_sm_float_array_klass, length * args.target_count, "pairwise_distances");
+  Data_Get_Struct(sm_out, s_float_t, args.distances);
 
-  if (SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
-    rb_check_frozen(sm_out);
-    vec3_scale(*self, scalar, *sm_unwrap_vec3(sm_out, NULL));
-  } else {
-    vec3_t out;
-    vec3_scale(*self, scalar, out);
-    sm_out = sm_wrap_vec3(out, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }
+  s_parallel_for(length, SM_PAIRS_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_pairs_range, &args);
 
   return sm_out;
 }
@@ -2888,310 +3906,465 @@ static VALUE sm_vec3_scale(int argc, VALUE *argv, VALUE sm_self)
 
 
 /*
- * Divides this vector's components by a scalar value and returns the result.
+ * Finds the k points in other nearest to each point in this array. Returns
+ * [indices, distances], two FloatArrays with k entries per point in this
+ * array, so the neighbours of self[i] start at i * k. Each point's neighbours
+ * are sorted by increasing distance, with ties in index order. If other has
+ * fewer than k points, the remaining entries are -1.
+ *
+ * If other is nil, neighbours are found among the points of this array and no
+ * point is its own neighbour. Targets and threads are handled as for
+ * #pairwise_distances.
  *
  * call-seq:
- *    divide(scalar, output = nil) -> output or new vec3
+ *    k_nearest(k, other = nil, indices = nil, distances = nil, threads = 1) -> [indices, distances]
  */
-static VALUE sm_vec3_divide(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_array_k_nearest(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out;
-  VALUE sm_scalar;
-  s_float_t scalar;
-  vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
+  VALUE sm_k;
+  VALUE sm_other;
+  VALUE sm_indices;
+  VALUE sm_distances;
+  VALUE sm_threads;
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  sm_pairs_args_t args;
+  long k;
 
-  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
-  scalar = NUM2DBL(sm_scalar);
+  rb_scan_args(argc, argv, "14", &sm_k, &sm_other, &sm_indices, &sm_distances, &sm_threads);
+  k = NUM2LONG(sm_k);
+  if (k < 1) {
+    rb_raise(rb_eArgError, "Invalid argument to k_nearest: k must be at least 1, got %ld", k);
+  }
 
-  if (SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
-    rb_check_frozen(sm_out);
-    vec3_divide(*self, scalar, *sm_unwrap_vec3(sm_out, NULL));
-  } else {
-    vec3_t out;
-    vec3_divide(*self, scalar, out);
-    sm_out = sm_wrap_vec3(out, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
+  sm_pairs_args_init(&args, SM_PAIRS_NEAREST, sm_self, sm_other, "k_nearest");
+  args.k = (size_t)k;
+  sm_indices = sm_array_output(sm_indices, s_sm_float_array_klass, length * args.k, "k_nearest");
+  sm_distances = sm_array_output(sm_distances, s_sm_float_array_klass, length * args.k, "k_nearest");
+  if (sm_indices == sm_distances) {
+    rb_raise(rb_eArgError, "Invalid argument to k_nearest: indices and distances must differ");
   }
+  Data_Get_Struct(sm_indices, s_float_t, args.indices);
+  Data_Get_Struct(sm_distances, s_float_t, args.distances);
 
-  return sm_out;
+  s_parallel_for(length, SM_PAIRS_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_pairs_range, &args);
+
+  return rb_ary_new3(2, sm_indices, sm_distances);
 }
 
 
 
 /*
- * Tests whether a Vec3 is equivalent to another Vec3, a Vec4, or a Quat. When
- * testing for equivalency against 4-component objects, only the first three
- * components are compared.
+ * Finds every pair of a point in this array and a point in other no more than
+ * radius apart. Returns [firsts, seconds, distances], three FloatArrays with
+ * one entry per pair holding the index of the point in this array, the index
+ * of the point in other, and the distance between them. Pairs are ordered by
+ * first and then second index. Returns nil if there are no such pairs.
+ *
+ * If other is nil, pairs are found among the points of this array and each
+ * pair is reported once, with first less than second. Targets and threads are
+ * handled as for #pairwise_distances. Raises ArgumentError if radius is
+ * negative or NaN.
  *
  * call-seq:
- *    vec3 == other_vec3 -> bool
- *    vec3 == vec4       -> bool
- *    vec3 == quat       -> bool
+ *    pairs_within(radius, other = nil, threads = 1) -> [firsts, seconds, distances]
  */
-static VALUE sm_vec3_equals(VALUE sm_self, VALUE sm_other)
+static VALUE sm_vec3_array_pairs_within(int argc, VALUE *argv, VALUE sm_self)
 {
-  if (!RTEST(sm_other) || (!SM_IS_A(sm_other, vec3) && !SM_IS_A(sm_other, vec4) && !SM_IS_A(sm_other, quat))) {
-    return Qfalse;
+  VALUE sm_radius;
+  VALUE sm_other;
+  VALUE sm_threads;
+  VALUE sm_buffer;
+  VALUE sm_firsts;
+  VALUE sm_seconds;
+  VALUE sm_distances;
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  sm_pairs_args_t args;
+  size_t total = 0;
+  size_t index;
+  int threads;
+
+  rb_scan_args(argc, argv, "12", &sm_radius, &sm_other, &sm_threads);
+  sm_pairs_args_init(&args, SM_PAIRS_WITHIN, sm_self, sm_other, "pairs_within");
+  args.radius = (s_float_t)NUM2DBL(sm_radius);
+  if (!(args.radius >= s_float_lit(0.0))) {
+    rb_raise(rb_eArgError, "Radius passed to pairs_within must be a non-negative number");
   }
+  threads = RTEST(sm_threads) ? NUM2INT(sm_threads) : 1;
 
-  return vec3_equals(*sm_unwrap_vec3(sm_self, NULL), *sm_unwrap_vec3(sm_other, NULL)) ? Qtrue : Qfalse;
-}
+  args.counts = ALLOCV_N(size_t, sm_buffer, length);
+  s_parallel_for(length, SM_PAIRS_GRAIN, threads, sm_pairs_range, &args);
+  for (index = 0; index < length; ++index) {
+    const size_t count = args.counts[index];
+    args.counts[index] = total;
+    total += count;
+  }
 
+  if (total == 0) {
+    ALLOCV_END(sm_buffer);
+    return Qnil;
+  }
 
+  sm_firsts = sm_array_output(Qnil, s_sm_float_array_klass, total, "pairs_within");
+  sm_seconds = sm_array_output(Qnil, s_sm_float_array_klass, total, "pairs_within");
+  sm_distances = sm_array_output(Qnil, s_sm_float_array_klass, total, "pairs_within");
+  Data_Get_Struct(sm_firsts, s_float_t, args.firsts);
+  Data_Get_Struct(sm_seconds, s_float_t, args.seconds);
+  Data_Get_Struct(sm_distances, s_float_t, args.distances);
+  s_parallel_for(length, SM_PAIRS_GRAIN, threads, sm_pairs_range, &args);
 
-/*==============================================================================
+  ALLOCV_END(sm_buffer);
+  return rb_ary_new3(3, sm_firsts, sm_seconds, sm_distances);
+}
 
-  vec4_t functions
 
-==============================================================================*/
 
-static VALUE sm_wrap_vec4(const vec4_t value, VALUE klass)
+/*
+  Arguments for sm_transform_vec2_range. A single matrix has a step of 0.
+*/
+typedef struct sm_transform_vec2_args_s {
+  const mat3_t *matrices;
+  size_t step;
+  const vec2_t *in;
+  vec2_t *out;
+  int translate;
+} sm_transform_vec2_args_t;
+
+static void sm_transform_vec2_range(void *context, size_t begin, size_t end)
 {
-  vec4_t *copy;
-  VALUE sm_wrapped = Qnil;
-  if (!RTEST(klass)) {
-    klass = s_sm_vec4_klass;
-  }
-  sm_wrapped = Data_Make_Struct(klass, vec4_t, 0, free, copy);
-  if (value) {
-    vec4_copy(value, *copy);
-  }
-  return sm_wrapped;
+  const sm_transform_vec2_args_t *args = (const sm_transform_vec2_args_t *)context;
+  mat3_array_transform_vec2(args->matrices + begin * args->step, args->step,
+    args->in + begin, args->translate, args->out + begin, end - begin);
 }
 
+static VALUE sm_vec2_array_transform_by(int argc, VALUE *argv, VALUE sm_self, int translate, const char *func_name)
+{
+  VALUE sm_matrix;
+  VALUE sm_out;
+  VALUE sm_threads;
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  sm_transform_vec2_args_t args;
+
+  rb_scan_args(argc, argv, "12", &sm_matrix, &sm_out, &sm_threads);
+  if (SM_IS_A(sm_matrix, mat3)) {
+    args.matrices = (const mat3_t *)sm_unwrap_mat3(sm_matrix, NULL);
+    args.step = 0;
+  } else if (SM_RB_IS_A(sm_matrix, s_sm_mat3_array_klass)) {
+    sm_array_input(sm_matrix, s_sm_mat3_array_klass, length, func_name);
+    Data_Get_Struct(sm_matrix, mat3_t, args.matrices);
+    args.step = 1;
+  } else {
+    rb_raise(rb_eTypeError,
+      "Invalid argument to %s: expected %s or %s, got %s",
+      func_name,
+      rb_class2name(s_sm_mat3_klass),
+      rb_class2name(s_sm_mat3_array_klass),
+      rb_obj_classname(sm_matrix));
+  }
 
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, func_name);
+  Data_Get_Struct(sm_self, vec2_t, args.in);
+  Data_Get_Struct(sm_out, vec2_t, args.out);
+  args.translate = translate;
 
-static vec4_t *sm_unwrap_vec4(VALUE sm_value, vec4_t store)
-{
-  vec4_t *value;
-  Data_Get_Struct(sm_value, vec4_t, value);
-  if(store) vec4_copy(*value, store);
-  return value;
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_transform_vec2_range, &args);
+
+  return sm_out;
 }
 
 
 
 /*
- * Gets the component of the Vec4 at the given index.
+ * Transforms each point in this array by a 2D affine transform and returns an
+ * array of the results (see Mat3#transform_vec2). Matrix may be a Mat3, applied
+ * to every point using SIMD, or a Mat3Array with a matrix per point. Output
+ * may be self.
  *
- * call-seq: fetch(index) -> float
+ * If threads is greater than 1, the points are split across that many threads.
+ * Zero uses one thread per processor.
+ *
+ * call-seq:
+ *    transform(matrix, output = nil, threads = 1) -> output or new vec2_array
  */
-static VALUE sm_vec4_fetch (VALUE sm_self, VALUE sm_index)
+static VALUE sm_vec2_array_transform(int argc, VALUE *argv, VALUE sm_self)
 {
-  static const int max_index = sizeof(vec4_t) / sizeof(s_float_t);
-  const vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  if (index < 0 || index >= max_index) {
-    rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
-  }
-  return DBL2NUM(self[0][NUM2INT(sm_index)]);
+  return sm_vec2_array_transform_by(argc, argv, sm_self, 1, "transform");
 }
 
 
 
 /*
- * Sets the Vec4's component at the index to the value.
+ * Transforms each direction in this array by a 2D affine transform, ignoring
+ * its translation, and returns an array of the results (see Mat3#rotate_vec2).
+ * Matrix, output, and threads are as for #transform.
  *
- * call-seq: store(index, value) -> value
+ * call-seq:
+ *    rotate(matrix, output = nil, threads = 1) -> output or new vec2_array
  */
-static VALUE sm_vec4_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_vec2_array_rotate(int argc, VALUE *argv, VALUE sm_self)
 {
-  static const int max_index = sizeof(vec4_t) / sizeof(s_float_t);
-  vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  rb_check_frozen(sm_self);
-  if (index < 0 || index >= max_index) {
-    rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
-  }
-  self[0][index] = (s_float_t)NUM2DBL(sm_value);
-  return sm_value;
+  return sm_vec2_array_transform_by(argc, argv, sm_self, 0, "rotate");
 }
 
 
 
 /*
- * Returns the length in bytes of the Vec4. When compiled to use doubles as the
- * base type, this is always 32. Otherwise, when compiled to use floats, it's
- * always 16.
+ * Returns a Mat3Array of 2D affine transforms composed from translations, a
+ * Vec2Array, angles, a FloatArray of counter-clockwise rotations in degrees,
+ * and scales, a Vec2Array or nil for unit scale (see Mat3::trs_2d). The
+ * result has as many elements as translations.
  *
- * call-seq: size -> fixnum
+ * call-seq:
+ *    trs_2d(translations, angles, scales = nil, output = nil) -> output or new mat3_array
  */
-static VALUE sm_vec4_size (VALUE self)
+static VALUE sm_mat3_array_s_trs_2d(int argc, VALUE *argv, VALUE self)
 {
-  return SIZET2NUM(sizeof(vec4_t));
+  VALUE sm_translations;
+  VALUE sm_angles;
+  VALUE sm_scales;
+  VALUE sm_out;
+  const vec2_t *translations;
+  const s_float_t *angles;
+  const vec2_t *scales = NULL;
+  mat3_t *output;
+  size_t length;
+
+  rb_scan_args(argc, argv, "22", &sm_translations, &sm_angles, &sm_scales, &sm_out);
+  sm_array_input(sm_translations, s_sm_vec2_array_klass, 0, "trs_2d");
+  length = SM_ARRAY_LENGTH(sm_translations);
+  sm_array_input(sm_angles, s_sm_float_array_klass, length, "trs_2d");
+  if (RTEST(sm_scales)) {
+    sm_array_input(sm_scales, s_sm_vec2_array_klass, length, "trs_2d");
+    Data_Get_Struct(sm_scales, vec2_t, scales);
+  }
+  sm_out = sm_array_output(sm_out, self, length, "trs_2d");
+
+  Data_Get_Struct(sm_translations, vec2_t, translations);
+  Data_Get_Struct(sm_angles, s_float_t, angles);
+  Data_Get_Struct(sm_out, mat3_t, output);
+  mat3_array_trs_2d(translations, angles, scales, output, length);
+
+  return sm_out;
 }
 
 
 
 /*
- * Returns the length of the Vec4 in components. Result is always 4.
+ * Inverts each matrix in this array as a 2D affine transform (see
+ * Mat3#inverse_affine) and returns an array of the results. Matrices that
+ * cannot be inverted are replaced by the identity in the output. Output may be
+ * self.
  *
- * call-seq: length -> fixnum
+ * call-seq:
+ *    inverse_affine(output = nil) -> output or new mat3_array
  */
-static VALUE sm_vec4_length (VALUE self)
+static VALUE sm_mat3_array_inverse_affine(int argc, VALUE *argv, VALUE sm_self)
 {
-  return SIZET2NUM(sizeof(vec4_t) / sizeof(s_float_t));
+  VALUE sm_out;
+  size_t length = SM_ARRAY_LENGTH(sm_self);
+  const mat3_t *self;
+  mat3_t *output;
+
+  rb_scan_args(argc, argv, "01", &sm_out);
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, "inverse_affine");
+
+  Data_Get_Struct(sm_self, mat3_t, self);
+  Data_Get_Struct(sm_out, mat3_t, output);
+  mat3_array_inverse_affine(self, output, length);
+
+  return sm_out;
 }
 
 
 
 /*
- * Returns a copy of self.
+  Arguments for sm_polygon_contains_range.
+*/
+typedef struct sm_polygon_args_s {
+  const vec2_t *polygon;
+  size_t count;
+  const vec2_t *points;
+  s_float_t *out;
+} sm_polygon_args_t;
+
+static void sm_polygon_contains_range(void *context, size_t begin, size_t end)
+{
+  const sm_polygon_args_t *args = (const sm_polygon_args_t *)context;
+  vec2_array_polygon_contains(args->polygon, args->count,
+    args->points + begin, args->out + begin, end - begin);
+}
+
+
+
+/*
+ * Tests points against the polygon formed by the elements of this array in
+ * range, or all of them if range is nil, using the even-odd rule. The polygon
+ * is closed by an edge from its last vertex back to its first, and may be
+ * concave or self-intersecting.
+ *
+ * If points is a Vec2, returns true or false. If points is a Vec2Array,
+ * returns a FloatArray holding 1 for each point inside the polygon and 0 for
+ * each outside it. If threads is greater than 1, the points are split across
+ * that many threads. Zero uses one thread per processor.
  *
  * call-seq:
- *    copy(output = nil) -> output or new vec4 / quat
+ *    polygon_contains(point, range = nil) -> true or false
+ *    polygon_contains(points, range = nil, output = nil, threads = 1) -> output or new float_array
  */
-static VALUE sm_vec4_copy(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_array_polygon_contains(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_points;
+  VALUE sm_range;
   VALUE sm_out;
-  vec4_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_copy (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_copy (*self, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
+  VALUE sm_threads;
+  const vec2_t *self;
+  sm_polygon_args_t args;
+  size_t begin;
+  size_t length;
+
+  rb_scan_args(argc, argv, "13", &sm_points, &sm_range, &sm_out, &sm_threads);
+  sm_array_range(sm_range, SM_ARRAY_LENGTH(sm_self), &begin, &args.count, "polygon_contains");
+  Data_Get_Struct(sm_self, vec2_t, self);
+  args.polygon = self + begin;
+
+  if (!SM_RB_IS_A(sm_points, s_sm_vec2_array_klass)) {
+    s_float_t inside;
+    args.points = (const vec2_t *)sm_vec2_operand(sm_points, NULL);
+    vec2_array_polygon_contains(args.polygon, args.count, args.points, &inside, 1);
+    return (inside != s_float_lit(0.0)) ? Qtrue : Qfalse;
   }
+
+  length = SM_ARRAY_LENGTH(sm_points);
+  sm_out = sm_array_output(sm_out, s_sm_float_array_klass, length, "polygon_contains");
+  Data_Get_Struct(sm_points, vec2_t, args.points);
+  Data_Get_Struct(sm_out, s_float_t, args.out);
+
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_polygon_contains_range, &args);
+
   return sm_out;
 }
 
 
 
 /*
- * Returns a normalized Vec4 or Quat, depending on the type of the receiver and
- * output.
+ * Returns the signed area of the polygon formed by the elements of this array
+ * in range, or all of them if range is nil. The area is positive if the
+ * polygon winds counter-clockwise and negative if it winds clockwise.
  *
  * call-seq:
- *    normalize(output = nil) -> output or new vec4 / quat
+ *    polygon_area(range = nil) -> float
  */
-static VALUE sm_vec4_normalize(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_array_polygon_area(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out;
-  vec4_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-     rb_raise(rb_eTypeError,
-       kSM_WANT_FOUR_FORMAT_LIT,
-       rb_obj_classname(sm_out));
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_normalize (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_normalize (*self, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to normalize");
-  }
-  return sm_out;
+  VALUE sm_range;
+  const vec2_t *self;
+  size_t begin;
+  size_t count;
+
+  rb_scan_args(argc, argv, "01", &sm_range);
+  sm_array_range(sm_range, SM_ARRAY_LENGTH(sm_self), &begin, &count, "polygon_area");
+  Data_Get_Struct(sm_self, vec2_t, self);
+
+  return rb_float_new(vec2_polygon_area(self + begin, count));
 }
 
 
 
 /*
- * Returns a vector whose components are the multiplicative inverse of this
- * vector's.
+ * Returns the centroid of the area of the polygon formed by the elements of
+ * this array in range, or all of them if range is nil. If the polygon has no
+ * area, returns the mean of its vertices.
  *
  * call-seq:
- *    inverse(output = nil) -> output or new vec4
+ *    polygon_centroid(range = nil, output = nil) -> output or new vec2
  */
-static VALUE sm_vec4_inverse(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_array_polygon_centroid(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_range;
   VALUE sm_out;
-  vec4_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_inverse (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_inverse (*self, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+  const vec2_t *self;
+  size_t begin;
+  size_t count;
+  vec2_t centroid;
+
+  rb_scan_args(argc, argv, "02", &sm_range, &sm_out);
+  sm_array_range(sm_range, SM_ARRAY_LENGTH(sm_self), &begin, &count, "polygon_centroid");
+  Data_Get_Struct(sm_self, vec2_t, self);
+  vec2_polygon_centroid(self + begin, count, centroid);
+
+  if (!RTEST(sm_out)) {
+    sm_out = sm_wrap_vec2(centroid, s_sm_vec2_klass);
     rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
+  } else if (SM_IS_A(sm_out, vec2) || SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
+    sm_check_writable(sm_out);
+    vec2_copy(centroid, *sm_unwrap_vec2(sm_out, NULL));
+  } else {
+    rb_raise(rb_eTypeError, kSM_WANT_TWO_TO_FOUR_FORMAT_LIT, rb_obj_classname(sm_out));
   }
+
   return sm_out;
 }
 
 
 
 /*
- * Negates this vector or quaternions's components and returns the result.
+ * Returns the convex hull of the elements of this array in range, or all of
+ * them if range is nil, as a Vec2Array of its vertices in counter-clockwise
+ * order. Points on the hull's edges are not included. Returns nil if the
+ * range is empty.
+ *
+ * If output is given, the hull is written to its first elements and an Array
+ * of output and the number of hull vertices written to it is returned. Output
+ * must be long enough to hold the hull, which has at most as many vertices as
+ * the range has points, and elements past the hull are left unchanged. Output
+ * may be self.
  *
  * call-seq:
- *    negate(output = nil) -> output or new vec4 or quat
+ *    convex_hull(range = nil) -> new vec2_array or nil
+ *    convex_hull(range, output) -> [output, count] or nil
  */
-static VALUE sm_vec4_negate(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_array_convex_hull(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_range;
   VALUE sm_out;
-  vec4_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_negate (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_negate (*self, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to negate");
+  VALUE sm_buffer;
+  const vec2_t *self;
+  vec2_t *scratch;
+  vec2_t *output;
+  size_t begin;
+  size_t count;
+  size_t hull;
+  int given_output;
+
+  rb_scan_args(argc, argv, "02", &sm_range, &sm_out);
+  sm_array_range(sm_range, SM_ARRAY_LENGTH(sm_self), &begin, &count, "convex_hull");
+  if (count == 0) {
+    return Qnil;
+  }
+
+  /* Sorted points followed by the hull, which needs one extra element */
+  scratch = ALLOCV_N(vec2_t, sm_buffer, count * 2 + 1);
+  Data_Get_Struct(sm_self, vec2_t, self);
+  hull = vec2_array_convex_hull(self + begin, count, scratch, scratch + count);
+
+  given_output = RTEST(sm_out);
+  if (given_output) {
+    sm_array_input(sm_out, s_sm_vec2_array_klass, hull, "convex_hull");
+    sm_check_writable(sm_out);
+  } else {
+    sm_out = sm_array_output(Qnil, s_sm_vec2_array_klass, hull, "convex_hull");
+  }
+  Data_Get_Struct(sm_out, vec2_t, output);
+  MEMCPY(output, scratch + count, vec2_t, hull);
+
+  ALLOCV_END(sm_buffer);
+  if (given_output) {
+    return rb_ary_new3(2, sm_out, SIZET2NUM(hull));
   }
   return sm_out;
 }
@@ -3199,457 +4372,646 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Projects this vector onto a normal vector and returns the result.
+  Arguments for sm_intersect_segments_range. Each endpoint has a step of 0 if
+  a single Vec2 is used for every segment.
+*/
+typedef struct sm_segments_args_s {
+  const vec2_t *ends[4];
+  size_t steps[4];
+  vec2_t *out;
+  s_float_t *params;
+} sm_segments_args_t;
+
+static void sm_intersect_segments_range(void *context, size_t begin, size_t end)
+{
+  const sm_segments_args_t *args = (const sm_segments_args_t *)context;
+  vec2_array_intersect_segments(
+    args->ends[0] + begin * args->steps[0], args->steps[0],
+    args->ends[1] + begin * args->steps[1], args->steps[1],
+    args->ends[2] + begin * args->steps[2], args->steps[2],
+    args->ends[3] + begin * args->steps[3], args->steps[3],
+    end - begin, args->out + begin, args->params + begin);
+}
+
+static void sm_segment_end(VALUE sm_value, size_t length, const vec2_t **end, size_t *step)
+{
+  if (SM_RB_IS_A(sm_value, s_sm_vec2_array_klass)) {
+    sm_array_input(sm_value, s_sm_vec2_array_klass, length, "intersect_segments");
+    Data_Get_Struct(sm_value, vec2_t, *end);
+    *step = 1;
+  } else {
+    *end = (const vec2_t *)sm_vec2_operand(sm_value, NULL);
+    *step = 0;
+  }
+}
+
+
+
+/*
+ * Intersects the segments from each point in this array to the point at the
+ * same index in ends with the segments from other_starts to other_ends. Each
+ * of ends, other_starts, and other_ends may be a Vec2Array or a single Vec2
+ * used for every segment.
+ *
+ * Returns points, a Vec2Array of the intersections, and params, a FloatArray
+ * of how far along its first segment each intersection is, from 0 to 1. Where
+ * the segments do not meet, the param is -1 and the point is the start of the
+ * first segment. Overlapping collinear segments meet where the overlap
+ * begins. If threads is greater than 1, the segments are split across that
+ * many threads. Zero uses one thread per processor.
  *
  * call-seq:
- *    project(normal, output = nil) -> output or new vec4
+ *    intersect_segments(ends, other_starts, other_ends, points = nil, params = nil, threads = 1) -> [points, params]
  */
-static VALUE sm_vec4_project(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_array_intersect_segments(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
-  vec4_t *self;
-  vec4_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
+  VALUE sm_ends;
+  VALUE sm_other_starts;
+  VALUE sm_other_ends;
+  VALUE sm_points;
+  VALUE sm_params;
+  VALUE sm_threads;
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  sm_segments_args_t args;
+
+  rb_scan_args(argc, argv, "33", &sm_ends, &sm_other_starts, &sm_other_ends,
+    &sm_points, &sm_params, &sm_threads);
+  Data_Get_Struct(sm_self, vec2_t, args.ends[0]);
+  args.steps[0] = 1;
+  sm_segment_end(sm_ends, length, &args.ends[1], &args.steps[1]);
+  sm_segment_end(sm_other_starts, length, &args.ends[2], &args.steps[2]);
+  sm_segment_end(sm_other_ends, length, &args.ends[3], &args.steps[3]);
+
+  sm_points = sm_array_output(sm_points, rb_obj_class(sm_self), length, "intersect_segments");
+  sm_params = sm_array_output(sm_params, s_sm_float_array_klass, length, "intersect_segments");
+  Data_Get_Struct(sm_points, vec2_t, args.out);
+  Data_Get_Struct(sm_params, s_float_t, args.params);
+
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_intersect_segments_range, &args);
+
+  return rb_ary_new3(2, sm_points, sm_params);
+}
+
+
+
+/*
+  Arguments for the packed encoding range functions, which encode elements to
+  bytes or decode them from bytes.
+*/
+typedef struct sm_packed_args_s {
+  s_float_t *elements;
+  uint8_t *bytes;
+  size_t stride;
+  int bits;
+  int decode;
+  const s_float_t *lower;
+  const s_float_t *upper;
+  s_float_t *signs;
+} sm_packed_args_t;
+
+static void sm_smallest3_range(void *context, size_t begin, size_t end)
+{
+  const sm_packed_args_t *args = (const sm_packed_args_t *)context;
+  quat_t *quats = (quat_t *)args->elements + begin;
+  uint8_t *bytes = args->bytes + begin * args->stride;
+  if (args->decode) {
+    quat_array_decode_smallest3(bytes, end - begin, args->bits, quats);
+  } else {
+    quat_array_encode_smallest3((const quat_t *)quats, end - begin, args->bits, bytes);
   }
-  rhs = sm_unwrap_vec4(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_project(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_project(*self, *rhs, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to project");
+}
+
+static void sm_quantize_range(void *context, size_t begin, size_t end)
+{
+  const sm_packed_args_t *args = (const sm_packed_args_t *)context;
+  vec3_t *points = (vec3_t *)args->elements + begin;
+  uint8_t *bytes = args->bytes + begin * args->stride;
+  if (args->decode) {
+    vec3_array_dequantize(bytes, end - begin, args->lower, args->upper, args->bits, points);
+  } else {
+    vec3_array_quantize((const vec3_t *)points, end - begin, args->lower, args->upper, args->bits, bytes);
+  }
+}
+
+/*
+  Runs fn over the elements of sm_self to encode them to a String of
+  args->stride bytes each, or over the elements packed in sm_packed to decode
+  them to an array of klass. The stride and any other parameters of the
+  encoding must already be set in args.
+*/
+static VALUE sm_packed_encode(VALUE sm_self, VALUE sm_out, VALUE sm_threads,
+  sm_packed_args_t *args, s_range_fn_t fn, const char *func_name)
+{
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  args->decode = 0;
+  sm_out = sm_packed_output(sm_out, length * args->stride, func_name);
+  Data_Get_Struct(sm_self, s_float_t, args->elements);
+  args->bytes = (uint8_t *)RSTRING_PTR(sm_out);
+
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    fn, args);
+
+  return sm_out;
+}
+
+static VALUE sm_packed_decode(VALUE klass, VALUE sm_packed, VALUE sm_out, VALUE sm_threads,
+  sm_packed_args_t *args, s_range_fn_t fn, const char *func_name)
+{
+  const size_t length = sm_packed_input(sm_packed, args->stride, func_name);
+  args->decode = 1;
+  sm_out = sm_array_output(sm_out, klass, length, func_name);
+  if (length == 0) {
+    return sm_out;
   }
+  Data_Get_Struct(sm_out, s_float_t, args->elements);
+  args->bytes = (uint8_t *)RSTRING_PTR(sm_packed);
+
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    fn, args);
+
   return sm_out;
 }
 
 
 
 /*
- * Reflects this vector against a normal vector and returns the result.
+ * Encodes the rotations in this array with the smallest-three method and
+ * returns a binary String holding them packed. Each rotation takes 3 * bits + 2
+ * bits, rounded up to whole bytes, so 10 bits gives 4 bytes per rotation and
+ * 15 bits gives 6. Bits may be 2 to 20. Rotations are normalized before they
+ * are encoded, and zero rotations are encoded as the identity. The identity and
+ * other rotations with zero components decode with those components exact.
+ *
+ * If output is a String, it is resized and the encoding is written to it. If
+ * threads is greater than 1, the rotations are split across that many threads.
+ * Zero uses one thread per processor.
  *
  * call-seq:
- *    reflect(normal, output = nil) -> output or new vec4
+ *    encode_smallest3(bits = 10, output = nil, threads = 1) -> output or new string
  */
-static VALUE sm_vec4_reflect(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_quat_array_encode_smallest3(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
+  VALUE sm_bits;
   VALUE sm_out;
-  vec4_t *self;
-  vec4_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec4(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_reflect(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_reflect(*self, *rhs, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to reflect");
-  }
-  return sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "03", &sm_bits, &sm_out, &sm_threads);
+  args.bits = sm_packed_bits(sm_bits, 10, 2, 20, "encode_smallest3");
+  args.stride = quat_smallest3_bytes(args.bits);
+  return sm_packed_encode(sm_self, sm_out, sm_threads, &args, sm_smallest3_range, "encode_smallest3");
 }
 
 
 
 /*
- * Multiplies this and another vector's components together and returns the
- * result.
+ * Decodes rotations encoded by QuatArray#encode_smallest3 with the same number
+ * of bits and returns a QuatArray holding them, renormalized. Returns nil if
+ * packed is empty. Output, if given, must hold at least as many rotations as
+ * packed does, and threads is as for #encode_smallest3.
  *
  * call-seq:
- *    multiply_vec4(vec4, output = nil) -> output or new vec4
+ *    decode_smallest3(packed, bits = 10, output = nil, threads = 1) -> output or new quat_array
  */
-static VALUE sm_vec4_multiply(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_quat_array_s_decode_smallest3(int argc, VALUE *argv, VALUE self)
 {
-  VALUE sm_rhs;
+  VALUE sm_packed;
+  VALUE sm_bits;
   VALUE sm_out;
-  vec4_t *self;
-  vec4_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec4(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_multiply(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_multiply(*self, *rhs, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_vec4");
-  }
-  return sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "13", &sm_packed, &sm_bits, &sm_out, &sm_threads);
+  args.bits = sm_packed_bits(sm_bits, 10, 2, 20, "decode_smallest3");
+  args.stride = quat_smallest3_bytes(args.bits);
+  return sm_packed_decode(self, sm_packed, sm_out, sm_threads, &args, sm_smallest3_range, "decode_smallest3");
 }
 
 
 
 /*
- * Adds this and another vector or quaternion's components together and returns
- * the result. The result type is that of the receiver.
+ * Quantizes the points in this array to bits bits per axis within the box
+ * from lower to upper, both Vec3s, and returns a binary String holding them
+ * packed. Each point takes 3 * bits bits, rounded up to whole bytes, so 16
+ * bits gives 6 bytes per point. Bits may be 1 to 21. Points outside the box
+ * are clamped to it.
+ *
+ * If output is a String, it is resized and the encoding is written to it. If
+ * threads is greater than 1, the points are split across that many threads.
+ * Zero uses one thread per processor.
  *
  * call-seq:
- *    add(vec4, output = nil) -> output or new vec4 or quat
+ *    quantize(lower, upper, bits = 16, output = nil, threads = 1) -> output or new string
  */
-static VALUE sm_vec4_add(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_array_quantize(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
+  VALUE sm_lower;
+  VALUE sm_upper;
+  VALUE sm_bits;
   VALUE sm_out;
-  vec4_t *self;
-  vec4_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec4(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_rhs));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_add(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_add(*self, *rhs, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to add");
-  }
-  return sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "23", &sm_lower, &sm_upper, &sm_bits, &sm_out, &sm_threads);
+  args.lower = *sm_vec3_operand(sm_lower, NULL);
+  args.upper = *sm_vec3_operand(sm_upper, NULL);
+  args.bits = sm_packed_bits(sm_bits, 16, 1, 21, "quantize");
+  args.stride = vec3_quantized_bytes(args.bits);
+  return sm_packed_encode(sm_self, sm_out, sm_threads, &args, sm_quantize_range, "quantize");
 }
 
 
 
 /*
- * Subtracts another vector or quaternion's components from this vector's and
- * returns the result. The return type is that of the receiver.
+ * Decodes points quantized by Vec3Array#quantize with the same box and number
+ * of bits and returns a Vec3Array holding them. Returns nil if packed is
+ * empty. Output, if given, must hold at least as many points as packed does,
+ * and threads is as for #quantize.
  *
  * call-seq:
- *    subtract(vec4, output = nil) -> output or new vec4
+ *    dequantize(packed, lower, upper, bits = 16, output = nil, threads = 1) -> output or new vec3_array
  */
-static VALUE sm_vec4_subtract(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_array_s_dequantize(int argc, VALUE *argv, VALUE self)
 {
-  VALUE sm_rhs;
+  VALUE sm_packed;
+  VALUE sm_lower;
+  VALUE sm_upper;
+  VALUE sm_bits;
   VALUE sm_out;
-  vec4_t *self;
-  vec4_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_vec4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "33", &sm_packed, &sm_lower, &sm_upper, &sm_bits, &sm_out, &sm_threads);
+  args.lower = *sm_vec3_operand(sm_lower, NULL);
+  args.upper = *sm_vec3_operand(sm_upper, NULL);
+  args.bits = sm_packed_bits(sm_bits, 16, 1, 21, "dequantize");
+  args.stride = vec3_quantized_bytes(args.bits);
+  return sm_packed_decode(self, sm_packed, sm_out, sm_threads, &args, sm_quantize_range, "dequantize");
+}
+
+
+
+static void sm_octahedral_range(void *context, size_t begin, size_t end)
+{
+  const sm_packed_args_t *args = (const sm_packed_args_t *)context;
+  vec3_t *directions = (vec3_t *)args->elements + begin;
+  uint8_t *bytes = args->bytes + begin * args->stride;
+  if (args->decode) {
+    vec3_array_decode_octahedral(bytes, end - begin, directions);
+  } else {
+    vec3_array_encode_octahedral((const vec3_t *)directions, end - begin, bytes);
   }
-  rhs = sm_unwrap_vec4(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_rhs));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    vec4_subtract(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec4_t output;
-    vec4_subtract(*self, *rhs, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to subtract");
+}
+
+static void sm_quat_qtangent_range(void *context, size_t begin, size_t end)
+{
+  const sm_packed_args_t *args = (const sm_packed_args_t *)context;
+  quat_t *rotations = (quat_t *)args->elements + begin;
+  uint8_t *bytes = args->bytes + begin * args->stride;
+  s_float_t *signs = args->signs ? args->signs + begin : NULL;
+  if (args->decode) {
+    quat_array_decode_qtangent(bytes, end - begin, rotations, signs);
+  } else {
+    quat_array_encode_qtangent((const quat_t *)rotations, signs, end - begin, bytes);
   }
-  return sm_out;
 }
 
+static void sm_mat3_qtangent_range(void *context, size_t begin, size_t end)
+{
+  const sm_packed_args_t *args = (const sm_packed_args_t *)context;
+  mat3_t *frames = (mat3_t *)args->elements + begin;
+  uint8_t *bytes = args->bytes + begin * args->stride;
+  if (args->decode) {
+    mat3_array_decode_qtangent(bytes, end - begin, frames);
+  } else {
+    mat3_array_encode_qtangent((const mat3_t *)frames, end - begin, bytes);
+  }
+}
+
+/*
+ * Encodes the directions in this array octahedrally and returns a binary
+ * String holding each as two signed normalized 16-bit integers, 4 bytes per
+ * direction. Directions need not be normalized. Zero directions decode to
+ * (0, 0, 1).
+ *
+ * If output is a String, it is resized and the encoding is written to it. If
+ * threads is greater than 1, the directions are split across that many
+ * threads. Zero uses one thread per processor.
+ *
+ * call-seq:
+ *    encode_octahedral(output = nil, threads = 1) -> output or new string
+ */
+static VALUE sm_vec3_array_encode_octahedral(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "02", &sm_out, &sm_threads);
+  args.stride = 4;
+  return sm_packed_encode(sm_self, sm_out, sm_threads, &args, sm_octahedral_range, "encode_octahedral");
+}
 
 
 
 /*
- * Returns the dot product of self and another Vec4 or Quat.
+ * Decodes directions encoded by Vec3Array#encode_octahedral and returns a
+ * Vec3Array holding them, normalized. Returns nil if packed is empty. Output,
+ * if given, must hold at least as many directions as packed does, and threads
+ * is as for #encode_octahedral.
  *
  * call-seq:
- *    dot_product(vec4) -> float
- *    dot_product(quat) -> float
+ *    decode_octahedral(packed, output = nil, threads = 1) -> output or new vec3_array
  */
-static VALUE sm_vec4_dot_product(VALUE sm_self, VALUE sm_other)
+static VALUE sm_vec3_array_s_decode_octahedral(int argc, VALUE *argv, VALUE self)
 {
-  if (!SM_IS_A(sm_other, vec4) &&
-      !SM_IS_A(sm_other, quat)) {
-    rb_raise(rb_eArgError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_other));
-    return Qnil;
-  }
-  return DBL2NUM(
-    vec4_dot_product(
-      *sm_unwrap_vec4(sm_self, NULL),
-      *sm_unwrap_vec4(sm_other, NULL)));
+  VALUE sm_packed;
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "12", &sm_packed, &sm_out, &sm_threads);
+  args.stride = 4;
+  return sm_packed_decode(self, sm_packed, sm_out, sm_threads, &args, sm_octahedral_range, "decode_octahedral");
 }
 
 
 
 /*
- * Allocates a new Vec4.
+ * Encodes the tangent frames in this array as QTangents and returns a binary
+ * String holding each as four signed normalized 16-bit integers, 8 bytes per
+ * frame. The rows of each frame (see Mat3#get_row3) are its tangent,
+ * bitangent, and normal. Frames with a negative determinant are reflections,
+ * which are stored by flipping the bitangent and negating the rotation.
+ *
+ * If output is a String, it is resized and the encoding is written to it. If
+ * threads is greater than 1, the frames are split across that many threads.
+ * Zero uses one thread per processor.
  *
  * call-seq:
- *     new()               -> new vec4 with components [0, 0, 0, 1]
- *     new(x, y, z, w = 1) -> new vec4 with components [x, y, z, w]
- *     new([x, y, z, w])   -> new vec4 with components [x, y, z, w]
- *     new(vec4)           -> copy of vec4
- *     new(vec3)           -> copy of vec3 with w component of 1
- *     new(quat)           -> copy of quat as vec4
+ *    encode_qtangents(output = nil, threads = 1) -> output or new string
  */
-static VALUE sm_vec4_new(int argc, VALUE *argv, VALUE self)
+static VALUE sm_mat3_array_encode_qtangents(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_vec = sm_wrap_vec4(g_vec4_identity, self);
-  rb_obj_call_init(sm_vec, argc, argv);
-  return sm_vec;
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "02", &sm_out, &sm_threads);
+  args.stride = 8;
+  return sm_packed_encode(sm_self, sm_out, sm_threads, &args, sm_mat3_qtangent_range, "encode_qtangents");
 }
 
 
 
 /*
- * Sets the Vec4's components.
+ * Decodes QTangents encoded by Mat3Array#encode_qtangents or
+ * QuatArray#encode_qtangents and returns a Mat3Array of the tangent frames,
+ * with the bitangents of reflected frames flipped. Returns nil if packed is
+ * empty. Output, if given, must hold at least as many frames as packed does,
+ * and threads is as for #encode_qtangents.
  *
  * call-seq:
- *    set(x, y, z, w = 1) -> new vec4 with components [x, y, z, w]
- *    set([x, y, z, w])   -> new vec4 with components [x, y, z, w]
- *    set(vec3)           -> vec4 with components [vec3.xyz, 1]
- *    set(vec2)           -> vec4 with components [vec2.xy, 0, 1]
- *    set(vec4)           -> copy of vec4
- *    set(quat)           -> copy of quat as vec4
+ *    decode_qtangents(packed, output = nil, threads = 1) -> output or new mat3_array
  */
-static VALUE sm_vec4_init(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_array_s_decode_qtangents(int argc, VALUE *argv, VALUE self)
 {
-  vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
-  size_t arr_index = 0;
+  VALUE sm_packed;
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
 
-  rb_check_frozen(sm_self);
+  rb_scan_args(argc, argv, "12", &sm_packed, &sm_out, &sm_threads);
+  args.stride = 8;
+  return sm_packed_decode(self, sm_packed, sm_out, sm_threads, &args, sm_mat3_qtangent_range, "decode_qtangents");
+}
 
-  switch(argc) {
 
-  /* Default value */
-  case 0: { break; }
 
-  /* Copy or by-array */
-  case 1: {
-    if (SM_IS_A(argv[0], quat) ||
-        SM_IS_A(argv[0], vec4)) {
-      sm_unwrap_quat(argv[0], *self);
-      break;
-    }
+/*
+ * Encodes the tangent frame rotations in this array as QTangents (see
+ * Mat3Array#encode_qtangents) and returns a binary String holding them. Signs,
+ * if given, is a FloatArray with a value per rotation that is negative for
+ * reflected frames, whose bitangents are flipped. Without signs, no frame is
+ * reflected. Output and threads are as for Mat3Array#encode_qtangents.
+ *
+ * call-seq:
+ *    encode_qtangents(signs = nil, output = nil, threads = 1) -> output or new string
+ */
+static VALUE sm_quat_array_encode_qtangents(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_signs;
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
 
-    if (SM_IS_A(argv[0], vec3)) {
-      sm_unwrap_vec3(argv[0], *self);
-      self[0][3] = s_float_lit(1.0);
-      break;
-    }
+  rb_scan_args(argc, argv, "03", &sm_signs, &sm_out, &sm_threads);
+  args.stride = 8;
+  args.signs = NULL;
+  if (RTEST(sm_signs)) {
+    sm_array_input(sm_signs, s_sm_float_array_klass, SM_ARRAY_LENGTH(sm_self), "encode_qtangents");
+    Data_Get_Struct(sm_signs, s_float_t, args.signs);
+  }
+  return sm_packed_encode(sm_self, sm_out, sm_threads, &args, sm_quat_qtangent_range, "encode_qtangents");
+}
 
-    if (SM_IS_A(argv[0], vec2)) {
-      sm_unwrap_vec2(argv[0], *self);
-      self[0][2] = s_float_lit(0.0);
-      self[0][3] = s_float_lit(1.0);
-      break;
-    }
 
-    /* Optional offset into array provided */
-    if (0) {
-      case 2:
-      arr_index = NUM2SIZET(argv[1]);
-    }
 
-    /* Array of values */
-    if (SM_RB_IS_A(argv[0], rb_cArray)) {
-      VALUE arrdata = argv[0];
-      const size_t arr_end = arr_index + 4;
-      s_float_t *vec_elem = *self;
-      for (; arr_index < arr_end; ++arr_index, ++vec_elem) {
-        *vec_elem = (s_float_t)NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
-      }
-      break;
-    }
+/*
+ * Decodes QTangents encoded by QuatArray#encode_qtangents or
+ * Mat3Array#encode_qtangents and returns a QuatArray of the rotations, with
+ * non-negative W, and a FloatArray holding -1 for each reflected frame and 1
+ * for each other frame. Both are nil if packed is empty. Output and signs, if
+ * given, must hold at least as many elements as packed does.
+ *
+ * call-seq:
+ *    decode_qtangents(packed, output = nil, signs = nil, threads = 1) -> [output, signs]
+ */
+static VALUE sm_quat_array_s_decode_qtangents(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_packed;
+  VALUE sm_out;
+  VALUE sm_signs;
+  VALUE sm_threads;
+  sm_packed_args_t args;
 
-    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Vec4");
-    break;
+  rb_scan_args(argc, argv, "13", &sm_packed, &sm_out, &sm_signs, &sm_threads);
+  args.stride = 8;
+  args.signs = NULL;
+  sm_signs = sm_array_output(sm_signs, s_sm_float_array_klass,
+    sm_packed_input(sm_packed, args.stride, "decode_qtangents"), "decode_qtangents");
+  if (RTEST(sm_signs)) {
+    Data_Get_Struct(sm_signs, s_float_t, args.signs);
   }
+  sm_out = sm_packed_decode(self, sm_packed, sm_out, sm_threads, &args, sm_quat_qtangent_range, "decode_qtangents");
+  return rb_ary_new3(2, sm_out, sm_signs);
+}
 
-  /* W */
-  case 4: {
-    self[0][3] = (s_float_t)NUM2DBL(argv[3]);
-    case 3: /* X, Y, Z */
-    self[0][0] = (s_float_t)NUM2DBL(argv[0]);
-    self[0][1] = (s_float_t)NUM2DBL(argv[1]);
-    self[0][2] = (s_float_t)NUM2DBL(argv[2]);
-    break;
-  }
 
-  default: {
-    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
-    break;
+
+static void sm_rgba8_range(void *context, size_t begin, size_t end)
+{
+  const sm_packed_args_t *args = (const sm_packed_args_t *)context;
+  vec4_t *colors = (vec4_t *)args->elements + begin;
+  uint8_t *bytes = args->bytes + begin * args->stride;
+  if (args->decode) {
+    vec4_array_unpack_rgba8(bytes, end - begin, colors);
+  } else {
+    vec4_array_pack_rgba8((const vec4_t *)colors, end - begin, bytes);
   }
-  } /* switch (argc) */
+}
 
-  return sm_self;
+static void sm_rgb10a2_range(void *context, size_t begin, size_t end)
+{
+  const sm_packed_args_t *args = (const sm_packed_args_t *)context;
+  vec4_t *colors = (vec4_t *)args->elements + begin;
+  uint8_t *bytes = args->bytes + begin * args->stride;
+  if (args->decode) {
+    vec4_array_unpack_rgb10a2(bytes, end - begin, colors);
+  } else {
+    vec4_array_pack_rgb10a2((const vec4_t *)colors, end - begin, bytes);
+  }
 }
 
 
 
 /*
- * Returns a string representation of self.
+ * Packs the RGBA colors in this array to a binary String with one byte per
+ * component, 4 bytes per color. Components are clamped to [0, 1] and rounded.
  *
- *    Vec4[].to_s     # => "{ 0.0, 0.0, 0.0, 1.0 }"
+ * If output is a String, it is resized and the colors are written to it. If
+ * threads is greater than 1, the colors are split across that many threads.
+ * Zero uses one thread per processor.
  *
  * call-seq:
- *    to_s -> string
+ *    pack_rgba8(output = nil, threads = 1) -> output or new string
  */
-static VALUE sm_vec4_to_s(VALUE self)
+static VALUE sm_vec4_array_pack_rgba8(int argc, VALUE *argv, VALUE sm_self)
 {
-  const s_float_t *v;
-  v = (const s_float_t *)*sm_unwrap_vec4(self, NULL);
-  return rb_sprintf(
-    "{ "
-    "%f, %f, %f, %f"
-    " }",
-    v[0], v[1], v[2], v[3]);
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "02", &sm_out, &sm_threads);
+  args.stride = 4;
+  return sm_packed_encode(sm_self, sm_out, sm_threads, &args, sm_rgba8_range, "pack_rgba8");
 }
 
 
 
 /*
- * Returns the squared magnitude of self.
+ * Unpacks colors packed by Vec4Array#pack_rgba8 and returns a Vec4Array
+ * holding them. Returns nil if packed is empty. Output, if given, must hold at
+ * least as many colors as packed does, and threads is as for #pack_rgba8.
  *
  * call-seq:
- *    magnitude_squared -> float
+ *    unpack_rgba8(packed, output = nil, threads = 1) -> output or new vec4_array
  */
-static VALUE sm_vec4_magnitude_squared(VALUE sm_self)
+static VALUE sm_vec4_array_s_unpack_rgba8(int argc, VALUE *argv, VALUE self)
 {
-  return DBL2NUM(vec4_length_squared(*sm_unwrap_vec4(sm_self, NULL)));
+  VALUE sm_packed;
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "12", &sm_packed, &sm_out, &sm_threads);
+  args.stride = 4;
+  return sm_packed_decode(self, sm_packed, sm_out, sm_threads, &args, sm_rgba8_range, "unpack_rgba8");
 }
 
 
 
 /*
- * Returns the magnitude of self.
+ * Packs the RGBA colors in this array to a binary String with one
+ * little-endian 32-bit word per color, holding 10 bits each for red, starting
+ * at the lowest bit, green, and blue, and 2 bits for alpha. This is the layout
+ * of OpenGL's GL_UNSIGNED_INT_2_10_10_10_REV. Components are clamped to
+ * [0, 1] and rounded. Output and threads are as for #pack_rgba8.
  *
  * call-seq:
- *    magnitude -> float
+ *    pack_rgb10a2(output = nil, threads = 1) -> output or new string
  */
-static VALUE sm_vec4_magnitude(VALUE sm_self)
+static VALUE sm_vec4_array_pack_rgb10a2(int argc, VALUE *argv, VALUE sm_self)
 {
-  return DBL2NUM(vec4_length(*sm_unwrap_vec4(sm_self, NULL)));
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_packed_args_t args;
+
+  rb_scan_args(argc, argv, "02", &sm_out, &sm_threads);
+  args.stride = 4;
+  return sm_packed_encode(sm_self, sm_out, sm_threads, &args, sm_rgb10a2_range, "pack_rgb10a2");
 }
 
 
 
 /*
- * Scales this vector or quaternion's components by a scalar value and returns
- * the result. The return type is that of the receiver.
+ * Unpacks colors packed by Vec4Array#pack_rgb10a2 and returns a Vec4Array
+ * holding them. Returns nil if packed is empty. Output and threads are as for
+ * ::unpack_rgba8.
  *
  * call-seq:
- *    scale(scalar, output = nil) -> output or new vec4
+ *    unpack_rgb10a2(packed, output = nil, threads = 1) -> output or new vec4_array
  */
-static VALUE sm_vec4_scale(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec4_array_s_unpack_rgb10a2(int argc, VALUE *argv, VALUE self)
 {
+  VALUE sm_packed;
   VALUE sm_out;
-  VALUE sm_scalar;
-  s_float_t scalar;
-  vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
+  VALUE sm_threads;
+  sm_packed_args_t args;
 
-  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
-  scalar = NUM2DBL(sm_scalar);
+  rb_scan_args(argc, argv, "12", &sm_packed, &sm_out, &sm_threads);
+  args.stride = 4;
+  return sm_packed_decode(self, sm_packed, sm_out, sm_threads, &args, sm_rgb10a2_range, "unpack_rgb10a2");
+}
 
-  if ((SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat))) {
-    rb_check_frozen(sm_out);
-    vec4_scale(*self, scalar, *sm_unwrap_vec4(sm_out, NULL));
-  } else {
-    vec4_t out;
-    vec4_scale(*self, scalar, out);
-    sm_out = sm_wrap_vec4(out, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
+
+
+/*
+  Arguments for sm_color_range.
+*/
+typedef enum sm_color_op_e {
+  SM_COLOR_TO_LINEAR,
+  SM_COLOR_TO_SRGB,
+  SM_COLOR_PREMULTIPLY
+} sm_color_op_t;
+
+typedef struct sm_color_args_s {
+  sm_color_op_t op;
+  int fast;
+  const s_float_t *in;
+  s_float_t *out;
+} sm_color_args_t;
+
+static void sm_color_range(void *context, size_t begin, size_t end)
+{
+  const sm_color_args_t *args = (const sm_color_args_t *)context;
+  const s_float_t *in = args->in + begin * 4;
+  s_float_t *out = args->out + begin * 4;
+  switch (args->op) {
+  case SM_COLOR_TO_LINEAR:   float_array_srgb_to_linear(in, args->fast, out, end - begin); break;
+  case SM_COLOR_TO_SRGB:     float_array_linear_to_srgb(in, args->fast, out, end - begin); break;
+  case SM_COLOR_PREMULTIPLY: float_array_premultiply(in, out, end - begin); break;
   }
+}
+
+static VALUE sm_vec4_array_color(VALUE sm_self, sm_color_op_t op, VALUE sm_fast, VALUE sm_out, VALUE sm_threads, const char *func_name)
+{
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  sm_color_args_t args;
+
+  sm_out = sm_array_output(sm_out, rb_obj_class(sm_self), length, func_name);
+  args.op = op;
+  args.fast = RTEST(sm_fast);
+  Data_Get_Struct(sm_self, s_float_t, args.in);
+  Data_Get_Struct(sm_out, s_float_t, args.out);
+
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_color_range, &args);
 
   return sm_out;
 }
@@ -3657,98 +5019,530 @@ static VALUE sm_vec4_scale(int argc, VALUE *argv, VALUE sm_self)
 
 
 /*
- * Divides this vector or quaternion's components by a scalar value and returns
- * the result. The return type is that of the receiver.
+ * Converts the RGBA colors in this array from sRGB to linear values and
+ * returns an array of the results. Alpha is left unchanged. Values outside
+ * [0, 1] follow the extended sRGB curve.
+ *
+ * If fast is true, the RGB components are clamped to [0, 1] and converted with
+ * a polynomial approximation that is within about 0.002 of the exact curve.
+ * Output may be self. If threads is greater than 1, the colors are split
+ * across that many threads. Zero uses one thread per processor.
  *
  * call-seq:
- *    divide(scalar, output = nil) -> output or new vec4
+ *    to_linear(fast = false, output = nil, threads = 1) -> output or new vec4_array
  */
-static VALUE sm_vec4_divide(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec4_array_to_linear(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_fast;
   VALUE sm_out;
-  VALUE sm_scalar;
-  s_float_t scalar;
-  vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
+  VALUE sm_threads;
+  rb_scan_args(argc, argv, "03", &sm_fast, &sm_out, &sm_threads);
+  return sm_vec4_array_color(sm_self, SM_COLOR_TO_LINEAR, sm_fast, sm_out, sm_threads, "to_linear");
+}
 
-  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
-  scalar = NUM2DBL(sm_scalar);
 
-  if ((SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat))) {
-    rb_check_frozen(sm_out);
-    vec4_divide(*self, scalar, *sm_unwrap_vec4(sm_out, NULL));
-  } else {
-    vec4_t out;
-    vec4_divide(*self, scalar, out);
-    sm_out = sm_wrap_vec4(out, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }
 
-  return sm_out;
+/*
+ * Converts the RGBA colors in this array from linear values to sRGB and
+ * returns an array of the results. Alpha is left unchanged. Fast, output, and
+ * threads are as for #to_linear.
+ *
+ * call-seq:
+ *    to_srgb(fast = false, output = nil, threads = 1) -> output or new vec4_array
+ */
+static VALUE sm_vec4_array_to_srgb(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_fast;
+  VALUE sm_out;
+  VALUE sm_threads;
+  rb_scan_args(argc, argv, "03", &sm_fast, &sm_out, &sm_threads);
+  return sm_vec4_array_color(sm_self, SM_COLOR_TO_SRGB, sm_fast, sm_out, sm_threads, "to_srgb");
 }
 
 
 
 /*
- * Tests this Vec4 or Quat and another Vec4 or Quat for equivalency.
+ * Multiplies the RGB components of the colors in this array by their alpha and
+ * returns an array of the results. Output may be self. If threads is greater
+ * than 1, the colors are split across that many threads. Zero uses one thread
+ * per processor.
  *
  * call-seq:
- *    quat == other_quat -> bool
- *    vec4 == other_vec4 -> bool
- *    quat == vec4       -> bool
- *    vec4 == quat       -> bool
+ *    premultiply(output = nil, threads = 1) -> output or new vec4_array
  */
-static VALUE sm_vec4_equals(VALUE sm_self, VALUE sm_other)
+static VALUE sm_vec4_array_premultiply(int argc, VALUE *argv, VALUE sm_self)
 {
-  if (!RTEST(sm_other) || (!SM_IS_A(sm_other, vec4) && !SM_IS_A(sm_other, quat))) {
-    return Qfalse;
-  }
-
-  return vec4_equals(*sm_unwrap_vec4(sm_self, NULL), *sm_unwrap_vec4(sm_other, NULL)) ? Qtrue : Qfalse;
+  VALUE sm_out;
+  VALUE sm_threads;
+  rb_scan_args(argc, argv, "02", &sm_out, &sm_threads);
+  return sm_vec4_array_color(sm_self, SM_COLOR_PREMULTIPLY, Qfalse, sm_out, sm_threads, "premultiply");
 }
 
 
 
-/*==============================================================================
-
-  quat_t functions
+/*
+  Arguments for sm_delta_mask_range, which works on whole mask bytes so that
+  threads never share one.
+*/
+typedef struct sm_delta_args_s {
+  const s_float_t *current;
+  const s_float_t *baseline;
+  s_float_t thresholds[16];
+  size_t components;
+  size_t length;
+  uint8_t *mask;
+} sm_delta_args_t;
 
-==============================================================================*/
+static void sm_delta_mask_range(void *context, size_t begin, size_t end)
+{
+  const sm_delta_args_t *args = (const sm_delta_args_t *)context;
+  const size_t first = begin * 8;
+  const size_t last = (end * 8 < args->length) ? end * 8 : args->length;
+  float_array_delta_mask(
+    args->current + first * args->components,
+    args->baseline + first * args->components,
+    args->thresholds, args->components, last - first, args->mask + begin);
+}
 
-static VALUE sm_wrap_quat(const quat_t value, VALUE klass)
+/*
+  Reads the thresholds of a delta encoding: nil for 0, a Numeric used for
+  every component, or an element of the array's type with one per component.
+*/
+static void sm_delta_thresholds(VALUE sm_value, VALUE sm_self, s_float_t *thresholds, size_t components, const char *func_name)
 {
-  quat_t *copy;
-  VALUE sm_wrapped = Qnil;
-  if (!RTEST(klass)) {
-    klass = s_sm_quat_klass;
+  const s_float_t *source = NULL;
+  size_t index;
+
+  if (!RTEST(sm_value) || SM_IS_NUMERIC(sm_value)) {
+    const s_float_t threshold = RTEST(sm_value) ? (s_float_t)NUM2DBL(sm_value) : s_float_lit(0.0);
+    for (index = 0; index < components; ++index) {
+      thresholds[index] = threshold;
+    }
+    return;
   }
-  sm_wrapped = Data_Make_Struct(klass, quat_t, 0, free, copy);
+
+  switch (sm_array_kind_of(sm_self)) {
+  case SM_ARRAY_VEC2: source = *sm_vec2_operand(sm_value, NULL); break;
+  case SM_ARRAY_VEC3: source = *sm_vec3_operand(sm_value, NULL); break;
+  case SM_ARRAY_VEC4:
+  case SM_ARRAY_QUAT: source = *sm_vec4_operand(sm_value, NULL); break;
+  case SM_ARRAY_MAT3:
+    if (SM_IS_A(sm_value, mat3)) {
+      source = *sm_unwrap_mat3(sm_value, NULL);
+    }
+    break;
+  case SM_ARRAY_MAT4:
+    if (SM_IS_A(sm_value, mat4)) {
+      source = *sm_unwrap_mat4(sm_value, NULL);
+    }
+    break;
+  default: break;
+  }
+
+  if (!source) {
+    rb_raise(rb_eTypeError,
+      "Invalid thresholds passed to %s: expected Numeric or %s, got %s",
+      func_name,
+      rb_class2name(rb_const_get(rb_obj_class(sm_self), rb_intern("TYPE"))),
+      rb_obj_classname(sm_value));
+  }
+
+  MEMCPY(thresholds, source, s_float_t, components);
+}
+
+
+
+/*
+ * Encodes the elements of this array that differ from the element at the same
+ * index in baseline, an array of the same type and at least the same length,
+ * and returns a binary String holding the encoding. An element differs if any
+ * of its components differs from the baseline's by more than its threshold
+ * or is NaN in only one of them. Thresholds may be nil for 0, a Numeric used for every component, or an
+ * element of this array's type with a threshold per component.
+ *
+ * The encoding is a bitmask of (length + 7) / 8 bytes, with bit i of byte
+ * i / 8 set if element i differs, followed by the components of each element
+ * that differs in order. Components are stored as they are in memory, so both
+ * ends of a stream must be built with the same float type. See #delta_apply!.
+ *
+ * The baseline is not changed. To keep it matched to a receiver, apply the
+ * encoding to it as well, so that elements changing slowly are still sent
+ * once they have drifted past their thresholds.
+ *
+ * If output is a String, it is resized and the encoding is written to it. If
+ * threads is greater than 1, the comparison is split across that many threads.
+ * Zero uses one thread per processor.
+ *
+ * call-seq:
+ *    delta_encode(baseline, thresholds = nil, output = nil, threads = 1) -> output or new string
+ */
+static VALUE sm_mathtype_array_delta_encode(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_baseline;
+  VALUE sm_thresholds;
+  VALUE sm_out;
+  VALUE sm_threads;
+  sm_delta_args_t args;
+  size_t mask_size;
+  size_t changed = 0;
+  size_t index;
+
+  rb_scan_args(argc, argv, "13", &sm_baseline, &sm_thresholds, &sm_out, &sm_threads);
+  args.length = SM_ARRAY_LENGTH(sm_self);
+  args.components = sm_array_kind_elem_size(sm_array_kind_of(sm_self)) / sizeof(s_float_t);
+  sm_array_input(sm_baseline, sm_array_kind_base_class(sm_array_kind_of(sm_self)), args.length, "delta_encode");
+  sm_delta_thresholds(sm_thresholds, sm_self, args.thresholds, args.components, "delta_encode");
+
+  mask_size = (args.length + 7) / 8;
+  sm_out = sm_packed_output(sm_out, mask_size, "delta_encode");
+  Data_Get_Struct(sm_self, s_float_t, args.current);
+  Data_Get_Struct(sm_baseline, s_float_t, args.baseline);
+  args.mask = (uint8_t *)RSTRING_PTR(sm_out);
+
+  s_parallel_for(mask_size, SM_PARALLEL_GRAIN / 8,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_delta_mask_range, &args);
+
+  for (index = 0; index < mask_size; ++index) {
+    unsigned int bits = args.mask[index];
+    for (; bits; bits &= bits - 1) {
+      ++changed;
+    }
+  }
+
+  rb_str_resize(sm_out, (long)(mask_size + changed * args.components * sizeof(s_float_t)));
+  args.mask = (uint8_t *)RSTRING_PTR(sm_out);
+  float_array_delta_gather(args.current, args.mask, args.components, args.length, args.mask + mask_size);
+
+  return sm_out;
+}
+
+
+
+/*
+ * Patches this array in place with an encoding from #delta_encode, made from
+ * an array of the same type and length, and returns self. Elements marked in
+ * the encoding's bitmask are replaced and the rest are left unchanged.
+ *
+ * Raises an ArgumentError if the encoding's size does not match this array's
+ * length and the number of elements it marks.
+ *
+ * call-seq:
+ *    delta_apply!(encoding) -> self
+ */
+static VALUE sm_mathtype_array_delta_apply(VALUE sm_self, VALUE sm_packed)
+{
+  const size_t length = SM_ARRAY_LENGTH(sm_self);
+  const size_t components = sm_array_kind_elem_size(sm_array_kind_of(sm_self)) / sizeof(s_float_t);
+  const size_t mask_size = (length + 7) / 8;
+  const uint8_t *mask;
+  s_float_t *self;
+  size_t changed = 0;
+  size_t index;
+
+  sm_check_writable(sm_self);
+  sm_packed_input(sm_packed, 1, "delta_apply!");
+  if ((size_t)RSTRING_LEN(sm_packed) < mask_size) {
+    rb_raise(rb_eArgError,
+      "Encoding passed to delta_apply! is too short for an array of %zu elements",
+      length);
+  }
+
+  mask = (const uint8_t *)RSTRING_PTR(sm_packed);
+  for (index = 0; index < mask_size; ++index) {
+    unsigned int bits = mask[index];
+    for (; bits; bits &= bits - 1) {
+      ++changed;
+    }
+  }
+
+  if ((length & 7) && (mask[mask_size - 1] >> (length & 7))) {
+    rb_raise(rb_eArgError,
+      "Encoding passed to delta_apply! marks elements past the end of an array of %zu elements",
+      length);
+  } else if ((size_t)RSTRING_LEN(sm_packed) != mask_size + changed * components * sizeof(s_float_t)) {
+    rb_raise(rb_eArgError,
+      "Encoding passed to delta_apply! has %ld bytes, expected %zu for %zu changed elements",
+      RSTRING_LEN(sm_packed), mask_size + changed * components * sizeof(s_float_t), changed);
+  }
+
+  Data_Get_Struct(sm_self, s_float_t, self);
+  float_array_delta_patch(mask, mask + mask_size, components, length, self);
+
+  return sm_self;
+}
+
+
+
+/*
+ * Returns a 64-bit hash of this array's memory as an Integer. Arrays with the
+ * same contents give the same digest for the same seed, so comparing digests
+ * tells whether an array has changed without keeping a copy of it. This is not
+ * a cryptographic hash.
+ *
+ * Components are hashed as they are in memory, so 0.0 and -0.0 hash
+ * differently, and digests only match between builds using the same float type
+ * and byte order.
+ *
+ * call-seq:
+ *    digest(seed = 0) -> integer
+ */
+static VALUE sm_mathtype_array_digest(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_seed;
+  const void *self;
+  size_t bytes;
+
+  rb_scan_args(argc, argv, "01", &sm_seed);
+  bytes = SM_ARRAY_LENGTH(sm_self) * sm_array_kind_elem_size(sm_array_kind_of(sm_self));
+  Data_Get_Struct(sm_self, void, self);
+  return ULL2NUM(s_hash_bytes(self, bytes, RTEST(sm_seed) ? NUM2ULL(sm_seed) : 0));
+}
+
+
+
+/*
+ * Returns whether other is an array of the same type and length whose memory
+ * is identical to this array's. Components are compared bitwise, so 0.0 and
+ * -0.0 differ and NaN is equal to itself. See #approx_equal to compare
+ * components within a tolerance.
+ *
+ * call-seq: array == other -> bool
+ */
+static VALUE sm_mathtype_array_equals(VALUE sm_self, VALUE sm_other)
+{
+  const sm_array_kind_t kind = sm_array_kind_of(sm_self);
+  const void *self;
+  const void *other;
+  size_t length;
+
+  if (sm_self == sm_other) {
+    return Qtrue;
+  } else if (sm_array_kind_of(sm_other) != kind) {
+    return Qfalse;
+  }
+
+  length = SM_ARRAY_LENGTH(sm_self);
+  if (SM_ARRAY_LENGTH(sm_other) != length) {
+    return Qfalse;
+  }
+
+  Data_Get_Struct(sm_self, void, self);
+  Data_Get_Struct(sm_other, void, other);
+  /* Snapshots share memory until written to, so skip comparing it. */
+  if (self == other) {
+    return Qtrue;
+  }
+  return MEMCMP(self, other, char, length * sm_array_kind_elem_size(kind)) == 0 ? Qtrue : Qfalse;
+}
+
+
+
+/*
+ * Returns whether other is of the same class as this array and equal to it by
+ * #==. Together with #hash, this lets arrays be used as Hash keys, though an
+ * array must not be modified while it's a key.
+ *
+ * call-seq: eql?(other) -> bool
+ */
+static VALUE sm_mathtype_array_eql(VALUE sm_self, VALUE sm_other)
+{
+  if (rb_obj_class(sm_self) != rb_obj_class(sm_other)) {
+    return Qfalse;
+  }
+  return sm_mathtype_array_equals(sm_self, sm_other);
+}
+
+
+
+/*
+ * Returns a hash code for this array's contents, derived from #digest.
+ *
+ * call-seq: hash -> fixnum
+ */
+static VALUE sm_mathtype_array_hash(VALUE sm_self)
+{
+  const uint64_t digest = NUM2ULL(sm_mathtype_array_digest(0, NULL, sm_self));
+  return LONG2FIX((long)(digest & (uint64_t)FIXNUM_MAX));
+}
+
+
+
+/*
+  Arguments for sm_approx_equal_range.
+*/
+typedef struct sm_approx_equal_args_s {
+  const s_float_t *left;
+  const s_float_t *right;
+  size_t components;
+  s_float_t epsilon;
+  uint64_t ulps;
+  int use_ulps;
+  s_float_t *mask;
+} sm_approx_equal_args_t;
+
+static void sm_approx_equal_range(void *context, size_t begin, size_t end)
+{
+  const sm_approx_equal_args_t *args = (const sm_approx_equal_args_t *)context;
+  float_array_approx_equal(
+    args->left + begin * args->components,
+    args->right + begin * args->components,
+    args->components, end - begin,
+    args->epsilon, args->ulps, args->use_ulps,
+    args->mask + begin);
+}
+
+/*
+ * Compares this array with other, an array of the same type, element by
+ * element. Two elements are equal if each of their components are within
+ * tolerance of each other: if tolerance is an Integer, it's a number of units
+ * in the last place, otherwise it's an absolute difference. Equal components
+ * are always equal and NaN is never equal to anything.
+ *
+ * If mask is nil or false, returns true if other has the same length as this
+ * array and all of their elements are equal, stopping at the first that
+ * isn't. Otherwise, returns a FloatArray holding 1 for each equal element and
+ * 0 for each other, which is written to mask if mask is a FloatArray. Other
+ * must then have at least this array's length. If threads is greater than 1,
+ * the mask is filled using that many threads. Zero uses one thread per
+ * processor.
+ *
+ * call-seq:
+ *    approx_equal(other, tolerance = 0, mask = false, threads = 1) -> true, false, or mask
+ */
+static VALUE sm_mathtype_array_approx_equal(int argc, VALUE *argv, VALUE sm_self)
+{
+  const VALUE array_klass = sm_array_kind_base_class(sm_array_kind_of(sm_self));
+  VALUE sm_other;
+  VALUE sm_tolerance;
+  VALUE sm_mask;
+  VALUE sm_threads;
+  sm_approx_equal_args_t args;
+  size_t length;
+  size_t begin;
+
+  rb_scan_args(argc, argv, "13", &sm_other, &sm_tolerance, &sm_mask, &sm_threads);
+  length = SM_ARRAY_LENGTH(sm_self);
+  args.components = sm_array_kind_elem_size(sm_array_kind_of(sm_self)) / sizeof(s_float_t);
+  args.epsilon = s_float_lit(0.0);
+  args.ulps = 0;
+  args.use_ulps = 1;
+
+  if (FIXNUM_P(sm_tolerance) || RB_TYPE_P(sm_tolerance, T_BIGNUM)) {
+    if (RTEST(rb_funcall(sm_tolerance, '<', 1, INT2FIX(0)))) {
+      rb_raise(rb_eArgError, "Tolerance passed to approx_equal must not be negative");
+    }
+    args.ulps = NUM2ULL(sm_tolerance);
+  } else if (RTEST(sm_tolerance)) {
+    args.epsilon = (s_float_t)NUM2DBL(sm_tolerance);
+    args.use_ulps = 0;
+  }
+
+  if (!SM_RB_IS_A(sm_other, array_klass)) {
+    rb_raise(rb_eTypeError,
+      "Invalid argument to approx_equal: expected %s, got %s",
+      rb_class2name(array_klass),
+      rb_obj_classname(sm_other));
+  }
+
+  if (!RTEST(sm_mask)) {
+    if (SM_ARRAY_LENGTH(sm_other) != length) {
+      return Qfalse;
+    }
+    Data_Get_Struct(sm_self, s_float_t, args.left);
+    Data_Get_Struct(sm_other, s_float_t, args.right);
+    for (begin = 0; begin < length; begin += SM_PARALLEL_GRAIN) {
+      const size_t count = (length - begin < SM_PARALLEL_GRAIN) ? length - begin : SM_PARALLEL_GRAIN;
+      if (float_array_approx_equal(
+            args.left + begin * args.components, args.right + begin * args.components,
+            args.components, count, args.epsilon, args.ulps, args.use_ulps, NULL) != count) {
+        return Qfalse;
+      }
+    }
+    return Qtrue;
+  }
+
+  sm_array_input(sm_other, array_klass, length, "approx_equal");
+  sm_mask = sm_array_output(sm_mask == Qtrue ? Qnil : sm_mask, s_sm_float_array_klass, length, "approx_equal");
+  Data_Get_Struct(sm_self, s_float_t, args.left);
+  Data_Get_Struct(sm_other, s_float_t, args.right);
+  Data_Get_Struct(sm_mask, s_float_t, args.mask);
+
+  s_parallel_for(length, SM_PARALLEL_GRAIN,
+    RTEST(sm_threads) ? NUM2INT(sm_threads) : 1,
+    sm_approx_equal_range, &args);
+
+  return sm_mask;
+}
+
+
+
+#endif /* BUILD_ARRAY_TYPE */
+
+
+
+/*==============================================================================
+
+  vec2_t functions
+
+==============================================================================*/
+
+static VALUE sm_wrap_vec2(const vec2_t value, VALUE klass)
+{
+  vec2_t *copy;
+  VALUE sm_wrapped = Qnil;
+  if (!RTEST(klass)) {
+    klass = s_sm_vec2_klass;
+  }
+  sm_wrapped = Data_Make_Struct(klass, vec2_t, 0, free, copy);
   if (value) {
-    quat_copy(value, *copy);
+    vec2_copy(value, *copy);
   }
   return sm_wrapped;
 }
 
 
 
-static quat_t *sm_unwrap_quat(VALUE sm_value, quat_t store)
+static vec2_t *sm_unwrap_vec2(VALUE sm_value, vec2_t store)
 {
-  quat_t *value;
-  Data_Get_Struct(sm_value, quat_t, value);
-  if(store) quat_copy(*value, store);
+  vec2_t *value;
+  Data_Get_Struct(sm_value, vec2_t, value);
+  if(store) vec2_copy(*value, store);
   return value;
 }
 
 
 
 /*
- * Gets the component of the Quat at the given index.
+  Unwraps the right-hand operand of a binary Vec2 operation, raising a TypeError
+  if it isn't a compatible vector. If broadcast is non-NULL and the operand is
+  a Numeric, broadcast is filled with its value and returned instead.
+*/
+static vec2_t *sm_vec2_operand(VALUE sm_rhs, vec2_t broadcast)
+{
+  if (broadcast && SM_IS_NUMERIC(sm_rhs)) {
+    broadcast[0] =
+    broadcast[1] = (s_float_t)NUM2DBL(sm_rhs);
+    return (vec2_t *)broadcast;
+  } else if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+  }
+  return sm_unwrap_vec2(sm_rhs, NULL);
+}
+
+
+
+/*
+ * Gets the component of the Vec2 at the given index.
  *
  * call-seq: fetch(index) -> float
  */
-static VALUE sm_quat_fetch (VALUE sm_self, VALUE sm_index)
+static VALUE sm_vec2_fetch (VALUE sm_self, VALUE sm_index)
 {
-  static const int max_index = sizeof(quat_t) / sizeof(s_float_t);
-  const quat_t *self = sm_unwrap_quat(sm_self, NULL);
+  static const int max_index = sizeof(vec2_t) / sizeof(s_float_t);
+  const vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
   int index = NUM2INT(sm_index);
   if (index < 0 || index >= max_index) {
     rb_raise(rb_eRangeError,
@@ -3760,16 +5554,17 @@ static VALUE sm_quat_fetch (VALUE sm_self, VALUE sm_index)
 
 
 /*
- * Sets the Quat's component at the index to the value.
+ * Sets the Vec2's component at the index to the value.
  *
  * call-seq: store(index, value) -> value
  */
-static VALUE sm_quat_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_vec2_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
 {
-  static const int max_index = sizeof(quat_t) / sizeof(s_float_t);
-  quat_t *self = sm_unwrap_quat(sm_self, NULL);
+  static const int max_index = sizeof(vec2_t) / sizeof(s_float_t);
+  vec2_t *self;
   int index = NUM2INT(sm_index);
-  rb_check_frozen(sm_self);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_vec2(sm_self, NULL);
   if (index < 0 || index >= max_index) {
     rb_raise(rb_eRangeError,
       "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
@@ -3781,66 +5576,65 @@ static VALUE sm_quat_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
 
 
 /*
- * Returns the length in bytes of the Quat. When compiled to use doubles as the
- * base type, this is always 32. Otherwise, when compiled to use floats, it's
- * always 16.
+ * Returns the length in bytes of the Vec2. When compiled to use doubles as the
+ * base type, this is always 16. Otherwise, when compiled to use floats, it's
+ * always 8.
  *
  * call-seq: size -> fixnum
  */
-static VALUE sm_quat_size (VALUE self)
+static VALUE sm_vec2_size (VALUE self)
 {
-  return SIZET2NUM(sizeof(quat_t));
+  return SIZET2NUM(sizeof(vec2_t));
 }
 
 
 
 /*
- * Returns the length of the Quat in components. Result is always 4.
+ * Returns the length of the Vec2 in components. Result is always 2.
  *
  * call-seq: length -> fixnum
  */
-static VALUE sm_quat_length (VALUE self)
+static VALUE sm_vec2_length (VALUE self)
 {
-  return SIZET2NUM(sizeof(quat_t) / sizeof(s_float_t));
+  return SIZET2NUM(sizeof(vec2_t) / sizeof(s_float_t));
 }
 
 
 
 /*
- * Returns the inverse of this Quat. Note that this is not the same as the
- * inverse of, for example, a Vec4.
+ * Returns a copy of self.
  *
  * call-seq:
- *    inverse(output = nil) -> output or new quat
+ *    copy(output = nil) -> output or new vec2
  */
-static VALUE sm_quat_inverse(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_copy(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_out;
-  quat_t *self;
+  vec2_t *self;
   rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_quat(sm_self, NULL);
+  self = sm_unwrap_vec2(sm_self, NULL);
   if (argc == 1) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    quat_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+   vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
       rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
         rb_obj_classname(sm_out));
       return Qnil;
     }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_quat(sm_out, NULL);
-    quat_inverse (*self, *output);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_copy (*self, *output);
   }} else if (argc == 0) {
 SM_LABEL(skip_output): {
-    quat_t output;
-    quat_inverse (*self, output);
-    sm_out = sm_wrap_quat(output, rb_obj_class(sm_self));
+    vec2_t output;
+    vec2_copy (*self, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
+    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
   }
   return sm_out;
 }
@@ -3848,48 +5642,40 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Concatenates this quaternion and another and returns the result.
+ * Returns a vector whose components are the multiplicative inverse of this
+ * vector's.
  *
  * call-seq:
- *    multiply_quat(quat, output = nil) -> output or new quat
+ *    normalize(output = nil) -> output or new vec2
  */
-static VALUE sm_quat_multiply(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_normalize(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
   VALUE sm_out;
-  quat_t *self;
-  quat_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_quat(sm_self, NULL);
-  if (!!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_quat(sm_rhs, NULL);
-  if (argc == 2) {
+  vec2_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (argc == 1) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    quat_t *output;
-    if (!!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
       rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
         rb_obj_classname(sm_out));
       return Qnil;
     }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_quat(sm_out, NULL);
-    quat_multiply(*self, *rhs, *output);
-  }} else if (argc == 1) {
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_normalize (*self, *output);
+  }} else if (argc == 0) {
 SM_LABEL(skip_output): {
-    quat_t output;
-    quat_multiply(*self, *rhs, output);
-    sm_out = sm_wrap_quat(output, rb_obj_class(sm_self));
+    vec2_t output;
+    vec2_normalize (*self, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_quat");
+    rb_raise(rb_eArgError, "Invalid number of arguments to normalize");
   }
   return sm_out;
 }
@@ -3897,48 +5683,40 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Multiplies a quaternion and vec3, returning the rotated vec3.
+ * Returns a vector whose components are the multiplicative inverse of this
+ * vector's.
  *
  * call-seq:
- *    multiply_vec3(quat, output = nil) -> output or new quat
+ *    inverse(output = nil) -> output or new vec2
  */
-static VALUE sm_quat_multiply_vec3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_inverse(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
   VALUE sm_out;
-  quat_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_quat(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
+  vec2_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (argc == 1) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
       rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
         rb_obj_classname(sm_out));
       return Qnil;
     }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    quat_multiply_vec3(*self, *rhs, *output);
-  }} else if (argc == 1) {
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_inverse (*self, *output);
+  }} else if (argc == 0) {
 SM_LABEL(skip_output): {
-    vec3_t output;
-    quat_multiply_vec3(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
+    vec2_t output;
+    vec2_inverse (*self, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_vec3");
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
   }
   return sm_out;
 }
@@ -3946,375 +5724,357 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Allocates a new Quat.
- *
- * call-seq:
- *    new()               -> new identity quaternion
- *    new(x, y, z, w = 1) -> new quaternion with components [x, y, z, w]
- *    new([x, y, z, w])   -> new quaternion with components [x, y, z, w]
- *    new(quat)           -> copy of quat
- *    new(vec3)           -> new quaternion with the components [vec3.xyz, 1]
- *    new(vec4)           -> new quaternion with the components of vec4
- *    new(mat3)           -> new quaternion from mat3
- *    new(mat4)           -> new quaternion from mat4
- */
-static VALUE sm_quat_new(int argc, VALUE *argv, VALUE self)
-{
-  VALUE sm_quat = sm_wrap_quat(g_quat_identity, self);
-  rb_obj_call_init(sm_quat, argc, argv);
-  return sm_quat;
-}
-
-
-
-/*
- * Sets the Quat's components.
+ * Negates this vector's components and returns the result.
  *
  * call-seq:
- *    set(x, y, z, w = 1) -> new quaternion with components [x, y, z, w]
- *    set([x, y, z, w])   -> new quaternion with components [x, y, z, w]
- *    set(quat)           -> copy of quat
- *    set(vec2)           -> new quaternion with the components [vec2.xy, 0, 1]
- *    set(vec3)           -> new quaternion with the components [vec3.xyz, 1]
- *    set(vec4)           -> new quaternion with the components of vec4
- *    set(mat3)           -> new quaternion from mat3
- *    set(mat4)           -> new quaternion from mat4
+ *    negate(output = nil) -> output or new vec2
  */
-static VALUE sm_quat_init(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_negate(int argc, VALUE *argv, VALUE sm_self)
 {
-  quat_t *self = sm_unwrap_quat(sm_self, NULL);
-  size_t arr_index = 0;
-
-  rb_check_frozen(sm_self);
-
-  switch(argc) {
-
-  /* Default value */
-  case 0: { break; }
-
-  /* Copy or by-array */
-  case 1: {
-    if (SM_IS_A(argv[0], quat) ||
-        SM_IS_A(argv[0], vec4)) {
-      sm_unwrap_quat(argv[0], *self);
-      break;
-    }
-
-    if (SM_IS_A(argv[0], vec2)) {
-      sm_unwrap_vec2(argv[0], *self);
-      self[0][2] = s_float_lit(0.0);
-      self[0][3] = s_float_lit(1.0);
-      break;
-    }
-
-    if (SM_IS_A(argv[0], vec3)) {
-      sm_unwrap_vec3(argv[0], *self);
-      self[0][3] = s_float_lit(1.0);
-      break;
-    }
-
-    if (SM_IS_A(argv[0], mat4)) {
-      const mat4_t *mat = sm_unwrap_mat4(argv[0], NULL);
-      quat_from_mat4(*mat, *self);
-      break;
-    }
-
-    if (SM_IS_A(argv[0], mat3)) {
-      const mat3_t *mat = sm_unwrap_mat3(argv[0], NULL);
-      quat_from_mat3(*mat, *self);
-      break;
-    }
-
-    /* Optional offset into array provided */
-    if (0) {
-      case 2:
-      arr_index = NUM2SIZET(argv[1]);
-    }
-
-    /* Array of values */
-    if (SM_RB_IS_A(argv[0], rb_cArray)) {
-      VALUE arrdata = argv[0];
-      const size_t arr_end = arr_index + 3;
-      s_float_t *vec_elem = *self;
-      for (; arr_index < arr_end; ++arr_index, ++vec_elem) {
-        *vec_elem = (s_float_t)NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
-      }
-      break;
+  VALUE sm_out;
+  vec2_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
     }
-
-    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Quat");
-    break;
-  }
-
-  /* W */
-  case 4: {
-    self[0][3] = (s_float_t)NUM2DBL(argv[3]);
-    case 3: /* X, Y, Z */
-    self[0][0] = (s_float_t)NUM2DBL(argv[0]);
-    self[0][1] = (s_float_t)NUM2DBL(argv[1]);
-    self[0][2] = (s_float_t)NUM2DBL(argv[2]);
-    break;
-  }
-
-  default: {
-    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
-    break;
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_negate (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec2_t output;
+    vec2_negate (*self, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to negate");
   }
-  } /* switch (argc) */
-
-  return sm_self;
+  return sm_out;
 }
 
 
 
 /*
- * Returns a string representation of self.
- *
- *    Quat[].to_s     # => "{ 0.0, 0.0, 0.0, 1.0 }"
+ * Projects this vector onto a normal vector and returns the result.
  *
  * call-seq:
- *    to_s -> string
+ *    project(normal, output = nil) -> output or new vec2
  */
-static VALUE sm_quat_to_s(VALUE self)
+static VALUE sm_vec2_project(int argc, VALUE *argv, VALUE sm_self)
 {
-  const s_float_t *v;
-  v = (const s_float_t *)*sm_unwrap_quat(self, NULL);
-  return rb_sprintf(
-    "{ "
-    "%f, %f, %f, %f"
-    " }",
-    v[0], v[1], v[2], v[3]);
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec2_t *self;
+  vec2_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec2(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_project(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec2_t output;
+    vec2_project(*self, *rhs, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to project");
+  }
+  return sm_out;
 }
 
 
 
 /*
- * Returns a quaternion describing a rotation around a given axis.
+ * Reflects this vector against a normal vector and returns the result.
  *
  * call-seq:
- *    angle_axis(angle_degrees, axis_vec3, output = nil) -> output or new quat
+ *    reflect(normal, output = nil) -> output or new vec2
  */
-static VALUE sm_quat_angle_axis(int argc, VALUE *argv, VALUE self)
+static VALUE sm_vec2_reflect(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_angle;
-  VALUE sm_axis;
+  VALUE sm_rhs;
   VALUE sm_out;
-  s_float_t angle;
-  const vec3_t *axis;
-
-  rb_scan_args(argc, argv, "21", &sm_angle, &sm_axis, &sm_out);
-  if (!SM_IS_A(sm_axis, vec3) && !SM_IS_A(sm_axis, vec4) && !SM_IS_A(sm_axis, quat)) {
+  vec2_t *self;
+  vec2_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
     rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_axis));
+      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
     return Qnil;
   }
-
-  angle = (s_float_t)NUM2DBL(sm_angle);
-  axis = sm_unwrap_vec3(sm_axis, NULL);
-
-  if (SM_IS_A(sm_out, quat) || SM_IS_A(sm_out, vec4)) {
-    rb_check_frozen(sm_out);
-    quat_t *out = sm_unwrap_quat(sm_out, NULL);
-    quat_from_angle_axis(angle, (*axis)[0], (*axis)[1], (*axis)[2], *out);
-  } else {
-    quat_t out;
-    quat_from_angle_axis(angle, (*axis)[0], (*axis)[1], (*axis)[2], out);
-    sm_out = sm_wrap_quat(out, self);
+  rhs = sm_unwrap_vec2(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_reflect(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec2_t output;
+    vec2_reflect(*self, *rhs, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to reflect");
   }
-
   return sm_out;
 }
 
 
 
 /*
- * Sets self to the identity quaternion.
- *
- * call-seq:
- *    load_identity -> self
- */
-static VALUE sm_quat_identity(VALUE sm_self)
-{
-  quat_t *self = sm_unwrap_quat(sm_self, NULL);
-  quat_identity(*self);
-  return sm_self;
-}
-
-
-
-/*
- * Returns a quaternion interpolated between self and destination using
- * spherical linear interpolation. Alpha is the interpolation value and must be
- * clamped from 0 to 1.
+ * Multiplies this and another vector's components together and returns the
+ * result.
  *
  * call-seq:
- *    slerp(destination, alpha, output = nil) -> output or new quat
+ *    multiply_vec2(vec2, output = nil) -> output or new vec2
  */
-static VALUE sm_quat_slerp(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_multiply(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_rhs;
   VALUE sm_out;
-  VALUE sm_destination;
-  VALUE sm_alpha;
-  quat_t *destination;
-  quat_t *self = sm_unwrap_vec4(sm_self, NULL);
-  s_float_t alpha;
-
-  rb_scan_args(argc, argv, "21", &sm_destination, &sm_alpha, &sm_out);
-  alpha = NUM2DBL(sm_alpha);
-
-  if (!SM_IS_A(sm_destination, vec4) && !SM_IS_A(sm_destination, quat)) {
+  vec2_t *self;
+  vec2_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec2) && !SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
     rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_destination));
+      kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
     return Qnil;
   }
-
-  destination = sm_unwrap_quat(sm_destination, NULL);
-
-  if ((SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat))) {
-    rb_check_frozen(sm_out);
-    quat_slerp(*self, *destination, alpha, *sm_unwrap_quat(sm_out, NULL));
-  } else {
-    quat_t out;
-    quat_slerp(*self, *destination, alpha, out);
-    sm_out = sm_wrap_quat(out, rb_obj_class(sm_self));
+  rhs = sm_unwrap_vec2(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_multiply(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec2_t output;
+    vec2_multiply(*self, *rhs, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to multiply");
   }
-
   return sm_out;
 }
 
 
 
-/*==============================================================================
-
-  mat4_t functions
-
-==============================================================================*/
-
-static VALUE sm_wrap_mat4(const mat4_t value, VALUE klass)
+/*
+ * Adds this and another vector's components together and returns the result.
+ *
+ * If given a Numeric, it is added to every component.
+ *
+ * call-seq:
+ *    add(vec2, output = nil) -> output or new vec2
+ *    add(scalar, output = nil) -> output or new vec2
+ */
+static VALUE sm_vec2_add(int argc, VALUE *argv, VALUE sm_self)
 {
-  mat4_t *copy;
-  VALUE sm_wrapped = Qnil;
-  if (!RTEST(klass)) {
-    klass = s_sm_mat4_klass;
-  }
-  sm_wrapped = Data_Make_Struct(klass, mat4_t, 0, free, copy);
-  if (value) {
-    mat4_copy(value, *copy);
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec2_t *self;
+  vec2_t *rhs;
+  vec2_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  rhs = sm_vec2_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_add(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec2_t output;
+    vec2_add(*self, *rhs, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to add");
   }
-  return sm_wrapped;
-}
-
-
-
-static mat4_t *sm_unwrap_mat4(VALUE sm_value, mat4_t store)
-{
-  mat4_t *value;
-  Data_Get_Struct(sm_value, mat4_t, value);
-  if(store) mat4_copy(*value, store);
-  return value;
+  return sm_out;
 }
 
 
 
 /*
- * Gets the component of the Mat4 at the given index.
+ * Subtracts another vector's components from this vector's and returns the
+ * result.
  *
- * call-seq: fetch(index) -> float
+ * If given a Numeric, it is subtracted from every component.
+ *
+ * call-seq:
+ *    subtract(vec2, output = nil) -> output or new vec2
+ *    subtract(scalar, output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_fetch (VALUE sm_self, VALUE sm_index)
+static VALUE sm_vec2_subtract(int argc, VALUE *argv, VALUE sm_self)
 {
-  static const int max_index = sizeof(mat4_t) / sizeof(s_float_t);
-  const mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  if (index < 0 || index >= max_index) {
-    rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec2_t *self;
+  vec2_t *rhs;
+  vec2_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  rhs = sm_vec2_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_subtract(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec2_t output;
+    vec2_subtract(*self, *rhs, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to subtract");
   }
-  return DBL2NUM(self[0][NUM2INT(sm_index)]);
+  return sm_out;
 }
 
 
 
 /*
- * Sets the Mat4's component at the index to the value.
+ * Returns the dot product of this and another Vec2 or the XY components of a
+ * Vec3, Vec4, or Quat.
  *
- * call-seq: store(index, value) -> value
+ * call-seq:
+ *    dot_product(vec2) -> float
+ *    dot_product(vec3) -> float
+ *    dot_product(vec4) -> float
+ *    dot_product(quat) -> float
  */
-static VALUE sm_mat4_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_vec2_dot_product(VALUE sm_self, VALUE sm_other)
 {
-  static const int max_index = sizeof(mat4_t) / sizeof(s_float_t);
-  mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  rb_check_frozen(sm_self);
-  if (index < 0 || index >= max_index) {
-    rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  if (!SM_IS_A(sm_other, vec2) &&
+      !SM_IS_A(sm_other, vec3) &&
+      !SM_IS_A(sm_other, vec4) &&
+      !SM_IS_A(sm_other, quat)) {
+    rb_raise(rb_eArgError,
+      "Expected a Vec2, Vec3, Vec4, or Quat, got %s",
+      rb_obj_classname(sm_other));
+    return Qnil;
   }
-  self[0][index] = (s_float_t)NUM2DBL(sm_value);
-  return sm_value;
+  return DBL2NUM(
+    vec2_dot_product(
+      *sm_unwrap_vec2(sm_self, NULL),
+      *sm_unwrap_vec2(sm_other, NULL)));
 }
 
 
 
 /*
- * Returns the length in bytes of the Mat4. When compiled to use doubles as the
- * base type, this is always 128. Otherwise, when compiled to use floats, it's
- * always 64.
- *
- * call-seq: size -> fixnum
- */
-static VALUE sm_mat4_size (VALUE self)
-{
-  return SIZET2NUM(sizeof(mat4_t));
-}
-
-
-
-/*
- * Returns the length of the Mat4 in components. Result is always 16.
- *
- * call-seq: length -> fixnum
- */
-static VALUE sm_mat4_length (VALUE self)
-{
-  return SIZET2NUM(sizeof(mat4_t) / sizeof(s_float_t));
-}
-
-
-
-/*
- * Returns a copy of self.
+ * Returns a vector of the smaller of each pair of components from this vector
+ * and another. If given a Numeric, each component is compared against it.
  *
  * call-seq:
- *    copy(output = nil) -> output or new mat4
+ *    component_min(vec2, output = nil) -> output or new vec2
+ *    component_min(scalar, output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_copy(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_component_min(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_rhs;
   VALUE sm_out;
-  mat4_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  if (argc == 1) {
+  vec2_t *self;
+  vec2_t *rhs;
+  vec2_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  rhs = sm_vec2_operand(sm_rhs, broadcast);
+  if (argc == 2) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    mat4_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat4(sm_out, NULL);
-    mat4_copy (*self, *output);
-  }} else if (argc == 0) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_min(*self, *rhs, *output);
+  }} else if (argc == 1) {
 SM_LABEL(skip_output): {
-    mat4_t output;
-    mat4_copy (*self, output);
-    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    vec2_t output;
+    vec2_min(*self, *rhs, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
+    rb_raise(rb_eArgError, "Invalid number of arguments to component_min");
   }
   return sm_out;
 }
@@ -4322,34 +6082,45 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Converts the Mat4 to a Mat3.
+ * Returns a vector of the larger of each pair of components from this vector
+ * and another. If given a Numeric, each component is compared against it.
  *
  * call-seq:
- *    to_mat3(output = nil) -> output or new mat3
+ *    component_max(vec2, output = nil) -> output or new vec2
+ *    component_max(scalar, output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_to_mat3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_component_max(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_rhs;
   VALUE sm_out;
-  mat4_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  if (argc == 1) {
+  vec2_t *self;
+  vec2_t *rhs;
+  vec2_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  rhs = sm_vec2_operand(sm_rhs, broadcast);
+  if (argc == 2) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    mat3_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat3(sm_out, NULL);
-    mat4_to_mat3 (*self, *output);
-  }} else if (argc == 0) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_max(*self, *rhs, *output);
+  }} else if (argc == 1) {
 SM_LABEL(skip_output): {
-    mat3_t output;
-    mat4_to_mat3 (*self, output);
-    sm_out = sm_wrap_mat3(output, s_sm_mat3_klass);
+    vec2_t output;
+    vec2_max(*self, *rhs, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to to_mat3");
+    rb_raise(rb_eArgError, "Invalid number of arguments to component_max");
   }
   return sm_out;
 }
@@ -4357,34 +6128,49 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Transposes this matrix and returns the result.
+ * Clamps each component of this vector to the range given by the same
+ * components of lower and upper and returns the result. Either bound may be a
+ * Numeric, which applies to every component.
  *
  * call-seq:
- *    transpose(output = nil) -> output or new mat4
+ *    clamp(lower, upper, output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_transpose(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_clamp(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_lower;
+  VALUE sm_upper;
   VALUE sm_out;
-  mat4_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  if (argc == 1) {
+  vec2_t *self;
+  vec2_t *lower;
+  vec2_t *upper;
+  vec2_t lower_broadcast;
+  vec2_t upper_broadcast;
+  rb_scan_args(argc, argv, "21", &sm_lower, &sm_upper, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  lower = sm_vec2_operand(sm_lower, lower_broadcast);
+  upper = sm_vec2_operand(sm_upper, upper_broadcast);
+  if (argc == 3) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    mat4_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat4(sm_out, NULL);
-    mat4_transpose (*self, *output);
-  }} else if (argc == 0) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_clamp(*self, *lower, *upper, *output);
+  }} else if (argc == 2) {
 SM_LABEL(skip_output): {
-    mat4_t output;
-    mat4_transpose (*self, output);
-    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    vec2_t output;
+    vec2_clamp(*self, *lower, *upper, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to transpose");
+    rb_raise(rb_eArgError, "Invalid number of arguments to clamp");
   }
   return sm_out;
 }
@@ -4392,34 +6178,46 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Returns an inverse orthogonal matrix.
+ * Linearly interpolates between this vector and destination by alpha and
+ * returns the result. Alpha is not clamped.
  *
  * call-seq:
- *    inverse_orthogonal(output = nil) -> output or new mat4
+ *    lerp(destination, alpha, output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_inverse_orthogonal(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_lerp(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_destination;
+  VALUE sm_alpha;
   VALUE sm_out;
-  mat4_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  if (argc == 1) {
+  vec2_t *self;
+  vec2_t *destination;
+  s_float_t alpha;
+  rb_scan_args(argc, argv, "21", &sm_destination, &sm_alpha, &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  destination = sm_vec2_operand(sm_destination, NULL);
+  alpha = (s_float_t)NUM2DBL(sm_alpha);
+  if (argc == 3) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    mat4_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat4(sm_out, NULL);
-    mat4_inverse_orthogonal (*self, *output);
-  }} else if (argc == 0) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_lerp(*self, *destination, alpha, *output);
+  }} else if (argc == 2) {
 SM_LABEL(skip_output): {
-    mat4_t output;
-    mat4_inverse_orthogonal (*self, output);
-    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    vec2_t output;
+    vec2_lerp(*self, *destination, alpha, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_orthogonal");
+    rb_raise(rb_eArgError, "Invalid number of arguments to lerp");
   }
   return sm_out;
 }
@@ -4427,34 +6225,39 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Returns an adjoint matrix.
+ * Returns a vector of the absolute values of this vector's components.
  *
  * call-seq:
- *    adjoint(output = nil) -> output or new mat4
+ *    abs(output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_adjoint(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_abs(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_out;
-  mat4_t *self;
+  vec2_t *self;
   rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
+  self = sm_unwrap_vec2(sm_self, NULL);
   if (argc == 1) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    mat4_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat4(sm_out, NULL);
-    mat4_adjoint (*self, *output);
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_abs(*self, *output);
   }} else if (argc == 0) {
 SM_LABEL(skip_output): {
-    mat4_t output;
-    mat4_adjoint (*self, output);
-    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    vec2_t output;
+    vec2_abs(*self, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to adjoint");
+    rb_raise(rb_eArgError, "Invalid number of arguments to abs");
   }
   return sm_out;
 }
@@ -4462,38 +6265,39 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Multiplies this and another Mat4 together and returns the result.
+ * Rounds each of this vector's components down and returns the result.
  *
  * call-seq:
- *    multiply_mat4(mat4, output = nil) -> output or new mat4
+ *    floor(output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_multiply(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_floor(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
   VALUE sm_out;
-  mat4_t *self;
-  mat4_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  SM_RAISE_IF_NOT_TYPE(sm_rhs, mat4);
-  rhs = sm_unwrap_mat4(sm_rhs, NULL);
-  if (argc == 2) {
+  vec2_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (argc == 1) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    mat4_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat4(sm_out, NULL);
-    mat4_multiply(*self, *rhs, *output);
-  }} else if (argc == 1) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_floor(*self, *output);
+  }} else if (argc == 0) {
 SM_LABEL(skip_output): {
-    mat4_t output;
-    mat4_multiply(*self, *rhs, output);
-    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    vec2_t output;
+    vec2_floor(*self, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_mat4");
+    rb_raise(rb_eArgError, "Invalid number of arguments to floor");
   }
   return sm_out;
 }
@@ -4501,48 +6305,39 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Transforms a Vec4 using self and returns the resulting vector.
+ * Rounds each of this vector's components up and returns the result.
  *
  * call-seq:
- *    multiply_vec4(vec4, output = nil) -> output or new vec4
+ *    ceil(output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_multiply_vec4(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_ceil(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
   VALUE sm_out;
-  mat4_t *self;
-  vec4_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec4(sm_rhs, NULL);
-  if (argc == 2) {
+  vec2_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (argc == 1) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    vec4_t *output;
-    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
       rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
         rb_obj_classname(sm_out));
       return Qnil;
     }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec4(sm_out, NULL);
-    mat4_multiply_vec4(*self, *rhs, *output);
-  }} else if (argc == 1) {
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_ceil(*self, *output);
+  }} else if (argc == 0) {
 SM_LABEL(skip_output): {
-    vec4_t output;
-    mat4_multiply_vec4(*self, *rhs, output);
-    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_rhs));
+    vec2_t output;
+    vec2_ceil(*self, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_vec4");
+    rb_raise(rb_eArgError, "Invalid number of arguments to ceil");
   }
   return sm_out;
 }
@@ -4550,48 +6345,40 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Transforms a Vec3 using self and returns the resulting vector.
+ * Returns a vector holding 1, -1, or 0 for each of this vector's components
+ * depending on whether it is positive, negative, or zero.
  *
  * call-seq:
- *    transform_vec3(vec3, output = nil) -> output or new vec3
+ *    sign(output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_transform_vec3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_sign(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
   VALUE sm_out;
-  mat4_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
+  vec2_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec2(sm_self, NULL);
+  if (argc == 1) {
     if (!RTEST(sm_out)) {
       goto SM_LABEL(skip_output);
     }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+    vec2_t *output;
+    if (!SM_IS_A(sm_out, vec2) && !SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
       rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        kSM_WANT_TWO_TO_FOUR_FORMAT_LIT,
         rb_obj_classname(sm_out));
       return Qnil;
     }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    mat4_transform_vec3(*self, *rhs, *output);
-  }} else if (argc == 1) {
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec2(sm_out, NULL);
+    vec2_sign(*self, *output);
+  }} else if (argc == 0) {
 SM_LABEL(skip_output): {
-    vec3_t output;
-    mat4_transform_vec3(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
+    vec2_t output;
+    vec2_sign(*self, output);
+    sm_out = sm_wrap_vec2(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
   }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to transform_vec3");
+    rb_raise(rb_eArgError, "Invalid number of arguments to sign");
   }
   return sm_out;
 }
@@ -4599,273 +6386,208 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Rotates a Vec3 by self, using only the inner 9x9 matrix to transform the
- * vector. Returns the rotated vector.
+ * Returns 2D simplex noise at this point, roughly in the range [-1, 1].
  *
  * call-seq:
- *    rotate_vec3(vec3, output = nil) -> output or new vec3
+ *    noise -> float
  */
-static VALUE sm_mat4_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_noise(VALUE sm_self)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
-  mat4_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    mat4_rotate_vec3(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    mat4_rotate_vec3(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to rotate_vec3");
-  }
-  return sm_out;
+  const vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
+  return DBL2NUM(noise_simplex2((*self)[0], (*self)[1]));
 }
 
 
 
 /*
- * Convenience function to rotate a Vec3 using the inverse of self. Returns the
- * resulting vector.
+ * Allocates a Vec2.
  *
  * call-seq:
- *    inv_rotate_vec3(vec3, output = nil) -> output or new vec3
+ *    new()          -> vec2 with components [0, 0]
+ *    new(x, y)      -> vec2 with components [x, y]
+ *    new([x, y])    -> vec2 with components [x, y]
+ *    new(vec2)      -> copy of vec3
+ *    new(vec3)      -> vec2 of vec3's x and y components
+ *    new(vec4)      -> vec2 of vec4's x and y components
+ *    new(quat)      -> vec2 of quat's x and y components
  */
-static VALUE sm_mat4_inv_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_new(int argc, VALUE *argv, VALUE self)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
-  mat4_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
-    return Qnil;
-  }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    mat4_inv_rotate_vec3(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    mat4_inv_rotate_vec3(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_rotate_vec3");
-  }
-  return sm_out;
+  VALUE sm_vec = sm_wrap_vec2(g_vec2_zero, self);
+  rb_obj_call_init(sm_vec, argc, argv);
+  return sm_vec;
 }
 
 
 
 /*
- * Returns an inverse affine matrix if successful. Otherwise, returns nil.
+ * Sets the Vec2's components.
  *
  * call-seq:
- *    inverse_affine(output = nil) -> output, new mat4, or nil
+ *    set(x, y)      -> vec2 with components [x, y]
+ *    set([x, y])    -> vec2 with components [x, y]
+ *    set(vec2)      -> copy of vec2
+ *    set(vec3)      -> vec2 with components [vec3.xy]
+ *    set(vec4)      -> vec2 with components [vec4.xy]
+ *    set(quat)      -> vec2 with components [quat.xy]
  */
-static VALUE sm_mat4_inverse_affine(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_init(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out = Qnil;
-  mat4_t *self;
-
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
+  vec2_t *self;
+  size_t arr_index = 0;
 
-  if (argc == 1) {
-    mat4_t *output;
+  sm_check_writable(sm_self);
+  self = sm_unwrap_vec2(sm_self, NULL);
 
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(output_lbl);
-    }
+  switch(argc) {
 
-    if (!SM_IS_A(sm_out, mat4)) {
-      rb_raise(rb_eTypeError,
-        "Invalid argument to output of inverse_affine: expected %s, got %s",
-        rb_class2name(s_sm_mat4_klass),
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
+  /* Default value */
+  case 0: { break; }
 
-    output = sm_unwrap_mat4(sm_out, NULL);
-    if (!mat4_inverse_affine(*self, *output)) {
-      return Qnil;
+  /* Copy or by-array */
+  case 1: {
+    if (SM_IS_A(argv[0], vec2) ||
+        SM_IS_A(argv[0], vec3) ||
+        SM_IS_A(argv[0], vec4) ||
+        SM_IS_A(argv[0], quat)) {
+      sm_unwrap_vec2(argv[0], *self);
+      break;
     }
 
-  } else if (argc == 0) {
-    SM_LABEL(output_lbl): {
-      mat4_t output;
-      if (!mat4_inverse_affine(*self, output)) {
-        return Qnil;
+    /* Optional offset into array provided */
+    if (0) {
+      case 2:
+      if (!SM_RB_IS_A(argv[0], rb_cArray)) {
+        self[0][0] = (s_float_t)NUM2DBL(argv[0]);
+        self[0][1] = (s_float_t)NUM2DBL(argv[1]);
+        break;
       }
+      arr_index = NUM2SIZET(argv[1]);
+    }
 
-      sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
-      rb_obj_call_init(sm_out, 0, 0);
+    /* Array of values */
+    VALUE arrdata = argv[0];
+    const size_t arr_end = arr_index + 2;
+    s_float_t *vec_elem = *self;
+    for (; arr_index < arr_end; ++arr_index, ++vec_elem) {
+      *vec_elem = (s_float_t)NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
     }
-  } else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_affine");
+    break;
   }
 
-  return sm_out;
+  default: {
+    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
+    break;
+  }
+  } /* switch (argc) */
+
+  return sm_self;
 }
 
 
 
 /*
- * Returns an generalized inverse matrix if successful. Otherwise, returns nil.
+ * Returns a string representation of self.
+ *
+ *    Vec2[].to_s     # => "{ 0.0, 0.0 }"
  *
  * call-seq:
- *    inverse_general(output = nil) -> output, new mat4, or nil
+ *    to_s -> string
  */
-static VALUE sm_mat4_inverse_general(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_to_s(VALUE self)
 {
-  VALUE sm_out = Qnil;
-  mat4_t *self;
-
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat4(sm_self, NULL);
+  const s_float_t *v;
+  v = (const s_float_t *)*sm_unwrap_vec2(self, NULL);
+  return rb_sprintf(
+    "{ "
+    "%f, %f"
+    " }",
+    v[0], v[1]);
+}
 
-  if (argc == 1) {
-    mat4_t *output;
 
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }
 
-    if (!SM_IS_A(sm_out, mat4)) {
-      rb_raise(rb_eTypeError,
-        "Invalid argument to output of inverse_general: expected %s, got %s",
-        rb_class2name(s_sm_mat4_klass),
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
+/*
+ * Returns the squared magnitude of self.
+ *
+ * call-seq:
+ *    magnitude_squared -> float
+ */
+static VALUE sm_vec2_magnitude_squared(VALUE sm_self)
+{
+  return DBL2NUM(vec2_length_squared(*sm_unwrap_vec2(sm_self, NULL)));
+}
 
-    output = sm_unwrap_mat4(sm_out, NULL);
-    if (!mat4_inverse_general(*self, *output)) {
-      return Qnil;
-    }
 
-  } else if (argc == 0) {
-    SM_LABEL(skip_output): {
-      mat4_t output;
-      if (!mat4_inverse_general(*self, output)) {
-        return Qnil;
-      }
 
-      sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
-      rb_obj_call_init(sm_out, 0, 0);
-    }
-  } else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_general");
-  }
-
-  return sm_out;
+/*
+ * Returns the magnitude of self.
+ *
+ * call-seq:
+ *    magnitude -> float
+ */
+static VALUE sm_vec2_magnitude(VALUE sm_self)
+{
+  return DBL2NUM(vec2_length(*sm_unwrap_vec2(sm_self, NULL)));
 }
 
 
 
 /*
- * Returns the matrix determinant.
+ * Scales this vector's components by a scalar value and returns the result.
  *
  * call-seq:
- *    determinant -> float
+ *    scale(scalar, output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_determinant(VALUE sm_self)
+static VALUE sm_vec2_scale(int argc, VALUE *argv, VALUE sm_self)
 {
-  return mat4_determinant(*sm_unwrap_mat4(sm_self, NULL));
+  VALUE sm_out;
+  VALUE sm_scalar;
+  s_float_t scalar;
+  vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
+
+  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
+  scalar = NUM2DBL(sm_scalar);
+
+  if (SM_IS_A(sm_out, vec2) || SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
+    sm_check_writable(sm_out);
+    vec2_scale(*self, scalar, *sm_unwrap_vec2(sm_out, NULL));
+  } else {
+    vec2_t out;
+    vec2_scale(*self, scalar, out);
+    sm_out = sm_wrap_vec2(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
 }
 
 
 
 /*
- * Translates this matrix by X, Y, and Z (or a Vec3's X, Y, and Z components)
- * and returns the result. Essentially the same as multiplying this matrix by a
- * translation matrix, but slightly more convenient.
+ * Divides this vector's components by a scalar value and returns the result.
  *
  * call-seq:
- *    translate(x, y, z, output = nil) -> output or new mat4
- *    translate(vec3, output = nil)    -> output or new mat4
+ *    divide(scalar, output = nil) -> output or new vec2
  */
-static VALUE sm_mat4_translate(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_divide(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out = Qnil;
-  mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
-  vec3_t xyz;
-
-  SM_LABEL(argc_reconfig):
-  switch (argc) {
-  case 2: case 4: {
-    sm_out = argv[--argc];
-    if (RTEST(sm_out)) {
-      SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
-    }
-    goto SM_LABEL(argc_reconfig);
-  }
-
-  case 1: {
-    sm_unwrap_vec3(argv[0], xyz);
-    goto SM_LABEL(get_output);
-  }
+  VALUE sm_out;
+  VALUE sm_scalar;
+  s_float_t scalar;
+  vec2_t *self = sm_unwrap_vec2(sm_self, NULL);
 
-  case 3: {
-    xyz[0] = NUM2DBL(argv[0]);
-    xyz[1] = NUM2DBL(argv[1]);
-    xyz[2] = NUM2DBL(argv[2]);
+  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
+  scalar = NUM2DBL(sm_scalar);
 
-    SM_LABEL(get_output):
-    if (RTEST(sm_out)) {
-      rb_check_frozen(sm_out);
-      mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
-      mat4_translate(xyz[0], xyz[1], xyz[2], *self, *out);
-    } else {
-      mat4_t out;
-      mat4_translate(xyz[0], xyz[1], xyz[2], *self, out);
-      sm_out = sm_wrap_mat4(out, rb_obj_class(sm_self));
-      rb_obj_call_init(sm_out, 0, 0);
-    }
-  }
+  if (SM_IS_A(sm_out, vec2) || SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
+    sm_check_writable(sm_out);
+    vec2_divide(*self, scalar, *sm_unwrap_vec2(sm_out, NULL));
+  } else {
+    vec2_t out;
+    vec2_divide(*self, scalar, out);
+    sm_out = sm_wrap_vec2(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
   }
 
   return sm_out;
@@ -4874,244 +6596,4369 @@ static VALUE sm_mat4_translate(int argc, VALUE *argv, VALUE sm_self)
 
 
 /*
- * Returns a translation matrix for the given X, Y, and Z translations (or using
- * the vector's components as such).
+ * Tests whether a Vec2 is equivalent to another Vec2, a Vec3, Vec4, or a Quat.
+ * When testing for equivalency against 4-component objects, only the first two
+ * components are compared.
  *
  * call-seq:
- *    translation(x, y, z, output = nil) -> output or new mat4
- *    translation(vec3, output = nil)    -> output or new mat4
+ *    vec2 == other_vec2 -> bool
+ *    vec2 == vec3       -> bool
+ *    vec2 == vec4       -> bool
+ *    vec2 == quat       -> bool
  */
-static VALUE sm_mat4_translation(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_equals(VALUE sm_self, VALUE sm_other)
 {
-  VALUE sm_out = Qnil;
-  vec3_t xyz;
-
-  SM_LABEL(argc_reconfig):
-  switch (argc) {
-  case 2: case 4: {
-    sm_out = argv[--argc];
-    if (RTEST(sm_out)) {
-      SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
-    }
-    goto SM_LABEL(argc_reconfig);
+  if (!RTEST(sm_other) || (!SM_IS_A(sm_other, vec2) && !SM_IS_A(sm_other, vec3) && !SM_IS_A(sm_other, vec4) && !SM_IS_A(sm_other, quat))) {
+    return Qfalse;
   }
 
-  case 1: {
-    sm_unwrap_vec3(argv[0], xyz);
-    goto SM_LABEL(get_output);
-  }
+  return vec2_equals(*sm_unwrap_vec2(sm_self, NULL), *sm_unwrap_vec2(sm_other, NULL)) ? Qtrue : Qfalse;
+}
 
-  case 3: {
-    xyz[0] = NUM2DBL(argv[0]);
-    xyz[1] = NUM2DBL(argv[1]);
-    xyz[2] = NUM2DBL(argv[2]);
 
-    SM_LABEL(get_output):
-    if (RTEST(sm_out)) {
-      rb_check_frozen(sm_out);
-      mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
-      mat4_translation(xyz[0], xyz[1], xyz[2], *out);
-    } else {
-      mat4_t out;
-      mat4_translation(xyz[0], xyz[1], xyz[2], out);
-      sm_out = sm_wrap_mat4(out, sm_self);
-      rb_obj_call_init(sm_out, 0, 0);
-    }
+
+/*==============================================================================
+
+  vec3_t functions
+
+==============================================================================*/
+
+static VALUE sm_wrap_vec3(const vec3_t value, VALUE klass)
+{
+  vec3_t *copy;
+  VALUE sm_wrapped = Qnil;
+  if (!RTEST(klass)) {
+    klass = s_sm_vec3_klass;
   }
+  sm_wrapped = Data_Make_Struct(klass, vec3_t, 0, free, copy);
+  if (value) {
+    vec3_copy(value, *copy);
   }
+  return sm_wrapped;
+}
 
-  return sm_out;
+
+
+static vec3_t *sm_unwrap_vec3(VALUE sm_value, vec3_t store)
+{
+  vec3_t *value;
+  Data_Get_Struct(sm_value, vec3_t, value);
+  if(store) vec3_copy(*value, store);
+  return value;
 }
 
 
 
 /*
- * Allocates a new Mat4.
+  Unwraps the right-hand operand of a binary Vec3 operation, raising a TypeError
+  if it isn't a compatible vector. If broadcast is non-NULL and the operand is
+  a Numeric, broadcast is filled with its value and returned instead.
+*/
+static vec3_t *sm_vec3_operand(VALUE sm_rhs, vec3_t broadcast)
+{
+  if (broadcast && SM_IS_NUMERIC(sm_rhs)) {
+    broadcast[0] =
+    broadcast[1] =
+    broadcast[2] = (s_float_t)NUM2DBL(sm_rhs);
+    return (vec3_t *)broadcast;
+  } else if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+  }
+  return sm_unwrap_vec3(sm_rhs, NULL);
+}
+
+
+
+/*
+ * Gets the component of the Vec3 at the given index.
  *
- * call-seq:
- *    new()                        -> identity mat4
- *    new(m1, m2, ..., m15, m16)   -> new mat4 with components
- *    new([m1, m2, ..., m15, m16]) -> new mat4 with components
- *    new(mat4)                    -> copy of mat4
- *    new(mat3)                    -> new mat4 with mat3's components
- *    new(quat)                    -> quat as mat4
- *    new(Vec4, Vec4, Vec4, Vec4)  -> new mat4 with given row vectors
+ * call-seq: fetch(index) -> float
  */
-static VALUE sm_mat4_new(int argc, VALUE *argv, VALUE self)
+static VALUE sm_vec3_fetch (VALUE sm_self, VALUE sm_index)
 {
-  VALUE sm_mat = sm_wrap_mat4(g_mat4_identity, self);
-  rb_obj_call_init(sm_mat, argc, argv);
-  return sm_mat;
+  static const int max_index = sizeof(vec3_t) / sizeof(s_float_t);
+  const vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
+  int index = NUM2INT(sm_index);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  }
+  return DBL2NUM(self[0][NUM2INT(sm_index)]);
 }
 
 
 
 /*
- * Sets the Mat4's components.
+ * Sets the Vec3's component at the index to the value.
  *
- * call-seq:
- *    set(m1, m2, ..., m15, m16)   -> new mat4 with components
- *    set([m1, m2, ..., m15, m16]) -> new mat4 with components
- *    set(mat4)                    -> copy of mat4
- *    set(mat3)                    -> new mat4 with mat3's components
- *    set(quat)                    -> quat as mat4
- *    set(Vec4, Vec4, Vec4, Vec4)  -> new mat4 with given row vectors
+ * call-seq: store(index, value) -> value
  */
-static VALUE sm_mat4_init(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec3_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
 {
-  mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
-  size_t arr_index = 0;
+  static const int max_index = sizeof(vec3_t) / sizeof(s_float_t);
+  vec3_t *self;
+  int index = NUM2INT(sm_index);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  }
+  self[0][index] = (s_float_t)NUM2DBL(sm_value);
+  return sm_value;
+}
 
-  rb_check_frozen(sm_self);
 
-  switch (argc) {
 
-  case 0: {
-    /* Identity (handled in _new) */
-    break;
-  }
+/*
+ * Returns the length in bytes of the Vec3. When compiled to use doubles as the
+ * base type, this is always 24. Otherwise, when compiled to use floats, it's
+ * always 12.
+ *
+ * call-seq: size -> fixnum
+ */
+static VALUE sm_vec3_size (VALUE self)
+{
+  return SIZET2NUM(sizeof(vec3_t));
+}
 
-  /* Copy Mat4 or provided [Numeric..] */
-  case 1: {
-    /* Copy Mat4 */
-    if (SM_IS_A(argv[0], mat4)) {
-      sm_unwrap_mat4(argv[0], *self);
-      break;
-    }
 
-    /* Copy Mat3 */
-    if (SM_IS_A(argv[0], mat3)) {
-      mat3_to_mat4(*sm_unwrap_mat4(argv[0], NULL), *self);
-      break;
-    }
 
-    /* Build from Quaternion */
-    if (SM_IS_A(argv[0], quat)) {
-      mat4_from_quat(*sm_unwrap_quat(argv[0], NULL), *self);
-      break;
-    }
+/*
+ * Returns the length of the Vec3 in components. Result is always 3.
+ *
+ * call-seq: length -> fixnum
+ */
+static VALUE sm_vec3_length (VALUE self)
+{
+  return SIZET2NUM(sizeof(vec3_t) / sizeof(s_float_t));
+}
 
-    /* Optional offset into array provided */
-    if (0) {
-      case 2:
-      arr_index = NUM2SIZET(argv[1]);
+
+
+/*
+ * Returns a copy of self.
+ *
+ * call-seq:
+ *    copy(output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_copy(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
     }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_copy (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_copy (*self, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
+  }
+  return sm_out;
+}
 
-    /* Array of values */
-    if (SM_RB_IS_A(argv[0], rb_cArray)) {
-      VALUE arrdata = argv[0];
-      const size_t arr_end = arr_index + 16;
-      s_float_t *mat_elem = *self;
-      for (; arr_index < arr_end; ++arr_index, ++mat_elem) {
-        *mat_elem = NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
-      }
-      break;
+
+
+/*
+ * Returns a vector whose components are the multiplicative inverse of this
+ * vector's.
+ *
+ * call-seq:
+ *    normalize(output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_normalize(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
     }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_normalize (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_normalize (*self, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to normalize");
+  }
+  return sm_out;
+}
 
-    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Mat4");
-    break;
+
+
+/*
+ * Returns a vector whose components are the multiplicative inverse of this
+ * vector's.
+ *
+ * call-seq:
+ *    inverse(output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_inverse(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_inverse (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_inverse (*self, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
   }
+  return sm_out;
+}
 
-  /* Mat4(Vec4, Vec4, Vec4, Vec4) */
-  case 4: {
-    size_t arg_index;
-    s_float_t *mat_elem = *self;
-    for (arg_index = 0; arg_index < 4; ++arg_index, mat_elem += 4) {
-      if (!SM_IS_A(argv[arg_index], vec4) && !SM_IS_A(argv[arg_index], quat)) {
-        rb_raise(
-          rb_eArgError,
-          "Argument %d must be a Vec4 or Quat when supplying four arguments to initialize/set",
-          (int)(arg_index + 1));
-      }
 
-      sm_unwrap_vec4(argv[arg_index], mat_elem);
+
+/*
+ * Negates this vector's components and returns the result.
+ *
+ * call-seq:
+ *    negate(output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_negate(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
     }
-    break;
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_negate (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_negate (*self, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to negate");
   }
+  return sm_out;
+}
 
-  /* Mat4(Numeric m00 .. m16) */
-  case 16: {
-    s_float_t *mat_elem = *self;
-    VALUE *argv_p = argv;
-    for (; argc; --argc, ++argv_p, ++mat_elem) {
-      *mat_elem = (s_float_t)NUM2DBL(*argv_p);
+
+
+/*
+ * Projects this vector onto a normal vector and returns the result.
+ *
+ * call-seq:
+ *    project(normal, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_project(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
     }
-    break;
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_project(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_project(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to project");
   }
+  return sm_out;
+}
 
-  default: {
-    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
-    break;
+
+
+/*
+ * Reflects this vector against a normal vector and returns the result.
+ *
+ * call-seq:
+ *    reflect(normal, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_reflect(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_reflect(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_reflect(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to reflect");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns the cross product of this vector and another Vec3.
+ *
+ * call-seq:
+ *    cross_product(vec3, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_cross_product(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_cross_product(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_cross_product(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to cross_product");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Multiplies this and another vector's components together and returns the
+ * result.
+ *
+ * call-seq:
+ *    multiply_vec3(vec3, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_multiply(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_multiply(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_multiply(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_vec3");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Adds this and another vector's components together and returns the result.
+ *
+ * If given a Numeric, it is added to every component.
+ *
+ * call-seq:
+ *    add(vec3, output = nil) -> output or new vec3
+ *    add(scalar, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_add(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *rhs;
+  vec3_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  rhs = sm_vec3_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_add(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_add(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to add");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Subtracts another vector's components from this vector's and returns the
+ * result.
+ *
+ * If given a Numeric, it is subtracted from every component.
+ *
+ * call-seq:
+ *    subtract(vec3, output = nil) -> output or new vec3
+ *    subtract(scalar, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_subtract(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *rhs;
+  vec3_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  rhs = sm_vec3_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_subtract(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_subtract(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to subtract");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns the dot product of this and another Vec3 or the XYZ components of a
+ * Vec4 or Quat.
+ *
+ * call-seq:
+ *    dot_product(vec3) -> float
+ *    dot_product(vec4) -> float
+ *    dot_product(quat) -> float
+ */
+static VALUE sm_vec3_dot_product(VALUE sm_self, VALUE sm_other)
+{
+  if (!SM_IS_A(sm_other, vec3) &&
+      !SM_IS_A(sm_other, vec4) &&
+      !SM_IS_A(sm_other, quat)) {
+    rb_raise(rb_eArgError,
+      "Expected a Quat, Vec3, or Vec4, got %s",
+      rb_obj_classname(sm_other));
+    return Qnil;
+  }
+  return DBL2NUM(
+    vec3_dot_product(
+      *sm_unwrap_vec3(sm_self, NULL),
+      *sm_unwrap_vec3(sm_other, NULL)));
+}
+
+
+
+/*
+ * Returns a vector of the smaller of each pair of components from this vector
+ * and another. If given a Numeric, each component is compared against it.
+ *
+ * call-seq:
+ *    component_min(vec3, output = nil) -> output or new vec3
+ *    component_min(scalar, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_component_min(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *rhs;
+  vec3_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  rhs = sm_vec3_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_min(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_min(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to component_min");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a vector of the larger of each pair of components from this vector
+ * and another. If given a Numeric, each component is compared against it.
+ *
+ * call-seq:
+ *    component_max(vec3, output = nil) -> output or new vec3
+ *    component_max(scalar, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_component_max(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *rhs;
+  vec3_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  rhs = sm_vec3_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_max(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_max(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to component_max");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Clamps each component of this vector to the range given by the same
+ * components of lower and upper and returns the result. Either bound may be a
+ * Numeric, which applies to every component.
+ *
+ * call-seq:
+ *    clamp(lower, upper, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_clamp(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_lower;
+  VALUE sm_upper;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *lower;
+  vec3_t *upper;
+  vec3_t lower_broadcast;
+  vec3_t upper_broadcast;
+  rb_scan_args(argc, argv, "21", &sm_lower, &sm_upper, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  lower = sm_vec3_operand(sm_lower, lower_broadcast);
+  upper = sm_vec3_operand(sm_upper, upper_broadcast);
+  if (argc == 3) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_clamp(*self, *lower, *upper, *output);
+  }} else if (argc == 2) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_clamp(*self, *lower, *upper, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to clamp");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Linearly interpolates between this vector and destination by alpha and
+ * returns the result. Alpha is not clamped.
+ *
+ * call-seq:
+ *    lerp(destination, alpha, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_lerp(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_destination;
+  VALUE sm_alpha;
+  VALUE sm_out;
+  vec3_t *self;
+  vec3_t *destination;
+  s_float_t alpha;
+  rb_scan_args(argc, argv, "21", &sm_destination, &sm_alpha, &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  destination = sm_vec3_operand(sm_destination, NULL);
+  alpha = (s_float_t)NUM2DBL(sm_alpha);
+  if (argc == 3) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_lerp(*self, *destination, alpha, *output);
+  }} else if (argc == 2) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_lerp(*self, *destination, alpha, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to lerp");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a vector of the absolute values of this vector's components.
+ *
+ * call-seq:
+ *    abs(output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_abs(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_abs(*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_abs(*self, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to abs");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Rounds each of this vector's components down and returns the result.
+ *
+ * call-seq:
+ *    floor(output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_floor(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_floor(*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_floor(*self, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to floor");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Rounds each of this vector's components up and returns the result.
+ *
+ * call-seq:
+ *    ceil(output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_ceil(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_ceil(*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_ceil(*self, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to ceil");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a vector holding 1, -1, or 0 for each of this vector's components
+ * depending on whether it is positive, negative, or zero.
+ *
+ * call-seq:
+ *    sign(output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_sign(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    vec3_sign(*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    vec3_sign(*self, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to sign");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns 3D simplex noise at this point, roughly in the range [-1, 1].
+ *
+ * call-seq:
+ *    noise -> float
+ */
+static VALUE sm_vec3_noise(VALUE sm_self)
+{
+  const vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
+  return DBL2NUM(noise_simplex3((*self)[0], (*self)[1], (*self)[2]));
+}
+
+
+
+/*
+ * Allocates a Vec3.
+ *
+ * call-seq:
+ *    new()          -> vec3 with components [0, 0, 0]
+ *    new(x, y, z)   -> vec3 with components [x, y, z]
+ *    new([x, y, z]) -> vec3 with components [x, y, z]
+ *    new(vec3)      -> copy of vec3
+ *    new(vec4)      -> vec3 of vec4's x, y, and z components
+ *    new(quat)      -> vec3 of quat's x, y, and z components
+ */
+static VALUE sm_vec3_new(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_vec = sm_wrap_vec3(g_vec3_zero, self);
+  rb_obj_call_init(sm_vec, argc, argv);
+  return sm_vec;
+}
+
+
+
+/*
+ * Sets the Vec3's components.
+ *
+ * call-seq:
+ *    set(x, y, z)   -> vec3 with components [x, y, z]
+ *    set([x, y, z]) -> vec3 with components [x, y, z]
+ *    set(vec2)      -> vec3 with components [vec2.xy, 0]
+ *    set(vec3)      -> copy of vec3
+ *    set(vec4)      -> vec3 with components [vec4.xyz]
+ *    set(quat)      -> vec3 with components [quat.xyz]
+ */
+static VALUE sm_vec3_init(int argc, VALUE *argv, VALUE sm_self)
+{
+  vec3_t *self;
+  size_t arr_index = 0;
+
+  sm_check_writable(sm_self);
+  self = sm_unwrap_vec3(sm_self, NULL);
+
+  switch(argc) {
+
+  /* Default value */
+  case 0: { break; }
+
+  /* Copy or by-array */
+  case 1: {
+    if (SM_IS_A(argv[0], vec3) ||
+        SM_IS_A(argv[0], vec4) ||
+        SM_IS_A(argv[0], quat)) {
+      sm_unwrap_vec3(argv[0], *self);
+      break;
+    }
+
+    if (SM_IS_A(argv[0], vec2)) {
+      sm_unwrap_vec2(argv[0], *self);
+      self[0][2] = s_float_lit(0.0);
+      break;
+    }
+
+    /* Optional offset into array provided */
+    if (0) {
+      case 2:
+      arr_index = NUM2SIZET(argv[1]);
+    }
+
+    /* Array of values */
+    if (SM_RB_IS_A(argv[0], rb_cArray)) {
+      VALUE arrdata = argv[0];
+      const size_t arr_end = arr_index + 3;
+      s_float_t *vec_elem = *self;
+      for (; arr_index < arr_end; ++arr_index, ++vec_elem) {
+        *vec_elem = (s_float_t)NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
+      }
+      break;
+    }
+
+    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Vec3");
+    break;
+  }
+
+  /* X, Y, Z */
+  case 3: {
+    self[0][0] = (s_float_t)NUM2DBL(argv[0]);
+    self[0][1] = (s_float_t)NUM2DBL(argv[1]);
+    self[0][2] = (s_float_t)NUM2DBL(argv[2]);
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
+    break;
+  }
+  } /* switch (argc) */
+
+  return sm_self;
+}
+
+
+
+/*
+ * Returns a string representation of self.
+ *
+ *    Vec3[].to_s     # => "{ 0.0, 0.0, 0.0 }"
+ *
+ * call-seq:
+ *    to_s -> string
+ */
+static VALUE sm_vec3_to_s(VALUE self)
+{
+  const s_float_t *v;
+  v = (const s_float_t *)*sm_unwrap_vec3(self, NULL);
+  return rb_sprintf(
+    "{ "
+    "%f, %f, %f"
+    " }",
+    v[0], v[1], v[2]);
+}
+
+
+
+/*
+ * Returns the squared magnitude of self.
+ *
+ * call-seq:
+ *    magnitude_squared -> float
+ */
+static VALUE sm_vec3_magnitude_squared(VALUE sm_self)
+{
+  return DBL2NUM(vec3_length_squared(*sm_unwrap_vec3(sm_self, NULL)));
+}
+
+
+
+/*
+ * Returns the magnitude of self.
+ *
+ * call-seq:
+ *    magnitude -> float
+ */
+static VALUE sm_vec3_magnitude(VALUE sm_self)
+{
+  return DBL2NUM(vec3_length(*sm_unwrap_vec3(sm_self, NULL)));
+}
+
+
+
+/*
+ * Scales this vector's components by a scalar value and returns the result.
+ *
+ * call-seq:
+ *    scale(scalar, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_scale(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  VALUE sm_scalar;
+  s_float_t scalar;
+  vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
+
+  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
+  scalar = NUM2DBL(sm_scalar);
+
+  if (SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
+    sm_check_writable(sm_out);
+    vec3_scale(*self, scalar, *sm_unwrap_vec3(sm_out, NULL));
+  } else {
+    vec3_t out;
+    vec3_scale(*self, scalar, out);
+    sm_out = sm_wrap_vec3(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Divides this vector's components by a scalar value and returns the result.
+ *
+ * call-seq:
+ *    divide(scalar, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_divide(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  VALUE sm_scalar;
+  s_float_t scalar;
+  vec3_t *self = sm_unwrap_vec3(sm_self, NULL);
+
+  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
+  scalar = NUM2DBL(sm_scalar);
+
+  if (SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
+    sm_check_writable(sm_out);
+    vec3_divide(*self, scalar, *sm_unwrap_vec3(sm_out, NULL));
+  } else {
+    vec3_t out;
+    vec3_divide(*self, scalar, out);
+    sm_out = sm_wrap_vec3(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Tests whether a Vec3 is equivalent to another Vec3, a Vec4, or a Quat. When
+ * testing for equivalency against 4-component objects, only the first three
+ * components are compared.
+ *
+ * call-seq:
+ *    vec3 == other_vec3 -> bool
+ *    vec3 == vec4       -> bool
+ *    vec3 == quat       -> bool
+ */
+static VALUE sm_vec3_equals(VALUE sm_self, VALUE sm_other)
+{
+  if (!RTEST(sm_other) || (!SM_IS_A(sm_other, vec3) && !SM_IS_A(sm_other, vec4) && !SM_IS_A(sm_other, quat))) {
+    return Qfalse;
+  }
+
+  return vec3_equals(*sm_unwrap_vec3(sm_self, NULL), *sm_unwrap_vec3(sm_other, NULL)) ? Qtrue : Qfalse;
+}
+
+
+
+/*==============================================================================
+
+  vec4_t functions
+
+==============================================================================*/
+
+static VALUE sm_wrap_vec4(const vec4_t value, VALUE klass)
+{
+  vec4_t *copy;
+  VALUE sm_wrapped = Qnil;
+  if (!RTEST(klass)) {
+    klass = s_sm_vec4_klass;
+  }
+  sm_wrapped = Data_Make_Struct(klass, vec4_t, 0, free, copy);
+  if (value) {
+    vec4_copy(value, *copy);
+  }
+  return sm_wrapped;
+}
+
+
+
+static vec4_t *sm_unwrap_vec4(VALUE sm_value, vec4_t store)
+{
+  vec4_t *value;
+  Data_Get_Struct(sm_value, vec4_t, value);
+  if(store) vec4_copy(*value, store);
+  return value;
+}
+
+
+
+/*
+  Unwraps the right-hand operand of a binary Vec4 operation, raising a TypeError
+  if it isn't a compatible vector. If broadcast is non-NULL and the operand is
+  a Numeric, broadcast is filled with its value and returned instead.
+*/
+static vec4_t *sm_vec4_operand(VALUE sm_rhs, vec4_t broadcast)
+{
+  if (broadcast && SM_IS_NUMERIC(sm_rhs)) {
+    broadcast[0] =
+    broadcast[1] =
+    broadcast[2] =
+    broadcast[3] = (s_float_t)NUM2DBL(sm_rhs);
+    return (vec4_t *)broadcast;
+  } else if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+  }
+  return sm_unwrap_vec4(sm_rhs, NULL);
+}
+
+
+
+/*
+ * Gets the component of the Vec4 at the given index.
+ *
+ * call-seq: fetch(index) -> float
+ */
+static VALUE sm_vec4_fetch (VALUE sm_self, VALUE sm_index)
+{
+  static const int max_index = sizeof(vec4_t) / sizeof(s_float_t);
+  const vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
+  int index = NUM2INT(sm_index);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  }
+  return DBL2NUM(self[0][NUM2INT(sm_index)]);
+}
+
+
+
+/*
+ * Sets the Vec4's component at the index to the value.
+ *
+ * call-seq: store(index, value) -> value
+ */
+static VALUE sm_vec4_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+{
+  static const int max_index = sizeof(vec4_t) / sizeof(s_float_t);
+  vec4_t *self;
+  int index = NUM2INT(sm_index);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  }
+  self[0][index] = (s_float_t)NUM2DBL(sm_value);
+  return sm_value;
+}
+
+
+
+/*
+ * Returns the length in bytes of the Vec4. When compiled to use doubles as the
+ * base type, this is always 32. Otherwise, when compiled to use floats, it's
+ * always 16.
+ *
+ * call-seq: size -> fixnum
+ */
+static VALUE sm_vec4_size (VALUE self)
+{
+  return SIZET2NUM(sizeof(vec4_t));
+}
+
+
+
+/*
+ * Returns the length of the Vec4 in components. Result is always 4.
+ *
+ * call-seq: length -> fixnum
+ */
+static VALUE sm_vec4_length (VALUE self)
+{
+  return SIZET2NUM(sizeof(vec4_t) / sizeof(s_float_t));
+}
+
+
+
+/*
+ * Returns a copy of self.
+ *
+ * call-seq:
+ *    copy(output = nil) -> output or new vec4 / quat
+ */
+static VALUE sm_vec4_copy(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_copy (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_copy (*self, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a normalized Vec4 or Quat, depending on the type of the receiver and
+ * output.
+ *
+ * call-seq:
+ *    normalize(output = nil) -> output or new vec4 / quat
+ */
+static VALUE sm_vec4_normalize(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+     rb_raise(rb_eTypeError,
+       kSM_WANT_FOUR_FORMAT_LIT,
+       rb_obj_classname(sm_out));
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_normalize (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_normalize (*self, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to normalize");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a vector whose components are the multiplicative inverse of this
+ * vector's.
+ *
+ * call-seq:
+ *    inverse(output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_inverse(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_inverse (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_inverse (*self, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Negates this vector or quaternions's components and returns the result.
+ *
+ * call-seq:
+ *    negate(output = nil) -> output or new vec4 or quat
+ */
+static VALUE sm_vec4_negate(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_negate (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_negate (*self, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to negate");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Projects this vector onto a normal vector and returns the result.
+ *
+ * call-seq:
+ *    project(normal, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_project(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec4(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_project(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_project(*self, *rhs, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to project");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Reflects this vector against a normal vector and returns the result.
+ *
+ * call-seq:
+ *    reflect(normal, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_reflect(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec4(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_reflect(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_reflect(*self, *rhs, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to reflect");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Multiplies this and another vector's components together and returns the
+ * result.
+ *
+ * call-seq:
+ *    multiply_vec4(vec4, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_multiply(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec4(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_multiply(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_multiply(*self, *rhs, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_vec4");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Adds this and another vector or quaternion's components together and returns
+ * the result. The result type is that of the receiver.
+ *
+ * If given a Numeric, it is added to every component.
+ *
+ * call-seq:
+ *    add(vec4, output = nil) -> output or new vec4 or quat
+ *    add(scalar, output = nil) -> output or new vec4 or quat
+ */
+static VALUE sm_vec4_add(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *rhs;
+  vec4_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  rhs = sm_vec4_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_rhs));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_add(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_add(*self, *rhs, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to add");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Subtracts another vector or quaternion's components from this vector's and
+ * returns the result. The return type is that of the receiver.
+ *
+ * If given a Numeric, it is subtracted from every component.
+ *
+ * call-seq:
+ *    subtract(vec4, output = nil) -> output or new vec4
+ *    subtract(scalar, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_subtract(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *rhs;
+  vec4_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  rhs = sm_vec4_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_rhs));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_subtract(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_subtract(*self, *rhs, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to subtract");
+  }
+  return sm_out;
+}
+
+
+
+
+/*
+ * Returns the dot product of self and another Vec4 or Quat.
+ *
+ * call-seq:
+ *    dot_product(vec4) -> float
+ *    dot_product(quat) -> float
+ */
+static VALUE sm_vec4_dot_product(VALUE sm_self, VALUE sm_other)
+{
+  if (!SM_IS_A(sm_other, vec4) &&
+      !SM_IS_A(sm_other, quat)) {
+    rb_raise(rb_eArgError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_other));
+    return Qnil;
+  }
+  return DBL2NUM(
+    vec4_dot_product(
+      *sm_unwrap_vec4(sm_self, NULL),
+      *sm_unwrap_vec4(sm_other, NULL)));
+}
+
+
+
+/*
+ * Returns a vector of the smaller of each pair of components from this vector
+ * and another. If given a Numeric, each component is compared against it.
+ *
+ * call-seq:
+ *    component_min(vec4, output = nil) -> output or new vec4
+ *    component_min(scalar, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_component_min(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *rhs;
+  vec4_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  rhs = sm_vec4_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_min(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_min(*self, *rhs, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to component_min");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a vector of the larger of each pair of components from this vector
+ * and another. If given a Numeric, each component is compared against it.
+ *
+ * call-seq:
+ *    component_max(vec4, output = nil) -> output or new vec4
+ *    component_max(scalar, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_component_max(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *rhs;
+  vec4_t broadcast;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  rhs = sm_vec4_operand(sm_rhs, broadcast);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_max(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_max(*self, *rhs, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to component_max");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Clamps each component of this vector to the range given by the same
+ * components of lower and upper and returns the result. Either bound may be a
+ * Numeric, which applies to every component.
+ *
+ * call-seq:
+ *    clamp(lower, upper, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_clamp(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_lower;
+  VALUE sm_upper;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *lower;
+  vec4_t *upper;
+  vec4_t lower_broadcast;
+  vec4_t upper_broadcast;
+  rb_scan_args(argc, argv, "21", &sm_lower, &sm_upper, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  lower = sm_vec4_operand(sm_lower, lower_broadcast);
+  upper = sm_vec4_operand(sm_upper, upper_broadcast);
+  if (argc == 3) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_clamp(*self, *lower, *upper, *output);
+  }} else if (argc == 2) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_clamp(*self, *lower, *upper, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to clamp");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Linearly interpolates between this vector and destination by alpha and
+ * returns the result. Alpha is not clamped.
+ *
+ * call-seq:
+ *    lerp(destination, alpha, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_lerp(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_destination;
+  VALUE sm_alpha;
+  VALUE sm_out;
+  vec4_t *self;
+  vec4_t *destination;
+  s_float_t alpha;
+  rb_scan_args(argc, argv, "21", &sm_destination, &sm_alpha, &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  destination = sm_vec4_operand(sm_destination, NULL);
+  alpha = (s_float_t)NUM2DBL(sm_alpha);
+  if (argc == 3) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_lerp(*self, *destination, alpha, *output);
+  }} else if (argc == 2) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_lerp(*self, *destination, alpha, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to lerp");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a vector of the absolute values of this vector's components.
+ *
+ * call-seq:
+ *    abs(output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_abs(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_abs(*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_abs(*self, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to abs");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Rounds each of this vector's components down and returns the result.
+ *
+ * call-seq:
+ *    floor(output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_floor(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_floor(*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_floor(*self, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to floor");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Rounds each of this vector's components up and returns the result.
+ *
+ * call-seq:
+ *    ceil(output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_ceil(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_ceil(*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_ceil(*self, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to ceil");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a vector holding 1, -1, or 0 for each of this vector's components
+ * depending on whether it is positive, negative, or zero.
+ *
+ * call-seq:
+ *    sign(output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_sign(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  vec4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_vec4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    vec4_sign(*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    vec4_sign(*self, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to sign");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns 4D simplex noise at this point, roughly in the range [-1, 1].
+ *
+ * call-seq:
+ *    noise -> float
+ */
+static VALUE sm_vec4_noise(VALUE sm_self)
+{
+  const vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
+  return DBL2NUM(noise_simplex4((*self)[0], (*self)[1], (*self)[2], (*self)[3]));
+}
+
+
+
+/*
+ * Allocates a new Vec4.
+ *
+ * call-seq:
+ *     new()               -> new vec4 with components [0, 0, 0, 1]
+ *     new(x, y, z, w = 1) -> new vec4 with components [x, y, z, w]
+ *     new([x, y, z, w])   -> new vec4 with components [x, y, z, w]
+ *     new(vec4)           -> copy of vec4
+ *     new(vec3)           -> copy of vec3 with w component of 1
+ *     new(quat)           -> copy of quat as vec4
+ */
+static VALUE sm_vec4_new(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_vec = sm_wrap_vec4(g_vec4_identity, self);
+  rb_obj_call_init(sm_vec, argc, argv);
+  return sm_vec;
+}
+
+
+
+/*
+ * Sets the Vec4's components.
+ *
+ * call-seq:
+ *    set(x, y, z, w = 1) -> new vec4 with components [x, y, z, w]
+ *    set([x, y, z, w])   -> new vec4 with components [x, y, z, w]
+ *    set(vec3)           -> vec4 with components [vec3.xyz, 1]
+ *    set(vec2)           -> vec4 with components [vec2.xy, 0, 1]
+ *    set(vec4)           -> copy of vec4
+ *    set(quat)           -> copy of quat as vec4
+ */
+static VALUE sm_vec4_init(int argc, VALUE *argv, VALUE sm_self)
+{
+  vec4_t *self;
+  size_t arr_index = 0;
+
+  sm_check_writable(sm_self);
+  self = sm_unwrap_vec4(sm_self, NULL);
+
+  switch(argc) {
+
+  /* Default value */
+  case 0: { break; }
+
+  /* Copy or by-array */
+  case 1: {
+    if (SM_IS_A(argv[0], quat) ||
+        SM_IS_A(argv[0], vec4)) {
+      sm_unwrap_quat(argv[0], *self);
+      break;
+    }
+
+    if (SM_IS_A(argv[0], vec3)) {
+      sm_unwrap_vec3(argv[0], *self);
+      self[0][3] = s_float_lit(1.0);
+      break;
+    }
+
+    if (SM_IS_A(argv[0], vec2)) {
+      sm_unwrap_vec2(argv[0], *self);
+      self[0][2] = s_float_lit(0.0);
+      self[0][3] = s_float_lit(1.0);
+      break;
+    }
+
+    /* Optional offset into array provided */
+    if (0) {
+      case 2:
+      arr_index = NUM2SIZET(argv[1]);
+    }
+
+    /* Array of values */
+    if (SM_RB_IS_A(argv[0], rb_cArray)) {
+      VALUE arrdata = argv[0];
+      const size_t arr_end = arr_index + 4;
+      s_float_t *vec_elem = *self;
+      for (; arr_index < arr_end; ++arr_index, ++vec_elem) {
+        *vec_elem = (s_float_t)NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
+      }
+      break;
+    }
+
+    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Vec4");
+    break;
+  }
+
+  /* W */
+  case 4: {
+    self[0][3] = (s_float_t)NUM2DBL(argv[3]);
+    case 3: /* X, Y, Z */
+    self[0][0] = (s_float_t)NUM2DBL(argv[0]);
+    self[0][1] = (s_float_t)NUM2DBL(argv[1]);
+    self[0][2] = (s_float_t)NUM2DBL(argv[2]);
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
+    break;
+  }
+  } /* switch (argc) */
+
+  return sm_self;
+}
+
+
+
+/*
+ * Returns a string representation of self.
+ *
+ *    Vec4[].to_s     # => "{ 0.0, 0.0, 0.0, 1.0 }"
+ *
+ * call-seq:
+ *    to_s -> string
+ */
+static VALUE sm_vec4_to_s(VALUE self)
+{
+  const s_float_t *v;
+  v = (const s_float_t *)*sm_unwrap_vec4(self, NULL);
+  return rb_sprintf(
+    "{ "
+    "%f, %f, %f, %f"
+    " }",
+    v[0], v[1], v[2], v[3]);
+}
+
+
+
+/*
+ * Returns the squared magnitude of self.
+ *
+ * call-seq:
+ *    magnitude_squared -> float
+ */
+static VALUE sm_vec4_magnitude_squared(VALUE sm_self)
+{
+  return DBL2NUM(vec4_length_squared(*sm_unwrap_vec4(sm_self, NULL)));
+}
+
+
+
+/*
+ * Returns the magnitude of self.
+ *
+ * call-seq:
+ *    magnitude -> float
+ */
+static VALUE sm_vec4_magnitude(VALUE sm_self)
+{
+  return DBL2NUM(vec4_length(*sm_unwrap_vec4(sm_self, NULL)));
+}
+
+
+
+/*
+ * Scales this vector or quaternion's components by a scalar value and returns
+ * the result. The return type is that of the receiver.
+ *
+ * call-seq:
+ *    scale(scalar, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_scale(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  VALUE sm_scalar;
+  s_float_t scalar;
+  vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
+
+  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
+  scalar = NUM2DBL(sm_scalar);
+
+  if ((SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat))) {
+    sm_check_writable(sm_out);
+    vec4_scale(*self, scalar, *sm_unwrap_vec4(sm_out, NULL));
+  } else {
+    vec4_t out;
+    vec4_scale(*self, scalar, out);
+    sm_out = sm_wrap_vec4(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Divides this vector or quaternion's components by a scalar value and returns
+ * the result. The return type is that of the receiver.
+ *
+ * call-seq:
+ *    divide(scalar, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_divide(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  VALUE sm_scalar;
+  s_float_t scalar;
+  vec4_t *self = sm_unwrap_vec4(sm_self, NULL);
+
+  rb_scan_args(argc, argv, "11", &sm_scalar, &sm_out);
+  scalar = NUM2DBL(sm_scalar);
+
+  if ((SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat))) {
+    sm_check_writable(sm_out);
+    vec4_divide(*self, scalar, *sm_unwrap_vec4(sm_out, NULL));
+  } else {
+    vec4_t out;
+    vec4_divide(*self, scalar, out);
+    sm_out = sm_wrap_vec4(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Tests this Vec4 or Quat and another Vec4 or Quat for equivalency.
+ *
+ * call-seq:
+ *    quat == other_quat -> bool
+ *    vec4 == other_vec4 -> bool
+ *    quat == vec4       -> bool
+ *    vec4 == quat       -> bool
+ */
+static VALUE sm_vec4_equals(VALUE sm_self, VALUE sm_other)
+{
+  if (!RTEST(sm_other) || (!SM_IS_A(sm_other, vec4) && !SM_IS_A(sm_other, quat))) {
+    return Qfalse;
+  }
+
+  return vec4_equals(*sm_unwrap_vec4(sm_self, NULL), *sm_unwrap_vec4(sm_other, NULL)) ? Qtrue : Qfalse;
+}
+
+
+
+/*==============================================================================
+
+  quat_t functions
+
+==============================================================================*/
+
+static VALUE sm_wrap_quat(const quat_t value, VALUE klass)
+{
+  quat_t *copy;
+  VALUE sm_wrapped = Qnil;
+  if (!RTEST(klass)) {
+    klass = s_sm_quat_klass;
+  }
+  sm_wrapped = Data_Make_Struct(klass, quat_t, 0, free, copy);
+  if (value) {
+    quat_copy(value, *copy);
+  }
+  return sm_wrapped;
+}
+
+
+
+static quat_t *sm_unwrap_quat(VALUE sm_value, quat_t store)
+{
+  quat_t *value;
+  Data_Get_Struct(sm_value, quat_t, value);
+  if(store) quat_copy(*value, store);
+  return value;
+}
+
+
+
+/*
+ * Gets the component of the Quat at the given index.
+ *
+ * call-seq: fetch(index) -> float
+ */
+static VALUE sm_quat_fetch (VALUE sm_self, VALUE sm_index)
+{
+  static const int max_index = sizeof(quat_t) / sizeof(s_float_t);
+  const quat_t *self = sm_unwrap_quat(sm_self, NULL);
+  int index = NUM2INT(sm_index);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  }
+  return DBL2NUM(self[0][NUM2INT(sm_index)]);
+}
+
+
+
+/*
+ * Sets the Quat's component at the index to the value.
+ *
+ * call-seq: store(index, value) -> value
+ */
+static VALUE sm_quat_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+{
+  static const int max_index = sizeof(quat_t) / sizeof(s_float_t);
+  quat_t *self;
+  int index = NUM2INT(sm_index);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_quat(sm_self, NULL);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  }
+  self[0][index] = (s_float_t)NUM2DBL(sm_value);
+  return sm_value;
+}
+
+
+
+/*
+ * Returns the length in bytes of the Quat. When compiled to use doubles as the
+ * base type, this is always 32. Otherwise, when compiled to use floats, it's
+ * always 16.
+ *
+ * call-seq: size -> fixnum
+ */
+static VALUE sm_quat_size (VALUE self)
+{
+  return SIZET2NUM(sizeof(quat_t));
+}
+
+
+
+/*
+ * Returns the length of the Quat in components. Result is always 4.
+ *
+ * call-seq: length -> fixnum
+ */
+static VALUE sm_quat_length (VALUE self)
+{
+  return SIZET2NUM(sizeof(quat_t) / sizeof(s_float_t));
+}
+
+
+
+/*
+ * Returns the inverse of this Quat. Note that this is not the same as the
+ * inverse of, for example, a Vec4.
+ *
+ * call-seq:
+ *    inverse(output = nil) -> output or new quat
+ */
+static VALUE sm_quat_inverse(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  quat_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_quat(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    quat_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_quat(sm_out, NULL);
+    quat_inverse (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    quat_t output;
+    quat_inverse (*self, output);
+    sm_out = sm_wrap_quat(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Concatenates this quaternion and another and returns the result.
+ *
+ * call-seq:
+ *    multiply_quat(quat, output = nil) -> output or new quat
+ */
+static VALUE sm_quat_multiply(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  quat_t *self;
+  quat_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_quat(sm_self, NULL);
+  if (!!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_quat(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    quat_t *output;
+    if (!!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_quat(sm_out, NULL);
+    quat_multiply(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    quat_t output;
+    quat_multiply(*self, *rhs, output);
+    sm_out = sm_wrap_quat(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_quat");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Multiplies a quaternion and vec3, returning the rotated vec3.
+ *
+ * call-seq:
+ *    multiply_vec3(quat, output = nil) -> output or new quat
+ */
+static VALUE sm_quat_multiply_vec3(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  quat_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_quat(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    quat_multiply_vec3(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    quat_multiply_vec3(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_vec3");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Allocates a new Quat.
+ *
+ * call-seq:
+ *    new()               -> new identity quaternion
+ *    new(x, y, z, w = 1) -> new quaternion with components [x, y, z, w]
+ *    new([x, y, z, w])   -> new quaternion with components [x, y, z, w]
+ *    new(quat)           -> copy of quat
+ *    new(vec3)           -> new quaternion with the components [vec3.xyz, 1]
+ *    new(vec4)           -> new quaternion with the components of vec4
+ *    new(mat3)           -> new quaternion from mat3
+ *    new(mat4)           -> new quaternion from mat4
+ */
+static VALUE sm_quat_new(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_quat = sm_wrap_quat(g_quat_identity, self);
+  rb_obj_call_init(sm_quat, argc, argv);
+  return sm_quat;
+}
+
+
+
+/*
+ * Sets the Quat's components.
+ *
+ * call-seq:
+ *    set(x, y, z, w = 1) -> new quaternion with components [x, y, z, w]
+ *    set([x, y, z, w])   -> new quaternion with components [x, y, z, w]
+ *    set(quat)           -> copy of quat
+ *    set(vec2)           -> new quaternion with the components [vec2.xy, 0, 1]
+ *    set(vec3)           -> new quaternion with the components [vec3.xyz, 1]
+ *    set(vec4)           -> new quaternion with the components of vec4
+ *    set(mat3)           -> new quaternion from mat3
+ *    set(mat4)           -> new quaternion from mat4
+ */
+static VALUE sm_quat_init(int argc, VALUE *argv, VALUE sm_self)
+{
+  quat_t *self;
+  size_t arr_index = 0;
+
+  sm_check_writable(sm_self);
+  self = sm_unwrap_quat(sm_self, NULL);
+
+  switch(argc) {
+
+  /* Default value */
+  case 0: { break; }
+
+  /* Copy or by-array */
+  case 1: {
+    if (SM_IS_A(argv[0], quat) ||
+        SM_IS_A(argv[0], vec4)) {
+      sm_unwrap_quat(argv[0], *self);
+      break;
+    }
+
+    if (SM_IS_A(argv[0], vec2)) {
+      sm_unwrap_vec2(argv[0], *self);
+      self[0][2] = s_float_lit(0.0);
+      self[0][3] = s_float_lit(1.0);
+      break;
+    }
+
+    if (SM_IS_A(argv[0], vec3)) {
+      sm_unwrap_vec3(argv[0], *self);
+      self[0][3] = s_float_lit(1.0);
+      break;
+    }
+
+    if (SM_IS_A(argv[0], mat4)) {
+      const mat4_t *mat = sm_unwrap_mat4(argv[0], NULL);
+      quat_from_mat4(*mat, *self);
+      break;
+    }
+
+    if (SM_IS_A(argv[0], mat3)) {
+      const mat3_t *mat = sm_unwrap_mat3(argv[0], NULL);
+      quat_from_mat3(*mat, *self);
+      break;
+    }
+
+    /* Optional offset into array provided */
+    if (0) {
+      case 2:
+      arr_index = NUM2SIZET(argv[1]);
+    }
+
+    /* Array of values */
+    if (SM_RB_IS_A(argv[0], rb_cArray)) {
+      VALUE arrdata = argv[0];
+      const size_t arr_end = arr_index + 3;
+      s_float_t *vec_elem = *self;
+      for (; arr_index < arr_end; ++arr_index, ++vec_elem) {
+        *vec_elem = (s_float_t)NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
+      }
+      break;
+    }
+
+    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Quat");
+    break;
+  }
+
+  /* W */
+  case 4: {
+    self[0][3] = (s_float_t)NUM2DBL(argv[3]);
+    case 3: /* X, Y, Z */
+    self[0][0] = (s_float_t)NUM2DBL(argv[0]);
+    self[0][1] = (s_float_t)NUM2DBL(argv[1]);
+    self[0][2] = (s_float_t)NUM2DBL(argv[2]);
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
+    break;
+  }
+  } /* switch (argc) */
+
+  return sm_self;
+}
+
+
+
+/*
+ * Returns a string representation of self.
+ *
+ *    Quat[].to_s     # => "{ 0.0, 0.0, 0.0, 1.0 }"
+ *
+ * call-seq:
+ *    to_s -> string
+ */
+static VALUE sm_quat_to_s(VALUE self)
+{
+  const s_float_t *v;
+  v = (const s_float_t *)*sm_unwrap_quat(self, NULL);
+  return rb_sprintf(
+    "{ "
+    "%f, %f, %f, %f"
+    " }",
+    v[0], v[1], v[2], v[3]);
+}
+
+
+
+/*
+ * Returns a quaternion describing a rotation around a given axis.
+ *
+ * call-seq:
+ *    angle_axis(angle_degrees, axis_vec3, output = nil) -> output or new quat
+ */
+static VALUE sm_quat_angle_axis(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_angle;
+  VALUE sm_axis;
+  VALUE sm_out;
+  s_float_t angle;
+  const vec3_t *axis;
+
+  rb_scan_args(argc, argv, "21", &sm_angle, &sm_axis, &sm_out);
+  if (!SM_IS_A(sm_axis, vec3) && !SM_IS_A(sm_axis, vec4) && !SM_IS_A(sm_axis, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_axis));
+    return Qnil;
+  }
+
+  angle = (s_float_t)NUM2DBL(sm_angle);
+  axis = sm_unwrap_vec3(sm_axis, NULL);
+
+  if (SM_IS_A(sm_out, quat) || SM_IS_A(sm_out, vec4)) {
+    sm_check_writable(sm_out);
+    quat_t *out = sm_unwrap_quat(sm_out, NULL);
+    quat_from_angle_axis(angle, (*axis)[0], (*axis)[1], (*axis)[2], *out);
+  } else {
+    quat_t out;
+    quat_from_angle_axis(angle, (*axis)[0], (*axis)[1], (*axis)[2], out);
+    sm_out = sm_wrap_quat(out, self);
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Sets self to the identity quaternion.
+ *
+ * call-seq:
+ *    load_identity -> self
+ */
+static VALUE sm_quat_identity(VALUE sm_self)
+{
+  quat_t *self = sm_unwrap_quat(sm_self, NULL);
+  quat_identity(*self);
+  return sm_self;
+}
+
+
+
+/*
+ * Returns a quaternion interpolated between self and destination using
+ * spherical linear interpolation. Alpha is the interpolation value and must be
+ * clamped from 0 to 1.
+ *
+ * call-seq:
+ *    slerp(destination, alpha, output = nil) -> output or new quat
+ */
+static VALUE sm_quat_slerp(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  VALUE sm_destination;
+  VALUE sm_alpha;
+  quat_t *destination;
+  quat_t *self = sm_unwrap_vec4(sm_self, NULL);
+  s_float_t alpha;
+
+  rb_scan_args(argc, argv, "21", &sm_destination, &sm_alpha, &sm_out);
+  alpha = NUM2DBL(sm_alpha);
+
+  if (!SM_IS_A(sm_destination, vec4) && !SM_IS_A(sm_destination, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_destination));
+    return Qnil;
+  }
+
+  destination = sm_unwrap_quat(sm_destination, NULL);
+
+  if ((SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat))) {
+    sm_check_writable(sm_out);
+    quat_slerp(*self, *destination, alpha, *sm_unwrap_quat(sm_out, NULL));
+  } else {
+    quat_t out;
+    quat_slerp(*self, *destination, alpha, out);
+    sm_out = sm_wrap_quat(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
+}
+
+
+
+/*==============================================================================
+
+  mat4_t functions
+
+==============================================================================*/
+
+static VALUE sm_wrap_mat4(const mat4_t value, VALUE klass)
+{
+  mat4_t *copy;
+  VALUE sm_wrapped = Qnil;
+  if (!RTEST(klass)) {
+    klass = s_sm_mat4_klass;
+  }
+  sm_wrapped = Data_Make_Struct(klass, mat4_t, 0, free, copy);
+  if (value) {
+    mat4_copy(value, *copy);
+  }
+  return sm_wrapped;
+}
+
+
+
+static mat4_t *sm_unwrap_mat4(VALUE sm_value, mat4_t store)
+{
+  mat4_t *value;
+  Data_Get_Struct(sm_value, mat4_t, value);
+  if(store) mat4_copy(*value, store);
+  return value;
+}
+
+
+
+/*
+ * Gets the component of the Mat4 at the given index.
+ *
+ * call-seq: fetch(index) -> float
+ */
+static VALUE sm_mat4_fetch (VALUE sm_self, VALUE sm_index)
+{
+  static const int max_index = sizeof(mat4_t) / sizeof(s_float_t);
+  const mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
+  int index = NUM2INT(sm_index);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  }
+  return DBL2NUM(self[0][NUM2INT(sm_index)]);
+}
+
+
+
+/*
+ * Sets the Mat4's component at the index to the value.
+ *
+ * call-seq: store(index, value) -> value
+ */
+static VALUE sm_mat4_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+{
+  static const int max_index = sizeof(mat4_t) / sizeof(s_float_t);
+  mat4_t *self;
+  int index = NUM2INT(sm_index);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
+  }
+  self[0][index] = (s_float_t)NUM2DBL(sm_value);
+  return sm_value;
+}
+
+
+
+/*
+ * Returns the length in bytes of the Mat4. When compiled to use doubles as the
+ * base type, this is always 128. Otherwise, when compiled to use floats, it's
+ * always 64.
+ *
+ * call-seq: size -> fixnum
+ */
+static VALUE sm_mat4_size (VALUE self)
+{
+  return SIZET2NUM(sizeof(mat4_t));
+}
+
+
+
+/*
+ * Returns the length of the Mat4 in components. Result is always 16.
+ *
+ * call-seq: length -> fixnum
+ */
+static VALUE sm_mat4_length (VALUE self)
+{
+  return SIZET2NUM(sizeof(mat4_t) / sizeof(s_float_t));
+}
+
+
+
+/*
+ * Returns a copy of self.
+ *
+ * call-seq:
+ *    copy(output = nil) -> output or new mat4
+ */
+static VALUE sm_mat4_copy(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  mat4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat4_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat4(sm_out, NULL);
+    mat4_copy (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat4_t output;
+    mat4_copy (*self, output);
+    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Converts the Mat4 to a Mat3.
+ *
+ * call-seq:
+ *    to_mat3(output = nil) -> output or new mat3
+ */
+static VALUE sm_mat4_to_mat3(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  mat4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat3_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat3(sm_out, NULL);
+    mat4_to_mat3 (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat3_t output;
+    mat4_to_mat3 (*self, output);
+    sm_out = sm_wrap_mat3(output, s_sm_mat3_klass);
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to to_mat3");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Transposes this matrix and returns the result.
+ *
+ * call-seq:
+ *    transpose(output = nil) -> output or new mat4
+ */
+static VALUE sm_mat4_transpose(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  mat4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat4_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat4(sm_out, NULL);
+    mat4_transpose (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat4_t output;
+    mat4_transpose (*self, output);
+    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to transpose");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns an inverse orthogonal matrix.
+ *
+ * call-seq:
+ *    inverse_orthogonal(output = nil) -> output or new mat4
+ */
+static VALUE sm_mat4_inverse_orthogonal(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  mat4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat4_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat4(sm_out, NULL);
+    mat4_inverse_orthogonal (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat4_t output;
+    mat4_inverse_orthogonal (*self, output);
+    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_orthogonal");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns an adjoint matrix.
+ *
+ * call-seq:
+ *    adjoint(output = nil) -> output or new mat4
+ */
+static VALUE sm_mat4_adjoint(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out;
+  mat4_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat4_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat4(sm_out, NULL);
+    mat4_adjoint (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat4_t output;
+    mat4_adjoint (*self, output);
+    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to adjoint");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Multiplies this and another Mat4 together and returns the result.
+ *
+ * call-seq:
+ *    multiply_mat4(mat4, output = nil) -> output or new mat4
+ */
+static VALUE sm_mat4_multiply(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  mat4_t *self;
+  mat4_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  SM_RAISE_IF_NOT_TYPE(sm_rhs, mat4);
+  rhs = sm_unwrap_mat4(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat4_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat4(sm_out, NULL);
+    mat4_multiply(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    mat4_t output;
+    mat4_multiply(*self, *rhs, output);
+    sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_mat4");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Transforms a Vec4 using self and returns the resulting vector.
+ *
+ * call-seq:
+ *    multiply_vec4(vec4, output = nil) -> output or new vec4
+ */
+static VALUE sm_mat4_multiply_vec4(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  mat4_t *self;
+  vec4_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec4(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec4_t *output;
+    if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec4(sm_out, NULL);
+    mat4_multiply_vec4(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec4_t output;
+    mat4_multiply_vec4(*self, *rhs, output);
+    sm_out = sm_wrap_vec4(output, rb_obj_class(sm_rhs));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_vec4");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Transforms a Vec3 using self and returns the resulting vector.
+ *
+ * call-seq:
+ *    transform_vec3(vec3, output = nil) -> output or new vec3
+ */
+static VALUE sm_mat4_transform_vec3(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  mat4_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    mat4_transform_vec3(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    mat4_transform_vec3(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to transform_vec3");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Rotates a Vec3 by self, using only the inner 9x9 matrix to transform the
+ * vector. Returns the rotated vector.
+ *
+ * call-seq:
+ *    rotate_vec3(vec3, output = nil) -> output or new vec3
+ */
+static VALUE sm_mat4_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  mat4_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    mat4_rotate_vec3(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    mat4_rotate_vec3(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to rotate_vec3");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Convenience function to rotate a Vec3 using the inverse of self. Returns the
+ * resulting vector.
+ *
+ * call-seq:
+ *    inv_rotate_vec3(vec3, output = nil) -> output or new vec3
+ */
+static VALUE sm_mat4_inv_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  mat4_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    mat4_inv_rotate_vec3(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    mat4_inv_rotate_vec3(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_rotate_vec3");
+  }
+  return sm_out;
+}
+
+
+
+/*
+ * Returns an inverse affine matrix if successful. Otherwise, returns nil.
+ *
+ * call-seq:
+ *    inverse_affine(output = nil) -> output, new mat4, or nil
+ */
+static VALUE sm_mat4_inverse_affine(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out = Qnil;
+  mat4_t *self;
+
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+
+  if (argc == 1) {
+    mat4_t *output;
+
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(output_lbl);
+    }
+
+    if (!SM_IS_A(sm_out, mat4)) {
+      rb_raise(rb_eTypeError,
+        "Invalid argument to output of inverse_affine: expected %s, got %s",
+        rb_class2name(s_sm_mat4_klass),
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+
+    output = sm_unwrap_mat4(sm_out, NULL);
+    if (!mat4_inverse_affine(*self, *output)) {
+      return Qnil;
+    }
+
+  } else if (argc == 0) {
+    SM_LABEL(output_lbl): {
+      mat4_t output;
+      if (!mat4_inverse_affine(*self, output)) {
+        return Qnil;
+      }
+
+      sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+      rb_obj_call_init(sm_out, 0, 0);
+    }
+  } else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_affine");
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Returns an generalized inverse matrix if successful. Otherwise, returns nil.
+ *
+ * call-seq:
+ *    inverse_general(output = nil) -> output, new mat4, or nil
+ */
+static VALUE sm_mat4_inverse_general(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out = Qnil;
+  mat4_t *self;
+
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat4(sm_self, NULL);
+
+  if (argc == 1) {
+    mat4_t *output;
+
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }
+
+    if (!SM_IS_A(sm_out, mat4)) {
+      rb_raise(rb_eTypeError,
+        "Invalid argument to output of inverse_general: expected %s, got %s",
+        rb_class2name(s_sm_mat4_klass),
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+
+    output = sm_unwrap_mat4(sm_out, NULL);
+    if (!mat4_inverse_general(*self, *output)) {
+      return Qnil;
+    }
+
+  } else if (argc == 0) {
+    SM_LABEL(skip_output): {
+      mat4_t output;
+      if (!mat4_inverse_general(*self, output)) {
+        return Qnil;
+      }
+
+      sm_out = sm_wrap_mat4(output, rb_obj_class(sm_self));
+      rb_obj_call_init(sm_out, 0, 0);
+    }
+  } else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_general");
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Returns the matrix determinant.
+ *
+ * call-seq:
+ *    determinant -> float
+ */
+static VALUE sm_mat4_determinant(VALUE sm_self)
+{
+  return DBL2NUM(mat4_determinant(*sm_unwrap_mat4(sm_self, NULL)));
+}
+
+
+
+/*
+ * Translates this matrix by X, Y, and Z (or a Vec3's X, Y, and Z components)
+ * and returns the result. Essentially the same as multiplying this matrix by a
+ * translation matrix, but slightly more convenient.
+ *
+ * call-seq:
+ *    translate(x, y, z, output = nil) -> output or new mat4
+ *    translate(vec3, output = nil)    -> output or new mat4
+ */
+static VALUE sm_mat4_translate(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out = Qnil;
+  mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
+  vec3_t xyz;
+
+  SM_LABEL(argc_reconfig):
+  switch (argc) {
+  case 2: case 4: {
+    sm_out = argv[--argc];
+    if (RTEST(sm_out)) {
+      SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
+    }
+    goto SM_LABEL(argc_reconfig);
+  }
+
+  case 1: {
+    sm_unwrap_vec3(argv[0], xyz);
+    goto SM_LABEL(get_output);
+  }
+
+  case 3: {
+    xyz[0] = NUM2DBL(argv[0]);
+    xyz[1] = NUM2DBL(argv[1]);
+    xyz[2] = NUM2DBL(argv[2]);
+
+    SM_LABEL(get_output):
+    if (RTEST(sm_out)) {
+      sm_check_writable(sm_out);
+      mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
+      mat4_translate(xyz[0], xyz[1], xyz[2], *self, *out);
+    } else {
+      mat4_t out;
+      mat4_translate(xyz[0], xyz[1], xyz[2], *self, out);
+      sm_out = sm_wrap_mat4(out, rb_obj_class(sm_self));
+      rb_obj_call_init(sm_out, 0, 0);
+    }
+  }
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a translation matrix for the given X, Y, and Z translations (or using
+ * the vector's components as such).
+ *
+ * call-seq:
+ *    translation(x, y, z, output = nil) -> output or new mat4
+ *    translation(vec3, output = nil)    -> output or new mat4
+ */
+static VALUE sm_mat4_translation(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_out = Qnil;
+  vec3_t xyz;
+
+  SM_LABEL(argc_reconfig):
+  switch (argc) {
+  case 2: case 4: {
+    sm_out = argv[--argc];
+    if (RTEST(sm_out)) {
+      SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
+    }
+    goto SM_LABEL(argc_reconfig);
+  }
+
+  case 1: {
+    sm_unwrap_vec3(argv[0], xyz);
+    goto SM_LABEL(get_output);
+  }
+
+  case 3: {
+    xyz[0] = NUM2DBL(argv[0]);
+    xyz[1] = NUM2DBL(argv[1]);
+    xyz[2] = NUM2DBL(argv[2]);
+
+    SM_LABEL(get_output):
+    if (RTEST(sm_out)) {
+      sm_check_writable(sm_out);
+      mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
+      mat4_translation(xyz[0], xyz[1], xyz[2], *out);
+    } else {
+      mat4_t out;
+      mat4_translation(xyz[0], xyz[1], xyz[2], out);
+      sm_out = sm_wrap_mat4(out, sm_self);
+      rb_obj_call_init(sm_out, 0, 0);
+    }
+  }
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Allocates a new Mat4.
+ *
+ * call-seq:
+ *    new()                        -> identity mat4
+ *    new(m1, m2, ..., m15, m16)   -> new mat4 with components
+ *    new([m1, m2, ..., m15, m16]) -> new mat4 with components
+ *    new(mat4)                    -> copy of mat4
+ *    new(mat3)                    -> new mat4 with mat3's components
+ *    new(quat)                    -> quat as mat4
+ *    new(Vec4, Vec4, Vec4, Vec4)  -> new mat4 with given row vectors
+ */
+static VALUE sm_mat4_new(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_mat = sm_wrap_mat4(g_mat4_identity, self);
+  rb_obj_call_init(sm_mat, argc, argv);
+  return sm_mat;
+}
+
+
+
+/*
+ * Sets the Mat4's components.
+ *
+ * call-seq:
+ *    set(m1, m2, ..., m15, m16)   -> new mat4 with components
+ *    set([m1, m2, ..., m15, m16]) -> new mat4 with components
+ *    set(mat4)                    -> copy of mat4
+ *    set(mat3)                    -> new mat4 with mat3's components
+ *    set(quat)                    -> quat as mat4
+ *    set(Vec4, Vec4, Vec4, Vec4)  -> new mat4 with given row vectors
+ */
+static VALUE sm_mat4_init(int argc, VALUE *argv, VALUE sm_self)
+{
+  mat4_t *self;
+  size_t arr_index = 0;
+
+  sm_check_writable(sm_self);
+  self = sm_unwrap_mat4(sm_self, NULL);
+
+  switch (argc) {
+
+  case 0: {
+    /* Identity (handled in _new) */
+    break;
+  }
+
+  /* Copy Mat4 or provided [Numeric..] */
+  case 1: {
+    /* Copy Mat4 */
+    if (SM_IS_A(argv[0], mat4)) {
+      sm_unwrap_mat4(argv[0], *self);
+      break;
+    }
+
+    /* Copy Mat3 */
+    if (SM_IS_A(argv[0], mat3)) {
+      mat3_to_mat4(*sm_unwrap_mat4(argv[0], NULL), *self);
+      break;
+    }
+
+    /* Build from Quaternion */
+    if (SM_IS_A(argv[0], quat)) {
+      mat4_from_quat(*sm_unwrap_quat(argv[0], NULL), *self);
+      break;
+    }
+
+    /* Optional offset into array provided */
+    if (0) {
+      case 2:
+      arr_index = NUM2SIZET(argv[1]);
+    }
+
+    /* Array of values */
+    if (SM_RB_IS_A(argv[0], rb_cArray)) {
+      VALUE arrdata = argv[0];
+      const size_t arr_end = arr_index + 16;
+      s_float_t *mat_elem = *self;
+      for (; arr_index < arr_end; ++arr_index, ++mat_elem) {
+        *mat_elem = NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
+      }
+      break;
+    }
+
+    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Mat4");
+    break;
+  }
+
+  /* Mat4(Vec4, Vec4, Vec4, Vec4) */
+  case 4: {
+    size_t arg_index;
+    s_float_t *mat_elem = *self;
+    for (arg_index = 0; arg_index < 4; ++arg_index, mat_elem += 4) {
+      if (!SM_IS_A(argv[arg_index], vec4) && !SM_IS_A(argv[arg_index], quat)) {
+        rb_raise(
+          rb_eArgError,
+          "Argument %d must be a Vec4 or Quat when supplying four arguments to initialize/set",
+          (int)(arg_index + 1));
+      }
+
+      sm_unwrap_vec4(argv[arg_index], mat_elem);
+    }
+    break;
+  }
+
+  /* Mat4(Numeric m00 .. m16) */
+  case 16: {
+    s_float_t *mat_elem = *self;
+    VALUE *argv_p = argv;
+    for (; argc; --argc, ++argv_p, ++mat_elem) {
+      *mat_elem = (s_float_t)NUM2DBL(*argv_p);
+    }
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
+    break;
+  }
+  } /* switch (argc) */
+
+  return sm_self;
+}
+
+
+
+/*
+ * Returns a string representation of self.
+ *
+ *    Mat4[].to_s     # => "{ 1.0, 0.0, 0.0, 0.0,\n
+ *                    #       0.0, 1.0, 0.0, 0.0,\n"
+ *                    #       0.0, 0.0, 1.0, 0.0,\n"
+ *                    #       0.0, 0.0, 0.0, 1.0 }"
+ *
+ * call-seq:
+ *    to_s -> string
+ */
+static VALUE sm_mat4_to_s(VALUE self)
+{
+  const s_float_t *v;
+  v = (const s_float_t *)*sm_unwrap_mat4(self, NULL);
+  return rb_sprintf(
+    "{ "
+    "%f, %f, %f, %f" ",\n  "
+    "%f, %f, %f, %f" ",\n  "
+    "%f, %f, %f, %f" ",\n  "
+    "%f, %f, %f, %f"
+    " }",
+    v[0], v[1], v[2], v[3],
+    v[4], v[5], v[6], v[7],
+    v[8], v[9], v[10], v[11],
+    v[12], v[13], v[14], v[15]);
+}
+
+
+
+/*
+ * Returns a Mat4 describing a rotation around an axis.
+ *
+ * call-seq:
+ *    angle_axis(angle_degrees, axis_vec3, output = nil) -> output or new mat4
+ */
+static VALUE sm_mat4_angle_axis(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_angle;
+  VALUE sm_axis;
+  VALUE sm_out;
+  s_float_t angle;
+  const vec3_t *axis;
+
+  rb_scan_args(argc, argv, "21", &sm_angle, &sm_axis, &sm_out);
+  if (!SM_IS_A(sm_axis, vec3) && !SM_IS_A(sm_axis, vec4) && !SM_IS_A(sm_axis, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_axis));
+    return Qnil;
+  }
+
+  angle = (s_float_t)NUM2DBL(sm_angle);
+  axis = sm_unwrap_vec3(sm_axis, NULL);
+
+  if (SM_IS_A(sm_out, mat4)) {
+    sm_check_writable(sm_out);
+    mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
+    mat4_rotation(angle, (*axis)[0], (*axis)[1], (*axis)[2], *out);
+  } else {
+    mat4_t out;
+    mat4_rotation(angle, (*axis)[0], (*axis)[1], (*axis)[2], out);
+    sm_out = sm_wrap_mat4(out, self);
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a Vec3 whose components are that of the row at the given index.
+ *
+ * call-seq:
+ *    get_row3(index, output = nil) -> output or new vec3
+ */
+static VALUE sm_mat4_get_row3(int argc, VALUE *argv, VALUE sm_self)
+{
+  mat4_t *self;
+  int index;
+  VALUE sm_out;
+
+  self = sm_unwrap_mat4(sm_self, NULL);
+  index = NUM2INT(argv[0]);
+  sm_out = Qnil;
+
+  if (index < 0 || index > 3) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
+    return Qnil;
+  }
+
+  switch (argc) {
+  case 2: {
+    vec3_t *out;
+
+    sm_out = argv[1];
+
+    if (RTEST(sm_out)) {
+      if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+        rb_raise(rb_eTypeError,
+          kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+          rb_obj_classname(sm_out));
+        return Qnil;
+      }
+      sm_check_writable(sm_out);
+    } else {
+      goto SM_LABEL(no_output);
+    }
+
+    out = sm_unwrap_vec3(sm_out, NULL);
+    mat4_get_row3(*self, index, *out);
+
+    break;
+  }
+
+  case 1: SM_LABEL(no_output): {
+    vec3_t out;
+    mat4_get_row3(*self, index, out);
+    sm_out = sm_wrap_vec3(out, Qnil);
+    rb_obj_call_init(sm_out, 0, 0);
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid number of arguments to get_row3 - expected 1 or 2");
+    break;
+  }
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a Vec4 whose components are that of the row at the given index.
+ *
+ * call-seq:
+ *    get_row4(index, output = nil) -> output or new vec4
+ */
+static VALUE sm_mat4_get_row4(int argc, VALUE *argv, VALUE sm_self)
+{
+  mat4_t *self;
+  int index;
+  VALUE sm_out;
+
+  self = sm_unwrap_mat4(sm_self, NULL);
+  index = NUM2INT(argv[0]);
+  sm_out = Qnil;
+
+  if (index < 0 || index > 3) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
+    return Qnil;
+  }
+
+  switch (argc) {
+  case 2: {
+    vec4_t *out;
+
+    sm_out = argv[1];
+
+    if (RTEST(sm_out)) {
+      if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+        rb_raise(rb_eTypeError,
+          kSM_WANT_FOUR_FORMAT_LIT,
+          rb_obj_classname(sm_out));
+        return Qnil;
+      }
+      sm_check_writable(sm_out);
+    } else {
+      goto SM_LABEL(no_output);
+    }
+
+    out = sm_unwrap_vec4(sm_out, NULL);
+    mat4_get_row4(*self, index, *out);
+
+    break;
+  }
+
+  case 1: SM_LABEL(no_output): {
+    vec4_t out;
+    mat4_get_row4(*self, index, out);
+    sm_out = sm_wrap_vec4(out, Qnil);
+    rb_obj_call_init(sm_out, 0, 0);
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid number of arguments to get_row4 - expected 1 or 2");
+    break;
+  }
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a Vec3 whose components are that of the column at the given index.
+ *
+ * call-seq:
+ *    get_column3(index, output = nil) -> output or new vec3
+ */
+static VALUE sm_mat4_get_column3(int argc, VALUE *argv, VALUE sm_self)
+{
+  mat4_t *self;
+  int index;
+  VALUE sm_out;
+
+  self = sm_unwrap_mat4(sm_self, NULL);
+  index = NUM2INT(argv[0]);
+  sm_out = Qnil;
+
+  if (index < 0 || index > 3) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
+    return Qnil;
+  }
+
+  switch (argc) {
+  case 2: {
+    vec3_t *out;
+
+    sm_out = argv[1];
+
+    if (RTEST(sm_out)) {
+      if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+        rb_raise(rb_eTypeError,
+          kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+          rb_obj_classname(sm_out));
+        return Qnil;
+      }
+      sm_check_writable(sm_out);
+    } else {
+      goto SM_LABEL(no_output);
+    }
+
+    out = sm_unwrap_vec3(sm_out, NULL);
+    mat4_get_column3(*self, index, *out);
+
+    break;
+  }
+
+  case 1: SM_LABEL(no_output): {
+    vec3_t out;
+    mat4_get_column3(*self, index, out);
+    sm_out = sm_wrap_vec3(out, Qnil);
+    rb_obj_call_init(sm_out, 0, 0);
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid number of arguments to get_column3 - expected 1 or 2");
+    break;
+  }
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a Vec4 whose components are that of the column at the given index.
+ *
+ * call-seq:
+ *    get_column4(index, output = nil) -> output or new vec4
+ */
+static VALUE sm_mat4_get_column4(int argc, VALUE *argv, VALUE sm_self)
+{
+  mat4_t *self;
+  int index;
+  VALUE sm_out;
+
+  self = sm_unwrap_mat4(sm_self, NULL);
+  index = NUM2INT(argv[0]);
+  sm_out = Qnil;
+
+  if (index < 0 || index > 3) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
+    return Qnil;
+  }
+
+  switch (argc) {
+  case 2: {
+    vec4_t *out;
+
+    sm_out = argv[1];
+
+    if (RTEST(sm_out)) {
+      if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+        rb_raise(rb_eTypeError,
+          kSM_WANT_FOUR_FORMAT_LIT,
+          rb_obj_classname(sm_out));
+        return Qnil;
+      }
+      sm_check_writable(sm_out);
+    } else {
+      goto SM_LABEL(no_output);
+    }
+
+    out = sm_unwrap_vec4(sm_out, NULL);
+    mat4_get_column4(*self, index, *out);
+
+    break;
+  }
+
+  case 1: SM_LABEL(no_output): {
+    vec4_t out;
+    mat4_get_column4(*self, index, out);
+    sm_out = sm_wrap_vec4(out, Qnil);
+    rb_obj_call_init(sm_out, 0, 0);
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid number of arguments to get_column4 - expected 1 or 2");
+    break;
+  }
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Sets the matrix's row at the given index to the given vector.
+ *
+ * call-seq:
+ *    set_row3(index, vec3) -> self
+ */
+static VALUE sm_mat4_set_row3(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+{
+  const vec3_t *value;
+  int index;
+  mat4_t *self;
+
+  if (!SM_IS_A(sm_value, vec3) && !SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_value));
+    return Qnil;
+  }
+
+  self = sm_unwrap_mat4(sm_self, NULL);
+  value = sm_unwrap_vec3(sm_value, NULL);
+  index = NUM2INT(sm_index);
+
+  if (index < 0 || index > 3) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
+    return Qnil;
+  }
+
+  mat4_set_row3(index, *value, *self);
+
+  return sm_self;
+}
+
+
+
+/*
+ * Sets the matrix's column at the given index to the given vector.
+ *
+ * call-seq:
+ *    set_column3(index, vec3) -> self
+ */
+static VALUE sm_mat4_set_column3(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+{
+  const vec3_t *value;
+  int index;
+  mat4_t *self;
+
+  if (!SM_IS_A(sm_value, vec3) && !SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_value));
+    return Qnil;
+  }
+
+  self = sm_unwrap_mat4(sm_self, NULL);
+  value = sm_unwrap_vec3(sm_value, NULL);
+  index = NUM2INT(sm_index);
+
+  if (index < 0 || index > 3) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
+    return Qnil;
+  }
+
+  mat4_set_column3(index, *value, *self);
+
+  return sm_self;
+}
+
+
+
+/*
+ * Sets the matrix's row at the given index to the given vector.
+ *
+ * call-seq:
+ *    set_row4(index, vec4) -> self
+ */
+static VALUE sm_mat4_set_row4(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+{
+  const vec4_t *value;
+  int index;
+  mat4_t *self;
+
+  if (!SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_value));
+    return Qnil;
+  }
+
+  self = sm_unwrap_mat4(sm_self, NULL);
+  value = sm_unwrap_vec4(sm_value, NULL);
+  index = NUM2INT(sm_index);
+
+  if (index < 0 || index > 3) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
+    return Qnil;
+  }
+
+  mat4_set_row4(index, *value, *self);
+
+  return sm_self;
+}
+
+
+
+/*
+ * Sets the matrix's column at the given index to the given vector.
+ *
+ * call-seq:
+ *    set_column4(index, vec4) -> self
+ */
+static VALUE sm_mat4_set_column4(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+{
+  const vec4_t *value;
+  int index;
+  mat4_t *self;
+
+  if (!SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_value));
+      return Qnil;
+    }
+
+  self = sm_unwrap_mat4(sm_self, NULL);
+  value = sm_unwrap_vec4(sm_value, NULL);
+  index = NUM2INT(sm_index);
+
+  if (index < 0 || index > 3) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
+    return Qnil;
+  }
+
+  mat4_set_column4(index, *value, *self);
+
+  return sm_self;
+}
+
+
+
+/*
+ * Sets self to the identity matrix.
+ *
+ * call-seq:
+ *    load_identity -> self
+ */
+static VALUE sm_mat4_identity(VALUE sm_self)
+{
+  mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
+  mat4_identity(*self);
+  return sm_self;
+}
+
+
+
+/*
+ * Returns a matrix describing a frustum perspective.
+ *
+ * call-seq:
+ *    frustum(left, right, bottom, top, z_near, z_far, output = nil) -> output or new mat4
+ */
+static VALUE sm_mat4_frustum(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_left;
+  VALUE sm_right;
+  VALUE sm_bottom;
+  VALUE sm_top;
+  VALUE sm_z_near;
+  VALUE sm_z_far;
+  VALUE sm_out;
+  s_float_t left;
+  s_float_t right;
+  s_float_t bottom;
+  s_float_t top;
+  s_float_t z_near;
+  s_float_t z_far;
+
+  rb_scan_args(argc, argv, "61", &sm_left, &sm_right, &sm_bottom, &sm_top, &sm_z_near, &sm_z_far, &sm_out);
+
+  left = (s_float_t)NUM2DBL(sm_left);
+  right = (s_float_t)NUM2DBL(sm_right);
+  bottom = (s_float_t)NUM2DBL(sm_bottom);
+  top = (s_float_t)NUM2DBL(sm_top);
+  z_near = (s_float_t)NUM2DBL(sm_z_near);
+  z_far = (s_float_t)NUM2DBL(sm_z_far);
+
+  if (SM_IS_A(sm_out, mat4)) {
+    sm_check_writable(sm_out);
+    mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
+    mat4_frustum(left, right, bottom, top, z_near, z_far, *out);
+  } else {
+    mat4_t out;
+    mat4_frustum(left, right, bottom, top, z_near, z_far, out);
+    sm_out = sm_wrap_mat4(out, Qnil);
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
+}
+
+
+
+/*
+ * Returns a matrix describing an orthographic projection.
+ *
+ * call-seq:
+ *    orthographic(left, right, bottom, top, z_near, z_far, output = nil) -> output or new mat4
+ */
+static VALUE sm_mat4_orthographic(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_left;
+  VALUE sm_right;
+  VALUE sm_bottom;
+  VALUE sm_top;
+  VALUE sm_z_near;
+  VALUE sm_z_far;
+  VALUE sm_out;
+  s_float_t left;
+  s_float_t right;
+  s_float_t bottom;
+  s_float_t top;
+  s_float_t z_near;
+  s_float_t z_far;
+
+  rb_scan_args(argc, argv, "61", &sm_left, &sm_right, &sm_bottom, &sm_top, &sm_z_near, &sm_z_far, &sm_out);
+
+  left = (s_float_t)NUM2DBL(sm_left);
+  right = (s_float_t)NUM2DBL(sm_right);
+  bottom = (s_float_t)NUM2DBL(sm_bottom);
+  top = (s_float_t)NUM2DBL(sm_top);
+  z_near = (s_float_t)NUM2DBL(sm_z_near);
+  z_far = (s_float_t)NUM2DBL(sm_z_far);
+
+  if (SM_IS_A(sm_out, mat4)) {
+    sm_check_writable(sm_out);
+    mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
+    mat4_orthographic(left, right, bottom, top, z_near, z_far, *out);
+  } else {
+    mat4_t out;
+    mat4_orthographic(left, right, bottom, top, z_near, z_far, out);
+    sm_out = sm_wrap_mat4(out, self);
+    rb_obj_call_init(sm_out, 0, 0);
   }
-  } /* switch (argc) */
 
-  return sm_self;
+  return sm_out;
 }
 
 
 
 /*
- * Returns a string representation of self.
- *
- *    Mat4[].to_s     # => "{ 1.0, 0.0, 0.0, 0.0,\n
- *                    #       0.0, 1.0, 0.0, 0.0,\n"
- *                    #       0.0, 0.0, 1.0, 0.0,\n"
- *                    #       0.0, 0.0, 0.0, 1.0 }"
+ * Returns a matrix describing a perspective projection.
  *
  * call-seq:
- *    to_s -> string
+ *    perspective(fov_y_degrees, aspect, z_near, z_far, output = nil) -> output or new mat4
  */
-static VALUE sm_mat4_to_s(VALUE self)
+static VALUE sm_mat4_perspective(int argc, VALUE *argv, VALUE self)
 {
-  const s_float_t *v;
-  v = (const s_float_t *)*sm_unwrap_mat4(self, NULL);
-  return rb_sprintf(
-    "{ "
-    "%f, %f, %f, %f" ",\n  "
-    "%f, %f, %f, %f" ",\n  "
-    "%f, %f, %f, %f" ",\n  "
-    "%f, %f, %f, %f"
-    " }",
-    v[0], v[1], v[2], v[3],
-    v[4], v[5], v[6], v[7],
-    v[8], v[9], v[10], v[11],
-    v[12], v[13], v[14], v[15]);
+  VALUE sm_fov_y;
+  VALUE sm_aspect;
+  VALUE sm_z_near;
+  VALUE sm_z_far;
+  VALUE sm_out;
+  s_float_t fov_y;
+  s_float_t aspect;
+  s_float_t z_near;
+  s_float_t z_far;
+
+  rb_scan_args(argc, argv, "41", &sm_fov_y, &sm_aspect, &sm_z_near, &sm_z_far, &sm_out);
+
+  fov_y = (s_float_t)NUM2DBL(sm_fov_y);
+  aspect = (s_float_t)NUM2DBL(sm_aspect);
+  z_near = (s_float_t)NUM2DBL(sm_z_near);
+  z_far = (s_float_t)NUM2DBL(sm_z_far);
+
+  if (SM_IS_A(sm_out, mat4)) {
+    sm_check_writable(sm_out);
+    mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
+    mat4_perspective(fov_y, aspect, z_near, z_far, *out);
+  } else {
+    mat4_t out;
+    mat4_perspective(fov_y, aspect, z_near, z_far, out);
+    sm_out = sm_wrap_mat4(out, self);
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
 }
 
 
 
 /*
- * Returns a Mat4 describing a rotation around an axis.
+ * Returns a matrix describing a view transformation for an eye looking at
+ * center with the given up vector.
  *
  * call-seq:
- *    angle_axis(angle_degrees, axis_vec3, output = nil) -> output or new mat4
+ *    look_at(eye, center, up, output = nil) -> output or new mat4
  */
-static VALUE sm_mat4_angle_axis(int argc, VALUE *argv, VALUE self)
+static VALUE sm_mat4_look_at(int argc, VALUE *argv, VALUE self)
 {
-  VALUE sm_angle;
-  VALUE sm_axis;
+  VALUE sm_eye;
+  VALUE sm_center;
+  VALUE sm_up;
   VALUE sm_out;
-  s_float_t angle;
-  const vec3_t *axis;
+  const vec3_t *eye;
+  const vec3_t *center;
+  const vec3_t *up;
 
-  rb_scan_args(argc, argv, "21", &sm_angle, &sm_axis, &sm_out);
-  if (!SM_IS_A(sm_axis, vec3) && !SM_IS_A(sm_axis, vec4) && !SM_IS_A(sm_axis, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_axis));
-    return Qnil;
-  }
+  rb_scan_args(argc, argv, "31", &sm_eye, &sm_center, &sm_up, &sm_out);
 
-  angle = (s_float_t)NUM2DBL(sm_angle);
-  axis = sm_unwrap_vec3(sm_axis, NULL);
+  eye = sm_unwrap_vec3(sm_eye, NULL);
+  center = sm_unwrap_vec3(sm_center, NULL);
+  up = sm_unwrap_vec3(sm_up, NULL);
 
   if (SM_IS_A(sm_out, mat4)) {
-    rb_check_frozen(sm_out);
+    sm_check_writable(sm_out);
     mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
-    mat4_rotation(angle, (*axis)[0], (*axis)[1], (*axis)[2], *out);
+    mat4_look_at(*eye, *center, *up, *out);
   } else {
     mat4_t out;
-    mat4_rotation(angle, (*axis)[0], (*axis)[1], (*axis)[2], out);
+    mat4_look_at(*eye, *center, *up, out);
     sm_out = sm_wrap_mat4(out, self);
     rb_obj_call_init(sm_out, 0, 0);
   }
@@ -5122,583 +10969,623 @@ static VALUE sm_mat4_angle_axis(int argc, VALUE *argv, VALUE self)
 
 
 /*
- * Returns a Vec3 whose components are that of the row at the given index.
+ * Scales the inner 9x9 matrix's columns by X, Y, and Z and returns the result.
  *
  * call-seq:
- *    get_row3(index, output = nil) -> output or new vec3
+ *    scale(x, y, z, output = nil) -> output or new mat4
  */
-static VALUE sm_mat4_get_row3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat4_scale(int argc, VALUE *argv, VALUE sm_self)
 {
-  mat4_t *self;
-  int index;
   VALUE sm_out;
+  VALUE sm_x, sm_y, sm_z;
+  s_float_t x, y, z;
+  mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
 
-  self = sm_unwrap_mat4(sm_self, NULL);
-  index = NUM2INT(argv[0]);
-  sm_out = Qnil;
+  rb_scan_args(argc, argv, "31", &sm_x, &sm_y, &sm_z, &sm_out);
+  x = NUM2DBL(sm_x);
+  y = NUM2DBL(sm_y);
+  z = NUM2DBL(sm_z);
 
-  if (index < 0 || index > 3) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
-    return Qnil;
+  if (SM_IS_A(sm_out, mat4)) {
+    sm_check_writable(sm_out);
+    mat4_scale(*self, x, y, z, *sm_unwrap_mat4(sm_out, NULL));
+  } else {
+    mat4_t out;
+    mat4_scale(*self, x, y, z, out);
+    sm_out = sm_wrap_mat4(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
   }
 
-  switch (argc) {
-  case 2: {
-    vec3_t *out;
-
-    sm_out = argv[1];
+  return sm_out;
+}
 
-    if (RTEST(sm_out)) {
-      if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-        rb_raise(rb_eTypeError,
-          kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-          rb_obj_classname(sm_out));
-        return Qnil;
-      }
-      rb_check_frozen(sm_out);
-    } else {
-      goto SM_LABEL(no_output);
-    }
 
-    out = sm_unwrap_vec3(sm_out, NULL);
-    mat4_get_row3(*self, index, *out);
 
-    break;
+/*
+ * Tests this Mat4 and another Mat4 for equivalency.
+ *
+ * call-seq:
+ *    mat4 == other_mat4 -> bool
+ */
+static VALUE sm_mat4_equals(VALUE sm_self, VALUE sm_other)
+{
+  if (!RTEST(sm_other) || !SM_IS_A(sm_other, mat4)) {
+    return Qfalse;
   }
 
-  case 1: SM_LABEL(no_output): {
-    vec3_t out;
-    mat4_get_row3(*self, index, out);
-    sm_out = sm_wrap_vec3(out, Qnil);
-    rb_obj_call_init(sm_out, 0, 0);
-    break;
+  return mat4_equals(*sm_unwrap_mat4(sm_self, NULL), *sm_unwrap_mat4(sm_other, NULL)) ? Qtrue : Qfalse;
+}
+
+
+
+/*==============================================================================
+
+  mat3_t functions
+
+==============================================================================*/
+
+static VALUE sm_wrap_mat3(const mat3_t value, VALUE klass)
+{
+  mat3_t *copy;
+  VALUE sm_wrapped = Qnil;
+  if (!RTEST(klass)) {
+    klass = s_sm_mat3_klass;
   }
+  sm_wrapped = Data_Make_Struct(klass, mat3_t, 0, free, copy);
+  if (value) {
+    mat3_copy(value, *copy);
+  }
+  return sm_wrapped;
+}
 
-  default: {
-    rb_raise(rb_eArgError, "Invalid number of arguments to get_row3 - expected 1 or 2");
-    break;
+
+
+static mat3_t *sm_unwrap_mat3(VALUE sm_value, mat3_t store)
+{
+  mat3_t *value;
+  Data_Get_Struct(sm_value, mat3_t, value);
+  if(store) mat3_copy(*value, store);
+  return value;
+}
+
+
+
+/*
+ * Gets the component of the Mat3 at the given index.
+ *
+ * call-seq: fetch(index) -> float
+ */
+static VALUE sm_mat3_fetch (VALUE sm_self, VALUE sm_index)
+{
+  static const int max_index = sizeof(mat3_t) / sizeof(s_float_t);
+  const mat3_t *self = sm_unwrap_mat3(sm_self, NULL);
+  int index = NUM2INT(sm_index);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
   }
+  return DBL2NUM(self[0][NUM2INT(sm_index)]);
+}
+
+
+
+/*
+ * Sets the Mat3's component at the index to the value.
+ *
+ * call-seq: store(index, value) -> value
+ */
+static VALUE sm_mat3_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+{
+  static const int max_index = sizeof(mat3_t) / sizeof(s_float_t);
+  mat3_t *self;
+  int index = NUM2INT(sm_index);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (index < 0 || index >= max_index) {
+    rb_raise(rb_eRangeError,
+      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
   }
+  self[0][index] = (s_float_t)NUM2DBL(sm_value);
+  return sm_value;
+}
 
-  return sm_out;
+
+
+/*
+ * Returns the length in bytes of the Mat3. When compiled to use doubles as the
+ * base type, this is always 72. Otherwise, when compiled to use floats, it's
+ * always 36.
+ *
+ * call-seq: size -> fixnum
+ */
+static VALUE sm_mat3_size (VALUE self)
+{
+  return SIZET2NUM(sizeof(mat3_t));
+}
+
+
+
+/*
+ * Returns the length of the Mat3 in components. Result is always 9.
+ *
+ * call-seq: length -> fixnum
+ */
+static VALUE sm_mat3_length (VALUE self)
+{
+  return SIZET2NUM(sizeof(mat3_t) / sizeof(s_float_t));
 }
 
 
 
 /*
- * Returns a Vec4 whose components are that of the row at the given index.
+ * Returns a copy of self.
  *
  * call-seq:
- *    get_row4(index, output = nil) -> output or new vec4
+ *    copy(output = nil) -> output or new mat3
  */
-static VALUE sm_mat4_get_row4(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_copy(int argc, VALUE *argv, VALUE sm_self)
 {
-  mat4_t *self;
-  int index;
   VALUE sm_out;
-
-  self = sm_unwrap_mat4(sm_self, NULL);
-  index = NUM2INT(argv[0]);
-  sm_out = Qnil;
-
-  if (index < 0 || index > 3) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
-    return Qnil;
-  }
-
-  switch (argc) {
-  case 2: {
-    vec4_t *out;
-
-    sm_out = argv[1];
-
-    if (RTEST(sm_out)) {
-      if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-        rb_raise(rb_eTypeError,
-          kSM_WANT_FOUR_FORMAT_LIT,
-          rb_obj_classname(sm_out));
-        return Qnil;
-      }
-      rb_check_frozen(sm_out);
-    } else {
-      goto SM_LABEL(no_output);
-    }
-
-    out = sm_unwrap_vec4(sm_out, NULL);
-    mat4_get_row4(*self, index, *out);
-
-    break;
-  }
-
-  case 1: SM_LABEL(no_output): {
-    vec4_t out;
-    mat4_get_row4(*self, index, out);
-    sm_out = sm_wrap_vec4(out, Qnil);
+  mat3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat3_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat3(sm_out, NULL);
+    mat3_copy (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat3_t output;
+    mat3_copy (*self, output);
+    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
-    break;
-  }
-
-  default: {
-    rb_raise(rb_eArgError, "Invalid number of arguments to get_row4 - expected 1 or 2");
-    break;
-  }
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
   }
-
   return sm_out;
 }
 
 
 
 /*
- * Returns a Vec3 whose components are that of the column at the given index.
+ * Returns a Mat4 converted from the Mat3.
  *
  * call-seq:
- *    get_column3(index, output = nil) -> output or new vec3
+ *    to_mat4(output = nil) -> output or new mat4
  */
-static VALUE sm_mat4_get_column3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_to_mat4(int argc, VALUE *argv, VALUE sm_self)
 {
-  mat4_t *self;
-  int index;
   VALUE sm_out;
-
-  self = sm_unwrap_mat4(sm_self, NULL);
-  index = NUM2INT(argv[0]);
-  sm_out = Qnil;
-
-  if (index < 0 || index > 3) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
-    return Qnil;
-  }
-
-  switch (argc) {
-  case 2: {
-    vec3_t *out;
-
-    sm_out = argv[1];
-
-    if (RTEST(sm_out)) {
-      if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-        rb_raise(rb_eTypeError,
-          kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-          rb_obj_classname(sm_out));
-        return Qnil;
-      }
-      rb_check_frozen(sm_out);
-    } else {
-      goto SM_LABEL(no_output);
-    }
-
-    out = sm_unwrap_vec3(sm_out, NULL);
-    mat4_get_column3(*self, index, *out);
-
-    break;
-  }
-
-  case 1: SM_LABEL(no_output): {
-    vec3_t out;
-    mat4_get_column3(*self, index, out);
-    sm_out = sm_wrap_vec3(out, Qnil);
+  mat3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat4_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat4(sm_out, NULL);
+    mat3_to_mat4 (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat4_t output;
+    mat3_to_mat4 (*self, output);
+    sm_out = sm_wrap_mat4(output, s_sm_mat4_klass);
     rb_obj_call_init(sm_out, 0, 0);
-    break;
-  }
-
-  default: {
-    rb_raise(rb_eArgError, "Invalid number of arguments to get_column3 - expected 1 or 2");
-    break;
-  }
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to to_mat4");
   }
-
   return sm_out;
 }
 
 
 
 /*
- * Returns a Vec4 whose components are that of the column at the given index.
+ * Transposes this matrix and returns the result.
  *
  * call-seq:
- *    get_column4(index, output = nil) -> output or new vec4
+ *    transpose(output = nil) -> output or new mat3
  */
-static VALUE sm_mat4_get_column4(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_transpose(int argc, VALUE *argv, VALUE sm_self)
 {
-  mat4_t *self;
-  int index;
   VALUE sm_out;
-
-  self = sm_unwrap_mat4(sm_self, NULL);
-  index = NUM2INT(argv[0]);
-  sm_out = Qnil;
-
-  if (index < 0 || index > 3) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
-    return Qnil;
-  }
-
-  switch (argc) {
-  case 2: {
-    vec4_t *out;
-
-    sm_out = argv[1];
-
-    if (RTEST(sm_out)) {
-      if (!SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-        rb_raise(rb_eTypeError,
-          kSM_WANT_FOUR_FORMAT_LIT,
-          rb_obj_classname(sm_out));
-        return Qnil;
-      }
-      rb_check_frozen(sm_out);
-    } else {
-      goto SM_LABEL(no_output);
-    }
-
-    out = sm_unwrap_vec4(sm_out, NULL);
-    mat4_get_column4(*self, index, *out);
-
-    break;
-  }
-
-  case 1: SM_LABEL(no_output): {
-    vec4_t out;
-    mat4_get_column4(*self, index, out);
-    sm_out = sm_wrap_vec4(out, Qnil);
+  mat3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat3_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat3(sm_out, NULL);
+    mat3_transpose (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat3_t output;
+    mat3_transpose (*self, output);
+    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
-    break;
-  }
-
-  default: {
-    rb_raise(rb_eArgError, "Invalid number of arguments to get_column4 - expected 1 or 2");
-    break;
-  }
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to transpose");
   }
-
   return sm_out;
 }
 
 
 
 /*
- * Sets the matrix's row at the given index to the given vector.
+ * Returns an ajoint matrix.
  *
  * call-seq:
- *    set_row3(index, vec3) -> self
+ *    adjoint(output = nil) -> output or new mat3
  */
-static VALUE sm_mat4_set_row3(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_mat3_adjoint(int argc, VALUE *argv, VALUE sm_self)
 {
-  const vec3_t *value;
-  int index;
-  mat4_t *self;
-
-  if (!SM_IS_A(sm_value, vec3) && !SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_value));
-    return Qnil;
-  }
-
-  self = sm_unwrap_mat4(sm_self, NULL);
-  value = sm_unwrap_vec3(sm_value, NULL);
-  index = NUM2INT(sm_index);
-
-  if (index < 0 || index > 3) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
-    return Qnil;
+  VALUE sm_out;
+  mat3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat3_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat3(sm_out, NULL);
+    mat3_adjoint (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat3_t output;
+    mat3_adjoint (*self, output);
+    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to adjoint");
   }
-
-  mat4_set_row3(index, *value, *self);
-
-  return sm_self;
+  return sm_out;
 }
 
 
 
 /*
- * Sets the matrix's column at the given index to the given vector.
+ * Returns an orthogonal matrix.
  *
  * call-seq:
- *    set_column3(index, vec3) -> self
+ *    orthogonal(output = nil) -> output or new mat3
  */
-static VALUE sm_mat4_set_column3(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_mat3_orthogonal(int argc, VALUE *argv, VALUE sm_self)
 {
-  const vec3_t *value;
-  int index;
-  mat4_t *self;
-
-  if (!SM_IS_A(sm_value, vec3) && !SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_value));
-    return Qnil;
-  }
-
-  self = sm_unwrap_mat4(sm_self, NULL);
-  value = sm_unwrap_vec3(sm_value, NULL);
-  index = NUM2INT(sm_index);
-
-  if (index < 0 || index > 3) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
-    return Qnil;
+  VALUE sm_out;
+  mat3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat3_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat3(sm_out, NULL);
+    mat3_orthogonal (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat3_t output;
+    mat3_orthogonal (*self, output);
+    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to orthogonal");
   }
-
-  mat4_set_column3(index, *value, *self);
-
-  return sm_self;
+  return sm_out;
 }
 
 
 
 /*
- * Sets the matrix's row at the given index to the given vector.
+ * Returns a cofactor matrix.
  *
  * call-seq:
- *    set_row4(index, vec4) -> self
+ *    cofactor(output = nil) -> output or new mat3
  */
-static VALUE sm_mat4_set_row4(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_mat3_cofactor(int argc, VALUE *argv, VALUE sm_self)
 {
-  const vec4_t *value;
-  int index;
-  mat4_t *self;
-
-  if (!SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_value));
-    return Qnil;
-  }
-
-  self = sm_unwrap_mat4(sm_self, NULL);
-  value = sm_unwrap_vec4(sm_value, NULL);
-  index = NUM2INT(sm_index);
-
-  if (index < 0 || index > 3) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
-    return Qnil;
+  VALUE sm_out;
+  mat3_t *self;
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (argc == 1) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat3_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat3(sm_out, NULL);
+    mat3_cofactor (*self, *output);
+  }} else if (argc == 0) {
+SM_LABEL(skip_output): {
+    mat3_t output;
+    mat3_cofactor (*self, output);
+    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to cofactor");
   }
-
-  mat4_set_row4(index, *value, *self);
-
-  return sm_self;
+  return sm_out;
 }
 
 
 
 /*
- * Sets the matrix's column at the given index to the given vector.
+ * Multiplies this Mat3 and another and returns the result.
  *
  * call-seq:
- *    set_column4(index, vec4) -> self
+ *    multiply_mat3(mat3, output = nil) -> output or new mat3
  */
-static VALUE sm_mat4_set_column4(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_mat3_multiply(int argc, VALUE *argv, VALUE sm_self)
 {
-  const vec4_t *value;
-  int index;
-  mat4_t *self;
-
-  if (!SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_value));
-      return Qnil;
-    }
-
-  self = sm_unwrap_mat4(sm_self, NULL);
-  value = sm_unwrap_vec4(sm_value, NULL);
-  index = NUM2INT(sm_index);
-
-  if (index < 0 || index > 3) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 3)", index);
-    return Qnil;
+  VALUE sm_rhs;
+  VALUE sm_out;
+  mat3_t *self;
+  mat3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  SM_RAISE_IF_NOT_TYPE(sm_rhs, mat3);
+  rhs = sm_unwrap_mat3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    mat3_t *output;
+    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat3(sm_out, NULL);
+    mat3_multiply(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    mat3_t output;
+    mat3_multiply(*self, *rhs, output);
+    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_mat3");
   }
-
-  mat4_set_column4(index, *value, *self);
-
-  return sm_self;
+  return sm_out;
 }
 
 
 
 /*
- * Sets self to the identity matrix.
+ * Rotates a Vec3 using self and returns the result.
  *
  * call-seq:
- *    load_identity -> self
+ *    rotate_vec3(vec3, output = nil) -> output or new vec3
  */
-static VALUE sm_mat4_identity(VALUE sm_self)
+static VALUE sm_mat3_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
 {
-  mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
-  mat4_identity(*self);
-  return sm_self;
+  VALUE sm_rhs;
+  VALUE sm_out;
+  mat3_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    mat3_rotate_vec3(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    mat3_rotate_vec3(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
+    rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to rotate_vec3");
+  }
+  return sm_out;
 }
 
 
 
 /*
- * Returns a matrix describing a frustum perspective.
+ * Convenience function to rotate a Vec3 by an inverse matrix and return the
+ * result.
  *
  * call-seq:
- *    frustum(left, right, bottom, top, z_near, z_far, output = nil) -> output or new mat4
+ *    inv_rotate_vec3(vec3, output = nil) -> output or new vec3
  */
-static VALUE sm_mat4_frustum(int argc, VALUE *argv, VALUE self)
+static VALUE sm_mat3_inv_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_left;
-  VALUE sm_right;
-  VALUE sm_bottom;
-  VALUE sm_top;
-  VALUE sm_z_near;
-  VALUE sm_z_far;
+  VALUE sm_rhs;
   VALUE sm_out;
-  s_float_t left;
-  s_float_t right;
-  s_float_t bottom;
-  s_float_t top;
-  s_float_t z_near;
-  s_float_t z_far;
-
-  rb_scan_args(argc, argv, "61", &sm_left, &sm_right, &sm_bottom, &sm_top, &sm_z_near, &sm_z_far, &sm_out);
-
-  left = (s_float_t)NUM2DBL(sm_left);
-  right = (s_float_t)NUM2DBL(sm_right);
-  bottom = (s_float_t)NUM2DBL(sm_bottom);
-  top = (s_float_t)NUM2DBL(sm_top);
-  z_near = (s_float_t)NUM2DBL(sm_z_near);
-  z_far = (s_float_t)NUM2DBL(sm_z_far);
-
-  if (SM_IS_A(sm_out, mat4)) {
-    rb_check_frozen(sm_out);
-    mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
-    mat4_frustum(left, right, bottom, top, z_near, z_far, *out);
-  } else {
-    mat4_t out;
-    mat4_frustum(left, right, bottom, top, z_near, z_far, out);
-    sm_out = sm_wrap_mat4(out, Qnil);
+  mat3_t *self;
+  vec3_t *rhs;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_rhs));
+    return Qnil;
+  }
+  rhs = sm_unwrap_vec3(sm_rhs, NULL);
+  if (argc == 2) {
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }{
+    vec3_t *output;
+    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+      rb_raise(rb_eTypeError,
+        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+    sm_check_writable(sm_out);
+    output = sm_unwrap_vec3(sm_out, NULL);
+    mat3_inv_rotate_vec3(*self, *rhs, *output);
+  }} else if (argc == 1) {
+SM_LABEL(skip_output): {
+    vec3_t output;
+    mat3_inv_rotate_vec3(*self, *rhs, output);
+    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
     rb_obj_call_init(sm_out, 0, 0);
+  }} else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_rotate_vec3");
   }
-
   return sm_out;
 }
 
 
 
 /*
- * Returns a matrix describing an orthographic projection.
+ * Returns the matrix determinant.
  *
  * call-seq:
- *    orthographic(left, right, bottom, top, z_near, z_far, output = nil) -> output or new mat4
+ *    determinant -> float
  */
-static VALUE sm_mat4_orthographic(int argc, VALUE *argv, VALUE self)
+static VALUE sm_mat3_determinant(VALUE sm_self)
 {
-  VALUE sm_left;
-  VALUE sm_right;
-  VALUE sm_bottom;
-  VALUE sm_top;
-  VALUE sm_z_near;
-  VALUE sm_z_far;
-  VALUE sm_out;
-  s_float_t left;
-  s_float_t right;
-  s_float_t bottom;
-  s_float_t top;
-  s_float_t z_near;
-  s_float_t z_far;
-
-  rb_scan_args(argc, argv, "61", &sm_left, &sm_right, &sm_bottom, &sm_top, &sm_z_near, &sm_z_far, &sm_out);
-
-  left = (s_float_t)NUM2DBL(sm_left);
-  right = (s_float_t)NUM2DBL(sm_right);
-  bottom = (s_float_t)NUM2DBL(sm_bottom);
-  top = (s_float_t)NUM2DBL(sm_top);
-  z_near = (s_float_t)NUM2DBL(sm_z_near);
-  z_far = (s_float_t)NUM2DBL(sm_z_far);
-
-  if (SM_IS_A(sm_out, mat4)) {
-    rb_check_frozen(sm_out);
-    mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
-    mat4_orthographic(left, right, bottom, top, z_near, z_far, *out);
-  } else {
-    mat4_t out;
-    mat4_orthographic(left, right, bottom, top, z_near, z_far, out);
-    sm_out = sm_wrap_mat4(out, self);
-    rb_obj_call_init(sm_out, 0, 0);
-  }
-
-  return sm_out;
+  return DBL2NUM(mat3_determinant(*sm_unwrap_mat3(sm_self, NULL)));
 }
 
 
 
 /*
- * Returns a matrix describing a perspective projection.
+ * Treats this matrix as symmetric and returns its eigen-decomposition as
+ * [rotation, eigenvalues]. The rows of rotation are the unit eigenvectors in
+ * order of decreasing eigenvalue, and rotation is always a proper rotation, so
+ * rotation.rotate_vec3(Vec3[1, 0, 0]) is the principal axis. Eigenvalues is a
+ * Vec3 of the matching eigenvalues.
+ *
+ * Rotation may be given as a Mat3 or a Quat to write to, and eigenvalues as a
+ * Vec3, Vec4, or Quat. A Quat receives the same rotation, so
+ * quat.multiply_vec3(Vec3[1, 0, 0]) is also the principal axis.
  *
  * call-seq:
- *    perspective(fov_y_degrees, aspect, z_near, z_far, output = nil) -> output or new mat4
+ *    eigen_symmetric(rotation = nil, eigenvalues = nil) -> [rotation, eigenvalues]
  */
-static VALUE sm_mat4_perspective(int argc, VALUE *argv, VALUE self)
+static VALUE sm_mat3_eigen_symmetric(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_fov_y;
-  VALUE sm_aspect;
-  VALUE sm_z_near;
-  VALUE sm_z_far;
-  VALUE sm_out;
-  s_float_t fov_y;
-  s_float_t aspect;
-  s_float_t z_near;
-  s_float_t z_far;
-
-  rb_scan_args(argc, argv, "41", &sm_fov_y, &sm_aspect, &sm_z_near, &sm_z_far, &sm_out);
+  VALUE sm_rotation;
+  VALUE sm_eigenvalues;
+  mat3_t rotation;
+  vec3_t eigenvalues;
 
-  fov_y = (s_float_t)NUM2DBL(sm_fov_y);
-  aspect = (s_float_t)NUM2DBL(sm_aspect);
-  z_near = (s_float_t)NUM2DBL(sm_z_near);
-  z_far = (s_float_t)NUM2DBL(sm_z_far);
+  rb_scan_args(argc, argv, "02", &sm_rotation, &sm_eigenvalues);
+  mat3_eigen_symmetric(*sm_unwrap_mat3(sm_self, NULL), rotation, eigenvalues);
 
-  if (SM_IS_A(sm_out, mat4)) {
-    rb_check_frozen(sm_out);
-    mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
-    mat4_perspective(fov_y, aspect, z_near, z_far, *out);
+  if (!RTEST(sm_rotation)) {
+    sm_rotation = sm_wrap_mat3(rotation, s_sm_mat3_klass);
+    rb_obj_call_init(sm_rotation, 0, 0);
+  } else if (SM_IS_A(sm_rotation, mat3)) {
+    sm_check_writable(sm_rotation);
+    mat3_copy(rotation, *sm_unwrap_mat3(sm_rotation, NULL));
+  } else if (SM_IS_A(sm_rotation, quat)) {
+    /* Transposed so the quaternion, like the matrix, rotates X onto the principal axis */
+    mat3_t transposed;
+    sm_check_writable(sm_rotation);
+    mat3_transpose(rotation, transposed);
+    quat_from_mat3(transposed, *sm_unwrap_quat(sm_rotation, NULL));
   } else {
-    mat4_t out;
-    mat4_perspective(fov_y, aspect, z_near, z_far, out);
-    sm_out = sm_wrap_mat4(out, self);
-    rb_obj_call_init(sm_out, 0, 0);
+    rb_raise(rb_eTypeError,
+      "Invalid argument to rotation of eigen_symmetric: expected %s or %s, got %s",
+      rb_class2name(s_sm_mat3_klass),
+      rb_class2name(s_sm_quat_klass),
+      rb_obj_classname(sm_rotation));
+  }
+
+  if (!RTEST(sm_eigenvalues)) {
+    sm_eigenvalues = sm_wrap_vec3(eigenvalues, s_sm_vec3_klass);
+    rb_obj_call_init(sm_eigenvalues, 0, 0);
+  } else if (SM_IS_A(sm_eigenvalues, vec3) || SM_IS_A(sm_eigenvalues, vec4) || SM_IS_A(sm_eigenvalues, quat)) {
+    sm_check_writable(sm_eigenvalues);
+    vec3_copy(eigenvalues, *sm_unwrap_vec3(sm_eigenvalues, NULL));
+  } else {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_eigenvalues));
   }
 
-  return sm_out;
+  return rb_ary_new3(2, sm_rotation, sm_eigenvalues);
 }
 
 
 
 /*
- * Returns a matrix describing a view transformation for an eye looking at
- * center with the given up vector.
+ * Returns the matrix inverse on success, nil on failure.
  *
  * call-seq:
- *    look_at(eye, center, up, output = nil) -> output or new mat4
+ *    inverse(output = nil) -> output, new mat3, or nil
  */
-static VALUE sm_mat4_look_at(int argc, VALUE *argv, VALUE self)
+static VALUE sm_mat3_inverse(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_eye;
-  VALUE sm_center;
-  VALUE sm_up;
-  VALUE sm_out;
-  const vec3_t *eye;
-  const vec3_t *center;
-  const vec3_t *up;
+  VALUE sm_out = Qnil;
+  mat3_t *self;
 
-  rb_scan_args(argc, argv, "31", &sm_eye, &sm_center, &sm_up, &sm_out);
+  rb_scan_args(argc, argv, "01", &sm_out);
+  self = sm_unwrap_mat3(sm_self, NULL);
 
-  eye = sm_unwrap_vec3(sm_eye, NULL);
-  center = sm_unwrap_vec3(sm_center, NULL);
-  up = sm_unwrap_vec3(sm_up, NULL);
+  if (argc == 1) {
+    mat3_t *output;
 
-  if (SM_IS_A(sm_out, mat4)) {
-    rb_check_frozen(sm_out);
-    mat4_t *out = sm_unwrap_mat4(sm_out, NULL);
-    mat4_look_at(*eye, *center, *up, *out);
+    if (!RTEST(sm_out)) {
+      goto SM_LABEL(skip_output);
+    }
+
+    if (!SM_IS_A(sm_out, mat3)) {
+      rb_raise(rb_eTypeError,
+        "Invalid argument to output of inverse_general: expected %s, got %s",
+        rb_class2name(s_sm_mat3_klass),
+        rb_obj_classname(sm_out));
+      return Qnil;
+    }
+
+    sm_check_writable(sm_out);
+    output = sm_unwrap_mat3(sm_out, NULL);
+    if (!mat3_inverse(*self, *output)) {
+      return Qnil;
+    }
+
+  } else if (argc == 0) {
+    SM_LABEL(skip_output): {
+      mat3_t output;
+      if (!mat3_inverse(*self, output)) {
+        return Qnil;
+      }
+
+      sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+      rb_obj_call_init(sm_out, 0, 0);
+    }
   } else {
-    mat4_t out;
-    mat4_look_at(*eye, *center, *up, out);
-    sm_out = sm_wrap_mat4(out, self);
-    rb_obj_call_init(sm_out, 0, 0);
+    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
   }
 
   return sm_out;
@@ -5707,182 +11594,213 @@ static VALUE sm_mat4_look_at(int argc, VALUE *argv, VALUE self)
 
 
 /*
- * Scales the inner 9x9 matrix's columns by X, Y, and Z and returns the result.
+ * Allocates a new Mat3.
  *
  * call-seq:
- *    scale(x, y, z, output = nil) -> output or new mat4
+ *    new()                      -> identity mat3
+ *    new(m1, m2, ..., m8, m9)   -> new mat3 with components
+ *    new([m1, m2, ..., m8, m9]) -> new mat3 with components
+ *    new(mat3)                  -> copy of mat3
+ *    new(mat4)                  -> new mat3 from mat4's inner 9x9 matrix
+ *    new(quat)                  -> quat as mat3
+ *    new(Vec3, Vec3, Vec3)      -> new mat3 with given row vectors
  */
-static VALUE sm_mat4_scale(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_new(int argc, VALUE *argv, VALUE self)
 {
-  VALUE sm_out;
-  VALUE sm_x, sm_y, sm_z;
-  s_float_t x, y, z;
-  mat4_t *self = sm_unwrap_mat4(sm_self, NULL);
-
-  rb_scan_args(argc, argv, "31", &sm_x, &sm_y, &sm_z, &sm_out);
-  x = NUM2DBL(sm_x);
-  y = NUM2DBL(sm_y);
-  z = NUM2DBL(sm_z);
-
-  if (SM_IS_A(sm_out, mat4)) {
-    rb_check_frozen(sm_out);
-    mat4_scale(*self, x, y, z, *sm_unwrap_mat4(sm_out, NULL));
-  } else {
-    mat4_t out;
-    mat4_scale(*self, x, y, z, out);
-    sm_out = sm_wrap_mat4(out, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }
-
-  return sm_out;
+  VALUE sm_mat = sm_wrap_mat3(g_mat3_identity, self);
+  rb_obj_call_init(sm_mat, argc, argv);
+  return sm_mat;
 }
 
 
 
 /*
- * Tests this Mat4 and another Mat4 for equivalency.
+ * Sets the Mat3's components.
  *
  * call-seq:
- *    mat4 == other_mat4 -> bool
+ *    set(m1, m2, ..., m8, m9)   -> new mat3 with components
+ *    set([m1, m2, ..., m8, m9]) -> new mat3 with components
+ *    set(mat3)                  -> copy of mat3
+ *    set(mat4)                  -> new mat3 from mat4's inner 9x9 matrix
+ *    set(quat)                  -> quat as mat3
+ *    set(Vec3, Vec3, Vec3)      -> new mat3 with given row vectors
  */
-static VALUE sm_mat4_equals(VALUE sm_self, VALUE sm_other)
+static VALUE sm_mat3_init(int argc, VALUE *argv, VALUE sm_self)
 {
-  if (!RTEST(sm_other) || !SM_IS_A(sm_other, mat4)) {
-    return Qfalse;
+  mat3_t *self;
+  size_t arr_index = 0;
+
+  sm_check_writable(sm_self);
+  self = sm_unwrap_mat3(sm_self, NULL);
+
+  switch (argc) {
+
+  case 0: {
+    /* Identity (handled in _new) */
+    break;
   }
 
-  return mat4_equals(*sm_unwrap_mat4(sm_self, NULL), *sm_unwrap_mat4(sm_other, NULL)) ? Qtrue : Qfalse;
-}
+  /* Copy Mat3 or provided [Numeric..] */
+  case 1: {
+    /* Copy Mat3 */
+    if (SM_IS_A(argv[0], mat3)) {
+      sm_unwrap_mat3(argv[0], *self);
+      break;
+    }
 
+    /* Copy Mat4 */
+    if (SM_IS_A(argv[0], mat4)) {
+      mat4_to_mat3(*sm_unwrap_mat4(argv[0], NULL), *self);
+      break;
+    }
 
+    /* Build from Quaternion */
+    if (SM_IS_A(argv[0], quat)) {
+      mat3_from_quat(*sm_unwrap_quat(argv[0], NULL), *self);
+      break;
+    }
 
-/*==============================================================================
+    /* Optional offset into array provided */
+    if (0) {
+      case 2:
+      arr_index = NUM2SIZET(argv[1]);
+    }
 
-  mat3_t functions
+    /* Array of values */
+    if (SM_RB_IS_A(argv[0], rb_cArray)) {
+      VALUE arrdata = argv[0];
+      const size_t arr_end = arr_index + 9;
+      s_float_t *mat_elem = *self;
+      for (; arr_index < arr_end; ++arr_index, ++mat_elem) {
+        *mat_elem = NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
+      }
+      break;
+    }
 
-==============================================================================*/
+    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Mat3");
+    break;
+  }
+
+  /* Mat3(Vec3, Vec3, Vec3) */
+  case 3: {
+    size_t arg_index;
+    s_float_t *mat_elem = *self;
+    for (arg_index = 0; arg_index < 3; ++arg_index, mat_elem += 3) {
+      if (!SM_IS_A(argv[arg_index], vec3) && !SM_IS_A(argv[arg_index], vec4) && !SM_IS_A(argv[arg_index], quat)) {
+        rb_raise(
+          rb_eArgError,
+          "Argument %d must be a Vec3, Vec4, or Quat when supplying three arguments to initialize/set",
+          (int)(arg_index + 1));
+      }
 
-static VALUE sm_wrap_mat3(const mat3_t value, VALUE klass)
-{
-  mat3_t *copy;
-  VALUE sm_wrapped = Qnil;
-  if (!RTEST(klass)) {
-    klass = s_sm_mat3_klass;
-  }
-  sm_wrapped = Data_Make_Struct(klass, mat3_t, 0, free, copy);
-  if (value) {
-    mat3_copy(value, *copy);
+      sm_unwrap_vec3(argv[arg_index], mat_elem);
+    }
+    break;
   }
-  return sm_wrapped;
-}
 
+  /* Mat3(Numeric m00 .. m16) */
+  case 9: {
+    s_float_t *mat_elem = *self;
+    VALUE *argv_p = argv;
+    for (; argc; --argc, ++argv_p, ++mat_elem) {
+      *mat_elem = (s_float_t)NUM2DBL(*argv_p);
+    }
+    break;
+  }
 
+  default: {
+    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
+    break;
+  }
+  } /* switch (argc) */
 
-static mat3_t *sm_unwrap_mat3(VALUE sm_value, mat3_t store)
-{
-  mat3_t *value;
-  Data_Get_Struct(sm_value, mat3_t, value);
-  if(store) mat3_copy(*value, store);
-  return value;
+  return sm_self;
 }
 
 
 
 /*
- * Gets the component of the Mat3 at the given index.
+ * Returns a string representation of self.
  *
- * call-seq: fetch(index) -> float
- */
-static VALUE sm_mat3_fetch (VALUE sm_self, VALUE sm_index)
-{
-  static const int max_index = sizeof(mat3_t) / sizeof(s_float_t);
-  const mat3_t *self = sm_unwrap_mat3(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  if (index < 0 || index >= max_index) {
-    rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
-  }
-  return DBL2NUM(self[0][NUM2INT(sm_index)]);
-}
-
-
-
-/*
- * Sets the Mat3's component at the index to the value.
+ *    Mat3[].to_s     # => "{ 1.0, 0.0, 0.0,\n
+ *                    #       0.0, 1.0, 0.0,\n"
+ *                    #       0.0, 0.0, 1.0 }"
  *
- * call-seq: store(index, value) -> value
+ * call-seq:
+ *    to_s -> string
  */
-static VALUE sm_mat3_store (VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_mat3_to_s(VALUE self)
 {
-  static const int max_index = sizeof(mat3_t) / sizeof(s_float_t);
-  mat3_t *self = sm_unwrap_mat3(sm_self, NULL);
-  int index = NUM2INT(sm_index);
-  rb_check_frozen(sm_self);
-  if (index < 0 || index >= max_index) {
-    rb_raise(rb_eRangeError,
-      "Index %d is out of bounds, must be from 0 through %d", index, max_index - 1);
-  }
-  self[0][index] = (s_float_t)NUM2DBL(sm_value);
-  return sm_value;
+  const s_float_t *v;
+  v = (const s_float_t *)*sm_unwrap_mat3(self, NULL);
+  return rb_sprintf(
+    "{ "
+    "%f, %f, %f" ",\n  "
+    "%f, %f, %f" ",\n  "
+    "%f, %f, %f"
+    " }",
+    v[0],   v[1],   v[2],
+    v[3],   v[4],   v[5],
+    v[6],   v[7],   v[8] );
 }
 
 
 
 /*
- * Returns the length in bytes of the Mat3. When compiled to use doubles as the
- * base type, this is always 72. Otherwise, when compiled to use floats, it's
- * always 36.
+ * Returns a Mat3 describing a rotation around the given axis.
  *
- * call-seq: size -> fixnum
+ * call-seq:
+ *    angle_axis(angle_degrees, axis_vec3, output = nil) -> output or new mat3
  */
-static VALUE sm_mat3_size (VALUE self)
+static VALUE sm_mat3_angle_axis(int argc, VALUE *argv, VALUE self)
 {
-  return SIZET2NUM(sizeof(mat3_t));
-}
+  VALUE sm_angle;
+  VALUE sm_axis;
+  VALUE sm_out;
+  s_float_t angle;
+  const vec3_t *axis;
 
+  rb_scan_args(argc, argv, "21", &sm_angle, &sm_axis, &sm_out);
+  if (!SM_IS_A(sm_axis, vec3) && !SM_IS_A(sm_axis, vec4) && !SM_IS_A(sm_axis, quat)) {
+    rb_raise(rb_eTypeError,
+      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+      rb_obj_classname(sm_axis));
+    return Qnil;
+  }
 
+  angle = (s_float_t)NUM2DBL(sm_angle);
+  axis = sm_unwrap_vec3(sm_axis, NULL);
 
-/*
- * Returns the length of the Mat3 in components. Result is always 9.
- *
- * call-seq: length -> fixnum
- */
-static VALUE sm_mat3_length (VALUE self)
-{
-  return SIZET2NUM(sizeof(mat3_t) / sizeof(s_float_t));
+  if (SM_IS_A(sm_out, mat3)) {
+    sm_check_writable(sm_out);
+    mat3_t *out = sm_unwrap_mat3(sm_out, NULL);
+    mat3_rotation(angle, (*axis)[0], (*axis)[1], (*axis)[2], *out);
+  } else {
+    mat3_t out;
+    mat3_rotation(angle, (*axis)[0], (*axis)[1], (*axis)[2], out);
+    sm_out = sm_wrap_mat3(out, self);
+    rb_obj_call_init(sm_out, 0, 0);
+  }
+
+  return sm_out;
 }
 
 
 
 /*
- * Returns a copy of self.
- *
- * call-seq:
- *    copy(output = nil) -> output or new mat3
- */
-static VALUE sm_mat3_copy(int argc, VALUE *argv, VALUE sm_self)
+  Writes a 2D result to sm_out, a Vec2, Vec3, Vec4, or Quat, or returns a new
+  Vec2 holding it if sm_out is nil.
+*/
+static VALUE sm_vec2_result(const vec2_t result, VALUE sm_out)
 {
-  VALUE sm_out;
-  mat3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    mat3_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat3(sm_out, NULL);
-    mat3_copy (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    mat3_t output;
-    mat3_copy (*self, output);
-    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+  if (!RTEST(sm_out)) {
+    sm_out = sm_wrap_vec2(result, s_sm_vec2_klass);
     rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to copy");
+  } else if (SM_IS_A(sm_out, vec2) || SM_IS_A(sm_out, vec3) || SM_IS_A(sm_out, vec4) || SM_IS_A(sm_out, quat)) {
+    sm_check_writable(sm_out);
+    vec2_copy(result, *sm_unwrap_vec2(sm_out, NULL));
+  } else {
+    rb_raise(rb_eTypeError, kSM_WANT_TWO_TO_FOUR_FORMAT_LIT, rb_obj_classname(sm_out));
   }
   return sm_out;
 }
@@ -5890,104 +11808,75 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Returns a Mat4 converted from the Mat3.
+ * Transforms a 2D point by self as a 2D affine transform, treating the point
+ * as (x, y, 1), and returns the result. The third column of self holds the
+ * translation, as in matrices returned by ::trs_2d.
  *
  * call-seq:
- *    to_mat4(output = nil) -> output or new mat4
+ *    transform_vec2(vec2, output = nil) -> output or new vec2
  */
-static VALUE sm_mat3_to_mat4(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_transform_vec2(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_rhs;
   VALUE sm_out;
-  mat3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    mat4_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat4);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat4(sm_out, NULL);
-    mat3_to_mat4 (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    mat4_t output;
-    mat3_to_mat4 (*self, output);
-    sm_out = sm_wrap_mat4(output, s_sm_mat4_klass);
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to to_mat4");
-  }
-  return sm_out;
+  vec2_t result;
+
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  mat3_transform_vec2(*sm_unwrap_mat3(sm_self, NULL), *sm_vec2_operand(sm_rhs, NULL), result);
+  return sm_vec2_result(result, sm_out);
 }
 
 
 
 /*
- * Transposes this matrix and returns the result.
+ * Transforms a 2D direction by self as a 2D affine transform, treating the
+ * direction as (x, y, 0) so translation is ignored, and returns the result.
  *
  * call-seq:
- *    transpose(output = nil) -> output or new mat3
+ *    rotate_vec2(vec2, output = nil) -> output or new vec2
  */
-static VALUE sm_mat3_transpose(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_rotate_vec2(int argc, VALUE *argv, VALUE sm_self)
 {
+  VALUE sm_rhs;
   VALUE sm_out;
-  mat3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    mat3_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat3(sm_out, NULL);
-    mat3_transpose (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    mat3_t output;
-    mat3_transpose (*self, output);
-    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to transpose");
-  }
-  return sm_out;
+  vec2_t result;
+
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  mat3_rotate_vec2(*sm_unwrap_mat3(sm_self, NULL), *sm_vec2_operand(sm_rhs, NULL), result);
+  return sm_vec2_result(result, sm_out);
 }
 
 
 
 /*
- * Returns an ajoint matrix.
+ * Returns the inverse of self as a 2D affine transform on success, nil if its
+ * upper 2x2 is singular. This is cheaper than #inverse and ignores the third
+ * row of self, which is assumed to be (0, 0, 1).
  *
  * call-seq:
- *    adjoint(output = nil) -> output or new mat3
+ *    inverse_affine(output = nil) -> output, new mat3, or nil
  */
-static VALUE sm_mat3_adjoint(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_inverse_affine(int argc, VALUE *argv, VALUE sm_self)
 {
   VALUE sm_out;
-  mat3_t *self;
+  mat3_t result;
+
   rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    mat3_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat3(sm_out, NULL);
-    mat3_adjoint (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    mat3_t output;
-    mat3_adjoint (*self, output);
-    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+  if (!mat3_inverse_affine(*sm_unwrap_mat3(sm_self, NULL), result)) {
+    return Qnil;
+  }
+
+  if (!RTEST(sm_out)) {
+    sm_out = sm_wrap_mat3(result, rb_obj_class(sm_self));
     rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to adjoint");
+  } else if (SM_IS_A(sm_out, mat3)) {
+    sm_check_writable(sm_out);
+    mat3_copy(result, *sm_unwrap_mat3(sm_out, NULL));
+  } else {
+    rb_raise(rb_eTypeError,
+      "Invalid argument to output of inverse_affine: expected %s, got %s",
+      rb_class2name(s_sm_mat3_klass),
+      rb_obj_classname(sm_out));
   }
   return sm_out;
 }
@@ -5995,34 +11884,34 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Returns an orthogonal matrix.
+ * Returns a Mat3 holding the 2D affine transform that scales, then rotates by
+ * angle_degrees counter-clockwise, then translates. Scale may be a Vec2 or a
+ * Numeric for uniform scale.
  *
  * call-seq:
- *    orthogonal(output = nil) -> output or new mat3
+ *    trs_2d(translation, angle_degrees, scale = 1, output = nil) -> output or new mat3
  */
-static VALUE sm_mat3_orthogonal(int argc, VALUE *argv, VALUE sm_self)
-{
-  VALUE sm_out;
-  mat3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    mat3_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat3(sm_out, NULL);
-    mat3_orthogonal (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    mat3_t output;
-    mat3_orthogonal (*self, output);
-    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+static VALUE sm_mat3_trs_2d(int argc, VALUE *argv, VALUE self)
+{
+  VALUE sm_translation;
+  VALUE sm_angle;
+  VALUE sm_scale;
+  VALUE sm_out;
+  vec2_t scale = { s_float_lit(1.0), s_float_lit(1.0) };
+  mat3_t result;
+
+  rb_scan_args(argc, argv, "22", &sm_translation, &sm_angle, &sm_scale, &sm_out);
+  if (RTEST(sm_scale)) {
+    vec2_copy(*sm_vec2_operand(sm_scale, scale), scale);
+  }
+  mat3_trs_2d(*sm_vec2_operand(sm_translation, NULL), (s_float_t)NUM2DBL(sm_angle), scale, result);
+
+  if (SM_IS_A(sm_out, mat3)) {
+    sm_check_writable(sm_out);
+    mat3_copy(result, *sm_unwrap_mat3(sm_out, NULL));
+  } else {
+    sm_out = sm_wrap_mat3(result, self);
     rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to orthogonal");
   }
   return sm_out;
 }
@@ -6030,238 +11919,244 @@ SM_LABEL(skip_output): {
 
 
 /*
- * Returns a cofactor matrix.
+ * Returns a Vec3 whose components are that of the row at the given index.
  *
  * call-seq:
- *    cofactor(output = nil) -> output or new mat3
+ *    get_row3(index, output = nil) -> output or new vec3
  */
-static VALUE sm_mat3_cofactor(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_get_row3(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out;
   mat3_t *self;
-  rb_scan_args(argc, argv, "01", &sm_out);
+  int index;
+  VALUE sm_out;
+
   self = sm_unwrap_mat3(sm_self, NULL);
-  if (argc == 1) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    mat3_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat3(sm_out, NULL);
-    mat3_cofactor (*self, *output);
-  }} else if (argc == 0) {
-SM_LABEL(skip_output): {
-    mat3_t output;
-    mat3_cofactor (*self, output);
-    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+  index = NUM2INT(argv[0]);
+  sm_out = Qnil;
+
+  if (index < 0 || index > 2) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 2)", index);
+    return Qnil;
+  }
+
+  switch (argc) {
+  case 2: {
+    vec3_t *out;
+
+    sm_out = argv[1];
+
+    if (RTEST(sm_out)) {
+      if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+        rb_raise(rb_eTypeError,
+          kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+          rb_obj_classname(sm_out));
+        return Qnil;
+      }
+      sm_check_writable(sm_out);
+    } else {
+      goto SM_LABEL(no_output);
+    }
+
+    out = sm_unwrap_vec3(sm_out, NULL);
+    mat3_get_row3(*self, index, *out);
+
+    break;
+  }
+
+  case 1: SM_LABEL(no_output): {
+    vec3_t out;
+    mat3_get_row3(*self, index, out);
+    sm_out = sm_wrap_vec3(out, Qnil);
     rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to cofactor");
+    break;
   }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid number of arguments to get_row3 - expected 1 or 2");
+    break;
+  }
+  }
+
   return sm_out;
 }
 
 
 
 /*
- * Multiplies this Mat3 and another and returns the result.
+ * Returns a Vec3 whose components are that of the column at the given index.
  *
  * call-seq:
- *    multiply_mat3(mat3, output = nil) -> output or new mat3
+ *    get_column3(index, output = nil) -> output or new vec3
  */
-static VALUE sm_mat3_multiply(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_get_column3(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
   mat3_t *self;
-  mat3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  int index;
+  VALUE sm_out;
+
   self = sm_unwrap_mat3(sm_self, NULL);
-  SM_RAISE_IF_NOT_TYPE(sm_rhs, mat3);
-  rhs = sm_unwrap_mat3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    mat3_t *output;
-    SM_RAISE_IF_NOT_TYPE(sm_out, mat3);
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat3(sm_out, NULL);
-    mat3_multiply(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    mat3_t output;
-    mat3_multiply(*self, *rhs, output);
-    sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
+  index = NUM2INT(argv[0]);
+  sm_out = Qnil;
+
+  if (index < 0 || index > 2) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 2)", index);
+    return Qnil;
+  }
+
+  switch (argc) {
+  case 2: {
+    vec3_t *out;
+
+    sm_out = argv[1];
+
+    if (RTEST(sm_out)) {
+      if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
+        rb_raise(rb_eTypeError,
+          kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
+          rb_obj_classname(sm_out));
+        return Qnil;
+      }
+      sm_check_writable(sm_out);
+    } else {
+      goto SM_LABEL(no_output);
+    }
+
+    out = sm_unwrap_vec3(sm_out, NULL);
+    mat3_get_column3(*self, index, *out);
+
+    break;
+  }
+
+  case 1: SM_LABEL(no_output): {
+    vec3_t out;
+    mat3_get_column3(*self, index, out);
+    sm_out = sm_wrap_vec3(out, Qnil);
     rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to multiply_mat3");
+    break;
+  }
+
+  default: {
+    rb_raise(rb_eArgError, "Invalid number of arguments to get_column3 - expected 1 or 2");
+    break;
   }
+  }
+
   return sm_out;
 }
 
 
 
 /*
- * Rotates a Vec3 using self and returns the result.
+ * Sets the matrix's row at the given index to the given vector.
  *
  * call-seq:
- *    rotate_vec3(vec3, output = nil) -> output or new vec3
+ *    set_row3(index, vec3) -> self
  */
-static VALUE sm_mat3_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_set_row3(VALUE sm_self, VALUE sm_index, VALUE sm_value)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
+  const vec3_t *value;
+  int index;
   mat3_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_mat3(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+
+  if (!SM_IS_A(sm_value, vec3) && !SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
     rb_raise(rb_eTypeError,
       kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
+      rb_obj_classname(sm_value));
     return Qnil;
   }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    mat3_rotate_vec3(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    mat3_rotate_vec3(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to rotate_vec3");
+
+  self = sm_unwrap_mat3(sm_self, NULL);
+  value = sm_unwrap_vec3(sm_value, NULL);
+  index = NUM2INT(sm_index);
+
+  if (index < 0 || index > 2) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 2)", index);
+    return Qnil;
   }
-  return sm_out;
+
+  mat3_set_row3(index, *value, *self);
+
+  return sm_self;
 }
 
 
 
 /*
- * Convenience function to rotate a Vec3 by an inverse matrix and return the
- * result.
+ * Sets the matrix's column at the given index to the given vector.
  *
  * call-seq:
- *    inv_rotate_vec3(vec3, output = nil) -> output or new vec3
+ *    set_column3(index, value) -> self
  */
-static VALUE sm_mat3_inv_rotate_vec3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_set_column3(VALUE sm_self, VALUE sm_index, VALUE sm_value)
 {
-  VALUE sm_rhs;
-  VALUE sm_out;
+  const vec3_t *value;
+  int index;
   mat3_t *self;
-  vec3_t *rhs;
-  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
-  self = sm_unwrap_mat3(sm_self, NULL);
-  if (!SM_IS_A(sm_rhs, vec3) && !SM_IS_A(sm_rhs, vec4) && !SM_IS_A(sm_rhs, quat)) {
+
+  if (!SM_IS_A(sm_value, vec3) && !SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
     rb_raise(rb_eTypeError,
       kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_rhs));
+      rb_obj_classname(sm_value));
     return Qnil;
   }
-  rhs = sm_unwrap_vec3(sm_rhs, NULL);
-  if (argc == 2) {
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }{
-    vec3_t *output;
-    if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-      rb_raise(rb_eTypeError,
-        kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_vec3(sm_out, NULL);
-    mat3_inv_rotate_vec3(*self, *rhs, *output);
-  }} else if (argc == 1) {
-SM_LABEL(skip_output): {
-    vec3_t output;
-    mat3_inv_rotate_vec3(*self, *rhs, output);
-    sm_out = sm_wrap_vec3(output, rb_obj_class(sm_rhs));
-    rb_obj_call_init(sm_out, 0, 0);
-  }} else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse_rotate_vec3");
+
+  self = sm_unwrap_mat3(sm_self, NULL);
+  value = sm_unwrap_vec3(sm_value, NULL);
+  index = NUM2INT(sm_index);
+
+  if (index < 0 || index > 2) {
+    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 2)", index);
+    return Qnil;
   }
-  return sm_out;
+
+  mat3_set_column3(index, *value, *self);
+
+  return sm_self;
 }
 
 
 
 /*
- * Returns the matrix determinant.
+ * Sets self to the identity matrix.
  *
  * call-seq:
- *    determinant -> float
+ *    load_identity -> self
  */
-static VALUE sm_mat3_determinant(VALUE sm_self)
+static VALUE sm_mat3_identity(VALUE sm_self)
 {
-  return mat3_determinant(*sm_unwrap_mat3(sm_self, NULL));
+  mat3_t *self = sm_unwrap_mat3(sm_self, NULL);
+  mat3_identity(*self);
+  return sm_self;
 }
 
 
 
 /*
- * Returns the matrix inverse on success, nil on failure.
+ * Scales Mat3's columns by X, Y, and Z and returns the result.
  *
  * call-seq:
- *    inverse(output = nil) -> output, new mat3, or nil
+ *    scale(x, y, z, output = nil) -> output or new mat3
  */
-static VALUE sm_mat3_inverse(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_scale(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_out = Qnil;
-  mat3_t *self;
-
-  rb_scan_args(argc, argv, "01", &sm_out);
-  self = sm_unwrap_mat3(sm_self, NULL);
-
-  if (argc == 1) {
-    mat3_t *output;
-
-    if (!RTEST(sm_out)) {
-      goto SM_LABEL(skip_output);
-    }
-
-    if (!SM_IS_A(sm_out, mat3)) {
-      rb_raise(rb_eTypeError,
-        "Invalid argument to output of inverse_general: expected %s, got %s",
-        rb_class2name(s_sm_mat3_klass),
-        rb_obj_classname(sm_out));
-      return Qnil;
-    }
-
-    rb_check_frozen(sm_out);
-    output = sm_unwrap_mat3(sm_out, NULL);
-    if (!mat3_inverse(*self, *output)) {
-      return Qnil;
-    }
+  VALUE sm_out;
+  VALUE sm_x, sm_y, sm_z;
+  s_float_t x, y, z;
+  mat3_t *self = sm_unwrap_mat3(sm_self, NULL);
 
-  } else if (argc == 0) {
-    SM_LABEL(skip_output): {
-      mat3_t output;
-      if (!mat3_inverse(*self, output)) {
-        return Qnil;
-      }
+  rb_scan_args(argc, argv, "31", &sm_x, &sm_y, &sm_z, &sm_out);
+  x = NUM2DBL(sm_x);
+  y = NUM2DBL(sm_y);
+  z = NUM2DBL(sm_z);
 
-      sm_out = sm_wrap_mat3(output, rb_obj_class(sm_self));
-      rb_obj_call_init(sm_out, 0, 0);
-    }
+  if (SM_IS_A(sm_out, mat3)) {
+    sm_check_writable(sm_out);
+    mat3_scale(*self, x, y, z, *sm_unwrap_mat3(sm_out, NULL));
   } else {
-    rb_raise(rb_eArgError, "Invalid number of arguments to inverse");
+    mat3_t out;
+    mat3_scale(*self, x, y, z, out);
+    sm_out = sm_wrap_mat3(out, rb_obj_class(sm_self));
+    rb_obj_call_init(sm_out, 0, 0);
   }
 
   return sm_out;
@@ -6270,457 +12165,593 @@ static VALUE sm_mat3_inverse(int argc, VALUE *argv, VALUE sm_self)
 
 
 /*
- * Allocates a new Mat3.
+ * Tests this Mat3 and another Mat3 for equivalency.
  *
  * call-seq:
- *    new()                      -> identity mat3
- *    new(m1, m2, ..., m8, m9)   -> new mat3 with components
- *    new([m1, m2, ..., m8, m9]) -> new mat3 with components
- *    new(mat3)                  -> copy of mat3
- *    new(mat4)                  -> new mat3 from mat4's inner 9x9 matrix
- *    new(quat)                  -> quat as mat3
- *    new(Vec3, Vec3, Vec3)      -> new mat3 with given row vectors
+ *    mat3 == other_mat3 -> bool
  */
-static VALUE sm_mat3_new(int argc, VALUE *argv, VALUE self)
+static VALUE sm_mat3_equals(VALUE sm_self, VALUE sm_other)
 {
-  VALUE sm_mat = sm_wrap_mat3(g_mat3_identity, self);
-  rb_obj_call_init(sm_mat, argc, argv);
-  return sm_mat;
+  if (!RTEST(sm_other) || !SM_IS_A(sm_other, mat3)) {
+    return Qfalse;
+  }
+
+  return mat3_equals(*sm_unwrap_mat3(sm_self, NULL), *sm_unwrap_mat3(sm_other, NULL)) ? Qtrue : Qfalse;
 }
 
 
 
+/*==============================================================================
+
+  Operator dispatch
+
+==============================================================================*/
+
 /*
- * Sets the Mat3's components.
+ * Calls #multiply_vec2 when given a Vec2, Vec3, Vec4, or Quat, or #scale when
+ * given a Numeric.
  *
  * call-seq:
- *    set(m1, m2, ..., m8, m9)   -> new mat3 with components
- *    set([m1, m2, ..., m8, m9]) -> new mat3 with components
- *    set(mat3)                  -> copy of mat3
- *    set(mat4)                  -> new mat3 from mat4's inner 9x9 matrix
- *    set(quat)                  -> quat as mat3
- *    set(Vec3, Vec3, Vec3)      -> new mat3 with given row vectors
+ *    multiply(vec2, output = nil) -> output or new vec2
+ *    multiply(scalar, output = nil) -> output or new vec2
  */
-static VALUE sm_mat3_init(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_vec2_multiply_generic(int argc, VALUE *argv, VALUE sm_self)
 {
-  mat3_t *self = sm_unwrap_mat3(sm_self, NULL);
-  size_t arr_index = 0;
-
-  rb_check_frozen(sm_self);
-
-  switch (argc) {
-
-  case 0: {
-    /* Identity (handled in _new) */
-    break;
+  VALUE sm_rhs;
+  VALUE sm_out;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_vec2_scale(argc, argv, sm_self);
+  } else if (SM_IS_A(sm_rhs, vec2) || SM_IS_A(sm_rhs, vec3) ||
+             SM_IS_A(sm_rhs, vec4) || SM_IS_A(sm_rhs, quat)) {
+    return sm_vec2_multiply(argc, argv, sm_self);
   }
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
+}
 
-  /* Copy Mat3 or provided [Numeric..] */
-  case 1: {
-    /* Copy Mat3 */
-    if (SM_IS_A(argv[0], mat3)) {
-      sm_unwrap_mat3(argv[0], *self);
-      break;
-    }
 
-    /* Copy Mat4 */
-    if (SM_IS_A(argv[0], mat4)) {
-      mat4_to_mat3(*sm_unwrap_mat4(argv[0], NULL), *self);
-      break;
-    }
 
-    /* Build from Quaternion */
-    if (SM_IS_A(argv[0], quat)) {
-      mat3_from_quat(*sm_unwrap_quat(argv[0], NULL), *self);
-      break;
-    }
+/*
+ * Calls #multiply_vec3 when given a Vec3, Vec4, or Quat, or #scale when given
+ * a Numeric.
+ *
+ * call-seq:
+ *    multiply(vec3, output = nil) -> output or new vec3
+ *    multiply(scalar, output = nil) -> output or new vec3
+ */
+static VALUE sm_vec3_multiply_generic(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_vec3_scale(argc, argv, sm_self);
+  } else if (SM_IS_A(sm_rhs, vec3) || SM_IS_A(sm_rhs, vec4) || SM_IS_A(sm_rhs, quat)) {
+    return sm_vec3_multiply(argc, argv, sm_self);
+  }
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
+}
 
-    /* Optional offset into array provided */
-    if (0) {
-      case 2:
-      arr_index = NUM2SIZET(argv[1]);
-    }
 
-    /* Array of values */
-    if (SM_RB_IS_A(argv[0], rb_cArray)) {
-      VALUE arrdata = argv[0];
-      const size_t arr_end = arr_index + 9;
-      s_float_t *mat_elem = *self;
-      for (; arr_index < arr_end; ++arr_index, ++mat_elem) {
-        *mat_elem = NUM2DBL(rb_ary_entry(arrdata, (long)arr_index));
-      }
-      break;
-    }
 
-    rb_raise(rb_eArgError, "Expected either an array of Numerics or a Mat3");
-    break;
+/*
+ * Calls #multiply_vec4 when given a Vec4 or Quat, or #scale when given a
+ * Numeric.
+ *
+ * call-seq:
+ *    multiply(vec4, output = nil) -> output or new vec4
+ *    multiply(scalar, output = nil) -> output or new vec4
+ */
+static VALUE sm_vec4_multiply_generic(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_vec4_scale(argc, argv, sm_self);
+  } else if (SM_IS_A(sm_rhs, vec4) || SM_IS_A(sm_rhs, quat)) {
+    return sm_vec4_multiply(argc, argv, sm_self);
   }
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
+}
 
-  /* Mat3(Vec3, Vec3, Vec3) */
-  case 3: {
-    size_t arg_index;
-    s_float_t *mat_elem = *self;
-    for (arg_index = 0; arg_index < 3; ++arg_index, mat_elem += 3) {
-      if (!SM_IS_A(argv[arg_index], vec3) && !SM_IS_A(argv[arg_index], vec4) && !SM_IS_A(argv[arg_index], quat)) {
-        rb_raise(
-          rb_eArgError,
-          "Argument %d must be a Vec3, Vec4, or Quat when supplying three arguments to initialize/set",
-          (int)(arg_index + 1));
-      }
-
-      sm_unwrap_vec3(argv[arg_index], mat_elem);
-    }
-    break;
-  }
 
-  /* Mat3(Numeric m00 .. m16) */
-  case 9: {
-    s_float_t *mat_elem = *self;
-    VALUE *argv_p = argv;
-    for (; argc; --argc, ++argv_p, ++mat_elem) {
-      *mat_elem = (s_float_t)NUM2DBL(*argv_p);
-    }
-    break;
-  }
 
-  default: {
-    rb_raise(rb_eArgError, "Invalid arguments to initialize/set");
-    break;
+/*
+ * Calls #multiply_quat when given a Quat, #multiply_vec3 when given a Vec3, or
+ * #scale when given a Numeric.
+ *
+ * call-seq:
+ *    multiply(quat, output = nil) -> output or new quat
+ *    multiply(vec3, output = nil) -> output or new vec3
+ *    multiply(scalar, output = nil) -> output or new quat
+ */
+static VALUE sm_quat_multiply_generic(int argc, VALUE *argv, VALUE sm_self)
+{
+  VALUE sm_rhs;
+  VALUE sm_out;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  if (SM_IS_A(sm_rhs, quat)) {
+    return sm_quat_multiply(argc, argv, sm_self);
+  } else if (SM_IS_A(sm_rhs, vec3)) {
+    return sm_quat_multiply_vec3(argc, argv, sm_self);
+  } else if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_vec4_scale(argc, argv, sm_self);
   }
-  } /* switch (argc) */
-
-  return sm_self;
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
 }
 
 
 
 /*
- * Returns a string representation of self.
- *
- *    Mat3[].to_s     # => "{ 1.0, 0.0, 0.0,\n
- *                    #       0.0, 1.0, 0.0,\n"
- *                    #       0.0, 0.0, 1.0 }"
+ * Calls #multiply_mat3 when given a Mat3, #rotate_vec3 when given a Vec3, or
+ * #scale(scalar, scalar, scalar) when given a Numeric.
  *
  * call-seq:
- *    to_s -> string
+ *    multiply(mat3, output = nil) -> output or new mat3
+ *    multiply(vec3, output = nil) -> output or new vec3
+ *    multiply(scalar, output = nil) -> output or new mat3
  */
-static VALUE sm_mat3_to_s(VALUE self)
+static VALUE sm_mat3_multiply_generic(int argc, VALUE *argv, VALUE sm_self)
 {
-  const s_float_t *v;
-  v = (const s_float_t *)*sm_unwrap_mat3(self, NULL);
-  return rb_sprintf(
-    "{ "
-    "%f, %f, %f" ",\n  "
-    "%f, %f, %f" ",\n  "
-    "%f, %f, %f"
-    " }",
-    v[0],   v[1],   v[2],
-    v[3],   v[4],   v[5],
-    v[6],   v[7],   v[8] );
+  VALUE sm_rhs;
+  VALUE sm_out;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  if (SM_IS_A(sm_rhs, mat3)) {
+    return sm_mat3_multiply(argc, argv, sm_self);
+  } else if (SM_IS_A(sm_rhs, vec3)) {
+    return sm_mat3_rotate_vec3(argc, argv, sm_self);
+  } else if (SM_IS_NUMERIC(sm_rhs)) {
+    VALUE scale_argv[4] = { sm_rhs, sm_rhs, sm_rhs, sm_out };
+    return sm_mat3_scale(argc + 2, scale_argv, sm_self);
+  }
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
 }
 
 
 
 /*
- * Returns a Mat3 describing a rotation around the given axis.
+ * Calls #multiply_mat4 when given a Mat4, #multiply_vec4 when given a Vec4,
+ * #transform_vec3 when given a Vec3, or #scale(scalar, scalar, scalar) when
+ * given a Numeric.
  *
  * call-seq:
- *    angle_axis(angle_degrees, axis_vec3, output = nil) -> output or new mat3
+ *    multiply(mat4, output = nil) -> output or new mat4
+ *    multiply(vec4, output = nil) -> output or new vec4
+ *    multiply(vec3, output = nil) -> output or new vec3
+ *    multiply(scalar, output = nil) -> output or new mat4
  */
-static VALUE sm_mat3_angle_axis(int argc, VALUE *argv, VALUE self)
+static VALUE sm_mat4_multiply_generic(int argc, VALUE *argv, VALUE sm_self)
 {
-  VALUE sm_angle;
-  VALUE sm_axis;
+  VALUE sm_rhs;
   VALUE sm_out;
-  s_float_t angle;
-  const vec3_t *axis;
-
-  rb_scan_args(argc, argv, "21", &sm_angle, &sm_axis, &sm_out);
-  if (!SM_IS_A(sm_axis, vec3) && !SM_IS_A(sm_axis, vec4) && !SM_IS_A(sm_axis, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_axis));
-    return Qnil;
+  rb_scan_args(argc, argv, "11", &sm_rhs, &sm_out);
+  if (SM_IS_A(sm_rhs, mat4)) {
+    return sm_mat4_multiply(argc, argv, sm_self);
+  } else if (SM_IS_A(sm_rhs, vec4)) {
+    return sm_mat4_multiply_vec4(argc, argv, sm_self);
+  } else if (SM_IS_A(sm_rhs, vec3)) {
+    return sm_mat4_transform_vec3(argc, argv, sm_self);
+  } else if (SM_IS_NUMERIC(sm_rhs)) {
+    VALUE scale_argv[4] = { sm_rhs, sm_rhs, sm_rhs, sm_out };
+    return sm_mat4_scale(argc + 2, scale_argv, sm_self);
   }
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
+}
 
-  angle = (s_float_t)NUM2DBL(sm_angle);
-  axis = sm_unwrap_vec3(sm_axis, NULL);
 
-  if (SM_IS_A(sm_out, mat3)) {
-    rb_check_frozen(sm_out);
-    mat3_t *out = sm_unwrap_mat3(sm_out, NULL);
-    mat3_rotation(angle, (*axis)[0], (*axis)[1], (*axis)[2], *out);
-  } else {
-    mat3_t out;
-    mat3_rotation(angle, (*axis)[0], (*axis)[1], (*axis)[2], out);
-    sm_out = sm_wrap_mat3(out, self);
-    rb_obj_call_init(sm_out, 0, 0);
-  }
 
-  return sm_out;
-}
+/*==============================================================================
+
+  In-place operations
 
+  These are the bang variants of the methods above. They write through self (or
+  the operand, for methods that transform a vector) rather than going through
+  the output argument handling of the non-bang methods.
 
+==============================================================================*/
 
 /*
- * Returns a Vec3 whose components are that of the row at the given index.
- *
- * call-seq:
- *    get_row3(index, output = nil) -> output or new vec3
- */
-static VALUE sm_mat3_get_row3(int argc, VALUE *argv, VALUE sm_self)
-{
-  mat3_t *self;
-  int index;
-  VALUE sm_out;
+  Defines sm_TYPE_NAME_bang, which applies FUNC(*self, *self) and returns self.
+*/
+#define SM_INPLACE_UNARY(TYPE, NAME, FUNC)                                      \
+static VALUE sm_##TYPE##_##NAME##_bang(VALUE sm_self)                           \
+{                                                                               \
+  TYPE##_t *self;                                                               \
+  sm_check_writable(sm_self);                                                   \
+  self = sm_unwrap_##TYPE(sm_self, NULL);                                       \
+  FUNC(*self, *self);                                                           \
+  return sm_self;                                                               \
+}
 
-  self = sm_unwrap_mat3(sm_self, NULL);
-  index = NUM2INT(argv[0]);
-  sm_out = Qnil;
+/*
+  Defines sm_TYPE_NAME_bang, which applies FUNC(*self, *self) and returns self
+  if FUNC succeeds, otherwise nil.
+*/
+#define SM_INPLACE_INVERSE(TYPE, NAME, FUNC)                                    \
+static VALUE sm_##TYPE##_##NAME##_bang(VALUE sm_self)                           \
+{                                                                               \
+  TYPE##_t *self;                                                               \
+  sm_check_writable(sm_self);                                                   \
+  self = sm_unwrap_##TYPE(sm_self, NULL);                                       \
+  return FUNC(*self, *self) ? sm_self : Qnil;                                   \
+}
 
-  if (index < 0 || index > 2) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 2)", index);
-    return Qnil;
-  }
+/*
+  Defines sm_TYPE_NAME_bang, which applies FUNC(*self, scalar, *self) and
+  returns self.
+*/
+#define SM_INPLACE_SCALAR(TYPE, NAME, FUNC)                                     \
+static VALUE sm_##TYPE##_##NAME##_bang(VALUE sm_self, VALUE sm_scalar)          \
+{                                                                               \
+  TYPE##_t *self;                                                               \
+  s_float_t scalar = (s_float_t)NUM2DBL(sm_scalar);                             \
+  sm_check_writable(sm_self);                                                   \
+  self = sm_unwrap_##TYPE(sm_self, NULL);                                       \
+  FUNC(*self, scalar, *self);                                                   \
+  return sm_self;                                                               \
+}
 
-  switch (argc) {
-  case 2: {
-    vec3_t *out;
+/*
+  Defines sm_TYPE_NAME_bang, which applies FUNC(*self, *rhs, *self) and returns
+  self. The operand is unwrapped with sm_TYPE_operand, so Numerics are only
+  accepted when BROADCAST is non-zero.
+*/
+#define SM_INPLACE_BINARY(TYPE, NAME, FUNC, BROADCAST)                          \
+static VALUE sm_##TYPE##_##NAME##_bang(VALUE sm_self, VALUE sm_rhs)             \
+{                                                                               \
+  TYPE##_t *self;                                                               \
+  TYPE##_t broadcast;                                                           \
+  const TYPE##_t *rhs = sm_##TYPE##_operand(sm_rhs, (BROADCAST) ? broadcast : NULL); \
+  sm_check_writable(sm_self);                                                   \
+  self = sm_unwrap_##TYPE(sm_self, NULL);                                       \
+  FUNC(*self, *rhs, *self);                                                     \
+  return sm_self;                                                               \
+}
 
-    sm_out = argv[1];
+/*
+  Defines sm_TYPE_NAME_bang, which transforms the Vec3 (or Vec4/Quat) operand
+  in place with FUNC(*self, *rhs, *rhs) and returns the operand.
+*/
+#define SM_INPLACE_TRANSFORM_VEC3(TYPE, NAME, FUNC)                             \
+static VALUE sm_##TYPE##_##NAME##_bang(VALUE sm_self, VALUE sm_rhs)             \
+{                                                                               \
+  vec3_t *rhs;                                                                  \
+  sm_check_writable(sm_rhs);                                                    \
+  rhs = sm_vec3_operand(sm_rhs, NULL);                                          \
+  FUNC(*sm_unwrap_##TYPE(sm_self, NULL), *rhs, *rhs);                           \
+  return sm_rhs;                                                                \
+}
+
+SM_INPLACE_UNARY(vec2, normalize, vec2_normalize)
+SM_INPLACE_UNARY(vec2, inverse, vec2_inverse)
+SM_INPLACE_UNARY(vec2, negate, vec2_negate)
+SM_INPLACE_BINARY(vec2, multiply_vec2, vec2_multiply, 0)
+SM_INPLACE_BINARY(vec2, add, vec2_add, 1)
+SM_INPLACE_BINARY(vec2, subtract, vec2_subtract, 1)
+SM_INPLACE_SCALAR(vec2, scale, vec2_scale)
+SM_INPLACE_SCALAR(vec2, divide, vec2_divide)
+
+SM_INPLACE_UNARY(vec3, normalize, vec3_normalize)
+SM_INPLACE_UNARY(vec3, inverse, vec3_inverse)
+SM_INPLACE_UNARY(vec3, negate, vec3_negate)
+SM_INPLACE_BINARY(vec3, cross_product, vec3_cross_product, 0)
+SM_INPLACE_BINARY(vec3, multiply_vec3, vec3_multiply, 0)
+SM_INPLACE_BINARY(vec3, add, vec3_add, 1)
+SM_INPLACE_BINARY(vec3, subtract, vec3_subtract, 1)
+SM_INPLACE_SCALAR(vec3, scale, vec3_scale)
+SM_INPLACE_SCALAR(vec3, divide, vec3_divide)
+
+/* Quat shares the Vec4 variants of these, as with the non-bang methods. */
+SM_INPLACE_UNARY(vec4, normalize, vec4_normalize)
+SM_INPLACE_UNARY(vec4, inverse, vec4_inverse)
+SM_INPLACE_UNARY(vec4, negate, vec4_negate)
+SM_INPLACE_BINARY(vec4, multiply_vec4, vec4_multiply, 0)
+SM_INPLACE_BINARY(vec4, add, vec4_add, 1)
+SM_INPLACE_BINARY(vec4, subtract, vec4_subtract, 1)
+SM_INPLACE_SCALAR(vec4, scale, vec4_scale)
+SM_INPLACE_SCALAR(vec4, divide, vec4_divide)
+
+SM_INPLACE_UNARY(quat, inverse, quat_inverse)
+SM_INPLACE_TRANSFORM_VEC3(quat, multiply_vec3, quat_multiply_vec3)
+
+SM_INPLACE_UNARY(mat3, transpose, mat3_transpose)
+SM_INPLACE_UNARY(mat3, adjoint, mat3_adjoint)
+SM_INPLACE_UNARY(mat3, cofactor, mat3_cofactor)
+SM_INPLACE_INVERSE(mat3, inverse, mat3_inverse)
+SM_INPLACE_TRANSFORM_VEC3(mat3, rotate_vec3, mat3_rotate_vec3)
+SM_INPLACE_TRANSFORM_VEC3(mat3, inverse_rotate_vec3, mat3_inv_rotate_vec3)
+
+SM_INPLACE_UNARY(mat4, transpose, mat4_transpose)
+SM_INPLACE_UNARY(mat4, inverse_orthogonal, mat4_inverse_orthogonal)
+SM_INPLACE_UNARY(mat4, adjoint, mat4_adjoint)
+SM_INPLACE_INVERSE(mat4, inverse_affine, mat4_inverse_affine)
+SM_INPLACE_INVERSE(mat4, inverse_general, mat4_inverse_general)
+SM_INPLACE_TRANSFORM_VEC3(mat4, transform_vec3, mat4_transform_vec3)
+SM_INPLACE_TRANSFORM_VEC3(mat4, rotate_vec3, mat4_rotate_vec3)
+SM_INPLACE_TRANSFORM_VEC3(mat4, inverse_rotate_vec3, mat4_inv_rotate_vec3)
+
+#undef SM_INPLACE_UNARY
+#undef SM_INPLACE_INVERSE
+#undef SM_INPLACE_SCALAR
+#undef SM_INPLACE_BINARY
+#undef SM_INPLACE_TRANSFORM_VEC3
+
+
+
+/*
+ * Multiplies this quaternion by another in place and returns self.
+ *
+ * call-seq: multiply_quat!(quat) -> self
+ */
+static VALUE sm_quat_multiply_quat_bang(VALUE sm_self, VALUE sm_rhs)
+{
+  quat_t *self;
+  const quat_t *rhs = sm_vec4_operand(sm_rhs, NULL);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_quat(sm_self, NULL);
+  quat_multiply(*self, *rhs, *self);
+  return sm_self;
+}
 
-    if (RTEST(sm_out)) {
-      if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-        rb_raise(rb_eTypeError,
-          kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-          rb_obj_classname(sm_out));
-        return Qnil;
-      }
-      rb_check_frozen(sm_out);
-    } else {
-      goto SM_LABEL(no_output);
-    }
 
-    out = sm_unwrap_vec3(sm_out, NULL);
-    mat3_get_row3(*self, index, *out);
 
-    break;
-  }
+/*
+ * Interpolates this quaternion toward destination in place and returns self.
+ *
+ * call-seq: slerp!(destination, alpha) -> self
+ */
+static VALUE sm_quat_slerp_bang(VALUE sm_self, VALUE sm_destination, VALUE sm_alpha)
+{
+  quat_t *self;
+  const quat_t *destination = sm_vec4_operand(sm_destination, NULL);
+  s_float_t alpha = (s_float_t)NUM2DBL(sm_alpha);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_quat(sm_self, NULL);
+  quat_slerp(*self, *destination, alpha, *self);
+  return sm_self;
+}
 
-  case 1: SM_LABEL(no_output): {
-    vec3_t out;
-    mat3_get_row3(*self, index, out);
-    sm_out = sm_wrap_vec3(out, Qnil);
-    rb_obj_call_init(sm_out, 0, 0);
-    break;
-  }
 
-  default: {
-    rb_raise(rb_eArgError, "Invalid number of arguments to get_row3 - expected 1 or 2");
-    break;
-  }
-  }
 
-  return sm_out;
+/*
+ * Multiplies this matrix by another in place and returns self.
+ *
+ * call-seq: multiply_mat3!(mat3) -> self
+ */
+static VALUE sm_mat3_multiply_mat3_bang(VALUE sm_self, VALUE sm_rhs)
+{
+  mat3_t *self;
+  SM_RAISE_IF_NOT_TYPE(sm_rhs, mat3);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_mat3(sm_self, NULL);
+  mat3_multiply(*self, *sm_unwrap_mat3(sm_rhs, NULL), *self);
+  return sm_self;
 }
 
 
 
 /*
- * Returns a Vec3 whose components are that of the column at the given index.
+ * Scales the matrix's columns in place and returns self.
  *
- * call-seq:
- *    get_column3(index, output = nil) -> output or new vec3
+ * call-seq: scale!(x, y, z) -> self
  */
-static VALUE sm_mat3_get_column3(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_scale_bang(VALUE sm_self, VALUE sm_x, VALUE sm_y, VALUE sm_z)
 {
   mat3_t *self;
-  int index;
-  VALUE sm_out;
-
+  sm_check_writable(sm_self);
   self = sm_unwrap_mat3(sm_self, NULL);
-  index = NUM2INT(argv[0]);
-  sm_out = Qnil;
+  mat3_scale(*self, NUM2DBL(sm_x), NUM2DBL(sm_y), NUM2DBL(sm_z), *self);
+  return sm_self;
+}
 
-  if (index < 0 || index > 2) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 2)", index);
-    return Qnil;
-  }
 
-  switch (argc) {
-  case 2: {
-    vec3_t *out;
 
-    sm_out = argv[1];
+/*
+ * Multiplies this matrix by another in place and returns self.
+ *
+ * call-seq: multiply_mat4!(mat4) -> self
+ */
+static VALUE sm_mat4_multiply_mat4_bang(VALUE sm_self, VALUE sm_rhs)
+{
+  mat4_t *self;
+  SM_RAISE_IF_NOT_TYPE(sm_rhs, mat4);
+  sm_check_writable(sm_self);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  mat4_multiply(*self, *sm_unwrap_mat4(sm_rhs, NULL), *self);
+  return sm_self;
+}
 
-    if (RTEST(sm_out)) {
-      if (!SM_IS_A(sm_out, vec3) && !SM_IS_A(sm_out, vec4) && !SM_IS_A(sm_out, quat)) {
-        rb_raise(rb_eTypeError,
-          kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-          rb_obj_classname(sm_out));
-        return Qnil;
-      }
-      rb_check_frozen(sm_out);
-    } else {
-      goto SM_LABEL(no_output);
-    }
 
-    out = sm_unwrap_vec3(sm_out, NULL);
-    mat3_get_column3(*self, index, *out);
 
-    break;
-  }
+/*
+ * Transforms the Vec4 in place by this matrix and returns the Vec4.
+ *
+ * call-seq: multiply_vec4!(vec4) -> vec4
+ */
+static VALUE sm_mat4_multiply_vec4_bang(VALUE sm_self, VALUE sm_rhs)
+{
+  vec4_t *rhs;
+  sm_check_writable(sm_rhs);
+  rhs = sm_vec4_operand(sm_rhs, NULL);
+  mat4_multiply_vec4(*sm_unwrap_mat4(sm_self, NULL), *rhs, *rhs);
+  return sm_rhs;
+}
 
-  case 1: SM_LABEL(no_output): {
-    vec3_t out;
-    mat3_get_column3(*self, index, out);
-    sm_out = sm_wrap_vec3(out, Qnil);
-    rb_obj_call_init(sm_out, 0, 0);
-    break;
-  }
 
-  default: {
-    rb_raise(rb_eArgError, "Invalid number of arguments to get_column3 - expected 1 or 2");
-    break;
-  }
-  }
 
-  return sm_out;
+/*
+ * Scales the matrix's inner 3x3 columns in place and returns self.
+ *
+ * call-seq: scale!(x, y, z) -> self
+ */
+static VALUE sm_mat4_scale_bang(VALUE sm_self, VALUE sm_x, VALUE sm_y, VALUE sm_z)
+{
+  mat4_t *self;
+  sm_check_writable(sm_self);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  mat4_scale(*self, NUM2DBL(sm_x), NUM2DBL(sm_y), NUM2DBL(sm_z), *self);
+  return sm_self;
 }
 
 
 
 /*
- * Sets the matrix's row at the given index to the given vector.
+ * Translates the matrix in place and returns self.
  *
  * call-seq:
- *    set_row3(index, vec3) -> self
+ *    translate!(vec3) -> self
+ *    translate!(x, y, z) -> self
  */
-static VALUE sm_mat3_set_row3(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_mat4_translate_bang(int argc, VALUE *argv, VALUE sm_self)
 {
-  const vec3_t *value;
-  int index;
-  mat3_t *self;
-
-  if (!SM_IS_A(sm_value, vec3) && !SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_value));
-    return Qnil;
-  }
-
-  self = sm_unwrap_mat3(sm_self, NULL);
-  value = sm_unwrap_vec3(sm_value, NULL);
-  index = NUM2INT(sm_index);
+  mat4_t *self;
+  vec3_t xyz;
 
-  if (index < 0 || index > 2) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 2)", index);
-    return Qnil;
+  if (argc == 1) {
+    vec3_copy(*sm_vec3_operand(argv[0], NULL), xyz);
+  } else if (argc == 3) {
+    xyz[0] = NUM2DBL(argv[0]);
+    xyz[1] = NUM2DBL(argv[1]);
+    xyz[2] = NUM2DBL(argv[2]);
+  } else {
+    rb_raise(rb_eArgError, "Invalid number of arguments to translate!");
   }
 
-  mat3_set_row3(index, *value, *self);
-
+  sm_check_writable(sm_self);
+  self = sm_unwrap_mat4(sm_self, NULL);
+  mat4_translate(xyz[0], xyz[1], xyz[2], *self, *self);
   return sm_self;
 }
 
 
 
 /*
- * Sets the matrix's column at the given index to the given vector.
+ * Calls #multiply_vec2! when given a vector, or #scale! when given a Numeric.
  *
- * call-seq:
- *    set_column3(index, value) -> self
+ * call-seq: multiply!(rhs) -> self
  */
-static VALUE sm_mat3_set_column3(VALUE sm_self, VALUE sm_index, VALUE sm_value)
+static VALUE sm_vec2_multiply_bang(VALUE sm_self, VALUE sm_rhs)
 {
-  const vec3_t *value;
-  int index;
-  mat3_t *self;
-
-  if (!SM_IS_A(sm_value, vec3) && !SM_IS_A(sm_value, vec4) && !SM_IS_A(sm_value, quat)) {
-    rb_raise(rb_eTypeError,
-      kSM_WANT_THREE_OR_FOUR_FORMAT_LIT,
-      rb_obj_classname(sm_value));
-    return Qnil;
+  if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_vec2_scale_bang(sm_self, sm_rhs);
   }
+  return sm_vec2_multiply_vec2_bang(sm_self, sm_rhs);
+}
 
-  self = sm_unwrap_mat3(sm_self, NULL);
-  value = sm_unwrap_vec3(sm_value, NULL);
-  index = NUM2INT(sm_index);
 
-  if (index < 0 || index > 2) {
-    rb_raise(rb_eRangeError, "Index %d is out of range, must be (0 .. 2)", index);
-    return Qnil;
+
+/*
+ * Calls #multiply_vec3! when given a vector, or #scale! when given a Numeric.
+ *
+ * call-seq: multiply!(rhs) -> self
+ */
+static VALUE sm_vec3_multiply_bang(VALUE sm_self, VALUE sm_rhs)
+{
+  if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_vec3_scale_bang(sm_self, sm_rhs);
   }
+  return sm_vec3_multiply_vec3_bang(sm_self, sm_rhs);
+}
 
-  mat3_set_column3(index, *value, *self);
 
-  return sm_self;
+
+/*
+ * Calls #multiply_vec4! when given a Vec4 or Quat, or #scale! when given a
+ * Numeric.
+ *
+ * call-seq: multiply!(rhs) -> self
+ */
+static VALUE sm_vec4_multiply_bang(VALUE sm_self, VALUE sm_rhs)
+{
+  if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_vec4_scale_bang(sm_self, sm_rhs);
+  }
+  return sm_vec4_multiply_vec4_bang(sm_self, sm_rhs);
 }
 
 
 
 /*
- * Sets self to the identity matrix.
+ * Calls #multiply_quat! when given a Quat, #scale! when given a Numeric, or
+ * #multiply_vec3! when given a Vec3. The latter modifies and returns the Vec3.
  *
  * call-seq:
- *    load_identity -> self
+ *    multiply!(quat) -> self
+ *    multiply!(scalar) -> self
+ *    multiply!(vec3) -> vec3
  */
-static VALUE sm_mat3_identity(VALUE sm_self)
+static VALUE sm_quat_multiply_bang(VALUE sm_self, VALUE sm_rhs)
 {
-  mat3_t *self = sm_unwrap_mat3(sm_self, NULL);
-  mat3_identity(*self);
-  return sm_self;
+  if (SM_IS_A(sm_rhs, quat)) {
+    return sm_quat_multiply_quat_bang(sm_self, sm_rhs);
+  } else if (SM_IS_A(sm_rhs, vec3)) {
+    return sm_quat_multiply_vec3_bang(sm_self, sm_rhs);
+  } else if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_vec4_scale_bang(sm_self, sm_rhs);
+  }
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
 }
 
 
 
 /*
- * Scales Mat3's columns by X, Y, and Z and returns the result.
+ * Calls #multiply_mat3! when given a Mat3, #scale!(scalar, scalar, scalar)
+ * when given a Numeric, or #rotate_vec3! when given a Vec3. The latter
+ * modifies and returns the Vec3.
  *
  * call-seq:
- *    scale(x, y, z, output = nil) -> output or new mat3
+ *    multiply!(mat3) -> self
+ *    multiply!(scalar) -> self
+ *    multiply!(vec3) -> vec3
  */
-static VALUE sm_mat3_scale(int argc, VALUE *argv, VALUE sm_self)
+static VALUE sm_mat3_multiply_bang(VALUE sm_self, VALUE sm_rhs)
 {
-  VALUE sm_out;
-  VALUE sm_x, sm_y, sm_z;
-  s_float_t x, y, z;
-  mat3_t *self = sm_unwrap_mat3(sm_self, NULL);
-
-  rb_scan_args(argc, argv, "31", &sm_x, &sm_y, &sm_z, &sm_out);
-  x = NUM2DBL(sm_x);
-  y = NUM2DBL(sm_y);
-  z = NUM2DBL(sm_z);
-
-  if (SM_IS_A(sm_out, mat3)) {
-    rb_check_frozen(sm_out);
-    mat3_scale(*self, x, y, z, *sm_unwrap_mat3(sm_out, NULL));
-  } else {
-    mat3_t out;
-    mat3_scale(*self, x, y, z, out);
-    sm_out = sm_wrap_mat3(out, rb_obj_class(sm_self));
-    rb_obj_call_init(sm_out, 0, 0);
+  if (SM_IS_A(sm_rhs, mat3)) {
+    return sm_mat3_multiply_mat3_bang(sm_self, sm_rhs);
+  } else if (SM_IS_A(sm_rhs, vec3)) {
+    return sm_mat3_rotate_vec3_bang(sm_self, sm_rhs);
+  } else if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_mat3_scale_bang(sm_self, sm_rhs, sm_rhs, sm_rhs);
   }
-
-  return sm_out;
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
 }
 
 
 
 /*
- * Tests this Mat3 and another Mat3 for equivalency.
+ * Calls #multiply_mat4! when given a Mat4, #scale!(scalar, scalar, scalar)
+ * when given a Numeric, #multiply_vec4! when given a Vec4, or
+ * #transform_vec3! when given a Vec3. The latter two modify and return the
+ * vector.
  *
  * call-seq:
- *    mat3 == other_mat3 -> bool
+ *    multiply!(mat4) -> self
+ *    multiply!(scalar) -> self
+ *    multiply!(vec4) -> vec4
+ *    multiply!(vec3) -> vec3
  */
-static VALUE sm_mat3_equals(VALUE sm_self, VALUE sm_other)
+static VALUE sm_mat4_multiply_bang(VALUE sm_self, VALUE sm_rhs)
 {
-  if (!RTEST(sm_other) || !SM_IS_A(sm_other, mat3)) {
-    return Qfalse;
+  if (SM_IS_A(sm_rhs, mat4)) {
+    return sm_mat4_multiply_mat4_bang(sm_self, sm_rhs);
+  } else if (SM_IS_A(sm_rhs, vec4)) {
+    return sm_mat4_multiply_vec4_bang(sm_self, sm_rhs);
+  } else if (SM_IS_A(sm_rhs, vec3)) {
+    return sm_mat4_transform_vec3_bang(sm_self, sm_rhs);
+  } else if (SM_IS_NUMERIC(sm_rhs)) {
+    return sm_mat4_scale_bang(sm_self, sm_rhs, sm_rhs, sm_rhs);
   }
-
-  return mat3_equals(*sm_unwrap_mat3(sm_self, NULL), *sm_unwrap_mat3(sm_other, NULL)) ? Qtrue : Qfalse;
+  rb_raise(rb_eTypeError, "Invalid type for RHS: %s", rb_obj_classname(sm_rhs));
+  return Qnil;
 }
 
 
@@ -6810,6 +12841,7 @@ void Init_bindings()
      kRB_SIZE_METHOD, kRB_BYTESIZE_METHOD;
 
   kRB_NAME_FREEZE           = rb_intern("freeze");
+  kRB_NAME_NEW              = rb_intern("new");
   kRB_IVAR_MATHARRAY_LENGTH = rb_intern("__length");
   kRB_IVAR_MATHARRAY_CACHE  = rb_intern("__cache");
   kRB_IVAR_MATHARRAY_SOURCE = rb_intern("__source");
@@ -6872,6 +12904,25 @@ void Init_bindings()
   rb_define_method(s_sm_vec2_klass, "magnitude", sm_vec2_magnitude, 0);
   rb_define_method(s_sm_vec2_klass, "scale", sm_vec2_scale, -1);
   rb_define_method(s_sm_vec2_klass, "divide", sm_vec2_divide, -1);
+  rb_define_method(s_sm_vec2_klass, "multiply", sm_vec2_multiply_generic, -1);
+  rb_define_method(s_sm_vec2_klass, "normalize!", sm_vec2_normalize_bang, 0);
+  rb_define_method(s_sm_vec2_klass, "inverse!", sm_vec2_inverse_bang, 0);
+  rb_define_method(s_sm_vec2_klass, "negate!", sm_vec2_negate_bang, 0);
+  rb_define_method(s_sm_vec2_klass, "multiply_vec2!", sm_vec2_multiply_vec2_bang, 1);
+  rb_define_method(s_sm_vec2_klass, "multiply!", sm_vec2_multiply_bang, 1);
+  rb_define_method(s_sm_vec2_klass, "add!", sm_vec2_add_bang, 1);
+  rb_define_method(s_sm_vec2_klass, "subtract!", sm_vec2_subtract_bang, 1);
+  rb_define_method(s_sm_vec2_klass, "scale!", sm_vec2_scale_bang, 1);
+  rb_define_method(s_sm_vec2_klass, "divide!", sm_vec2_divide_bang, 1);
+  rb_define_method(s_sm_vec2_klass, "component_min", sm_vec2_component_min, -1);
+  rb_define_method(s_sm_vec2_klass, "component_max", sm_vec2_component_max, -1);
+  rb_define_method(s_sm_vec2_klass, "clamp", sm_vec2_clamp, -1);
+  rb_define_method(s_sm_vec2_klass, "lerp", sm_vec2_lerp, -1);
+  rb_define_method(s_sm_vec2_klass, "abs", sm_vec2_abs, -1);
+  rb_define_method(s_sm_vec2_klass, "floor", sm_vec2_floor, -1);
+  rb_define_method(s_sm_vec2_klass, "ceil", sm_vec2_ceil, -1);
+  rb_define_method(s_sm_vec2_klass, "sign", sm_vec2_sign, -1);
+  rb_define_method(s_sm_vec2_klass, "noise", sm_vec2_noise, 0);
   rb_define_method(s_sm_vec2_klass, "==", sm_vec2_equals, 1);
   rb_alias(s_sm_vec2_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
@@ -6899,6 +12950,26 @@ void Init_bindings()
   rb_define_method(s_sm_vec3_klass, "magnitude", sm_vec3_magnitude, 0);
   rb_define_method(s_sm_vec3_klass, "scale", sm_vec3_scale, -1);
   rb_define_method(s_sm_vec3_klass, "divide", sm_vec3_divide, -1);
+  rb_define_method(s_sm_vec3_klass, "multiply", sm_vec3_multiply_generic, -1);
+  rb_define_method(s_sm_vec3_klass, "normalize!", sm_vec3_normalize_bang, 0);
+  rb_define_method(s_sm_vec3_klass, "inverse!", sm_vec3_inverse_bang, 0);
+  rb_define_method(s_sm_vec3_klass, "negate!", sm_vec3_negate_bang, 0);
+  rb_define_method(s_sm_vec3_klass, "cross_product!", sm_vec3_cross_product_bang, 1);
+  rb_define_method(s_sm_vec3_klass, "multiply_vec3!", sm_vec3_multiply_vec3_bang, 1);
+  rb_define_method(s_sm_vec3_klass, "multiply!", sm_vec3_multiply_bang, 1);
+  rb_define_method(s_sm_vec3_klass, "add!", sm_vec3_add_bang, 1);
+  rb_define_method(s_sm_vec3_klass, "subtract!", sm_vec3_subtract_bang, 1);
+  rb_define_method(s_sm_vec3_klass, "scale!", sm_vec3_scale_bang, 1);
+  rb_define_method(s_sm_vec3_klass, "divide!", sm_vec3_divide_bang, 1);
+  rb_define_method(s_sm_vec3_klass, "component_min", sm_vec3_component_min, -1);
+  rb_define_method(s_sm_vec3_klass, "component_max", sm_vec3_component_max, -1);
+  rb_define_method(s_sm_vec3_klass, "clamp", sm_vec3_clamp, -1);
+  rb_define_method(s_sm_vec3_klass, "lerp", sm_vec3_lerp, -1);
+  rb_define_method(s_sm_vec3_klass, "abs", sm_vec3_abs, -1);
+  rb_define_method(s_sm_vec3_klass, "floor", sm_vec3_floor, -1);
+  rb_define_method(s_sm_vec3_klass, "ceil", sm_vec3_ceil, -1);
+  rb_define_method(s_sm_vec3_klass, "sign", sm_vec3_sign, -1);
+  rb_define_method(s_sm_vec3_klass, "noise", sm_vec3_noise, 0);
   rb_define_method(s_sm_vec3_klass, "==", sm_vec3_equals, 1);
   rb_alias(s_sm_vec3_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
@@ -6925,6 +12996,25 @@ void Init_bindings()
   rb_define_method(s_sm_vec4_klass, "magnitude", sm_vec4_magnitude, 0);
   rb_define_method(s_sm_vec4_klass, "scale", sm_vec4_scale, -1);
   rb_define_method(s_sm_vec4_klass, "divide", sm_vec4_divide, -1);
+  rb_define_method(s_sm_vec4_klass, "multiply", sm_vec4_multiply_generic, -1);
+  rb_define_method(s_sm_vec4_klass, "normalize!", sm_vec4_normalize_bang, 0);
+  rb_define_method(s_sm_vec4_klass, "inverse!", sm_vec4_inverse_bang, 0);
+  rb_define_method(s_sm_vec4_klass, "negate!", sm_vec4_negate_bang, 0);
+  rb_define_method(s_sm_vec4_klass, "multiply_vec4!", sm_vec4_multiply_vec4_bang, 1);
+  rb_define_method(s_sm_vec4_klass, "multiply!", sm_vec4_multiply_bang, 1);
+  rb_define_method(s_sm_vec4_klass, "add!", sm_vec4_add_bang, 1);
+  rb_define_method(s_sm_vec4_klass, "subtract!", sm_vec4_subtract_bang, 1);
+  rb_define_method(s_sm_vec4_klass, "scale!", sm_vec4_scale_bang, 1);
+  rb_define_method(s_sm_vec4_klass, "divide!", sm_vec4_divide_bang, 1);
+  rb_define_method(s_sm_vec4_klass, "component_min", sm_vec4_component_min, -1);
+  rb_define_method(s_sm_vec4_klass, "component_max", sm_vec4_component_max, -1);
+  rb_define_method(s_sm_vec4_klass, "clamp", sm_vec4_clamp, -1);
+  rb_define_method(s_sm_vec4_klass, "lerp", sm_vec4_lerp, -1);
+  rb_define_method(s_sm_vec4_klass, "abs", sm_vec4_abs, -1);
+  rb_define_method(s_sm_vec4_klass, "floor", sm_vec4_floor, -1);
+  rb_define_method(s_sm_vec4_klass, "ceil", sm_vec4_ceil, -1);
+  rb_define_method(s_sm_vec4_klass, "sign", sm_vec4_sign, -1);
+  rb_define_method(s_sm_vec4_klass, "noise", sm_vec4_noise, 0);
   rb_define_method(s_sm_vec4_klass, "==", sm_vec4_equals, 1);
   rb_alias(s_sm_vec4_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
@@ -6951,6 +13041,18 @@ void Init_bindings()
   rb_define_method(s_sm_quat_klass, "divide", sm_vec4_divide, -1);
   rb_define_method(s_sm_quat_klass, "add", sm_vec4_add, -1);
   rb_define_method(s_sm_quat_klass, "subtract", sm_vec4_subtract, -1);
+  rb_define_method(s_sm_quat_klass, "multiply", sm_quat_multiply_generic, -1);
+  rb_define_method(s_sm_quat_klass, "normalize!", sm_vec4_normalize_bang, 0);
+  rb_define_method(s_sm_quat_klass, "inverse!", sm_quat_inverse_bang, 0);
+  rb_define_method(s_sm_quat_klass, "negate!", sm_vec4_negate_bang, 0);
+  rb_define_method(s_sm_quat_klass, "multiply_quat!", sm_quat_multiply_quat_bang, 1);
+  rb_define_method(s_sm_quat_klass, "multiply_vec3!", sm_quat_multiply_vec3_bang, 1);
+  rb_define_method(s_sm_quat_klass, "multiply!", sm_quat_multiply_bang, 1);
+  rb_define_method(s_sm_quat_klass, "add!", sm_vec4_add_bang, 1);
+  rb_define_method(s_sm_quat_klass, "subtract!", sm_vec4_subtract_bang, 1);
+  rb_define_method(s_sm_quat_klass, "scale!", sm_vec4_scale_bang, 1);
+  rb_define_method(s_sm_quat_klass, "divide!", sm_vec4_divide_bang, 1);
+  rb_define_method(s_sm_quat_klass, "slerp!", sm_quat_slerp_bang, 2);
   rb_define_method(s_sm_quat_klass, "dot_product", sm_vec4_dot_product, 1);
   rb_define_method(s_sm_quat_klass, "magnitude_squared", sm_vec4_magnitude_squared, 0);
   rb_define_method(s_sm_quat_klass, "magnitude", sm_vec4_magnitude, 0);
@@ -6983,6 +13085,20 @@ void Init_bindings()
   rb_define_method(s_sm_mat4_klass, "multiply_vec4", sm_mat4_multiply_vec4, -1);
   rb_define_method(s_sm_mat4_klass, "transform_vec3", sm_mat4_transform_vec3, -1);
   rb_define_method(s_sm_mat4_klass, "rotate_vec3", sm_mat4_rotate_vec3, -1);
+  rb_define_method(s_sm_mat4_klass, "multiply", sm_mat4_multiply_generic, -1);
+  rb_define_method(s_sm_mat4_klass, "transpose!", sm_mat4_transpose_bang, 0);
+  rb_define_method(s_sm_mat4_klass, "inverse_orthogonal!", sm_mat4_inverse_orthogonal_bang, 0);
+  rb_define_method(s_sm_mat4_klass, "adjoint!", sm_mat4_adjoint_bang, 0);
+  rb_define_method(s_sm_mat4_klass, "multiply_mat4!", sm_mat4_multiply_mat4_bang, 1);
+  rb_define_method(s_sm_mat4_klass, "multiply_vec4!", sm_mat4_multiply_vec4_bang, 1);
+  rb_define_method(s_sm_mat4_klass, "transform_vec3!", sm_mat4_transform_vec3_bang, 1);
+  rb_define_method(s_sm_mat4_klass, "rotate_vec3!", sm_mat4_rotate_vec3_bang, 1);
+  rb_define_method(s_sm_mat4_klass, "inverse_rotate_vec3!", sm_mat4_inverse_rotate_vec3_bang, 1);
+  rb_define_method(s_sm_mat4_klass, "multiply!", sm_mat4_multiply_bang, 1);
+  rb_define_method(s_sm_mat4_klass, "scale!", sm_mat4_scale_bang, 3);
+  rb_define_method(s_sm_mat4_klass, "translate!", sm_mat4_translate_bang, -1);
+  rb_define_method(s_sm_mat4_klass, "inverse_affine!", sm_mat4_inverse_affine_bang, 0);
+  rb_define_method(s_sm_mat4_klass, "inverse_general!", sm_mat4_inverse_general_bang, 0);
   rb_define_method(s_sm_mat4_klass, "inverse_rotate_vec3", sm_mat4_inv_rotate_vec3, -1);
   rb_define_method(s_sm_mat4_klass, "inverse_affine", sm_mat4_inverse_affine, -1);
   rb_define_method(s_sm_mat4_klass, "inverse_general", sm_mat4_inverse_general, -1);
@@ -7001,6 +13117,7 @@ void Init_bindings()
 
   rb_define_singleton_method(s_sm_mat3_klass, "new", sm_mat3_new, -1);
   rb_define_singleton_method(s_sm_mat3_klass, "angle_axis", sm_mat3_angle_axis, -1);
+  rb_define_singleton_method(s_sm_mat3_klass, "trs_2d", sm_mat3_trs_2d, -1);
   rb_define_method(s_sm_mat3_klass, "initialize", sm_mat3_init, -1);
   rb_define_method(s_sm_mat3_klass, "set", sm_mat3_init, -1);
   rb_define_method(s_sm_mat3_klass, "to_mat4", sm_mat3_to_mat4, -1);
@@ -7019,9 +13136,23 @@ void Init_bindings()
   rb_define_method(s_sm_mat3_klass, "scale", sm_mat3_scale, -1);
   rb_define_method(s_sm_mat3_klass, "multiply_mat3", sm_mat3_multiply, -1);
   rb_define_method(s_sm_mat3_klass, "rotate_vec3", sm_mat3_rotate_vec3, -1);
+  rb_define_method(s_sm_mat3_klass, "multiply", sm_mat3_multiply_generic, -1);
+  rb_define_method(s_sm_mat3_klass, "transpose!", sm_mat3_transpose_bang, 0);
+  rb_define_method(s_sm_mat3_klass, "inverse!", sm_mat3_inverse_bang, 0);
+  rb_define_method(s_sm_mat3_klass, "adjoint!", sm_mat3_adjoint_bang, 0);
+  rb_define_method(s_sm_mat3_klass, "cofactor!", sm_mat3_cofactor_bang, 0);
+  rb_define_method(s_sm_mat3_klass, "multiply_mat3!", sm_mat3_multiply_mat3_bang, 1);
+  rb_define_method(s_sm_mat3_klass, "rotate_vec3!", sm_mat3_rotate_vec3_bang, 1);
+  rb_define_method(s_sm_mat3_klass, "inverse_rotate_vec3!", sm_mat3_inverse_rotate_vec3_bang, 1);
+  rb_define_method(s_sm_mat3_klass, "multiply!", sm_mat3_multiply_bang, 1);
+  rb_define_method(s_sm_mat3_klass, "scale!", sm_mat3_scale_bang, 3);
   rb_define_method(s_sm_mat3_klass, "inverse_rotate_vec3", sm_mat3_inv_rotate_vec3, -1);
   rb_define_method(s_sm_mat3_klass, "inverse", sm_mat3_inverse, -1);
+  rb_define_method(s_sm_mat3_klass, "inverse_affine", sm_mat3_inverse_affine, -1);
+  rb_define_method(s_sm_mat3_klass, "transform_vec2", sm_mat3_transform_vec2, -1);
+  rb_define_method(s_sm_mat3_klass, "rotate_vec2", sm_mat3_rotate_vec2, -1);
   rb_define_method(s_sm_mat3_klass, "determinant", sm_mat3_determinant, 0);
+  rb_define_method(s_sm_mat3_klass, "eigen_symmetric", sm_mat3_eigen_symmetric, -1);
   rb_define_method(s_sm_mat3_klass, "set_row3", sm_mat3_set_row3, 2);
   rb_define_method(s_sm_mat3_klass, "get_row3", sm_mat3_get_row3, -1);
   rb_define_method(s_sm_mat3_klass, "set_column3", sm_mat3_set_column3, 2);
@@ -7031,9 +13162,12 @@ void Init_bindings()
 
   #if BUILD_ARRAY_TYPE
 
+  s_sm_shared_arrays = st_init_numtable();
+
   s_sm_vec2_array_klass = rb_define_class_under(s_sm_snowmath_mod, "Vec2Array", rb_cData);
   rb_define_const(s_sm_vec2_array_klass, "TYPE", s_sm_vec2_klass);
   rb_define_singleton_method(s_sm_vec2_array_klass, "new", sm_vec2_array_new, 1);
+  rb_define_singleton_method(s_sm_vec2_array_klass, "lerp", sm_vec_array_s_lerp, -1);
   rb_define_method(s_sm_vec2_array_klass, "freeze", sm_mathtype_array_freeze, 0);
   rb_define_method(s_sm_vec2_array_klass, "fetch", sm_vec2_array_fetch, 1);
   rb_define_method(s_sm_vec2_array_klass, "store", sm_vec2_array_store, 2);
@@ -7041,11 +13175,44 @@ void Init_bindings()
   rb_define_method(s_sm_vec2_array_klass, "size", sm_vec2_array_size, 0);
   rb_define_method(s_sm_vec2_array_klass, "length", sm_mathtype_array_length, 0);
   rb_define_method(s_sm_vec2_array_klass, "address", sm_get_address, 0);
+  rb_define_method(s_sm_vec2_array_klass, "convert_to", sm_mathtype_array_convert_to, -1);
+  rb_define_method(s_sm_vec2_array_klass, "snapshot", sm_mathtype_array_snapshot, 0);
+  rb_define_method(s_sm_vec2_array_klass, "component_min", sm_vec_array_component_min, -1);
+  rb_define_method(s_sm_vec2_array_klass, "component_max", sm_vec_array_component_max, -1);
+  rb_define_method(s_sm_vec2_array_klass, "clamp", sm_vec_array_clamp, -1);
+  rb_define_method(s_sm_vec2_array_klass, "abs", sm_vec_array_abs, -1);
+  rb_define_method(s_sm_vec2_array_klass, "floor", sm_vec_array_floor, -1);
+  rb_define_method(s_sm_vec2_array_klass, "ceil", sm_vec_array_ceil, -1);
+  rb_define_method(s_sm_vec2_array_klass, "sign", sm_vec_array_sign, -1);
+  rb_define_method(s_sm_vec2_array_klass, "axpy!", sm_vec_array_axpy, 2);
+  rb_define_method(s_sm_vec2_array_klass, "integrate_euler!", sm_vec_array_integrate_euler, -1);
+  rb_define_method(s_sm_vec2_array_klass, "integrate_verlet!", sm_vec_array_integrate_verlet, -1);
+  rb_define_method(s_sm_vec2_array_klass, "fill_uniform!", sm_vec_array_fill_uniform, -1);
+  rb_define_method(s_sm_vec2_array_klass, "fill_gaussian!", sm_vec_array_fill_gaussian, -1);
+  rb_define_method(s_sm_vec2_array_klass, "fill_in_sphere!", sm_vec_array_fill_in_sphere, -1);
+  rb_define_method(s_sm_vec2_array_klass, "fill_on_sphere!", sm_vec_array_fill_on_sphere, -1);
+  rb_define_method(s_sm_vec2_array_klass, "noise", sm_vec_array_noise, -1);
+  rb_define_method(s_sm_vec2_array_klass, "fbm", sm_vec_array_fbm, -1);
+  rb_define_method(s_sm_vec2_array_klass, "transform", sm_vec2_array_transform, -1);
+  rb_define_method(s_sm_vec2_array_klass, "rotate", sm_vec2_array_rotate, -1);
+  rb_define_method(s_sm_vec2_array_klass, "polygon_contains", sm_vec2_array_polygon_contains, -1);
+  rb_define_method(s_sm_vec2_array_klass, "polygon_area", sm_vec2_array_polygon_area, -1);
+  rb_define_method(s_sm_vec2_array_klass, "polygon_centroid", sm_vec2_array_polygon_centroid, -1);
+  rb_define_method(s_sm_vec2_array_klass, "convex_hull", sm_vec2_array_convex_hull, -1);
+  rb_define_method(s_sm_vec2_array_klass, "intersect_segments", sm_vec2_array_intersect_segments, -1);
+  rb_define_method(s_sm_vec2_array_klass, "delta_encode", sm_mathtype_array_delta_encode, -1);
+  rb_define_method(s_sm_vec2_array_klass, "delta_apply!", sm_mathtype_array_delta_apply, 1);
+  rb_define_method(s_sm_vec2_array_klass, "digest", sm_mathtype_array_digest, -1);
+  rb_define_method(s_sm_vec2_array_klass, "==", sm_mathtype_array_equals, 1);
+  rb_define_method(s_sm_vec2_array_klass, "eql?", sm_mathtype_array_eql, 1);
+  rb_define_method(s_sm_vec2_array_klass, "hash", sm_mathtype_array_hash, 0);
+  rb_define_method(s_sm_vec2_array_klass, "approx_equal", sm_mathtype_array_approx_equal, -1);
   rb_alias(s_sm_vec2_array_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
   s_sm_vec3_array_klass = rb_define_class_under(s_sm_snowmath_mod, "Vec3Array", rb_cData);
   rb_define_const(s_sm_vec3_array_klass, "TYPE", s_sm_vec3_klass);
   rb_define_singleton_method(s_sm_vec3_array_klass, "new", sm_vec3_array_new, 1);
+  rb_define_singleton_method(s_sm_vec3_array_klass, "lerp", sm_vec_array_s_lerp, -1);
   rb_define_method(s_sm_vec3_array_klass, "freeze", sm_mathtype_array_freeze, 0);
   rb_define_method(s_sm_vec3_array_klass, "fetch", sm_vec3_array_fetch, 1);
   rb_define_method(s_sm_vec3_array_klass, "store", sm_vec3_array_store, 2);
@@ -7053,11 +13220,53 @@ void Init_bindings()
   rb_define_method(s_sm_vec3_array_klass, "size", sm_vec3_array_size, 0);
   rb_define_method(s_sm_vec3_array_klass, "length", sm_mathtype_array_length, 0);
   rb_define_method(s_sm_vec3_array_klass, "address", sm_get_address, 0);
+  rb_define_method(s_sm_vec3_array_klass, "convert_to", sm_mathtype_array_convert_to, -1);
+  rb_define_method(s_sm_vec3_array_klass, "snapshot", sm_mathtype_array_snapshot, 0);
+  rb_define_method(s_sm_vec3_array_klass, "component_min", sm_vec_array_component_min, -1);
+  rb_define_method(s_sm_vec3_array_klass, "component_max", sm_vec_array_component_max, -1);
+  rb_define_method(s_sm_vec3_array_klass, "clamp", sm_vec_array_clamp, -1);
+  rb_define_method(s_sm_vec3_array_klass, "abs", sm_vec_array_abs, -1);
+  rb_define_method(s_sm_vec3_array_klass, "floor", sm_vec_array_floor, -1);
+  rb_define_method(s_sm_vec3_array_klass, "ceil", sm_vec_array_ceil, -1);
+  rb_define_method(s_sm_vec3_array_klass, "sign", sm_vec_array_sign, -1);
+  rb_define_method(s_sm_vec3_array_klass, "axpy!", sm_vec_array_axpy, 2);
+  rb_define_method(s_sm_vec3_array_klass, "integrate_euler!", sm_vec_array_integrate_euler, -1);
+  rb_define_method(s_sm_vec3_array_klass, "integrate_verlet!", sm_vec_array_integrate_verlet, -1);
+  rb_define_method(s_sm_vec3_array_klass, "fill_uniform!", sm_vec_array_fill_uniform, -1);
+  rb_define_method(s_sm_vec3_array_klass, "fill_gaussian!", sm_vec_array_fill_gaussian, -1);
+  rb_define_method(s_sm_vec3_array_klass, "fill_in_sphere!", sm_vec_array_fill_in_sphere, -1);
+  rb_define_method(s_sm_vec3_array_klass, "fill_on_sphere!", sm_vec_array_fill_on_sphere, -1);
+  rb_define_method(s_sm_vec3_array_klass, "noise", sm_vec_array_noise, -1);
+  rb_define_method(s_sm_vec3_array_klass, "fbm", sm_vec_array_fbm, -1);
+  rb_define_method(s_sm_vec3_array_klass, "covariance", sm_vec3_array_covariance, -1);
+  rb_define_method(s_sm_vec3_array_klass, "fit_obbs", sm_vec3_array_fit_obbs, -1);
+  rb_define_method(s_sm_vec3_array_klass, "ritter_sphere", sm_vec3_array_ritter_sphere, -1);
+  rb_define_method(s_sm_vec3_array_klass, "bounding_sphere", sm_vec3_array_bounding_sphere, -1);
+  rb_define_method(s_sm_vec3_array_klass, "ritter_spheres", sm_vec3_array_ritter_spheres, -1);
+  rb_define_method(s_sm_vec3_array_klass, "bounding_spheres", sm_vec3_array_bounding_spheres, -1);
+  rb_define_method(s_sm_vec3_array_klass, "closest_on_segments", sm_vec3_array_closest_on_segments, -1);
+  rb_define_method(s_sm_vec3_array_klass, "closest_on_triangles", sm_vec3_array_closest_on_triangles, -1);
+  rb_define_method(s_sm_vec3_array_klass, "closest_on_aabbs", sm_vec3_array_closest_on_aabbs, -1);
+  rb_define_method(s_sm_vec3_array_klass, "pairwise_distances", sm_vec3_array_pairwise_distances, -1);
+  rb_define_method(s_sm_vec3_array_klass, "k_nearest", sm_vec3_array_k_nearest, -1);
+  rb_define_method(s_sm_vec3_array_klass, "pairs_within", sm_vec3_array_pairs_within, -1);
+  rb_define_method(s_sm_vec3_array_klass, "quantize", sm_vec3_array_quantize, -1);
+  rb_define_singleton_method(s_sm_vec3_array_klass, "dequantize", sm_vec3_array_s_dequantize, -1);
+  rb_define_method(s_sm_vec3_array_klass, "encode_octahedral", sm_vec3_array_encode_octahedral, -1);
+  rb_define_singleton_method(s_sm_vec3_array_klass, "decode_octahedral", sm_vec3_array_s_decode_octahedral, -1);
+  rb_define_method(s_sm_vec3_array_klass, "delta_encode", sm_mathtype_array_delta_encode, -1);
+  rb_define_method(s_sm_vec3_array_klass, "delta_apply!", sm_mathtype_array_delta_apply, 1);
+  rb_define_method(s_sm_vec3_array_klass, "digest", sm_mathtype_array_digest, -1);
+  rb_define_method(s_sm_vec3_array_klass, "==", sm_mathtype_array_equals, 1);
+  rb_define_method(s_sm_vec3_array_klass, "eql?", sm_mathtype_array_eql, 1);
+  rb_define_method(s_sm_vec3_array_klass, "hash", sm_mathtype_array_hash, 0);
+  rb_define_method(s_sm_vec3_array_klass, "approx_equal", sm_mathtype_array_approx_equal, -1);
   rb_alias(s_sm_vec3_array_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
   s_sm_vec4_array_klass = rb_define_class_under(s_sm_snowmath_mod, "Vec4Array", rb_cData);
   rb_define_const(s_sm_vec4_array_klass, "TYPE", s_sm_vec4_klass);
   rb_define_singleton_method(s_sm_vec4_array_klass, "new", sm_vec4_array_new, 1);
+  rb_define_singleton_method(s_sm_vec4_array_klass, "lerp", sm_vec_array_s_lerp, -1);
   rb_define_method(s_sm_vec4_array_klass, "freeze", sm_mathtype_array_freeze, 0);
   rb_define_method(s_sm_vec4_array_klass, "fetch", sm_vec4_array_fetch, 1);
   rb_define_method(s_sm_vec4_array_klass, "store", sm_vec4_array_store, 2);
@@ -7065,6 +13274,34 @@ void Init_bindings()
   rb_define_method(s_sm_vec4_array_klass, "size", sm_vec4_array_size, 0);
   rb_define_method(s_sm_vec4_array_klass, "length", sm_mathtype_array_length, 0);
   rb_define_method(s_sm_vec4_array_klass, "address", sm_get_address, 0);
+  rb_define_method(s_sm_vec4_array_klass, "convert_to", sm_mathtype_array_convert_to, -1);
+  rb_define_method(s_sm_vec4_array_klass, "snapshot", sm_mathtype_array_snapshot, 0);
+  rb_define_method(s_sm_vec4_array_klass, "component_min", sm_vec_array_component_min, -1);
+  rb_define_method(s_sm_vec4_array_klass, "component_max", sm_vec_array_component_max, -1);
+  rb_define_method(s_sm_vec4_array_klass, "clamp", sm_vec_array_clamp, -1);
+  rb_define_method(s_sm_vec4_array_klass, "abs", sm_vec_array_abs, -1);
+  rb_define_method(s_sm_vec4_array_klass, "floor", sm_vec_array_floor, -1);
+  rb_define_method(s_sm_vec4_array_klass, "ceil", sm_vec_array_ceil, -1);
+  rb_define_method(s_sm_vec4_array_klass, "sign", sm_vec_array_sign, -1);
+  rb_define_method(s_sm_vec4_array_klass, "axpy!", sm_vec_array_axpy, 2);
+  rb_define_method(s_sm_vec4_array_klass, "fill_uniform!", sm_vec_array_fill_uniform, -1);
+  rb_define_method(s_sm_vec4_array_klass, "fill_gaussian!", sm_vec_array_fill_gaussian, -1);
+  rb_define_method(s_sm_vec4_array_klass, "noise", sm_vec_array_noise, -1);
+  rb_define_method(s_sm_vec4_array_klass, "fbm", sm_vec_array_fbm, -1);
+  rb_define_method(s_sm_vec4_array_klass, "to_linear", sm_vec4_array_to_linear, -1);
+  rb_define_method(s_sm_vec4_array_klass, "to_srgb", sm_vec4_array_to_srgb, -1);
+  rb_define_method(s_sm_vec4_array_klass, "premultiply", sm_vec4_array_premultiply, -1);
+  rb_define_method(s_sm_vec4_array_klass, "pack_rgba8", sm_vec4_array_pack_rgba8, -1);
+  rb_define_singleton_method(s_sm_vec4_array_klass, "unpack_rgba8", sm_vec4_array_s_unpack_rgba8, -1);
+  rb_define_method(s_sm_vec4_array_klass, "pack_rgb10a2", sm_vec4_array_pack_rgb10a2, -1);
+  rb_define_singleton_method(s_sm_vec4_array_klass, "unpack_rgb10a2", sm_vec4_array_s_unpack_rgb10a2, -1);
+  rb_define_method(s_sm_vec4_array_klass, "delta_encode", sm_mathtype_array_delta_encode, -1);
+  rb_define_method(s_sm_vec4_array_klass, "delta_apply!", sm_mathtype_array_delta_apply, 1);
+  rb_define_method(s_sm_vec4_array_klass, "digest", sm_mathtype_array_digest, -1);
+  rb_define_method(s_sm_vec4_array_klass, "==", sm_mathtype_array_equals, 1);
+  rb_define_method(s_sm_vec4_array_klass, "eql?", sm_mathtype_array_eql, 1);
+  rb_define_method(s_sm_vec4_array_klass, "hash", sm_mathtype_array_hash, 0);
+  rb_define_method(s_sm_vec4_array_klass, "approx_equal", sm_mathtype_array_approx_equal, -1);
   rb_alias(s_sm_vec4_array_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
   s_sm_quat_array_klass = rb_define_class_under(s_sm_snowmath_mod, "QuatArray", rb_cData);
@@ -7077,6 +13314,24 @@ void Init_bindings()
   rb_define_method(s_sm_quat_array_klass, "size", sm_quat_array_size, 0);
   rb_define_method(s_sm_quat_array_klass, "length", sm_mathtype_array_length, 0);
   rb_define_method(s_sm_quat_array_klass, "address", sm_get_address, 0);
+  rb_define_method(s_sm_quat_array_klass, "convert_to", sm_mathtype_array_convert_to, -1);
+  rb_define_method(s_sm_quat_array_klass, "snapshot", sm_mathtype_array_snapshot, 0);
+  rb_define_method(s_sm_quat_array_klass, "multiply_quat", sm_quat_array_multiply_quat, -1);
+  rb_define_method(s_sm_quat_array_klass, "multiply_vec3", sm_quat_array_multiply_vec3, -1);
+  rb_define_method(s_sm_quat_array_klass, "renormalize!", sm_quat_array_renormalize, 0);
+  rb_define_method(s_sm_quat_array_klass, "integrate!", sm_quat_array_integrate, -1);
+  rb_define_method(s_sm_quat_array_klass, "fill_random!", sm_quat_array_fill_random, -1);
+  rb_define_method(s_sm_quat_array_klass, "encode_smallest3", sm_quat_array_encode_smallest3, -1);
+  rb_define_singleton_method(s_sm_quat_array_klass, "decode_smallest3", sm_quat_array_s_decode_smallest3, -1);
+  rb_define_method(s_sm_quat_array_klass, "encode_qtangents", sm_quat_array_encode_qtangents, -1);
+  rb_define_singleton_method(s_sm_quat_array_klass, "decode_qtangents", sm_quat_array_s_decode_qtangents, -1);
+  rb_define_method(s_sm_quat_array_klass, "delta_encode", sm_mathtype_array_delta_encode, -1);
+  rb_define_method(s_sm_quat_array_klass, "delta_apply!", sm_mathtype_array_delta_apply, 1);
+  rb_define_method(s_sm_quat_array_klass, "digest", sm_mathtype_array_digest, -1);
+  rb_define_method(s_sm_quat_array_klass, "==", sm_mathtype_array_equals, 1);
+  rb_define_method(s_sm_quat_array_klass, "eql?", sm_mathtype_array_eql, 1);
+  rb_define_method(s_sm_quat_array_klass, "hash", sm_mathtype_array_hash, 0);
+  rb_define_method(s_sm_quat_array_klass, "approx_equal", sm_mathtype_array_approx_equal, -1);
   rb_alias(s_sm_quat_array_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
   s_sm_mat3_array_klass = rb_define_class_under(s_sm_snowmath_mod, "Mat3Array", rb_cData);
@@ -7089,6 +13344,24 @@ void Init_bindings()
   rb_define_method(s_sm_mat3_array_klass, "size", sm_mat3_array_size, 0);
   rb_define_method(s_sm_mat3_array_klass, "length", sm_mathtype_array_length, 0);
   rb_define_method(s_sm_mat3_array_klass, "address", sm_get_address, 0);
+  rb_define_method(s_sm_mat3_array_klass, "convert_to", sm_mathtype_array_convert_to, -1);
+  rb_define_method(s_sm_mat3_array_klass, "snapshot", sm_mathtype_array_snapshot, 0);
+  rb_define_method(s_sm_mat3_array_klass, "multiply_mat3", sm_mat3_array_multiply_mat3, -1);
+  rb_define_method(s_sm_mat3_array_klass, "rotate_vec3", sm_mat3_array_rotate_vec3, -1);
+  rb_define_method(s_sm_mat3_array_klass, "inverse", sm_mat3_array_inverse, -1);
+  rb_define_method(s_sm_mat3_array_klass, "orthogonal", sm_mat3_array_orthogonal, -1);
+  rb_define_method(s_sm_mat3_array_klass, "orthonormalize!", sm_mat3_array_orthonormalize, 0);
+  rb_define_singleton_method(s_sm_mat3_array_klass, "trs_2d", sm_mat3_array_s_trs_2d, -1);
+  rb_define_method(s_sm_mat3_array_klass, "inverse_affine", sm_mat3_array_inverse_affine, -1);
+  rb_define_method(s_sm_mat3_array_klass, "encode_qtangents", sm_mat3_array_encode_qtangents, -1);
+  rb_define_singleton_method(s_sm_mat3_array_klass, "decode_qtangents", sm_mat3_array_s_decode_qtangents, -1);
+  rb_define_method(s_sm_mat3_array_klass, "delta_encode", sm_mathtype_array_delta_encode, -1);
+  rb_define_method(s_sm_mat3_array_klass, "delta_apply!", sm_mathtype_array_delta_apply, 1);
+  rb_define_method(s_sm_mat3_array_klass, "digest", sm_mathtype_array_digest, -1);
+  rb_define_method(s_sm_mat3_array_klass, "==", sm_mathtype_array_equals, 1);
+  rb_define_method(s_sm_mat3_array_klass, "eql?", sm_mathtype_array_eql, 1);
+  rb_define_method(s_sm_mat3_array_klass, "hash", sm_mathtype_array_hash, 0);
+  rb_define_method(s_sm_mat3_array_klass, "approx_equal", sm_mathtype_array_approx_equal, -1);
   rb_alias(s_sm_mat3_array_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
   s_sm_mat4_array_klass = rb_define_class_under(s_sm_snowmath_mod, "Mat4Array", rb_cData);
@@ -7101,8 +13374,46 @@ void Init_bindings()
   rb_define_method(s_sm_mat4_array_klass, "size", sm_mat4_array_size, 0);
   rb_define_method(s_sm_mat4_array_klass, "length", sm_mathtype_array_length, 0);
   rb_define_method(s_sm_mat4_array_klass, "address", sm_get_address, 0);
+  rb_define_method(s_sm_mat4_array_klass, "convert_to", sm_mathtype_array_convert_to, -1);
+  rb_define_method(s_sm_mat4_array_klass, "snapshot", sm_mathtype_array_snapshot, 0);
+  rb_define_method(s_sm_mat4_array_klass, "orthonormalize!", sm_mat4_array_orthonormalize, 0);
+  rb_define_method(s_sm_mat4_array_klass, "transform_aabbs", sm_mat4_array_transform_aabbs, -1);
+  rb_define_method(s_sm_mat4_array_klass, "delta_encode", sm_mathtype_array_delta_encode, -1);
+  rb_define_method(s_sm_mat4_array_klass, "delta_apply!", sm_mathtype_array_delta_apply, 1);
+  rb_define_method(s_sm_mat4_array_klass, "digest", sm_mathtype_array_digest, -1);
+  rb_define_method(s_sm_mat4_array_klass, "==", sm_mathtype_array_equals, 1);
+  rb_define_method(s_sm_mat4_array_klass, "eql?", sm_mathtype_array_eql, 1);
+  rb_define_method(s_sm_mat4_array_klass, "hash", sm_mathtype_array_hash, 0);
+  rb_define_method(s_sm_mat4_array_klass, "approx_equal", sm_mathtype_array_approx_equal, -1);
   rb_alias(s_sm_mat4_array_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
 
+  s_sm_float_array_klass = rb_define_class_under(s_sm_snowmath_mod, "FloatArray", rb_cData);
+  rb_define_const(s_sm_float_array_klass, "TYPE", rb_cFloat);
+  rb_define_singleton_method(s_sm_float_array_klass, "new", sm_float_array_new, 1);
+  rb_define_singleton_method(s_sm_float_array_klass, "lerp", sm_vec_array_s_lerp, -1);
+  rb_define_method(s_sm_float_array_klass, "freeze", sm_mathtype_array_freeze, 0);
+  rb_define_method(s_sm_float_array_klass, "fetch", sm_float_array_fetch, 1);
+  rb_define_method(s_sm_float_array_klass, "store", sm_float_array_store, 2);
+  rb_define_method(s_sm_float_array_klass, "resize!", sm_float_array_resize, 1);
+  rb_define_method(s_sm_float_array_klass, "size", sm_float_array_size, 0);
+  rb_define_method(s_sm_float_array_klass, "length", sm_mathtype_array_length, 0);
+  rb_define_method(s_sm_float_array_klass, "address", sm_get_address, 0);
+  rb_define_method(s_sm_float_array_klass, "convert_to", sm_mathtype_array_convert_to, -1);
+  rb_define_method(s_sm_float_array_klass, "snapshot", sm_mathtype_array_snapshot, 0);
+  rb_define_method(s_sm_float_array_klass, "axpy!", sm_vec_array_axpy, 2);
+  rb_define_method(s_sm_float_array_klass, "fill_uniform!", sm_vec_array_fill_uniform, -1);
+  rb_define_method(s_sm_float_array_klass, "fill_gaussian!", sm_vec_array_fill_gaussian, -1);
+  rb_define_method(s_sm_float_array_klass, "delta_encode", sm_mathtype_array_delta_encode, -1);
+  rb_define_method(s_sm_float_array_klass, "delta_apply!", sm_mathtype_array_delta_apply, 1);
+  rb_define_method(s_sm_float_array_klass, "digest", sm_mathtype_array_digest, -1);
+  rb_define_method(s_sm_float_array_klass, "==", sm_mathtype_array_equals, 1);
+  rb_define_method(s_sm_float_array_klass, "eql?", sm_mathtype_array_eql, 1);
+  rb_define_method(s_sm_float_array_klass, "hash", sm_mathtype_array_hash, 0);
+  rb_define_method(s_sm_float_array_klass, "approx_equal", sm_mathtype_array_approx_equal, -1);
+  rb_alias(s_sm_float_array_klass, kRB_BYTESIZE_METHOD, kRB_SIZE_METHOD);
+
+  rb_define_method(s_sm_quat_klass, "multiply_vec3_array", sm_quat_multiply_vec3_array, -1);
+
   #endif
 
 }
@@ -8,6 +8,7 @@
 #define __SNOW__VEC2_C__
 
 #include "maths_local.h"
+#include <stdlib.h>
 
 #if defined(__cplusplus)
 extern "C"
@@ -128,6 +129,337 @@ int vec2_equals(const vec2_t left, const vec2_t right)
          float_equals(left[1], right[1]);
 }
 
+void vec2_min(const vec2_t left, const vec2_t right, vec2_t out)
+{
+  out[0] = (left[0] < right[0]) ? left[0] : right[0];
+  out[1] = (left[1] < right[1]) ? left[1] : right[1];
+}
+
+void vec2_max(const vec2_t left, const vec2_t right, vec2_t out)
+{
+  out[0] = (left[0] > right[0]) ? left[0] : right[0];
+  out[1] = (left[1] > right[1]) ? left[1] : right[1];
+}
+
+/*!
+ * Clamps each component of v to the range given by the same components of
+ * lower and upper.
+ */
+void vec2_clamp(const vec2_t v, const vec2_t lower, const vec2_t upper, vec2_t out)
+{
+  s_float_t c;
+  c = (v[0] > lower[0]) ? v[0] : lower[0];
+  out[0] = (c < upper[0]) ? c : upper[0];
+  c = (v[1] > lower[1]) ? v[1] : lower[1];
+  out[1] = (c < upper[1]) ? c : upper[1];
+}
+
+/*!
+ * Linearly interpolates between from and to by delta. Delta is not clamped.
+ */
+void vec2_lerp(const vec2_t from, const vec2_t to, s_float_t delta, vec2_t out)
+{
+  out[0] = from[0] + (to[0] - from[0]) * delta;
+  out[1] = from[1] + (to[1] - from[1]) * delta;
+}
+
+void vec2_abs(const vec2_t v, vec2_t out)
+{
+  out[0] = s_fabs(v[0]);
+  out[1] = s_fabs(v[1]);
+}
+
+void vec2_floor(const vec2_t v, vec2_t out)
+{
+  out[0] = s_floor(v[0]);
+  out[1] = s_floor(v[1]);
+}
+
+void vec2_ceil(const vec2_t v, vec2_t out)
+{
+  out[0] = s_ceil(v[0]);
+  out[1] = s_ceil(v[1]);
+}
+
+void vec2_sign(const vec2_t v, vec2_t out)
+{
+  out[0] = float_sign(v[0]);
+  out[1] = float_sign(v[1]);
+}
+
+void vec2_array_to_vec3(const vec2_t *S_RESTRICT in, vec3_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    out[index][0] = in[index][0];
+    out[index][1] = in[index][1];
+    out[index][2] = s_float_lit(0.0);
+  }
+}
+
+void vec2_array_to_vec4(const vec2_t *S_RESTRICT in, s_float_t w, vec4_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    out[index][0] = in[index][0];
+    out[index][1] = in[index][1];
+    out[index][2] = s_float_lit(0.0);
+    out[index][3] = w;
+  }
+}
+
+/*
+  The random fills draw uniform numbers for a block of elements at a time.
+  In-sphere points use radius * sqrt(u) so they are uniform over the disc.
+*/
+#define VEC2_RANDOM_BLOCK 32
+
+void vec2_array_random_in_sphere(s_random_t *random, s_float_t radius, vec2_t *out, size_t count)
+{
+  s_float_t uniform[VEC2_RANDOM_BLOCK * 2];
+  size_t block;
+  size_t index;
+  for (block = 0; block < count; block += VEC2_RANDOM_BLOCK) {
+    const size_t block_count = (count - block < VEC2_RANDOM_BLOCK) ? count - block : VEC2_RANDOM_BLOCK;
+    s_random_uniform(random, uniform, block_count * 2);
+    for (index = 0; index < block_count; ++index) {
+      const s_float_t r = radius * s_sqrt(uniform[index * 2]);
+      const s_float_t angle = S_FLOAT_TAU * uniform[index * 2 + 1];
+      out[block + index][0] = r * s_cos(angle);
+      out[block + index][1] = r * s_sin(angle);
+    }
+  }
+}
+
+void vec2_array_random_on_sphere(s_random_t *random, s_float_t radius, vec2_t *out, size_t count)
+{
+  s_float_t uniform[VEC2_RANDOM_BLOCK];
+  size_t block;
+  size_t index;
+  for (block = 0; block < count; block += VEC2_RANDOM_BLOCK) {
+    const size_t block_count = (count - block < VEC2_RANDOM_BLOCK) ? count - block : VEC2_RANDOM_BLOCK;
+    s_random_uniform(random, uniform, block_count);
+    for (index = 0; index < block_count; ++index) {
+      const s_float_t angle = S_FLOAT_TAU * uniform[index];
+      out[block + index][0] = radius * s_cos(angle);
+      out[block + index][1] = radius * s_sin(angle);
+    }
+  }
+}
+
+/*
+  Polygons are count vertices in order, closed by an edge from the last vertex
+  back to the first. Signed area is positive for counter-clockwise polygons.
+*/
+static s_float_t vec2_cross_from(const vec2_t origin, const vec2_t a, const vec2_t b)
+{
+  return (a[0] - origin[0]) * (b[1] - origin[1]) - (a[1] - origin[1]) * (b[0] - origin[0]);
+}
+
+/* Even-odd crossing test against a horizontal ray toward +X */
+static int vec2_polygon_contains(const vec2_t *polygon, size_t count, const vec2_t point)
+{
+  const s_float_t x = point[0];
+  const s_float_t y = point[1];
+  size_t index;
+  size_t previous = count - 1;
+  int inside = 0;
+
+  for (index = 0; index < count; previous = index++) {
+    const s_float_t *a = polygon[index];
+    const s_float_t *b = polygon[previous];
+    if ((a[1] > y) != (b[1] > y) &&
+        x < (b[0] - a[0]) * (y - a[1]) / (b[1] - a[1]) + a[0]) {
+      inside = !inside;
+    }
+  }
+
+  return inside;
+}
+
+void vec2_array_polygon_contains(const vec2_t *polygon, size_t count, const vec2_t *points, s_float_t *out, size_t point_count)
+{
+  vec2_t low;
+  vec2_t high;
+  size_t index;
+
+  if (count < 3) {
+    for (index = 0; index < point_count; ++index) {
+      out[index] = s_float_lit(0.0);
+    }
+    return;
+  }
+
+  /* Points outside the polygon's bounds skip the edge loop */
+  vec2_copy(polygon[0], low);
+  vec2_copy(polygon[0], high);
+  for (index = 1; index < count; ++index) {
+    vec2_min(low, polygon[index], low);
+    vec2_max(high, polygon[index], high);
+  }
+
+  for (index = 0; index < point_count; ++index) {
+    const s_float_t *point = points[index];
+    const int bounded =
+      point[0] >= low[0] && point[0] <= high[0] &&
+      point[1] >= low[1] && point[1] <= high[1];
+    out[index] = (bounded && vec2_polygon_contains(polygon, count, point)) ? s_float_lit(1.0) : s_float_lit(0.0);
+  }
+}
+
+s_float_t vec2_polygon_area(const vec2_t *polygon, size_t count)
+{
+  s_float_t twice_area = s_float_lit(0.0);
+  size_t index;
+  /* Fanning from the first vertex keeps the products small */
+  for (index = 2; index < count; ++index) {
+    twice_area += vec2_cross_from(polygon[0], polygon[index - 1], polygon[index]);
+  }
+  return twice_area * s_float_lit(0.5);
+}
+
+void vec2_polygon_centroid(const vec2_t *polygon, size_t count, vec2_t out)
+{
+  s_float_t twice_area = s_float_lit(0.0);
+  vec2_t sum = { s_float_lit(0.0), s_float_lit(0.0) };
+  size_t index;
+
+  if (count == 0) {
+    vec2_copy(g_vec2_zero, out);
+    return;
+  }
+
+  for (index = 2; index < count; ++index) {
+    const s_float_t *a = polygon[index - 1];
+    const s_float_t *b = polygon[index];
+    const s_float_t cross = vec2_cross_from(polygon[0], a, b);
+    twice_area += cross;
+    sum[0] += cross * (a[0] + b[0] - s_float_lit(2.0) * polygon[0][0]);
+    sum[1] += cross * (a[1] + b[1] - s_float_lit(2.0) * polygon[0][1]);
+  }
+
+  if (float_is_zero(twice_area)) {
+    /* Degenerate polygons use the mean of their vertices */
+    vec2_copy(g_vec2_zero, sum);
+    for (index = 0; index < count; ++index) {
+      vec2_add(sum, polygon[index], sum);
+    }
+    vec2_scale(sum, s_float_lit(1.0) / (s_float_t)count, out);
+    return;
+  }
+
+  out[0] = polygon[0][0] + sum[0] / (s_float_lit(3.0) * twice_area);
+  out[1] = polygon[0][1] + sum[1] / (s_float_lit(3.0) * twice_area);
+}
+
+static int vec2_compare_xy(const void *left, const void *right)
+{
+  const s_float_t *l = (const s_float_t *)left;
+  const s_float_t *r = (const s_float_t *)right;
+  if (l[0] != r[0]) {
+    return (l[0] < r[0]) ? -1 : 1;
+  } else if (l[1] != r[1]) {
+    return (l[1] < r[1]) ? -1 : 1;
+  }
+  return 0;
+}
+
+/*
+  Andrew's monotone chain. The points are sorted in scratch and the lower and
+  upper hulls are built in out, which never holds more than count + 1 points.
+*/
+size_t vec2_array_convex_hull(const vec2_t *in, size_t count, vec2_t *scratch, vec2_t *out)
+{
+  size_t hull = 0;
+  size_t lower;
+  size_t index;
+
+  if (count == 0) {
+    return 0;
+  }
+
+  for (index = 0; index < count; ++index) {
+    vec2_copy(in[index], scratch[index]);
+  }
+  qsort(scratch, count, sizeof(vec2_t), vec2_compare_xy);
+
+  /* Repeated points would otherwise survive as zero-length hull edges */
+  for (lower = 1, index = 1; index < count; ++index) {
+    if (vec2_compare_xy(scratch[index], scratch[lower - 1]) != 0) {
+      vec2_copy(scratch[index], scratch[lower++]);
+    }
+  }
+  count = lower;
+
+  for (index = 0; index < count; ++index) {
+    while (hull >= 2 && vec2_cross_from(out[hull - 2], out[hull - 1], scratch[index]) <= s_float_lit(0.0)) {
+      --hull;
+    }
+    vec2_copy(scratch[index], out[hull++]);
+  }
+
+  lower = hull + 1;
+  for (index = count - 1; index > 0; --index) {
+    while (hull >= lower && vec2_cross_from(out[hull - 2], out[hull - 1], scratch[index - 1]) <= s_float_lit(0.0)) {
+      --hull;
+    }
+    vec2_copy(scratch[index - 1], out[hull++]);
+  }
+
+  /* The last point repeats the first unless every point was the same */
+  return (hull > 1) ? hull - 1 : hull;
+}
+
+void vec2_array_intersect_segments(const vec2_t *a0, size_t a0_step, const vec2_t *a1, size_t a1_step,
+  const vec2_t *b0, size_t b0_step, const vec2_t *b1, size_t b1_step,
+  size_t count, vec2_t *out, s_float_t *params)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    const s_float_t *p = a0[index * a0_step];
+    const s_float_t *q = b0[index * b0_step];
+    vec2_t r, s, qp;
+    s_float_t denom, t, u;
+
+    vec2_subtract(a1[index * a1_step], p, r);
+    vec2_subtract(b1[index * b1_step], q, s);
+    vec2_subtract(q, p, qp);
+    denom = r[0] * s[1] - r[1] * s[0];
+
+    if (float_is_zero(denom)) {
+      /* Parallel segments only meet if collinear, at the start of the overlap */
+      const s_float_t r_sq = vec2_dot_product(r, r);
+      t = s_float_lit(-1.0);
+      if (float_is_zero(qp[0] * r[1] - qp[1] * r[0]) && r_sq > s_float_lit(0.0)) {
+        s_float_t t0 = vec2_dot_product(qp, r) / r_sq;
+        s_float_t t1 = t0 + vec2_dot_product(s, r) / r_sq;
+        if (t0 > t1) {
+          const s_float_t swap = t0;
+          t0 = t1;
+          t1 = swap;
+        }
+        if (t0 <= s_float_lit(1.0) && t1 >= s_float_lit(0.0)) {
+          t = (t0 > s_float_lit(0.0)) ? t0 : s_float_lit(0.0);
+        }
+      }
+    } else {
+      t = (qp[0] * s[1] - qp[1] * s[0]) / denom;
+      u = (qp[0] * r[1] - qp[1] * r[0]) / denom;
+      if (t < s_float_lit(0.0) || t > s_float_lit(1.0) || u < s_float_lit(0.0) || u > s_float_lit(1.0)) {
+        t = s_float_lit(-1.0);
+      }
+    }
+
+    params[index] = t;
+    if (t < s_float_lit(0.0)) {
+      vec2_copy(p, out[index]);
+    } else {
+      out[index][0] = p[0] + r[0] * t;
+      out[index][1] = p[1] + r[1] * t;
+    }
+  }
+}
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
@@ -8,6 +8,7 @@
 #define __SNOW__VEC3_C__
 
 #include "maths_local.h"
+#include <string.h>
 
 #if defined(__cplusplus)
 extern "C"
@@ -108,7 +109,7 @@ void vec3_cross_product(const vec3_t left, const vec3_t right, vec3_t out)
 {
   s_float_t x, y, z;
   x = (left[1] * right[2]) - (left[2] * right[1]);
-  y = (left[0] * right[2]) - (left[2] * right[0]);
+  y = (left[2] * right[0]) - (left[0] * right[2]);
   z = (left[0] * right[1]) - (left[1] * right[0]);
   out[0] = x;
   out[1] = y;
@@ -150,6 +151,934 @@ int vec3_equals(const vec3_t left, const vec3_t right)
     float_equals(left[2], right[2]);
 }
 
+void vec3_min(const vec3_t left, const vec3_t right, vec3_t out)
+{
+  out[0] = (left[0] < right[0]) ? left[0] : right[0];
+  out[1] = (left[1] < right[1]) ? left[1] : right[1];
+  out[2] = (left[2] < right[2]) ? left[2] : right[2];
+}
+
+void vec3_max(const vec3_t left, const vec3_t right, vec3_t out)
+{
+  out[0] = (left[0] > right[0]) ? left[0] : right[0];
+  out[1] = (left[1] > right[1]) ? left[1] : right[1];
+  out[2] = (left[2] > right[2]) ? left[2] : right[2];
+}
+
+/*!
+ * Clamps each component of v to the range given by the same components of
+ * lower and upper.
+ */
+void vec3_clamp(const vec3_t v, const vec3_t lower, const vec3_t upper, vec3_t out)
+{
+  s_float_t c;
+  c = (v[0] > lower[0]) ? v[0] : lower[0];
+  out[0] = (c < upper[0]) ? c : upper[0];
+  c = (v[1] > lower[1]) ? v[1] : lower[1];
+  out[1] = (c < upper[1]) ? c : upper[1];
+  c = (v[2] > lower[2]) ? v[2] : lower[2];
+  out[2] = (c < upper[2]) ? c : upper[2];
+}
+
+/*!
+ * Linearly interpolates between from and to by delta. Delta is not clamped.
+ */
+void vec3_lerp(const vec3_t from, const vec3_t to, s_float_t delta, vec3_t out)
+{
+  out[0] = from[0] + (to[0] - from[0]) * delta;
+  out[1] = from[1] + (to[1] - from[1]) * delta;
+  out[2] = from[2] + (to[2] - from[2]) * delta;
+}
+
+void vec3_abs(const vec3_t v, vec3_t out)
+{
+  out[0] = s_fabs(v[0]);
+  out[1] = s_fabs(v[1]);
+  out[2] = s_fabs(v[2]);
+}
+
+void vec3_floor(const vec3_t v, vec3_t out)
+{
+  out[0] = s_floor(v[0]);
+  out[1] = s_floor(v[1]);
+  out[2] = s_floor(v[2]);
+}
+
+void vec3_ceil(const vec3_t v, vec3_t out)
+{
+  out[0] = s_ceil(v[0]);
+  out[1] = s_ceil(v[1]);
+  out[2] = s_ceil(v[2]);
+}
+
+void vec3_sign(const vec3_t v, vec3_t out)
+{
+  out[0] = float_sign(v[0]);
+  out[1] = float_sign(v[1]);
+  out[2] = float_sign(v[2]);
+}
+
+void vec3_array_to_vec2(const vec3_t *S_RESTRICT in, vec2_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    out[index][0] = in[index][0];
+    out[index][1] = in[index][1];
+  }
+}
+
+void vec3_array_to_vec4(const vec3_t *S_RESTRICT in, s_float_t w, vec4_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    out[index][0] = in[index][0];
+    out[index][1] = in[index][1];
+    out[index][2] = in[index][2];
+    out[index][3] = w;
+  }
+}
+
+void vec3_array_covariance(const vec3_t *in, size_t count, vec3_t mean, mat3_t out)
+{
+  s_float_t sums[9];
+  s_float_t inv_count;
+  s_float_t xy, yz, zx;
+  vec3_t origin;
+
+  if (count == 0) {
+    vec3_copy(g_vec3_zero, mean);
+    mat3_set(0, 0, 0, 0, 0, 0, 0, 0, 0, out);
+    return;
+  }
+
+  /* Offsetting by the first point keeps the one-pass sums well conditioned */
+  vec3_copy(in[0], origin);
+  float_array_moments3((const s_float_t *)in, count, origin, sums);
+  inv_count = s_float_lit(1.0) / (s_float_t)count;
+
+  mean[0] = origin[0] + sums[0] * inv_count;
+  mean[1] = origin[1] + sums[1] * inv_count;
+  mean[2] = origin[2] + sums[2] * inv_count;
+
+  xy = (sums[6] - sums[0] * sums[1] * inv_count) * inv_count;
+  yz = (sums[7] - sums[1] * sums[2] * inv_count) * inv_count;
+  zx = (sums[8] - sums[2] * sums[0] * inv_count) * inv_count;
+  mat3_set(
+    (sums[3] - sums[0] * sums[0] * inv_count) * inv_count, xy, zx,
+    xy, (sums[4] - sums[1] * sums[1] * inv_count) * inv_count, yz,
+    zx, yz, (sums[5] - sums[2] * sums[2] * inv_count) * inv_count,
+    out);
+}
+
+void vec3_array_fit_obb(const vec3_t *in, size_t count, vec3_t center, mat3_t axes, vec3_t half_extents)
+{
+  mat3_t covariance;
+  vec3_t eigenvalues;
+  vec3_t low;
+  vec3_t high;
+  vec3_t mid;
+  size_t index;
+  int axis;
+
+  if (count == 0) {
+    vec3_copy(g_vec3_zero, center);
+    vec3_copy(g_vec3_zero, half_extents);
+    mat3_identity(axes);
+    return;
+  }
+
+  vec3_array_covariance(in, count, center, covariance);
+  mat3_eigen_symmetric(covariance, axes, eigenvalues);
+
+  for (axis = 0; axis < 3; ++axis) {
+    low[axis] = high[axis] = vec3_dot_product(in[0], axes + axis * 3);
+  }
+  for (index = 1; index < count; ++index) {
+    for (axis = 0; axis < 3; ++axis) {
+      const s_float_t d = vec3_dot_product(in[index], axes + axis * 3);
+      low[axis] = (d < low[axis]) ? d : low[axis];
+      high[axis] = (d > high[axis]) ? d : high[axis];
+    }
+  }
+  for (axis = 0; axis < 3; ++axis) {
+    mid[axis] = (low[axis] + high[axis]) * s_float_lit(0.5);
+    half_extents[axis] = (high[axis] - low[axis]) * s_float_lit(0.5);
+  }
+
+  mat3_rotate_vec3(axes, mid, center);
+}
+
+/*
+  Bounding spheres, written as (x, y, z, radius). Points are read as
+  points[indices[i]] if indices is non-null and points[i] otherwise. Both
+  routines end with a pass growing the radius over any point that rounding
+  left outside, so every point is always contained.
+*/
+#define VEC3_GROUP_POINT(POINTS, INDICES, I) ((POINTS)[(INDICES) ? (INDICES)[(I)] : (I)])
+
+static void vec3_sphere_cover(const vec3_t *points, const size_t *indices, size_t count, vec4_t sphere)
+{
+  s_float_t radius_sq = sphere[3] * sphere[3];
+  vec3_t delta;
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    s_float_t distance_sq;
+    vec3_subtract(VEC3_GROUP_POINT(points, indices, index), sphere, delta);
+    distance_sq = vec3_length_squared(delta);
+    if (distance_sq > radius_sq) {
+      radius_sq = distance_sq;
+    }
+  }
+  sphere[3] = s_sqrt(radius_sq);
+}
+
+static size_t vec3_farthest_point(const vec3_t *points, const size_t *indices, size_t count, const vec3_t from)
+{
+  s_float_t farthest_sq = s_float_lit(-1.0);
+  size_t farthest = 0;
+  vec3_t delta;
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    s_float_t distance_sq;
+    vec3_subtract(VEC3_GROUP_POINT(points, indices, index), from, delta);
+    distance_sq = vec3_length_squared(delta);
+    if (distance_sq > farthest_sq) {
+      farthest_sq = distance_sq;
+      farthest = index;
+    }
+  }
+  return farthest;
+}
+
+void vec3_array_ritter_sphere(const vec3_t *points, const size_t *indices, size_t count, vec4_t out)
+{
+  const s_float_t *y;
+  const s_float_t *z;
+  s_float_t radius;
+  vec3_t delta;
+  size_t index;
+
+  if (count == 0) {
+    vec4_copy(g_vec4_zero, out);
+    return;
+  }
+
+  /* Start from the sphere spanning two points that are far apart */
+  y = VEC3_GROUP_POINT(points, indices, vec3_farthest_point(points, indices, count, VEC3_GROUP_POINT(points, indices, 0)));
+  z = VEC3_GROUP_POINT(points, indices, vec3_farthest_point(points, indices, count, y));
+  vec3_add(y, z, out);
+  vec3_scale(out, s_float_lit(0.5), out);
+  vec3_subtract(z, y, delta);
+  radius = vec3_length(delta) * s_float_lit(0.5);
+
+  /* Grow it just enough to reach each point outside it */
+  for (index = 0; index < count; ++index) {
+    const s_float_t *point = VEC3_GROUP_POINT(points, indices, index);
+    s_float_t distance_sq;
+    vec3_subtract(point, out, delta);
+    distance_sq = vec3_length_squared(delta);
+    if (distance_sq > radius * radius) {
+      const s_float_t distance = s_sqrt(distance_sq);
+      const s_float_t grown = (radius + distance) * s_float_lit(0.5);
+      vec3_scale(delta, (grown - radius) / distance, delta);
+      vec3_add(out, delta, out);
+      radius = grown;
+    }
+  }
+
+  out[3] = radius;
+  vec3_sphere_cover(points, indices, count, out);
+}
+
+static int vec3_sphere_contains(const vec4_t sphere, const vec3_t point)
+{
+  const s_float_t radius_sq = sphere[3] * sphere[3];
+  vec3_t delta;
+  if (sphere[3] < s_float_lit(0.0)) {
+    return 0;
+  }
+  vec3_subtract(point, sphere, delta);
+  return vec3_length_squared(delta) <= radius_sq + S_FLOAT_EPSILON * (radius_sq + S_FLOAT_EPSILON);
+}
+
+static void vec3_sphere_from_pair(const vec3_t a, const vec3_t b, vec4_t sphere)
+{
+  vec3_t delta;
+  vec3_add(a, b, sphere);
+  vec3_scale(sphere, s_float_lit(0.5), sphere);
+  vec3_subtract(b, a, delta);
+  sphere[3] = vec3_length(delta) * s_float_lit(0.5);
+}
+
+/* Circumscribed sphere of a triangle, centered in its plane */
+static int vec3_sphere_from_triangle(const vec3_t a, const vec3_t b, const vec3_t c, vec4_t sphere)
+{
+  vec3_t ab, ac, normal, term, offset;
+  s_float_t normal_sq;
+
+  vec3_subtract(b, a, ab);
+  vec3_subtract(c, a, ac);
+  vec3_cross_product(ab, ac, normal);
+  normal_sq = vec3_length_squared(normal);
+  if (normal_sq <= S_FLOAT_EPSILON * vec3_length_squared(ab) * vec3_length_squared(ac)) {
+    return 0;
+  }
+
+  vec3_cross_product(normal, ab, offset);
+  vec3_scale(offset, vec3_length_squared(ac), offset);
+  vec3_cross_product(ac, normal, term);
+  vec3_scale(term, vec3_length_squared(ab), term);
+  vec3_add(offset, term, offset);
+  vec3_scale(offset, s_float_lit(0.5) / normal_sq, offset);
+
+  vec3_add(a, offset, sphere);
+  sphere[3] = vec3_length(offset);
+  return 1;
+}
+
+/* Circumscribed sphere of a tetrahedron */
+static int vec3_sphere_from_tetrahedron(const vec3_t a, const vec3_t b, const vec3_t c, const vec3_t d, vec4_t sphere)
+{
+  vec3_t u, v, w, vw, wu, uv, offset;
+  s_float_t det;
+
+  vec3_subtract(b, a, u);
+  vec3_subtract(c, a, v);
+  vec3_subtract(d, a, w);
+  vec3_cross_product(v, w, vw);
+  vec3_cross_product(w, u, wu);
+  vec3_cross_product(u, v, uv);
+  det = vec3_dot_product(u, vw);
+  if (s_fabs(det) <= S_FLOAT_EPSILON * vec3_length(u) * vec3_length(v) * vec3_length(w)) {
+    return 0;
+  }
+
+  vec3_scale(vw, vec3_length_squared(u), offset);
+  vec3_scale(wu, vec3_length_squared(v), wu);
+  vec3_scale(uv, vec3_length_squared(w), uv);
+  vec3_add(offset, wu, offset);
+  vec3_add(offset, uv, offset);
+  vec3_scale(offset, s_float_lit(0.5) / det, offset);
+
+  vec3_add(a, offset, sphere);
+  sphere[3] = vec3_length(offset);
+  return 1;
+}
+
+/*
+  Smallest sphere with every support point on its surface. Degenerate sets
+  (collinear triangles, flat tetrahedra) fall back to the smallest sphere
+  through a subset that contains the rest. No support points give an empty
+  sphere with a negative radius.
+*/
+static void vec3_sphere_from_support(vec3_t support[4], int count, vec4_t sphere)
+{
+  switch (count) {
+  case 0:
+    vec4_copy(g_vec4_zero, sphere);
+    sphere[3] = s_float_lit(-1.0);
+    break;
+
+  case 1:
+    vec3_copy(support[0], sphere);
+    sphere[3] = s_float_lit(0.0);
+    break;
+
+  case 2:
+    vec3_sphere_from_pair(support[0], support[1], sphere);
+    break;
+
+  case 3:
+    if (!vec3_sphere_from_triangle(support[0], support[1], support[2], sphere)) {
+      vec4_t candidate;
+      int pair;
+      sphere[3] = s_float_lit(-1.0);
+      for (pair = 0; pair < 3; ++pair) {
+        vec3_sphere_from_pair(support[pair], support[(pair + 1) % 3], candidate);
+        if (candidate[3] > sphere[3]) {
+          vec4_copy(candidate, sphere);
+        }
+      }
+    }
+    break;
+
+  default:
+    if (!vec3_sphere_from_tetrahedron(support[0], support[1], support[2], support[3], sphere)) {
+      vec4_t candidate;
+      int skip;
+      sphere[3] = s_float_lit(-1.0);
+      for (skip = 0; skip < 4; ++skip) {
+        vec3_t triangle[4];
+        int corner;
+        int used = 0;
+        for (corner = 0; corner < 4; ++corner) {
+          if (corner != skip) {
+            vec3_copy(support[corner], triangle[used++]);
+          }
+        }
+        vec3_sphere_from_support(triangle, 3, candidate);
+        if (vec3_sphere_contains(candidate, support[skip]) &&
+            (sphere[3] < s_float_lit(0.0) || candidate[3] < sphere[3])) {
+          vec4_copy(candidate, sphere);
+        }
+      }
+      if (sphere[3] < s_float_lit(0.0)) {
+        vec3_sphere_from_support(support, 3, sphere);
+      }
+    }
+    break;
+  }
+}
+
+/*
+  Welzl's algorithm with the move-to-front heuristic: the sphere is rebuilt
+  with each point outside it as a support point, and that point is moved to
+  the front of list so later passes test it early.
+*/
+static void vec3_sphere_mtf(const vec3_t *points, size_t *list, size_t end, vec3_t support[4], int support_count, vec4_t sphere)
+{
+  size_t index;
+
+  vec3_sphere_from_support(support, support_count, sphere);
+  if (support_count == 4) {
+    return;
+  }
+
+  for (index = 0; index < end; ++index) {
+    const size_t point = list[index];
+    if (!vec3_sphere_contains(sphere, points[point])) {
+      vec3_copy(points[point], support[support_count]);
+      vec3_sphere_mtf(points, list, index, support, support_count + 1, sphere);
+      memmove(list + 1, list, index * sizeof(*list));
+      list[0] = point;
+    }
+  }
+}
+
+#define VEC3_SHUFFLE_BLOCK 64
+
+void vec3_array_min_sphere(const vec3_t *points, const size_t *indices, size_t count, size_t *scratch, vec4_t out)
+{
+  s_float_t uniform[VEC3_SHUFFLE_BLOCK];
+  s_random_t random;
+  vec3_t support[4];
+  size_t index;
+
+  if (count == 0) {
+    vec4_copy(g_vec4_zero, out);
+    return;
+  }
+
+  for (index = 0; index < count; ++index) {
+    scratch[index] = indices ? indices[index] : index;
+  }
+
+  /* A fixed shuffle keeps the expected linear time for sorted input */
+  s_random_seed(&random, (uint64_t)count, 0);
+  for (index = count - 1; index > 0; --index) {
+    const size_t block_index = (count - 1 - index) % VEC3_SHUFFLE_BLOCK;
+    size_t other;
+    size_t swap;
+    if (block_index == 0) {
+      s_random_uniform(&random, uniform, VEC3_SHUFFLE_BLOCK);
+    }
+    other = (size_t)(uniform[block_index] * (s_float_t)(index + 1));
+    other = (other > index) ? index : other;
+    swap = scratch[index];
+    scratch[index] = scratch[other];
+    scratch[other] = swap;
+  }
+
+  vec3_sphere_mtf(points, scratch, count, support, 0, out);
+  vec3_sphere_cover(points, scratch, count, out);
+}
+
+/*
+  Closest-point queries. Each query point is paired with a primitive whose
+  corners are read from arrays advanced by a step per query, so a step of 0
+  shares one primitive across every query. Distances are Euclidean and feature
+  ids are written as floats.
+*/
+static int vec3_closest_on_segment(const vec3_t p, const vec3_t a, const vec3_t b, vec3_t out)
+{
+  vec3_t ab, ap;
+  s_float_t length_sq, t;
+
+  vec3_subtract(b, a, ab);
+  vec3_subtract(p, a, ap);
+  length_sq = vec3_length_squared(ab);
+  t = (length_sq > s_float_lit(0.0)) ? vec3_dot_product(ap, ab) / length_sq : s_float_lit(0.0);
+
+  if (t <= s_float_lit(0.0)) {
+    vec3_copy(a, out);
+    return 0;
+  } else if (t >= s_float_lit(1.0)) {
+    vec3_copy(b, out);
+    return 1;
+  }
+
+  vec3_scale(ab, t, out);
+  vec3_add(a, out, out);
+  return 2;
+}
+
+static s_float_t vec3_closest_distance(const vec3_t p, const vec3_t closest)
+{
+  vec3_t delta;
+  vec3_subtract(p, closest, delta);
+  return vec3_length(delta);
+}
+
+/*
+  Segment and box queries are transposed a block at a time into rows of X, Y,
+  and Z so the maths kernels can answer a lane of queries at once. The closest
+  points are transposed back into out.
+*/
+#define VEC3_CLOSEST_BLOCK 64
+
+static void vec3_closest_block(const vec3_t *points, const vec3_t *a, size_t a_step,
+  const vec3_t *b, size_t b_step, size_t begin, size_t count, s_float_t *soa)
+{
+  size_t index;
+  int axis;
+  for (index = 0; index < count; ++index) {
+    for (axis = 0; axis < 3; ++axis) {
+      soa[axis * VEC3_CLOSEST_BLOCK + index] = points[begin + index][axis];
+      soa[(3 + axis) * VEC3_CLOSEST_BLOCK + index] = a[(begin + index) * a_step][axis];
+      soa[(6 + axis) * VEC3_CLOSEST_BLOCK + index] = b[(begin + index) * b_step][axis];
+    }
+  }
+}
+
+static void vec3_closest_unblock(const s_float_t *closest, size_t begin, size_t count, vec3_t *out)
+{
+  size_t index;
+  int axis;
+  for (index = 0; index < count; ++index) {
+    for (axis = 0; axis < 3; ++axis) {
+      out[begin + index][axis] = closest[axis * VEC3_CLOSEST_BLOCK + index];
+    }
+  }
+}
+
+void vec3_array_closest_on_segment(const vec3_t *points, const vec3_t *a, size_t a_step,
+  const vec3_t *b, size_t b_step, size_t count, vec3_t *out, s_float_t *distances, s_float_t *features)
+{
+  s_float_t soa[9 * VEC3_CLOSEST_BLOCK];
+  s_float_t closest[3 * VEC3_CLOSEST_BLOCK];
+  size_t begin;
+  for (begin = 0; begin < count; begin += VEC3_CLOSEST_BLOCK) {
+    const size_t block = (count - begin < VEC3_CLOSEST_BLOCK) ? count - begin : VEC3_CLOSEST_BLOCK;
+    vec3_closest_block(points, a, a_step, b, b_step, begin, block, soa);
+    float_array_closest_on_segment3(soa, VEC3_CLOSEST_BLOCK, closest, distances + begin, features + begin, block);
+    vec3_closest_unblock(closest, begin, block, out);
+  }
+}
+
+/*
+  Degenerate triangles are treated as their nearest edge. Segment features map
+  to the triangle's vertices and edges.
+*/
+static int vec3_closest_on_flat_triangle(const vec3_t p, const vec3_t a, const vec3_t b, const vec3_t c, vec3_t out)
+{
+  static const int edge_features[3][3] = { { 0, 1, 3 }, { 1, 2, 4 }, { 2, 0, 5 } };
+  const s_float_t *corners[4];
+  s_float_t best_distance = s_float_lit(-1.0);
+  int best_feature = 0;
+  int edge;
+
+  corners[0] = a; corners[1] = b; corners[2] = c; corners[3] = a;
+  for (edge = 0; edge < 3; ++edge) {
+    vec3_t closest;
+    const int feature = vec3_closest_on_segment(p, corners[edge], corners[edge + 1], closest);
+    const s_float_t distance = vec3_closest_distance(p, closest);
+    if (best_distance < s_float_lit(0.0) || distance < best_distance) {
+      best_distance = distance;
+      best_feature = edge_features[edge][feature];
+      vec3_copy(closest, out);
+    }
+  }
+  return best_feature;
+}
+
+/* Voronoi region tests from Ericson, Real-Time Collision Detection, 5.1.5 */
+static int vec3_closest_on_triangle(const vec3_t p, const vec3_t a, const vec3_t b, const vec3_t c, vec3_t out)
+{
+  vec3_t ab, ac, ap, bp, cp, normal;
+  s_float_t d1, d2, d3, d4, d5, d6, va, vb, vc, v, w, denom;
+
+  vec3_subtract(b, a, ab);
+  vec3_subtract(c, a, ac);
+  vec3_cross_product(ab, ac, normal);
+  if (vec3_length_squared(normal) <= S_FLOAT_EPSILON * vec3_length_squared(ab) * vec3_length_squared(ac)) {
+    return vec3_closest_on_flat_triangle(p, a, b, c, out);
+  }
+
+  vec3_subtract(p, a, ap);
+  d1 = vec3_dot_product(ab, ap);
+  d2 = vec3_dot_product(ac, ap);
+  if (d1 <= s_float_lit(0.0) && d2 <= s_float_lit(0.0)) {
+    vec3_copy(a, out);
+    return 0;
+  }
+
+  vec3_subtract(p, b, bp);
+  d3 = vec3_dot_product(ab, bp);
+  d4 = vec3_dot_product(ac, bp);
+  if (d3 >= s_float_lit(0.0) && d4 <= d3) {
+    vec3_copy(b, out);
+    return 1;
+  }
+
+  vc = d1 * d4 - d3 * d2;
+  if (vc <= s_float_lit(0.0) && d1 >= s_float_lit(0.0) && d3 <= s_float_lit(0.0)) {
+    vec3_scale(ab, d1 / (d1 - d3), out);
+    vec3_add(a, out, out);
+    return 3;
+  }
+
+  vec3_subtract(p, c, cp);
+  d5 = vec3_dot_product(ab, cp);
+  d6 = vec3_dot_product(ac, cp);
+  if (d6 >= s_float_lit(0.0) && d5 <= d6) {
+    vec3_copy(c, out);
+    return 2;
+  }
+
+  vb = d5 * d2 - d1 * d6;
+  if (vb <= s_float_lit(0.0) && d2 >= s_float_lit(0.0) && d6 <= s_float_lit(0.0)) {
+    vec3_scale(ac, d2 / (d2 - d6), out);
+    vec3_add(a, out, out);
+    return 5;
+  }
+
+  va = d3 * d6 - d5 * d4;
+  if (va <= s_float_lit(0.0) && (d4 - d3) >= s_float_lit(0.0) && (d5 - d6) >= s_float_lit(0.0)) {
+    vec3_subtract(c, b, out);
+    vec3_scale(out, (d4 - d3) / ((d4 - d3) + (d5 - d6)), out);
+    vec3_add(b, out, out);
+    return 4;
+  }
+
+  denom = s_float_lit(1.0) / (va + vb + vc);
+  v = vb * denom;
+  w = vc * denom;
+  vec3_scale(ab, v, ab);
+  vec3_scale(ac, w, ac);
+  vec3_add(a, ab, out);
+  vec3_add(out, ac, out);
+  return 6;
+}
+
+void vec3_array_closest_on_triangle(const vec3_t *points, const vec3_t *a, size_t a_step,
+  const vec3_t *b, size_t b_step, const vec3_t *c, size_t c_step, size_t count,
+  vec3_t *out, s_float_t *distances, s_float_t *features)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    vec3_t closest;
+    const int feature = vec3_closest_on_triangle(points[index],
+      a[index * a_step], b[index * b_step], c[index * c_step], closest);
+    distances[index] = vec3_closest_distance(points[index], closest);
+    features[index] = (s_float_t)feature;
+    vec3_copy(closest, out[index]);
+  }
+}
+
+void vec3_array_closest_on_aabb(const vec3_t *points, const vec3_t *mins, size_t mins_step,
+  const vec3_t *maxs, size_t maxs_step, size_t count, vec3_t *out, s_float_t *distances, s_float_t *features)
+{
+  s_float_t soa[9 * VEC3_CLOSEST_BLOCK];
+  s_float_t closest[3 * VEC3_CLOSEST_BLOCK];
+  size_t begin;
+  for (begin = 0; begin < count; begin += VEC3_CLOSEST_BLOCK) {
+    const size_t block = (count - begin < VEC3_CLOSEST_BLOCK) ? count - begin : VEC3_CLOSEST_BLOCK;
+    vec3_closest_block(points, mins, mins_step, maxs, maxs_step, begin, block, soa);
+    float_array_closest_on_aabb3(soa, VEC3_CLOSEST_BLOCK, closest, distances + begin, features + begin, block);
+    vec3_closest_unblock(closest, begin, block, out);
+  }
+}
+
+/*
+  Pairwise queries between query points and targets. Targets are transposed a
+  block at a time into separate X, Y, and Z arrays so the distances from each
+  query to a block are computed in lanes while the block stays in cache.
+  Queries are the range [query_begin, query_end) and their results are written
+  at their own positions. If self is nonzero, queries and targets are the same
+  array and a point is never paired with itself.
+*/
+#define VEC3_PAIR_BLOCK 256
+
+static size_t vec3_pair_block(const vec3_t *targets, size_t target_count, size_t block, s_float_t *soa)
+{
+  const size_t count = (target_count - block < VEC3_PAIR_BLOCK) ? target_count - block : VEC3_PAIR_BLOCK;
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    soa[index] = targets[block + index][0];
+    soa[VEC3_PAIR_BLOCK + index] = targets[block + index][1];
+    soa[2 * VEC3_PAIR_BLOCK + index] = targets[block + index][2];
+  }
+  return count;
+}
+
+void vec3_array_pairwise_distance(const vec3_t *queries, size_t query_begin, size_t query_end,
+  const vec3_t *targets, size_t target_count, s_float_t *out)
+{
+  s_float_t soa[VEC3_PAIR_BLOCK * 3];
+  size_t block;
+  size_t query;
+  size_t index;
+
+  for (block = 0; block < target_count; block += VEC3_PAIR_BLOCK) {
+    const size_t count = vec3_pair_block(targets, target_count, block, soa);
+    for (query = query_begin; query < query_end; ++query) {
+      s_float_t *row = out + query * target_count + block;
+      float_array_distance_sq3(queries[query], soa, soa + VEC3_PAIR_BLOCK, soa + 2 * VEC3_PAIR_BLOCK, row, count);
+      for (index = 0; index < count; ++index) {
+        row[index] = s_sqrt(row[index]);
+      }
+    }
+  }
+}
+
+void vec3_array_k_nearest(const vec3_t *queries, size_t query_begin, size_t query_end,
+  const vec3_t *targets, size_t target_count, size_t k, int self, s_float_t *indices, s_float_t *distances)
+{
+  s_float_t soa[VEC3_PAIR_BLOCK * 3];
+  s_float_t distance_sq[VEC3_PAIR_BLOCK];
+  size_t block;
+  size_t query;
+  size_t index;
+
+  for (index = query_begin * k; index < query_end * k; ++index) {
+    indices[index] = distances[index] = s_float_lit(-1.0);
+  }
+
+  for (block = 0; block < target_count; block += VEC3_PAIR_BLOCK) {
+    const size_t count = vec3_pair_block(targets, target_count, block, soa);
+    for (query = query_begin; query < query_end; ++query) {
+      s_float_t *nearest_indices = indices + query * k;
+      s_float_t *nearest = distances + query * k;
+      float_array_distance_sq3(queries[query], soa, soa + VEC3_PAIR_BLOCK, soa + 2 * VEC3_PAIR_BLOCK, distance_sq, count);
+      for (index = 0; index < count; ++index) {
+        const s_float_t d = distance_sq[index];
+        size_t slot = k - 1;
+        if ((self && block + index == query) ||
+            (nearest_indices[slot] >= s_float_lit(0.0) && d >= nearest[slot])) {
+          continue;
+        }
+        /* Insertion keeps each list sorted, with ties in target order */
+        for (; slot > 0 && (nearest_indices[slot - 1] < s_float_lit(0.0) || nearest[slot - 1] > d); --slot) {
+          nearest[slot] = nearest[slot - 1];
+          nearest_indices[slot] = nearest_indices[slot - 1];
+        }
+        nearest[slot] = d;
+        nearest_indices[slot] = (s_float_t)(block + index);
+      }
+    }
+  }
+
+  for (index = query_begin * k; index < query_end * k; ++index) {
+    if (indices[index] >= s_float_lit(0.0)) {
+      distances[index] = s_sqrt(distances[index]);
+    }
+  }
+}
+
+void vec3_array_pairs_within(const vec3_t *queries, size_t query_begin, size_t query_end,
+  const vec3_t *targets, size_t target_count, s_float_t radius, int self,
+  size_t *counts, s_float_t *firsts, s_float_t *seconds, s_float_t *distances)
+{
+  /* A negative radius contains nothing */
+  const s_float_t radius_sq = (radius < s_float_lit(0.0)) ? s_float_lit(-1.0) : radius * radius;
+  s_float_t soa[VEC3_PAIR_BLOCK * 3];
+  s_float_t distance_sq[VEC3_PAIR_BLOCK];
+  size_t block;
+  size_t query;
+  size_t index;
+
+  if (!firsts) {
+    for (query = query_begin; query < query_end; ++query) {
+      counts[query] = 0;
+    }
+  }
+
+  for (block = 0; block < target_count; block += VEC3_PAIR_BLOCK) {
+    const size_t count = vec3_pair_block(targets, target_count, block, soa);
+    for (query = query_begin; query < query_end; ++query) {
+      /* Pairs from the same array are only reported once, with first < second */
+      const size_t first_target = self ? query + 1 : 0;
+      if (block + count <= first_target) {
+        continue;
+      }
+      float_array_distance_sq3(queries[query], soa, soa + VEC3_PAIR_BLOCK, soa + 2 * VEC3_PAIR_BLOCK, distance_sq, count);
+      for (index = (first_target > block) ? first_target - block : 0; index < count; ++index) {
+        /* Written so a NaN distance or radius never makes a pair */
+        if (!(distance_sq[index] <= radius_sq)) {
+          continue;
+        } else if (firsts) {
+          const size_t pair = counts[query]++;
+          firsts[pair] = (s_float_t)query;
+          seconds[pair] = (s_float_t)(block + index);
+          distances[pair] = s_sqrt(distance_sq[index]);
+        } else {
+          counts[query] += 1;
+        }
+      }
+    }
+  }
+}
+
+/*
+  The random fills draw uniform numbers for a block of elements at a time.
+  Directions take z uniformly from [-1, 1] and an angle around the Z axis, and
+  in-sphere points scale them by radius * cbrt(u) so they are uniform over the
+  ball.
+*/
+#define VEC3_RANDOM_BLOCK 32
+
+void vec3_array_random_in_sphere(s_random_t *random, s_float_t radius, vec3_t *out, size_t count)
+{
+  s_float_t uniform[VEC3_RANDOM_BLOCK * 3];
+  size_t block;
+  size_t index;
+  for (block = 0; block < count; block += VEC3_RANDOM_BLOCK) {
+    const size_t block_count = (count - block < VEC3_RANDOM_BLOCK) ? count - block : VEC3_RANDOM_BLOCK;
+    s_random_uniform(random, uniform, block_count * 3);
+    for (index = 0; index < block_count; ++index) {
+      const s_float_t z = s_float_lit(1.0) - s_float_lit(2.0) * uniform[index * 3];
+      const s_float_t angle = S_FLOAT_TAU * uniform[index * 3 + 1];
+      const s_float_t r = radius * s_cbrt(uniform[index * 3 + 2]);
+      const s_float_t planar = r * s_sqrt(s_float_lit(1.0) - z * z);
+      out[block + index][0] = planar * s_cos(angle);
+      out[block + index][1] = planar * s_sin(angle);
+      out[block + index][2] = r * z;
+    }
+  }
+}
+
+void vec3_array_random_on_sphere(s_random_t *random, s_float_t radius, vec3_t *out, size_t count)
+{
+  s_float_t uniform[VEC3_RANDOM_BLOCK * 2];
+  size_t block;
+  size_t index;
+  for (block = 0; block < count; block += VEC3_RANDOM_BLOCK) {
+    const size_t block_count = (count - block < VEC3_RANDOM_BLOCK) ? count - block : VEC3_RANDOM_BLOCK;
+    s_random_uniform(random, uniform, block_count * 2);
+    for (index = 0; index < block_count; ++index) {
+      const s_float_t z = s_float_lit(1.0) - s_float_lit(2.0) * uniform[index * 2];
+      const s_float_t angle = S_FLOAT_TAU * uniform[index * 2 + 1];
+      const s_float_t planar = radius * s_sqrt(s_float_lit(1.0) - z * z);
+      out[block + index][0] = planar * s_cos(angle);
+      out[block + index][1] = planar * s_sin(angle);
+      out[block + index][2] = radius * z;
+    }
+  }
+}
+
+/*
+  Quantized positions. Each axis maps the box's extent to 0 through
+  2^bits - 1, packed with X in the lowest bits.
+*/
+size_t vec3_quantized_bytes(int bits)
+{
+  return ((size_t)bits * 3 + 7) / 8;
+}
+
+void vec3_array_quantize(const vec3_t *in, size_t count, const vec3_t lower, const vec3_t upper, int bits, uint8_t *out)
+{
+  const size_t stride = vec3_quantized_bytes(bits);
+  const uint64_t max_value = (UINT64_C(1) << bits) - 1;
+  vec3_t scale;
+  size_t index;
+  int axis;
+
+  for (axis = 0; axis < 3; ++axis) {
+    const s_float_t extent = upper[axis] - lower[axis];
+    scale[axis] = (extent > s_float_lit(0.0)) ? s_float_lit(1.0) / extent : s_float_lit(0.0);
+  }
+
+  for (index = 0; index < count; ++index) {
+    uint64_t packed = 0;
+    for (axis = 0; axis < 3; ++axis) {
+      const s_float_t t = (in[index][axis] - lower[axis]) * scale[axis];
+      packed |= s_quantize_unit(t, max_value) << (bits * axis);
+    }
+    s_store_packed(packed, stride, out + index * stride);
+  }
+}
+
+void vec3_array_dequantize(const uint8_t *in, size_t count, const vec3_t lower, const vec3_t upper, int bits, vec3_t *out)
+{
+  const size_t stride = vec3_quantized_bytes(bits);
+  const uint64_t max_value = (UINT64_C(1) << bits) - 1;
+  vec3_t scale;
+  size_t index;
+  int axis;
+
+  for (axis = 0; axis < 3; ++axis) {
+    scale[axis] = (upper[axis] - lower[axis]) / (s_float_t)max_value;
+  }
+
+  for (index = 0; index < count; ++index) {
+    const uint64_t packed = s_load_packed(in + index * stride, stride);
+    for (axis = 0; axis < 3; ++axis) {
+      const uint64_t value = (packed >> (bits * axis)) & max_value;
+      out[index][axis] = lower[axis] + (s_float_t)value * scale[axis];
+    }
+  }
+}
+
+/*
+  Octahedral directions. A direction is projected onto the octahedron
+  |x| + |y| + |z| = 1, whose lower half is folded over the upper so that the
+  whole sphere maps onto the square [-1, 1] in x and y.
+*/
+void vec3_array_encode_octahedral(const vec3_t *in, size_t count, uint8_t *out)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    const s_float_t *v = in[index];
+    const s_float_t l1 = s_fabs(v[0]) + s_fabs(v[1]) + s_fabs(v[2]);
+    s_float_t x = s_float_lit(0.0);
+    s_float_t y = s_float_lit(0.0);
+
+    if (l1 > s_float_lit(0.0)) {
+      x = v[0] / l1;
+      y = v[1] / l1;
+      if (v[2] < s_float_lit(0.0)) {
+        const s_float_t folded = (s_float_lit(1.0) - s_fabs(y)) * (x < s_float_lit(0.0) ? s_float_lit(-1.0) : s_float_lit(1.0));
+        y = (s_float_lit(1.0) - s_fabs(x)) * (y < s_float_lit(0.0) ? s_float_lit(-1.0) : s_float_lit(1.0));
+        x = folded;
+      }
+    }
+
+    s_store_snorm16(x, out + index * 4);
+    s_store_snorm16(y, out + index * 4 + 2);
+  }
+}
+
+void vec3_array_decode_octahedral(const uint8_t *in, size_t count, vec3_t *out)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    s_float_t x = s_load_snorm16(in + index * 4);
+    s_float_t y = s_load_snorm16(in + index * 4 + 2);
+    const s_float_t z = s_float_lit(1.0) - s_fabs(x) - s_fabs(y);
+
+    if (z < s_float_lit(0.0)) {
+      const s_float_t unfolded = (s_float_lit(1.0) - s_fabs(y)) * (x < s_float_lit(0.0) ? s_float_lit(-1.0) : s_float_lit(1.0));
+      y = (s_float_lit(1.0) - s_fabs(x)) * (y < s_float_lit(0.0) ? s_float_lit(-1.0) : s_float_lit(1.0));
+      x = unfolded;
+    }
+
+    out[index][0] = x;
+    out[index][1] = y;
+    out[index][2] = z;
+    vec3_normalize(out[index], out[index]);
+  }
+}
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
@@ -151,6 +151,150 @@ int vec4_equals(const vec4_t left, const vec4_t right)
     float_equals(left[3], right[3]);
 }
 
+void vec4_min(const vec4_t left, const vec4_t right, vec4_t out)
+{
+  out[0] = (left[0] < right[0]) ? left[0] : right[0];
+  out[1] = (left[1] < right[1]) ? left[1] : right[1];
+  out[2] = (left[2] < right[2]) ? left[2] : right[2];
+  out[3] = (left[3] < right[3]) ? left[3] : right[3];
+}
+
+void vec4_max(const vec4_t left, const vec4_t right, vec4_t out)
+{
+  out[0] = (left[0] > right[0]) ? left[0] : right[0];
+  out[1] = (left[1] > right[1]) ? left[1] : right[1];
+  out[2] = (left[2] > right[2]) ? left[2] : right[2];
+  out[3] = (left[3] > right[3]) ? left[3] : right[3];
+}
+
+/*!
+ * Clamps each component of v to the range given by the same components of
+ * lower and upper.
+ */
+void vec4_clamp(const vec4_t v, const vec4_t lower, const vec4_t upper, vec4_t out)
+{
+  s_float_t c;
+  c = (v[0] > lower[0]) ? v[0] : lower[0];
+  out[0] = (c < upper[0]) ? c : upper[0];
+  c = (v[1] > lower[1]) ? v[1] : lower[1];
+  out[1] = (c < upper[1]) ? c : upper[1];
+  c = (v[2] > lower[2]) ? v[2] : lower[2];
+  out[2] = (c < upper[2]) ? c : upper[2];
+  c = (v[3] > lower[3]) ? v[3] : lower[3];
+  out[3] = (c < upper[3]) ? c : upper[3];
+}
+
+/*!
+ * Linearly interpolates between from and to by delta. Delta is not clamped.
+ */
+void vec4_lerp(const vec4_t from, const vec4_t to, s_float_t delta, vec4_t out)
+{
+  out[0] = from[0] + (to[0] - from[0]) * delta;
+  out[1] = from[1] + (to[1] - from[1]) * delta;
+  out[2] = from[2] + (to[2] - from[2]) * delta;
+  out[3] = from[3] + (to[3] - from[3]) * delta;
+}
+
+void vec4_abs(const vec4_t v, vec4_t out)
+{
+  out[0] = s_fabs(v[0]);
+  out[1] = s_fabs(v[1]);
+  out[2] = s_fabs(v[2]);
+  out[3] = s_fabs(v[3]);
+}
+
+void vec4_floor(const vec4_t v, vec4_t out)
+{
+  out[0] = s_floor(v[0]);
+  out[1] = s_floor(v[1]);
+  out[2] = s_floor(v[2]);
+  out[3] = s_floor(v[3]);
+}
+
+void vec4_ceil(const vec4_t v, vec4_t out)
+{
+  out[0] = s_ceil(v[0]);
+  out[1] = s_ceil(v[1]);
+  out[2] = s_ceil(v[2]);
+  out[3] = s_ceil(v[3]);
+}
+
+void vec4_sign(const vec4_t v, vec4_t out)
+{
+  out[0] = float_sign(v[0]);
+  out[1] = float_sign(v[1]);
+  out[2] = float_sign(v[2]);
+  out[3] = float_sign(v[3]);
+}
+
+void vec4_array_to_vec2(const vec4_t *S_RESTRICT in, vec2_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    out[index][0] = in[index][0];
+    out[index][1] = in[index][1];
+  }
+}
+
+void vec4_array_to_vec3(const vec4_t *S_RESTRICT in, vec3_t *S_RESTRICT out, size_t count)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    out[index][0] = in[index][0];
+    out[index][1] = in[index][1];
+    out[index][2] = in[index][2];
+  }
+}
+
+void vec4_array_pack_rgba8(const vec4_t *in, size_t count, uint8_t *out)
+{
+  size_t index;
+  int component;
+  for (index = 0; index < count; ++index) {
+    for (component = 0; component < 4; ++component) {
+      out[index * 4 + component] = (uint8_t)s_quantize_unit(in[index][component], 255);
+    }
+  }
+}
+
+void vec4_array_unpack_rgba8(const uint8_t *in, size_t count, vec4_t *out)
+{
+  const s_float_t scale = s_float_lit(1.0) / s_float_lit(255.0);
+  size_t index;
+  int component;
+  for (index = 0; index < count; ++index) {
+    for (component = 0; component < 4; ++component) {
+      out[index][component] = (s_float_t)in[index * 4 + component] * scale;
+    }
+  }
+}
+
+void vec4_array_pack_rgb10a2(const vec4_t *in, size_t count, uint8_t *out)
+{
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    const uint64_t packed =
+      s_quantize_unit(in[index][0], 1023) |
+      (s_quantize_unit(in[index][1], 1023) << 10) |
+      (s_quantize_unit(in[index][2], 1023) << 20) |
+      (s_quantize_unit(in[index][3], 3) << 30);
+    s_store_packed(packed, 4, out + index * 4);
+  }
+}
+
+void vec4_array_unpack_rgb10a2(const uint8_t *in, size_t count, vec4_t *out)
+{
+  const s_float_t scale = s_float_lit(1.0) / s_float_lit(1023.0);
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    const uint64_t packed = s_load_packed(in + index * 4, 4);
+    out[index][0] = (s_float_t)(packed & 1023) * scale;
+    out[index][1] = (s_float_t)((packed >> 10) & 1023) * scale;
+    out[index][2] = (s_float_t)((packed >> 20) & 1023) * scale;
+    out[index][3] = (s_float_t)(packed >> 30) / s_float_lit(3.0);
+  }
+}
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
@@ -10,6 +10,7 @@ require 'snow-math/vec4'
 require 'snow-math/mat3'
 require 'snow-math/mat4'
 require 'snow-math/quat'
+require 'snow-math/float_array'
 require 'snow-math/swizzle'
 require 'snow-math/inspect'
 require 'snow-math/to_a'
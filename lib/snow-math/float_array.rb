@@ -0,0 +1,21 @@
+# This file is part of ruby-snowmath.
+# Copyright (c) 2013 Noel Raymond Cower. All rights reserved.
+# See COPYING for license details.
+
+require 'snow-math/bindings'
+
+module Snow ; end
+
+if Snow.const_defined?(:FloatArray)
+  #
+  # A contiguous array of floats. Allocated as a single block of memory so that
+  # it can easily be passed back to C libraries and used as the scalar input or
+  # output of batch operations on other typed arrays.
+  #
+  class Snow::FloatArray
+    class << self ; alias_method :[], :new ; end
+
+    alias_method :[], :fetch
+    alias_method :[]=, :store
+  end
+end
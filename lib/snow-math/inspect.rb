@@ -66,4 +66,8 @@ module Snow
     class Mat4Array ; include ::Snow::InspectSupport ; end
   end
 
+  if const_defined?(:FloatArray)
+    class FloatArray ; include ::Snow::InspectSupport ; end
+  end
+
 end
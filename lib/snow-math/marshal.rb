@@ -26,7 +26,7 @@ end
 module Snow::ArrayMarshalSupport # :nodoc: all
 
   def _dump(level)
-    to_dump = [self.length, *self.to_a.map { |elem| elem.copy }]
+    to_dump = [self.length, *self.to_a.map { |elem| elem.respond_to?(:copy) ? elem.copy : elem }]
     Marshal.dump(to_dump)
   end
 
@@ -78,4 +78,8 @@ module Snow
     class Mat4Array ; include ::Snow::ArrayMarshalSupport ; end
   end
 
+  if const_defined?(:FloatArray)
+    class FloatArray ; include ::Snow::ArrayMarshalSupport ; end
+  end
+
 end
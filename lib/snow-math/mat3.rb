@@ -44,98 +44,6 @@ class Snow::Mat3
     Quat.new(self)
   end
 
-  #
-  # Calls #transpose(self)
-  #
-  # call-seq: transpose! -> self
-  #
-  def transpose!
-    transpose self
-  end
-
-  #
-  # Calls #inverse(self)
-  #
-  # call-seq: inverse! -> self
-  #
-  def inverse!
-    inverse self
-  end
-
-  #
-  # Calls #adjoint(self)
-  #
-  # call-seq: adjoint! -> self
-  #
-  def adjoint!
-    adjoint self
-  end
-
-  #
-  # Calls #cofactor(self)
-  #
-  # call-seq: cofactor! -> self
-  #
-  def cofactor!
-    cofactor self
-  end
-
-  #
-  # Calls #multiply_mat3(rhs, self)
-  #
-  # call-seq: multiply_mat3!(rhs) -> self
-  #
-  def multiply_mat3!(rhs)
-    multiply_mat3 rhs, self
-  end
-
-  #
-  # Multiplies self and RHS and returns the result. This is a wrapper around
-  # other multiply methods. See multiply_mat3, rotate_vec3, and #scale for more
-  # reference.
-  #
-  # In the third form, the scalar value provided is passed for all three columns
-  # when calling scale.
-  #
-  # call-seq:
-  #   multiply(mat3, output = nil) -> output or new mat3
-  #   multiply(vec3, output = nil) -> output or new vec3
-  #   multiply(scalar, output = nil) -> output or new mat3
-  #
-  def multiply(rhs, out = nil)
-    case rhs
-    when ::Snow::Mat3 then multiply_mat3(rhs, out)
-    when ::Snow::Vec3 then rotate_vec3(rhs, out)
-    when Numeric      then scale(rhs, rhs, rhs, out)
-    else raise TypeError, "Invalid type for RHS"
-    end
-  end
-
-  #
-  # Calls #multiply(rhs, self).
-  #
-  # call-seq:
-  #     multiply!(mat3) -> self
-  #     multiply!(vec3) -> vec3
-  #     multiply!(scalar) -> self
-  #
-  def multiply!(rhs)
-    multiply rhs, case rhs
-      when ::Snow::Mat3, Numeric then self
-      when ::Snow::Vec3 then rhs
-      else raise TypeError, "Invalid type for RHS"
-      end
-  end
-
-  #
-  # Calls scale(x, y, z, self)
-  #
-  # call-seq: scale!(x, y, z) -> self
-  #
-  def scale!(x, y, z)
-    scale x, y, z, self
-  end
-
   #
   # Returns the pitch (X-axis rotation) of this matrix in degrees. This assumes
   # the matrix is orthogonal.
@@ -87,4 +87,10 @@ module Snow
     end
   end
 
+  if const_defined?(:FloatArray)
+    class FloatArray
+      include ::Snow::FiddlePointerSupport
+    end
+  end
+
 end
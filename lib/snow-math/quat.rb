@@ -123,105 +123,6 @@ class Snow::Quat
     self[3] = value
   end
 
-  # Calls #normalize(self)
-  #
-  # call-seq: normalize! -> self
-  def normalize!
-    normalize self
-  end
-
-  # Calls #inverse(self)
-  #
-  # call-seq: inverse! -> self
-  def inverse!
-    inverse self
-  end
-
-  # Calls #negate(self)
-  #
-  # call-seq: negate! -> self
-  def negate!
-    negate self
-  end
-
-  # Calls #multiply_quat(rhs, self)
-  #
-  # call-seq: multiply_quat!(rhs) -> self
-  def multiply_quat!(rhs)
-    multiply_quat rhs, self
-  end
-
-  # Calls #multiply_vec3(rhs, rhs)
-  #
-  # call-seq: multiply_vec3!(rhs) -> rhs
-  def multiply_vec3!(rhs)
-    multiply_vec3 rhs, rhs
-  end
-
-  # Wrapper around #multiply_quat, #multiply_vec3, and #scale respectively.
-  #
-  # call-seq:
-  #     multiply(quat, output = nil) -> output or new quat
-  #     multiply(scalar, output = nil) -> output or new quat
-  #     multiply(vec3, output = nil) -> output or new vec3
-  def multiply(rhs, output = nil)
-    case rhs
-    when ::Snow::Quat then multiply_quat(rhs, output)
-    when ::Snow::Vec3 then multiply_vec3(rhs, output)
-    when Numeric then scale(rhs, output)
-    else raise TypeError, "Invalid type for RHS"
-    end
-  end
-
-  # Calls #multiply(rhs, self) for scaling and Quat multiplication, otherwise
-  # calls #multiply(rhs, rhs) for Vec3 multiplication.
-  #
-  # call-seq:
-  #     multiply!(quat) -> self
-  #     multiply!(scalar) -> self
-  #     multiply!(vec3) -> vec3
-  def multiply!(rhs)
-    case rhs
-    when ::Snow::Vec3 then multiply(rhs, rhs)
-    else multiply(rhs, self)
-    end
-  end
-
-  # Calls #add(rhs, self)
-  #
-  # call-seq: add!(rhs) -> self
-  def add!(rhs)
-    add rhs, self
-  end
-
-  # Calls #subtract(rhs, self)
-  #
-  # call-seq: subtract!(rhs) -> self
-  def subtract!(rhs)
-    subtract rhs, self
-  end
-
-  # Calls #scale(rhs, self)
-  #
-  # call-seq: scale!(rhs) -> self
-  def scale!(rhs)
-    scale rhs, self
-  end
-
-  # Calls #divide(rhs, self)
-  #
-  # call-seq: divide!(rhs) -> self
-  def divide!(rhs)
-    divide rhs, self
-  end
-
-  # Calls #slerp(destination, alpha, self)
-  #
-  # call-seq: slerp!(destination, alpha) -> self
-  def slerp!(destination, alpha)
-    slerp(destination, alpha, self)
-  end
-
   def pitch
     x, y, z, w = self[0], self[1], self[2], self[3]
     tx = 2.0 * (x * z - w * y)
@@ -216,4 +216,21 @@ module Snow
     end
   end
 
+  if const_defined?(:FloatArray)
+    class FloatArray
+      include ::Snow::ArraySupport
+
+      #
+      # Duplicates the FloatArray and returns it.
+      #
+      # call-seq: dup -> new float_array
+      #
+      def dup
+        self.class.new(self)
+      end
+
+      alias_method :clone, :dup
+    end
+  end
+
 end
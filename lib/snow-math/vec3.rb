@@ -103,90 +103,6 @@ class Snow::Vec3
     self[2] = value
   end
 
-  # Calls #normalize(self)
-  #
-  # call-seq: normalize! -> self
-  def normalize!
-    normalize self
-  end
-
-  # Calls #inverse(self)
-  #
-  # call-seq: inverse! -> self
-  def inverse!
-    inverse self
-  end
-
-  # Calls #negate(self)
-  #
-  # call-seq: negate! -> self
-  def negate!
-    negate self
-  end
-
-  # Calls #cross_product(rhs, self)
-  #
-  # call-seq: cross_product!(rhs) -> self
-  def cross_product!(rhs)
-    cross_product rhs, self
-  end
-
-  # Calls #multiply_vec3(rhs, self)
-  #
-  # call-seq: multiply_vec3!(rhs) -> self
-  def multiply_vec3!(rhs)
-    multiply_vec3 rhs, self
-  end
-
-  # Calls #multiply_vec3 and #scale, respectively.
-  #
-  # call-seq:
-  #     multiply(vec3, output) -> output or new vec3
-  #     multiply(scalar, output) -> output or new vec3
-  def multiply(rhs, output = nil)
-    case rhs
-    when ::Snow::Vec3, ::Snow::Vec4, ::Snow::Quat then multiply_vec3(rhs, output)
-    when Numeric then scale(rhs, output)
-    else raise TypeError, "Invalid type for RHS"
-    end
-  end
-
-  # Calls #multiply(rhs, self)
-  #
-  # call-seq: multiply!(rhs) -> self
-  def multiply!(rhs)
-    multiply rhs, self
-  end
-
-  # Calls #add(rhs, self)
-  #
-  # call-seq: add!(rhs) -> self
-  def add!(rhs)
-    add rhs, self
-  end
-
-  # Calls #subtract(rhs, self)
-  #
-  # call-seq: subtract!(rhs) -> self
-  def subtract!(rhs)
-    subtract rhs, self
-  end
-
-  # Calls #scale(rhs, self)
-  #
-  # call-seq: scale!(rhs) -> self
-  def scale!(rhs)
-    scale rhs, self
-  end
-
-  # Calls #divide(rhs, self)
-  #
-  # call-seq: divide!(rhs) -> self
-  def divide!(rhs)
-    divide rhs, self
-  end
-
-
   alias_method :-, :subtract
   alias_method :+, :add
   alias_method :^, :cross_product
@@ -117,83 +117,6 @@ class Snow::Vec4
     self[3] = value
   end
 
-  # Calls #normalize(self)
-  #
-  # call-seq: normalize! -> self
-  def normalize!
-    normalize self
-  end
-
-  # Calls #inverse(self)
-  #
-  # call-seq: inverse! -> self
-  def inverse!
-    inverse self
-  end
-
-  # Calls #negate(self)
-  #
-  # call-seq: negate! -> self
-  def negate!
-    negate self
-  end
-
-  # Calls #multiply_vec4(rhs, self)
-  #
-  # call-seq: multiply_vec4!(rhs) -> self
-  def multiply_vec4!(rhs)
-    multiply_vec4 rhs, self
-  end
-
-  # Calls #multiply_vec4 and #scale, respectively.
-  #
-  # call-seq:
-  #     multiply(vec4, output = nil) -> output or new vec4
-  #     multiply(scalar, output = nil) -> output or new vec4
-  def multiply(rhs, output = nil)
-    case rhs
-    when ::Snow::Vec4, ::Snow::Quat then multiply_vec4(rhs, output)
-    when Numeric then scale(rhs, output)
-    else raise TypeError, "Invalid type for RHS"
-    end
-  end
-
-  # Calls #multiply(rhs, self)
-  #
-  # call-seq: multiply!(rhs) -> self
-  def multiply!(rhs)
-    multiply rhs, self
-  end
-
-  # Calls #add(rhs, self)
-  #
-  # call-seq: add!(rhs) -> self
-  def add!(rhs)
-    add rhs, self
-  end
-
-  # Calls #subtract(rhs, self)
-  #
-  # call-seq: subtract!(rhs) -> self
-  def subtract!(rhs)
-    subtract rhs, self
-  end
-
-  # Calls #scale(rhs, self)
-  #
-  # call-seq: scale!(rhs) -> self
-  def scale!(rhs)
-    scale rhs, self
-  end
-
-  # Calls #divide(rhs, self)
-  #
-  # call-seq: divide!(rhs) -> self
-  def divide!(rhs)
-    divide rhs, self
-  end
-
-
   alias_method :-, :subtract
   alias_method :+, :add
   alias_method :*, :multiply